@@ -0,0 +1,122 @@
+/*
+ *   File name:	kbatchjob.cpp
+ *   Summary:	Support classes for KDirStat - reading a tree without any GUI
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <stdio.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qtextstream.h>
+#include <kapp.h>
+#include <kdebug.h>
+
+#include "kbatchjob.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KBatchJob::KBatchJob( const QString & input )
+    : QObject()
+    , _input( input )
+    , _ok( false )
+{
+    _tree = new KDirTree();
+    CHECK_PTR( _tree );
+
+    connect( _tree, SIGNAL( finished()        ),
+	     this,  SLOT  ( readingFinished() ) );
+
+    connect( _tree, SIGNAL( aborted()         ),
+	     this,  SLOT  ( readingAborted()  ) );
+}
+
+
+KBatchJob::~KBatchJob()
+{
+    if ( _tree )
+	delete _tree;
+}
+
+
+void
+KBatchJob::start()
+{
+    QFileInfo info( _input );
+
+    if ( info.isFile() )
+    {
+	// kdDebug() << "Reading cache file " << _input << endl;
+	_tree->readCache( _input );
+    }
+    else
+    {
+	// kdDebug() << "Reading directory " << _input << endl;
+	_tree->startReading( fixedUrl( _input ) );
+    }
+}
+
+
+void
+KBatchJob::readingFinished()
+{
+    _ok = process( _tree );
+
+    if ( ! writeScanStats() )
+	_ok = false;
+
+    kapp->quit();
+}
+
+
+void
+KBatchJob::readingAborted()
+{
+    kdError() << "Reading " << _input << " aborted" << endl;
+    _ok = false;
+    writeScanStats();
+
+    kapp->quit();
+}
+
+
+bool
+KBatchJob::writeScanStats()
+{
+    if ( _scanStatsFile.isEmpty() )
+	return true;
+
+    QFile file( _scanStatsFile );
+    bool  opened;
+
+    if ( _scanStatsFile == "-" )
+	opened = file.open( IO_WriteOnly, stderr );
+    else
+	opened = file.open( IO_WriteOnly );
+
+    if ( ! opened )
+    {
+	kdError() << "Can't open " << _scanStatsFile << endl;
+	return false;
+    }
+
+    QTextStream str( &file );
+    str << _tree->scanStats()->toJson();
+    file.close();
+
+    return true;
+}
+
+
+
+// EOF
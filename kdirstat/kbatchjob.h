@@ -0,0 +1,130 @@
+/*
+ *   File name:	kbatchjob.h
+ *   Summary:	Support classes for KDirStat - reading a tree without any GUI
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KBatchJob_h
+#define KBatchJob_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qobject.h>
+#include <qstring.h>
+
+
+namespace KDirStat
+{
+    class KDirTree;
+
+
+    /**
+     * Abstract base class for command line batch jobs: Reads a directory or
+     * a cache file into a @ref KDirTree, calls process() as soon as reading
+     * is finished, then quits the application.
+     *
+     * Derived classes only need to implement process().
+     *
+     * Typical usage in main():
+     *
+     *     KApplication app( false, false );	// No styles, no GUI
+     *     KMyBatchJob job( input );
+     *     job.start();
+     *     app.exec();
+     *
+     *     return job.ok() ? 0 : 1;
+     *
+     * @short Abstract base class for batch jobs on a directory tree
+     **/
+    class KBatchJob: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor. 'input' is either a directory (path or URL) or a
+	 * KDirStat cache file.
+	 **/
+	KBatchJob( const QString & input );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KBatchJob();
+
+	/**
+	 * Start reading the input. process() is called once reading is
+	 * finished.
+	 **/
+	void start();
+
+	/**
+	 * Returns 'true' if the job was successful.
+	 **/
+	bool ok() const { return _ok; }
+
+	/**
+	 * Returns the input directory or cache file.
+	 **/
+	const QString & input() const { return _input; }
+
+	/**
+	 * Write the scan statistics (see @ref KScanStats) in JSON format to
+	 * file 'fileName' when reading is finished or aborted. "-" means
+	 * stderr.
+	 **/
+	void setScanStatsFile( const QString & fileName ) { _scanStatsFile = fileName; }
+
+
+    protected slots:
+
+	/**
+	 * Reading is finished - process the tree and quit.
+	 **/
+	void readingFinished();
+
+	/**
+	 * Reading was aborted - quit without processing anything.
+	 **/
+	void readingAborted();
+
+
+    protected:
+
+	/**
+	 * Do the real work on the completely read tree 'tree'.
+	 * Return 'true' on success, 'false' on error.
+	 *
+	 * Derived classes are required to implement this.
+	 **/
+	virtual bool process( KDirTree * tree ) = 0;
+
+	/**
+	 * Write the scan statistics if there is a file for them.
+	 * Returns 'false' upon error.
+	 **/
+	bool writeScanStats();
+
+
+	KDirTree *	_tree;
+	QString		_input;
+	QString		_scanStatsFile;
+	bool		_ok;
+
+    }; // class KBatchJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KBatchJob_h
+
+
+// EOF
@@ -12,22 +12,17 @@
 #   include <config.h>
 #endif
 
-#include <stdlib.h>
-#include <qapplication.h>
 #include <qregexp.h>
+#include <qstringlist.h>
 
 #include <kapp.h>
-#include <kprocess.h>
 #include <kdebug.h>
 #include <kmessagebox.h>
 #include <klocale.h>
 #include <kglobalsettings.h>
 
 #include "kcleanup.h"
-#include "kdirsaver.h"
-
-#define VERBOSE_RUN_COMMAND	1
-#define SIMULATE_COMMAND	0
+#include "kcleanupbatch.h"
 
 using namespace KDirStat;
 
@@ -118,47 +113,66 @@ KCleanup::worksFor( KFileInfo *item ) const
 }
 
 
-void
-KCleanup::selectionChanged( KFileInfo *selection )
+bool
+KCleanup::canExecute( KFileInfo *item ) const
 {
-    bool enabled = false;
-    _selection = selection;
+    if ( ! worksFor( item ) )
+	return false;
 
-    if ( selection )
+    if ( ! item->isFinished() )
     {
-	enabled = worksFor( selection );
+	// This subtree isn't finished reading yet
 
-	if ( ! selection->isFinished() )
+	switch ( _refreshPolicy )
 	{
-	    // This subtree isn't finished reading yet
+	    // Refresh policies that would cause this subtree to be deleted
+	    case refreshThis:
+	    case refreshParent:
+	    case assumeDeleted:
 
-	    switch ( _refreshPolicy )
-	    {
-		// Refresh policies that would cause this subtree to be deleted
-		case refreshThis:
-		case refreshParent:
-		case assumeDeleted:
-
-		    // Prevent premature deletion of this tree - this would
-		    // cause a core dump for sure. 
-		    enabled = false;
-		    break;
-			
-		default:
-		    break;
-	    }
-	    
+		// Prevent premature deletion of this tree - this would
+		// cause a core dump for sure.
+		return false;
+
+	    default:
+		break;
 	}
     }
-    
-    KAction::setEnabled( enabled );
+
+    return true;
+}
+
+
+bool
+KCleanup::isPlainDelete() const
+{
+    QRegExp plainDelete( "^rm +-(rf|fr|Rf|fR) +('%p'|\"%p\"|%p)$" );
+
+    return plainDelete.search( _command.simplifyWhiteSpace() ) >= 0;
+}
+
+
+void
+KCleanup::selectionChanged( KFileInfo *selection )
+{
+    _selection = selection;
+    KAction::setEnabled( selection && canExecute( selection ) );
 }
 
 
 void
 KCleanup::executeWithSelection()
 {
-    if ( _selection )
+    if ( ! _selection )
+	return;
+
+    // Copy the selected items: Executing this cleanup might change them.
+
+    QPtrList<KFileInfo> items = _selection->tree()->selectedItems();
+
+    if ( items.count() > 1 )
+	execute( items );
+    else
 	execute( _selection );
 }
 
@@ -188,6 +202,29 @@ KCleanup::confirmation( KFileInfo * item )
 }
 
 
+bool
+KCleanup::confirmation( const QPtrList<KFileInfo> & items )
+{
+    QStringList urls;
+    QPtrListIterator<KFileInfo> it( items );
+
+    for ( ; *it; ++it )
+	urls.append( (*it)->url() );
+
+    QString msg = i18n( "%1\nfor %2 items:" ).arg( cleanTitle() ).arg( items.count() );
+
+    if ( KMessageBox::warningContinueCancelList( 0,			// parentWidget
+						 msg,			// message
+						 urls,			// strlist
+						 i18n( "Please Confirm" ),	// caption
+						 i18n( "Confirm" )	// confirmButtonLabel
+						 ) == KMessageBox::Continue )
+	return true;
+    else
+	return false;
+}
+
+
 void
 KCleanup::execute( KFileInfo *item )
 {
@@ -195,52 +232,133 @@ KCleanup::execute( KFileInfo *item )
     {
 	if ( _askForConfirmation && ! confirmation( item ) )
 	    return;
-	    
-	KDirTree  * tree = item->tree();
-	
-	executeRecursive( item );
-	
+
+	QPtrList<KFileInfo> items;
+	items.append( item );
+	run( items );
+    }
+
+    emit executed();
+}
+
+
+void
+KCleanup::execute( const QPtrList<KFileInfo> & selectedItems )
+{
+    QPtrList<KFileInfo> items;
+    QPtrListIterator<KFileInfo> it( selectedItems );
+
+    for ( ; *it; ++it )
+    {
+	if ( canExecute( *it ) )
+	    items.append( *it );
+    }
+
+    if ( items.count() < 2 )
+    {
+	if ( items.isEmpty() )
+	    emit executed();
+	else
+	    execute( items.first() );
+
+	return;
+    }
+
+    if ( _askForConfirmation && ! confirmation( items ) )
+	return;
+
+    run( items );
+    emit executed();
+}
+
+
+void
+KCleanup::run( const QPtrList<KFileInfo> & items )
+{
+    KDirTree * tree = items.getFirst()->tree();
+
+    if ( isPlainDelete() && tree->isFileProtocol() )
+    {
+	// No need to start a shell for that: The tree's delete job does the
+	// same in the background, and it takes care of updating the tree,
+	// too - no matter what the refresh policy says. Deleting something
+	// deletes everything in it, too.
+
+	QPtrList<KFileInfo> outermost = KDirTree::outermostItems( items );
+
+	for ( KFileInfo * item = outermost.first(); item; item = outermost.next() )
+	    tree->deleteJob()->add( item );
+
+	return;
+    }
+
+
+    // Expand the commands for all items while they are still there.
+
+    QString batchTitle;
+
+    if ( items.count() == 1 )
+	batchTitle = i18n( "%1: %2" ).arg( cleanTitle() ).arg( items.getFirst()->url() );
+    else
+	batchTitle = i18n( "%1: %2 items" ).arg( cleanTitle() ).arg( items.count() );
+
+    KCleanupBatch * batch = new KCleanupBatch( tree, batchTitle );
+    CHECK_PTR( batch );
+
+    QPtrListIterator<KFileInfo> it( items );
+
+    for ( ; *it; ++it )
+    {
+	KFileInfo * item = *it;
+	executeRecursive( item, batch );
+
 	switch ( _refreshPolicy )
 	{
 	    case noRefresh:
-		// Do nothing.
+	    case assumeDeleted:
 		break;
 
-
 	    case refreshThis:
-		tree->refresh( item );
+		batch->addRefresh( item );
 		break;
 
-
 	    case refreshParent:
-		tree->refresh( item->parent() );
+		batch->addRefresh( item->parent() );
 		break;
+	}
+    }
 
+    if ( _refreshPolicy == assumeDeleted )
+    {
+	// Assume the commands delete the items, and update the tree only once
+	// for all of them.
+	//
+	// Don't try to figure out a reasonable next selection - the views
+	// have to do that while handling the subtree deletion. Only the views
+	// have any knowledge about a reasonable strategy for choosing a next
+	// selection. Unlike the view items, the KFileInfo items don't have an
+	// order that makes any sense to the user.
 
-	    case assumeDeleted:
-
-		// Assume the cleanup action has deleted the item.
-		// Modify the KDirTree accordingly.
+	QPtrList<KFileInfo> outermost = KDirTree::outermostItems( items );
 
-		tree->deleteSubtree( item );
+	tree->beginUpdate();
 
-		// Don't try to figure out a reasonable next selection - the
-		// views have to do that while handling the subtree
-		// deletion. Only the views have any knowledge about a
-		// reasonable strategy for choosing a next selection. Unlike
-		// the view items, the KFileInfo items don't have an order that
-		// makes any sense to the user.
+	for ( KFileInfo * item = outermost.first(); item; item = outermost.next() )
+	    tree->deleteSubtree( item );
 
-		break;
-	}
+	tree->endUpdate();
     }
 
-    emit executed();
+    // Let everybody who wants to watch it know before it starts - a batch
+    // that has nothing to do is gone right away.
+
+    emit batchStarted( batch );
+    batch->start();
 }
 
 
 void
-KCleanup::executeRecursive( KFileInfo *item )
+KCleanup::executeRecursive( KFileInfo *item, KCleanupBatch *batch )
 {
     if ( worksFor( item ) )
     {
@@ -261,7 +379,7 @@ KCleanup::executeRecursive( KFileInfo *item )
 		     * the dot entry) if there are no real subdirectories on
 		     * this directory level.
 		     **/
-		    executeRecursive( subdir );
+		    executeRecursive( subdir, batch );
 		}
 		subdir = subdir->next();
 	    }
@@ -270,7 +388,7 @@ KCleanup::executeRecursive( KFileInfo *item )
 
 	// Perform cleanup for this directory.
 
-	runCommand( item, _command );
+	batch->addCommand( itemDir( item ), expandVariables( item, _command ) );
     }
 }
 
@@ -328,59 +446,6 @@ KCleanup::expandVariables( const KFileInfo *	item,
     return expanded;
 }
 
-#include <qtextcodec.h>
-void
-KCleanup::runCommand ( const KFileInfo *	item,
-		       const QString &		command ) const
-{
-    KProcess	proc;
-    KDirSaver	dir( itemDir( item ) );
-    QString	cmd( expandVariables( item, command ));
-
-#if VERBOSE_RUN_COMMAND
-    printf( "\ncd " );
-    fflush( stdout );
-    system( "pwd" );
-    QTextCodec * codec = QTextCodec::codecForLocale();
-    printf( "%s\n", (const char *) codec->fromUnicode( cmd ) );
-    fflush( stdout );
-#endif
-
-#if ! SIMULATE_COMMAND
-    proc << "sh";
-    proc << "-c";
-    proc << cmd;
-
-    switch ( _refreshPolicy )
-    {
-	case noRefresh:
-	case assumeDeleted:
-
-	    // In either case it is no use waiting for the command to
-	    // finish, so we are starting the command as a pure
-	    // background process.
-
-	    proc.start( KProcess::DontCare );
-	    break;
-
-
-	case refreshThis:
-	case refreshParent:
-
-	    // If a display refresh is due after the command, we need to
-	    // wait for the command to be finished in order to avoid
-	    // performing the update prematurely, so we are starting this
-	    // process in blocking mode.
-
-	    QApplication::setOverrideCursor( waitCursor );
-	    proc.start( KProcess::Block );
-	    QApplication::restoreOverrideCursor();
-	    break;
-    }
-
-#endif
-}
-
 
 void
 KCleanup::readConfig()
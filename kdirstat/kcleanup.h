@@ -25,6 +25,10 @@
 
 namespace KDirStat
 {
+    // Forward declarations
+    class KCleanupBatch;
+
+
     /**
      * Cleanup action to be performed for @ref KDirTree items.
      *
@@ -105,6 +109,13 @@ namespace KDirStat
 	 **/
 	QString cleanTitle() const;
 
+	/**
+	 * Returns 'true' if the command is nothing but a plain "rm -rf %p".
+	 * Such cleanups are done without any shell by the tree's @ref
+	 * KDeleteJob for local items.
+	 **/
+	bool isPlainDelete() const;
+
 	/**
 	 * Return whether or not this cleanup action is generally enabled.
 	 **/
@@ -123,6 +134,14 @@ namespace KDirStat
 	 **/
 	bool worksFor( KFileInfo *item ) const;
 
+	/**
+	 * Return whether or not this cleanup action can be executed for 'item'
+	 * right now: Like @ref worksFor(), but cleanups that would cause a
+	 * subtree to be deleted from the tree are not possible while that
+	 * subtree is still being read.
+	 **/
+	bool canExecute( KFileInfo *item ) const;
+
 	/**
 	 * Return whether or not this cleanup action works for directories,
 	 * i.e. whether or not @ref KCleanup::execute() will be successful if
@@ -177,12 +196,16 @@ namespace KDirStat
 	 * This is the default.
 	 *
 	 * refreshThis: Refresh the KDirTree from the item on that was passed
-	 * to KCleanup::execute().
+	 * to KCleanup::execute() when the command is done.
 	 *
 	 * refreshParent: Refresh the KDirTree from the parent of the item on
 	 * that was passed to KCleanup::execute(). If there is no such parent,
 	 * refresh the entire tree.
 	 *
+	 * Both refreshes are not done right away, but scheduled with @ref
+	 * KDirTree::scheduleRefresh(), so several cleanups in a row cause only
+	 * one refresh.
+	 *
 	 * assumeDeleted: Do not actually refresh the KDirTree.  Instead,
 	 * blindly assume the cleanup action has deleted the item that was
 	 * passed to KCleanup::execute() and delete the corresponding subtree
@@ -215,13 +238,25 @@ namespace KDirStat
 
 	/**
 	 * The heart of the matter: Perform the cleanup with the KFileInfo
-	 * specified.
+	 * specified. The commands are run in the background (see @ref
+	 * KCleanupBatch); this returns right away.
 	 **/
         void execute( KFileInfo *item );
 
+	/**
+	 * Perform the cleanup with all of 'items' as one batch: Ask for
+	 * confirmation only once, run the commands for all items (several of
+	 * them at the same time, see @ref KCleanupBatch), and bring the tree
+	 * back into sync only once when all of them are done, according to
+	 * the refresh policy. Items the cleanup can't be executed for are
+	 * skipped.
+	 **/
+	void execute( const QPtrList<KFileInfo> & items );
+
 	/**
 	 * Perform the cleanup with the current KDirTree selection if there is
-	 * any.
+	 * any - with all selected items (see @ref KDirTree::selectedItems() ) if
+	 * there are several.
 	 **/
 	void executeWithSelection();
 
@@ -250,10 +285,17 @@ namespace KDirStat
 	 *
 	 * Please note that there intentionally is no reference as to which
 	 * object the action was executed upon since this object very likely
-	 * doesn't exist any more.
+	 * doesn't exist any more. Neither are the commands necessarily done
+	 * yet.
 	 **/
 	void executed();
 
+	/**
+	 * Emitted when the commands of this cleanup are started in the
+	 * background. 'batch' is valid until it emits its finished() signal.
+	 **/
+	void batchStarted( KCleanupBatch * batch );
+
 	
     protected slots:
 
@@ -267,15 +309,28 @@ namespace KDirStat
     protected:
 
 	/**
-	 * Recursively perform the cleanup.
+	 * Perform the cleanup with all of 'items' (without any more checks or
+	 * confirmation): Start a @ref KCleanupBatch for them that runs the
+	 * commands in the background and handle the refresh policy.
+	 **/
+	void run( const QPtrList<KFileInfo> & items );
+
+	/**
+	 * Recursively perform the cleanup: Add the commands to 'batch'.
 	 **/
-	void executeRecursive( KFileInfo *item );
+	void executeRecursive( KFileInfo *item, KCleanupBatch *batch );
 
 	/**
 	 * Ask user for confirmation to execute this cleanup action for
 	 * 'item'. Returns 'true' if user accepts, 'false' otherwise.
 	 **/
 	bool confirmation( KFileInfo *item );
+
+	/**
+	 * Ask user for confirmation to execute this cleanup action for all of
+	 * 'items'. Returns 'true' if user accepts, 'false' otherwise.
+	 **/
+	bool confirmation( const QPtrList<KFileInfo> & items );
 	
 	/**
 	 * Retrieve the directory part of a KFileInfo's path.
@@ -308,12 +363,6 @@ namespace KDirStat
 	QString	expandVariables ( const KFileInfo *	item,
 				  const QString &	unexpanded ) const;
 
-	/**
-	 * Run a command with 'item' as base to expand variables.
-	 **/
-	void	runCommand	( const KFileInfo *	item,
-				  const QString &	command ) const;
-
 	/**
 	 * Internal implementation of the copy constructor and assignment
 	 * operator: Copy all data members from 'src'.
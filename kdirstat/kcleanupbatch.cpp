@@ -0,0 +1,201 @@
+/*
+ *   File name:	kcleanupbatch.cpp
+ *   Summary:	Support classes for KDirStat - running cleanup commands
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <kprocess.h>
+#include <kdebug.h>
+#include <klocale.h>
+
+#include "kcleanupbatch.h"
+#include "kdirtree.h"
+#include "kdirsaver.h"
+
+
+using namespace KDirStat;
+
+
+KCleanupBatch::KCleanupBatch( KDirTree * tree, const QString & title )
+    : QObject()
+    , _tree( tree )
+    , _title( title )
+    , _refreshAll( false )
+    , _aborted( false )
+    , _totalCount( 0 )
+    , _doneCount( 0 )
+    , _failedCount( 0 )
+{
+    _running.setAutoDelete( true );
+}
+
+
+KCleanupBatch::~KCleanupBatch()
+{
+    // Auto-deleting the running processes kills them.
+}
+
+
+void
+KCleanupBatch::addCommand( const QString & dir, const QString & command )
+{
+    _commands.append( Command( dir, command ) );
+    _totalCount++;
+}
+
+
+void
+KCleanupBatch::addRefresh( KFileInfo * subtree )
+{
+    if ( subtree && subtree->parent() )
+	_refreshUrls.append( subtree->url() );
+    else
+	_refreshAll = true;
+}
+
+
+void
+KCleanupBatch::start()
+{
+    startProcesses();
+
+    if ( _running.isEmpty() )		// Nothing to run at all
+	finish();
+}
+
+
+void
+KCleanupBatch::abort()
+{
+    _aborted = true;
+    _commands.clear();
+
+    // The processes report back one by one when they are gone.
+
+    for ( KProcess * proc = _running.first(); proc; proc = _running.next() )
+	proc->kill();
+}
+
+
+void
+KCleanupBatch::startProcesses()
+{
+    while ( _running.count() < CleanupMaxParallel && ! _commands.isEmpty() )
+    {
+	Command command = _commands.front();
+	_commands.pop_front();
+
+	kdDebug() << "cd " << command.dir << "; " << command.command << endl;
+
+	KProcess * proc = new KProcess();
+	CHECK_PTR( proc );
+
+	*proc << "sh";
+	*proc << "-c";
+	*proc << command.command;
+
+	connect( proc, SIGNAL( processExited( KProcess * ) ),
+		 this, SLOT  ( processExited( KProcess * ) ) );
+
+	connect( proc, SIGNAL( receivedStdout( KProcess *, char *, int ) ),
+		 this, SLOT  ( readOutput    ( KProcess *, char *, int ) ) );
+
+	connect( proc, SIGNAL( receivedStderr( KProcess *, char *, int ) ),
+		 this, SLOT  ( readOutput    ( KProcess *, char *, int ) ) );
+
+	// The new process inherits the current working directory.
+
+	KDirSaver dir( command.dir );
+
+	if ( proc->start( KProcess::NotifyOnExit, KProcess::AllOutput ) )
+	{
+	    _running.append( proc );
+	}
+	else
+	{
+	    QString msg = i18n( "Can't start %1" ).arg( command.command );
+	    kdError() << msg << endl;
+
+	    delete proc;
+	    _doneCount++;
+	    _failedCount++;
+
+	    _output += msg + "\n";
+	    emit receivedOutput( msg + "\n" );
+	    emit progress( _doneCount, _totalCount );
+	}
+    }
+}
+
+
+void
+KCleanupBatch::readOutput( KProcess *, char * buffer, int len )
+{
+    QString text = QString::fromLocal8Bit( buffer, len );
+
+    _output += text;
+
+    if ( _output.length() > CleanupMaxOutput )
+	_output = _output.right( CleanupMaxOutput );
+
+    emit receivedOutput( text );
+}
+
+
+void
+KCleanupBatch::processExited( KProcess * proc )
+{
+    _doneCount++;
+
+    if ( ! proc->normalExit() || proc->exitStatus() != 0 )
+	_failedCount++;
+
+    // Don't delete the process right away - it is still sending this
+    // signal.
+
+    _running.setAutoDelete( false );
+    _running.removeRef( proc );
+    _running.setAutoDelete( true );
+    proc->deleteLater();
+
+    emit progress( _doneCount, _totalCount );
+
+    startProcesses();
+
+    if ( _running.isEmpty() )
+	finish();
+}
+
+
+void
+KCleanupBatch::finish()
+{
+    if ( _refreshAll )
+    {
+	_tree->scheduleRefresh();
+    }
+    else
+    {
+	for ( QStringList::Iterator it = _refreshUrls.begin(); it != _refreshUrls.end(); ++it )
+	{
+	    KFileInfo * subtree = _tree->locate( *it );
+
+	    if ( subtree )
+		_tree->scheduleRefresh( subtree );
+	}
+    }
+
+    emit finished();
+    deleteLater();
+}
+
+
+// EOF
@@ -0,0 +1,222 @@
+/*
+ *   File name:	kcleanupbatch.h
+ *   Summary:	Support classes for KDirStat - running cleanup commands
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KCleanupBatch_h
+#define KCleanupBatch_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qobject.h>
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qptrlist.h>
+#include <qvaluelist.h>
+
+
+// Maximum number of cleanup commands of one batch that run at the same time
+
+#define CleanupMaxParallel	4
+
+// Maximum number of characters of command output a batch keeps; of longer
+// output, only the last part is kept.
+
+#define CleanupMaxOutput	65536
+
+
+class KProcess;
+
+
+namespace KDirStat
+{
+    // Forward declarations
+    class KFileInfo;
+    class KDirTree;
+
+
+    /**
+     * The commands of one cleanup for one or more items, running in the
+     * background while the user goes on working: Up to @ref
+     * CleanupMaxParallel of them are run at the same time, each one in its
+     * own directory. Their output (stdout and stderr) is collected. When all
+     * of them are done, all subtrees that need it are scheduled for a refresh
+     * (see @ref KDirTree::scheduleRefresh() ) to be read again in one go.
+     *
+     * The subtrees to refresh are remembered by URL, not by pointer, so it
+     * does not matter what happens to the tree while the commands are
+     * running; whatever can't be found any more is not refreshed.
+     *
+     * Any number of batches may be running at the same time. A batch deletes
+     * itself when it is finished. Normally, batches are created only by @ref
+     * KCleanup.
+     *
+     * @short Commands of one cleanup running in the background
+     **/
+    class KCleanupBatch: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor. 'title' is what the user sees: The cleanup and what it
+	 * is executed for.
+	 **/
+	KCleanupBatch( KDirTree * tree, const QString & title );
+
+	/**
+	 * Destructor. Kills all commands that are still running.
+	 **/
+	virtual ~KCleanupBatch();
+
+	/**
+	 * Add shell command 'command' to be run in directory 'dir'.
+	 **/
+	void addCommand( const QString & dir, const QString & command );
+
+	/**
+	 * Read 'subtree' again after all commands are done. 0 means the
+	 * entire tree.
+	 **/
+	void addRefresh( KFileInfo * subtree );
+
+	/**
+	 * Start running the commands.
+	 **/
+	void start();
+
+	/**
+	 * Returns the title of this batch.
+	 **/
+	const QString & title() const { return _title; }
+
+	/**
+	 * Returns the number of commands in this batch.
+	 **/
+	int totalCount() const { return _totalCount; }
+
+	/**
+	 * Returns the number of commands that are done.
+	 **/
+	int doneCount() const { return _doneCount; }
+
+	/**
+	 * Returns the number of commands that could not be started, returned
+	 * a nonzero exit code or were killed.
+	 **/
+	int failedCount() const { return _failedCount; }
+
+	/**
+	 * Returns 'true' if the batch was aborted.
+	 **/
+	bool wasAborted() const { return _aborted; }
+
+	/**
+	 * Returns the output of all commands so far (at most @ref
+	 * CleanupMaxOutput characters).
+	 **/
+	const QString & output() const { return _output; }
+
+
+    public slots:
+
+	/**
+	 * Kill all commands that are running and don't start any more. The
+	 * batch finishes as usual when all of them are gone, including the
+	 * refresh: Whatever they did before is done.
+	 **/
+	void abort();
+
+
+    signals:
+
+	/**
+	 * Emitted when a command wrote 'text' to stdout or stderr.
+	 **/
+	void receivedOutput( const QString & text );
+
+	/**
+	 * Emitted whenever a command is done.
+	 **/
+	void progress( int doneCount, int totalCount );
+
+	/**
+	 * Emitted when all commands are done (and the refresh is scheduled),
+	 * right before this batch is deleted.
+	 **/
+	void finished();
+
+
+    protected slots:
+
+	/**
+	 * Notification that a command is done.
+	 **/
+	void processExited( KProcess * proc );
+
+	/**
+	 * Notification that a command wrote something to stdout or stderr.
+	 **/
+	void readOutput( KProcess * proc, char * buffer, int len );
+
+
+    protected:
+
+	/**
+	 * Start commands until there are @ref CleanupMaxParallel of them
+	 * running or no more waiting.
+	 **/
+	void startProcesses();
+
+	/**
+	 * All commands done: Schedule a refresh of what needs to be
+	 * refreshed and delete this batch.
+	 **/
+	void finish();
+
+
+	/**
+	 * A command and the directory to run it in.
+	 **/
+	struct Command
+	{
+	    Command( const QString & d = QString::null, const QString & c = QString::null )
+		: dir( d ), command( c ) {}
+
+	    QString dir;
+	    QString command;
+	};
+
+
+	// Data members
+
+	KDirTree *			_tree;
+	QString				_title;
+	QValueList<Command>		_commands;
+	QPtrList<KProcess>		_running;
+	QStringList			_refreshUrls;
+	bool				_refreshAll;
+	bool				_aborted;
+	int				_totalCount;
+	int				_doneCount;
+	int				_failedCount;
+	QString				_output;
+
+    };	// class KCleanupBatch
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KCleanupBatch_h
+
+
+// EOF
@@ -205,6 +205,9 @@ KCleanupCollection::add( KCleanup *newCleanup )
     
     connect( newCleanup, SIGNAL( executed() ),
 	     this, 	 SLOT  ( cleanupExecuted() ) );
+
+    connect( newCleanup, SIGNAL( batchStarted( KCleanupBatch * ) ),
+	     this,	 SIGNAL( batchStarted( KCleanupBatch * ) ) );
 }
 
 
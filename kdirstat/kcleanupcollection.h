@@ -189,6 +189,12 @@ namespace KDirStat
 	 **/
 	void userActivity( int points );
 
+	/**
+	 * Emitted when any of the cleanups starts its commands in the
+	 * background. See @ref KCleanup::batchStarted().
+	 **/
+	void batchStarted( KCleanupBatch * batch );
+
 
     protected slots:
 
@@ -0,0 +1,279 @@
+/*
+ *   File name:	kcleanupjobsdialog.cpp
+ *   Summary:	Dialog with the cleanups running in the background
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qlayout.h>
+#include <qsplitter.h>
+#include <qtextedit.h>
+
+#include <klistview.h>
+#include <klocale.h>
+
+#include "kcleanupjobsdialog.h"
+#include "kcleanupbatch.h"
+
+
+using namespace KDirStat;
+
+
+KCleanupJobsDialog::KCleanupJobsDialog( QWidget * parent )
+    : KDialogBase( Plain,				// dialogFace
+		   i18n( "Cleanup Jobs" ),		// caption
+		   User1 | User2 | Close,		// buttonMask
+		   Close,				// defaultButton
+		   parent,				// parent
+		   0,					// name
+		   false )				// modal
+{
+    setButtonText( User1, i18n( "&Cancel Job"	  ) );
+    setButtonText( User2, i18n( "C&lear Finished" ) );
+
+    QWidget *	  page	   = plainPage();
+    QVBoxLayout * layout   = new QVBoxLayout( page, 0, spacingHint() );
+    QSplitter *	  splitter = new QSplitter( QSplitter::Vertical, page );
+    layout->addWidget( splitter );
+
+    _list = new KListView( splitter );
+    _list->addColumn( i18n( "Cleanup" ) );
+    _list->addColumn( i18n( "Status"  ) );
+    _list->setAllColumnsShowFocus( true );
+    _list->setSorting( -1 );			// newest first
+
+    _output = new QTextEdit( splitter );
+    _output->setTextFormat( PlainText );
+    _output->setReadOnly( true );
+    _output->setWordWrap( QTextEdit::NoWrap );
+
+    connect( _list,	SIGNAL( selectionChanged() ),
+	     this,	SLOT  ( selectionChanged() ) );
+
+    selectionChanged();
+    resize( 600, 450 );
+}
+
+
+KCleanupJobsDialog::~KCleanupJobsDialog()
+{
+    // NOP
+}
+
+
+int
+KCleanupJobsDialog::runningCount() const
+{
+    int count = 0;
+    QListViewItem * item = _list->firstChild();
+
+    while ( item )
+    {
+	if ( ( (KCleanupJobsListItem *) item )->batch() )
+	    count++;
+
+	item = item->nextSibling();
+    }
+
+    return count;
+}
+
+
+void
+KCleanupJobsDialog::addBatch( KCleanupBatch * batch )
+{
+    if ( ! batch )
+	return;
+
+    KCleanupJobsListItem * item = new KCleanupJobsListItem( _list, batch );
+    CHECK_PTR( item );
+
+    connect( batch,	SIGNAL( receivedOutput( const QString & ) ),
+	     this,	SLOT  ( batchOutput   ( const QString & ) ) );
+
+    connect( batch,	SIGNAL( progress     ( int, int ) ),
+	     this,	SLOT  ( batchProgress( int, int ) ) );
+
+    connect( batch,	SIGNAL( finished()	),
+	     this,	SLOT  ( batchFinished() ) );
+
+    if ( ! selectedItem() )
+	_list->setSelected( item, true );
+}
+
+
+void
+KCleanupJobsDialog::clearFinished()
+{
+    QListViewItem * item = _list->firstChild();
+
+    while ( item )
+    {
+	QListViewItem * next = item->nextSibling();
+
+	if ( ! ( (KCleanupJobsListItem *) item )->batch() )
+	    delete item;
+
+	item = next;
+    }
+
+    selectionChanged();
+}
+
+
+void
+KCleanupJobsDialog::slotUser1()
+{
+    KCleanupJobsListItem * item = selectedItem();
+
+    if ( item && item->batch() )
+	item->batch()->abort();
+}
+
+
+void
+KCleanupJobsDialog::slotUser2()
+{
+    clearFinished();
+}
+
+
+void
+KCleanupJobsDialog::batchOutput( const QString & text )
+{
+    KCleanupJobsListItem * item = findItem( sender() );
+
+    if ( item && item == selectedItem() )
+    {
+	_output->moveCursor( QTextEdit::MoveEnd, false );
+	_output->insert( text );
+    }
+}
+
+
+void
+KCleanupJobsDialog::batchProgress( int, int )
+{
+    KCleanupJobsListItem * item = findItem( sender() );
+
+    if ( item )
+	item->updateStatus();
+}
+
+
+void
+KCleanupJobsDialog::batchFinished()
+{
+    KCleanupJobsListItem * item = findItem( sender() );
+
+    if ( item )
+    {
+	item->batchFinished();
+
+	if ( item == selectedItem() )
+	    selectionChanged();
+    }
+}
+
+
+void
+KCleanupJobsDialog::selectionChanged()
+{
+    KCleanupJobsListItem * item = selectedItem();
+
+    if ( item )
+    {
+	_output->setText( item->output() );
+	_output->moveCursor( QTextEdit::MoveEnd, false );
+    }
+    else
+    {
+	_output->clear();
+    }
+
+    enableButton( User1, item && item->batch() );
+}
+
+
+KCleanupJobsListItem *
+KCleanupJobsDialog::findItem( const QObject * batch ) const
+{
+    QListViewItem * item = _list->firstChild();
+
+    while ( item )
+    {
+	if ( (QObject *) ( (KCleanupJobsListItem *) item )->batch() == batch )
+	    return (KCleanupJobsListItem *) item;
+
+	item = item->nextSibling();
+    }
+
+    return 0;
+}
+
+
+KCleanupJobsListItem *
+KCleanupJobsDialog::selectedItem() const
+{
+    return (KCleanupJobsListItem *) _list->selectedItem();
+}
+
+
+
+
+KCleanupJobsListItem::KCleanupJobsListItem( QListView *	    parent,
+					    KCleanupBatch * batch )
+    : QListViewItem( parent )
+    , _batch( batch )
+{
+    setText( 0, batch->title() );
+    updateStatus();
+}
+
+
+QString
+KCleanupJobsListItem::output() const
+{
+    return _batch ? _batch->output() : _output;
+}
+
+
+void
+KCleanupJobsListItem::updateStatus()
+{
+    if ( ! _batch )
+	return;
+
+    setText( 1, i18n( "Running (%1 of %2 done)" )
+	     .arg( _batch->doneCount() ).arg( _batch->totalCount() ) );
+}
+
+
+void
+KCleanupJobsListItem::batchFinished()
+{
+    if ( ! _batch )
+	return;
+
+    if ( _batch->wasAborted() )
+	setText( 1, i18n( "Cancelled" ) );
+    else if ( _batch->failedCount() > 0 )
+	setText( 1, i18n( "Failed (%1 of %2)" )
+		 .arg( _batch->failedCount() ).arg( _batch->totalCount() ) );
+    else
+	setText( 1, i18n( "Done" ) );
+
+    _output = _batch->output();
+    _batch  = 0;
+}
+
+
+
+// EOF
@@ -0,0 +1,180 @@
+/*
+ *   File name:	kcleanupjobsdialog.h
+ *   Summary:	Dialog with the cleanups running in the background
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KCleanupJobsDialog_h
+#define KCleanupJobsDialog_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qlistview.h>
+#include <kdialogbase.h>
+
+
+class QTextEdit;
+class KListView;
+
+
+namespace KDirStat
+{
+    class KCleanupBatch;
+    class KCleanupJobsListItem;
+
+
+    /**
+     * Non-modal dialog that lists the cleanups that were started in the
+     * background (see @ref KCleanupBatch) with their status and shows the
+     * output of the selected one. Running cleanups can be cancelled from
+     * here.
+     *
+     * Finished cleanups stay in the list (with their output) until the user
+     * clears them.
+     *
+     * @short Dialog for the cleanups running in the background
+     **/
+    class KCleanupJobsDialog: public KDialogBase
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KCleanupJobsDialog( QWidget * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KCleanupJobsDialog();
+
+	/**
+	 * Returns the number of cleanups in the list that are still running.
+	 **/
+	int runningCount() const;
+
+
+    public slots:
+
+	/**
+	 * Add 'batch' to the list. It is followed until it is finished.
+	 **/
+	void addBatch( KCleanupBatch * batch );
+
+	/**
+	 * Remove all cleanups from the list that are finished.
+	 **/
+	void clearFinished();
+
+
+    protected slots:
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Cancel Job" button.
+	 **/
+	virtual void slotUser1();
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Clear Finished" button.
+	 **/
+	virtual void slotUser2();
+
+	/**
+	 * Notification that the sending batch received 'text'.
+	 **/
+	void batchOutput( const QString & text );
+
+	/**
+	 * Notification that a command of the sending batch is done.
+	 **/
+	void batchProgress( int doneCount, int totalCount );
+
+	/**
+	 * Notification that the sending batch is finished.
+	 **/
+	void batchFinished();
+
+	/**
+	 * Show the output of the selected cleanup and update the buttons.
+	 **/
+	void selectionChanged();
+
+
+    protected:
+
+	/**
+	 * Returns the list item for 'batch' or 0 if there is none.
+	 **/
+	KCleanupJobsListItem * findItem( const QObject * batch ) const;
+
+	/**
+	 * Returns the selected list item or 0 if there is none.
+	 **/
+	KCleanupJobsListItem * selectedItem() const;
+
+
+	KListView *	_list;
+	QTextEdit *	_output;
+
+    };	// class KCleanupJobsDialog
+
+
+
+    /**
+     * List item for one @ref KCleanupBatch in a @ref KCleanupJobsDialog.
+     * Since a batch deletes itself when it is finished, the item keeps its
+     * status and output from then on.
+     **/
+    class KCleanupJobsListItem: public QListViewItem
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KCleanupJobsListItem( QListView * parent, KCleanupBatch * batch );
+
+	/**
+	 * Returns the batch of this item or 0 if it is finished.
+	 **/
+	KCleanupBatch * batch() const { return _batch; }
+
+	/**
+	 * Returns the output of the batch so far.
+	 **/
+	QString output() const;
+
+	/**
+	 * Update the status column from the batch.
+	 **/
+	void updateStatus();
+
+	/**
+	 * Take over the status and output of the batch because it is about
+	 * to be deleted.
+	 **/
+	void batchFinished();
+
+    protected:
+
+	KCleanupBatch *	_batch;
+	QString		_output;
+
+    };	// class KCleanupJobsListItem
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KCleanupJobsDialog_h
+
+
+// EOF
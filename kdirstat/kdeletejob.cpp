@@ -0,0 +1,481 @@
+/*
+ *   File name:	kdeletejob.cpp
+ *   Summary:	Support classes for KDirStat - deleting subtrees from disk
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <kdebug.h>
+
+#include "kdeletejob.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KDeleteJob::KDeleteJob( KDirTree * tree )
+    : QObject()
+    , _tree( tree )
+    , _active( false )
+    , _updatingTree( false )
+    , _deletedCount( 0 )
+    , _totalCount( 0 )
+    , _errorCount( 0 )
+{
+    connect( &_timer,	SIGNAL( timeout()	 ),
+	     this,	SLOT  ( timeSlicedWork() ) );
+
+    connect( _tree,	SIGNAL( deletingChild( KFileInfo * ) ),
+	     this,	SLOT  ( deletingChild( KFileInfo * ) ) );
+}
+
+
+KDeleteJob::~KDeleteJob()
+{
+    while ( ! _stack.isEmpty() )
+    {
+	closedir( _stack.back().dir );
+	delete _stack.back().index;
+	_stack.pop_back();
+    }
+}
+
+
+void
+KDeleteJob::add( KFileInfo * item )
+{
+    if ( ! item || item->isDotEntry() )
+	return;
+
+    if ( ! _active )
+    {
+	_active	      = true;
+	_deletedCount = 0;
+	_totalCount   = 0;
+	_errorCount   = 0;
+	_lastUpdate.start();
+	_timer.start( 0 );
+    }
+
+    _queue.append( QueueEntry( item->url(), item ) );
+    _totalCount += item->totalItems() + 1;
+}
+
+
+void
+KDeleteJob::abort()
+{
+    if ( ! _active )
+	return;
+
+    while ( ! _stack.isEmpty() )
+    {
+	closedir( _stack.back().dir );
+	delete _stack.back().index;
+	_stack.pop_back();
+    }
+
+    if ( _current.item )
+	_incomplete.append( _current.item );
+
+    _current = QueueEntry();
+    _queue.clear();
+
+    finish();
+}
+
+
+void
+KDeleteJob::detach()
+{
+    _current.item = 0;
+
+    for ( QValueList<QueueEntry>::Iterator it = _queue.begin(); it != _queue.end(); ++it )
+	(*it).item = 0;
+
+    for ( uint i=0; i < _stack.size(); i++ )
+    {
+	_stack[i].item = 0;
+	delete _stack[i].index;
+	_stack[i].index = 0;
+    }
+
+    _deleted.clear();
+    _incomplete.clear();
+}
+
+
+void
+KDeleteJob::deletingChild( KFileInfo * subtree )
+{
+    if ( ! _active )
+	return;
+
+    if ( _current.item && _current.item->isInSubtree( subtree ) )
+	_current.item = 0;
+
+    for ( QValueList<QueueEntry>::Iterator it = _queue.begin(); it != _queue.end(); ++it )
+    {
+	if ( (*it).item && (*it).item->isInSubtree( subtree ) )
+	    (*it).item = 0;
+    }
+
+    for ( uint i=0; i < _stack.size(); i++ )
+    {
+	StackEntry & entry = _stack[i];
+
+	if ( entry.item && entry.item->isInSubtree( subtree ) )
+	{
+	    entry.item = 0;
+	    delete entry.index;
+	    entry.index = 0;
+	}
+	else if ( entry.index && subtree->parent() == entry.item )
+	{
+	    entry.index->remove( subtree->name() );
+	}
+    }
+
+    forget( _incomplete, subtree );
+
+    // While the tree is being updated, the deleted items are the ones that
+    // are just being deleted - in the order they were deleted from disk,
+    // i.e. never one within one that comes before it.
+
+    if ( ! _updatingTree )
+	forget( _deleted, subtree );
+}
+
+
+void
+KDeleteJob::forget( QPtrList<KFileInfo> & list, KFileInfo * subtree )
+{
+    KFileInfo * item = list.first();
+
+    while ( item )
+    {
+	if ( item->isInSubtree( subtree ) )
+	{
+	    list.remove();		// The next one becomes current
+	    item = list.current();
+	}
+	else
+	{
+	    item = list.next();
+	}
+    }
+}
+
+
+void
+KDeleteJob::timeSlicedWork()
+{
+    if ( work( DeleteSliceMillisec ) )
+    {
+	finish();
+	return;
+    }
+
+    if ( _lastUpdate.elapsed() >= DeleteUpdateMillisec )
+	updateTree();
+
+    emit progress( _deletedCount, _totalCount );
+}
+
+
+bool
+KDeleteJob::work( int millisec )
+{
+    QTime time;
+    time.start();
+    int steps = 0;
+
+    while ( ! _stack.isEmpty() || ! _queue.isEmpty() )
+    {
+	if ( _stack.isEmpty() )
+	{
+	    startNext();
+	}
+	else
+	{
+	    struct dirent * entry = readdir( _stack.back().dir );
+
+	    if ( entry )
+		deleteEntry( entry );
+	    else
+		pop();
+	}
+
+	// Checking the clock is not exactly free - do it only every now and
+	// then.
+
+	if ( ++steps % 256 == 0 && time.elapsed() >= millisec )
+	    return _stack.isEmpty() && _queue.isEmpty();
+    }
+
+    return true;
+}
+
+
+void
+KDeleteJob::startNext()
+{
+    _current = _queue.front();
+    _queue.pop_front();
+
+    QString	 path	  = _current.path;
+    const char * diskPath = path;
+    struct stat	 statInfo;
+
+    if ( lstat( diskPath, &statInfo ) != 0 )
+    {
+	if ( errno == ENOENT )
+	{
+	    // Gone already - most likely because it was in something else
+	    // that was deleted before. Don't delete it from the tree twice.
+
+	    KFileInfo * item = _current.item;
+
+	    for ( KFileInfo * deleted = _deleted.first(); deleted && item; deleted = _deleted.next() )
+	    {
+		if ( item->isInSubtree( deleted ) )
+		    item = 0;
+	    }
+
+	    if ( item )
+		_deleted.append( item );
+	}
+	else
+	{
+	    _errorCount++;
+	    kdWarning() << "lstat(" << path << ") failed: " << strerror( errno ) << endl;
+	}
+
+	_current = QueueEntry();
+	return;
+    }
+
+    if ( S_ISDIR( statInfo.st_mode ) )
+    {
+	if ( push( -1, diskPath, _current.item ) )
+	    return;
+    }
+    else if ( unlink( diskPath ) == 0 )
+    {
+	_deletedCount++;
+
+	if ( _current.item )
+	    _deleted.append( _current.item );
+
+	_current = QueueEntry();
+	return;
+    }
+
+    _errorCount++;
+    kdWarning() << "Can't delete " << path << ": " << strerror( errno ) << endl;
+
+    if ( _current.item )
+	_incomplete.append( _current.item );
+
+    _current = QueueEntry();
+}
+
+
+void
+KDeleteJob::deleteEntry( struct dirent * entry )
+{
+    const char * name = entry->d_name;
+
+    if ( strcmp( name, "." ) == 0 || strcmp( name, ".." ) == 0 )
+	return;
+
+    StackEntry & top = _stack.back();
+    int		 fd  = dirfd( top.dir );
+    bool	 isDir;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+    if ( entry->d_type != DT_UNKNOWN )
+    {
+	isDir = entry->d_type == DT_DIR;
+    }
+    else
+#endif
+    {
+	struct stat statInfo;
+	isDir = fstatat( fd, name, &statInfo, AT_SYMLINK_NOFOLLOW ) == 0 && S_ISDIR( statInfo.st_mode );
+    }
+
+    if ( isDir )
+    {
+	KFileInfo * item = subDir( top.item, &top.index, name );
+
+	if ( ! push( fd, name, item ) )		// invalidates 'top'
+	{
+	    // Its parent can't be deleted then, either; this is noticed when
+	    // it is popped.
+
+	    _errorCount++;
+	    kdWarning() << "Can't open directory " << name << " in " << _current.path
+			<< ": " << strerror( errno ) << endl;
+	}
+
+	return;
+    }
+
+    if ( unlinkat( fd, name, 0 ) == 0 )
+    {
+	_deletedCount++;
+    }
+    else
+    {
+	_errorCount++;
+	kdWarning() << "Can't delete " << name << " in " << _current.path
+		    << ": " << strerror( errno ) << endl;
+    }
+}
+
+
+bool
+KDeleteJob::push( int parentFd, const char * name, KFileInfo * item )
+{
+    int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW;
+    int fd    = parentFd >= 0 ? openat( parentFd, name, flags ) : open( name, flags );
+
+    if ( fd < 0 )
+	return false;
+
+    DIR * dir = fdopendir( fd );
+
+    if ( ! dir )
+    {
+	::close( fd );
+	return false;
+    }
+
+    StackEntry entry;
+    entry.dir  = dir;
+    entry.name = name;
+    entry.item = item;
+    _stack.push_back( entry );
+
+    return true;
+}
+
+
+void
+KDeleteJob::pop()
+{
+    StackEntry top = _stack.back();
+    _stack.pop_back();
+
+    closedir( top.dir );	// This closes its file descriptor, too
+    delete top.index;
+
+    int result = _stack.isEmpty() ?
+	rmdir( top.name ) : unlinkat( dirfd( _stack.back().dir ), top.name, AT_REMOVEDIR );
+
+    if ( result == 0 )
+    {
+	_deletedCount++;
+
+	if ( top.item )
+	    _deleted.append( top.item );
+    }
+    else
+    {
+	_errorCount++;
+	kdWarning() << "Can't delete directory " << top.name << " in " << _current.path
+		    << ": " << strerror( errno ) << endl;
+    }
+
+    if ( _stack.isEmpty() )	// Top level item done
+    {
+	if ( result != 0 && _current.item )
+	    _incomplete.append( _current.item );
+
+	_current = QueueEntry();
+    }
+}
+
+
+KFileInfo *
+KDeleteJob::subDir( KFileInfo *		dir,
+		    QDict<KFileInfo> **	index,
+		    const QString &	name )
+{
+    if ( ! dir )
+	return 0;
+
+    if ( ! *index )
+    {
+	// Subdirectories are always direct children, never in the dot entry.
+
+	*index = new QDict<KFileInfo>( 2 * dir->childCount() + 1 );
+	CHECK_PTR( *index );
+
+	for ( KFileInfo * child = dir->firstChild(); child; child = child->next() )
+	{
+	    if ( child->isDirInfo() && ! child->isDotEntry() )
+		(*index)->insert( child->name(), child );
+	}
+    }
+
+    return (*index)->find( name );
+}
+
+
+void
+KDeleteJob::updateTree()
+{
+    _lastUpdate.restart();
+
+    if ( _deleted.isEmpty() )
+	return;
+
+    _updatingTree = true;
+    _tree->beginUpdate();
+
+    for ( KFileInfo * item = _deleted.first(); item; item = _deleted.next() )
+	_tree->deleteSubtree( item );
+
+    _deleted.clear();
+    _tree->endUpdate();
+    _updatingTree = false;
+}
+
+
+void
+KDeleteJob::finish()
+{
+    _timer.stop();
+    updateTree();
+
+    // Read again what could not be deleted completely - all in one go.
+
+    for ( KFileInfo * item = _incomplete.first(); item; item = _incomplete.next() )
+	_tree->scheduleRefresh( item );
+
+    _incomplete.clear();
+
+    _active = false;
+
+    emit progress( _deletedCount, _totalCount );
+    emit finished();
+}
+
+
+
+// EOF
@@ -0,0 +1,275 @@
+/*
+ *   File name:	kdeletejob.h
+ *   Summary:	Support classes for KDirStat - deleting subtrees from disk
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KDeleteJob_h
+#define KDeleteJob_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <dirent.h>
+#include <qobject.h>
+#include <qcstring.h>
+#include <qtimer.h>
+#include <qtime.h>
+#include <qdict.h>
+#include <qptrlist.h>
+#include <qvaluelist.h>
+#include <qvaluevector.h>
+
+
+// Milliseconds to spend in one slice of deleting before returning to the
+// event loop
+
+#define DeleteSliceMillisec	50
+
+// Milliseconds between two updates of the directory tree while deleting
+
+#define DeleteUpdateMillisec	1000
+
+
+namespace KDirStat
+{
+    // Forward declarations
+    class KFileInfo;
+    class KDirTree;
+
+
+    /**
+     * Deleting subtrees from disk without any external process: The
+     * equivalent of "rm -rf" for each item that is added, done with
+     * openat(), fdopendir() and unlinkat() in small time slices from the
+     * event loop, so the application stays responsive, and deleting can be
+     * cancelled at any time.
+     *
+     * The disk is authoritative: Everything below a deleted directory is
+     * deleted, whether or not the directory tree knows about it (e.g. in
+     * excluded directories). Symbolic links are deleted, never followed.
+     *
+     * The directory tree is updated while deleting: Every directory that is
+     * completely gone from disk is deleted from the tree, too - in batches
+     * every @ref DeleteUpdateMillisec, so the views don't have to be rebuilt
+     * all the time. Items that could not be deleted completely (because of
+     * missing permissions, or because deleting was cancelled) are read from
+     * disk again at the end.
+     *
+     * Normally, this is used only through @ref KDirTree::deleteJob().
+     *
+     * @short Time sliced deletion of subtrees from disk
+     **/
+    class KDeleteJob: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KDeleteJob( KDirTree * tree );
+
+	/**
+	 * Destructor. Stops deleting.
+	 **/
+	virtual ~KDeleteJob();
+
+	/**
+	 * Delete 'item' (and everything below it) from disk. If something is
+	 * being deleted already, 'item' is deleted after that. Only items of
+	 * local trees can be deleted.
+	 **/
+	void add( KFileInfo * item );
+
+	/**
+	 * Forget everything about the directory tree, but go on deleting on
+	 * disk. Use this before the tree is cleared without any signals.
+	 **/
+	void detach();
+
+	/**
+	 * Returns 'true' if anything is being deleted.
+	 **/
+	bool isActive() const { return _active; }
+
+	/**
+	 * Returns the number of directory entries deleted so far.
+	 **/
+	int deletedCount() const { return _deletedCount; }
+
+	/**
+	 * Returns the (estimated) number of entries to delete in total.
+	 **/
+	int totalCount() const { return _totalCount; }
+
+	/**
+	 * Returns the number of entries that could not be deleted.
+	 **/
+	int errorCount() const { return _errorCount; }
+
+	/**
+	 * Returns the path of the top level item that is being deleted.
+	 **/
+	QString currentPath() const { return _current.path; }
+
+
+    public slots:
+
+	/**
+	 * Stop deleting. Everything that is deleted so far is gone, of
+	 * course; the items that were not deleted completely are read again.
+	 * finished() is emitted as usual.
+	 **/
+	void abort();
+
+
+    signals:
+
+	/**
+	 * Emitted now and then while deleting.
+	 **/
+	void progress( int deletedCount, int totalCount );
+
+	/**
+	 * Emitted when all items are deleted (or deleting is aborted) and the
+	 * tree is up to date again.
+	 **/
+	void finished();
+
+
+    protected slots:
+
+	/**
+	 * Do one time slice worth of deleting.
+	 **/
+	void timeSlicedWork();
+
+	/**
+	 * Notification that a subtree is about to be deleted from the tree:
+	 * Forget all pointers into it.
+	 **/
+	void deletingChild( KFileInfo * subtree );
+
+
+    protected:
+
+	/**
+	 * Delete for at most 'millisec' milliseconds.
+	 * Returns 'true' if everything is done.
+	 **/
+	bool work( int millisec );
+
+	/**
+	 * Start deleting the next queued top level item.
+	 **/
+	void startNext();
+
+	/**
+	 * Delete 'entry' of the directory on top of the stack: Anything but a
+	 * directory right away, a directory is pushed onto the stack.
+	 **/
+	void deleteEntry( struct dirent * entry );
+
+	/**
+	 * Open directory 'name' relative to 'parentFd' (or an absolute path
+	 * if 'parentFd' is -1) and push it onto the stack.
+	 * Returns 'false' upon error.
+	 **/
+	bool push( int parentFd, const char * name, KFileInfo * item );
+
+	/**
+	 * Close the directory on top of the stack and remove it.
+	 **/
+	void pop();
+
+	/**
+	 * Returns the subdirectory 'name' of 'dir' in the tree or 0 if there
+	 * is none. 'index' is a name index of the subdirectories of 'dir' that
+	 * is created on demand.
+	 **/
+	static KFileInfo * subDir( KFileInfo *		dir,
+				   QDict<KFileInfo> **	index,
+				   const QString &	name );
+
+	/**
+	 * Remove all items in 'subtree' from 'list'.
+	 **/
+	static void forget( QPtrList<KFileInfo> & list, KFileInfo * subtree );
+
+	/**
+	 * Delete everything from the tree that is gone from disk.
+	 **/
+	void updateTree();
+
+	/**
+	 * All done: Update the tree, read again what is left and notify
+	 * everybody.
+	 **/
+	void finish();
+
+
+	/**
+	 * A top level item to delete: The path is all it takes to delete it;
+	 * the item (if there still is one in the tree) is only for updating
+	 * the tree.
+	 **/
+	struct QueueEntry
+	{
+	    QueueEntry( const QString & p = QString::null, KFileInfo * i = 0 )
+		: path( p ), item( i ) {}
+
+	    QString	path;
+	    KFileInfo * item;
+	};
+
+	/**
+	 * One open directory on disk, its name (relative to its parent, the
+	 * full path for a top level item) and its counterpart in the tree (if
+	 * known).
+	 **/
+	struct StackEntry
+	{
+	    StackEntry()
+		: dir( 0 ), item( 0 ), index( 0 ) {}
+
+	    DIR *		dir;
+	    QCString		name;
+	    KFileInfo *		item;
+	    QDict<KFileInfo> *	index;
+	};
+
+
+	// Data members
+
+	KDirTree *			_tree;
+	QValueList<QueueEntry>		_queue;
+	QueueEntry			_current;
+	QValueVector<StackEntry>	_stack;
+	QPtrList<KFileInfo>		_deleted;	// Gone from disk, not yet from the tree
+	QPtrList<KFileInfo>		_incomplete;	// To read again at the end
+	QTimer				_timer;
+	QTime				_lastUpdate;
+	bool				_active;
+	bool				_updatingTree;
+	int				_deletedCount;
+	int				_totalCount;
+	int				_errorCount;
+
+    };	// class KDeleteJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KDeleteJob_h
+
+
+// EOF
@@ -15,6 +15,7 @@
 #include <kapp.h>
 #include <klocale.h>
 #include "kdirinfo.h"
+#include "kdirtree.h"
 #include "kdirtreeiterators.h"
 
 using namespace KDirStat;
@@ -92,7 +93,7 @@ KDirInfo::init()
     _isDotEntry		= false;
     _pendingReadJobs	= 0;
     _dotEntry		= 0;
-    _firstChild		= 0;
+    _sortCache		= 0;
     _totalSize		= _size;
     _totalBlocks	= _blocks;
     _totalItems		= 0;
@@ -104,23 +105,26 @@ KDirInfo::init()
     _summaryDirty	= false;
     _beingDestroyed	= false;
     _readState		= KDirQueued;
+
+    for ( int bucket=0; bucket < KAgeBuckets; bucket++ )
+	_totalAgeSizes[ bucket ] = 0;
+
+    _totalAgeSizes[ _ageBucket ] = _size;
+
+    _totalFilteredSize	= 0;
+    _totalFilteredFiles	= 0;
 }
 
 
 KDirInfo::~KDirInfo()
 {
     _beingDestroyed	= true;
-    KFileInfo	*child	= _firstChild;
 
 
     // Recursively delete all children.
 
-    while ( child )
-    {
-	KFileInfo * nextChild = child->next();
-	delete child;
-	child = nextChild;
-    }
+    for ( uint i=0; i < _children.size(); i++ )
+	delete _children[i];
 
 
     // Delete the dot entry.
@@ -129,6 +133,8 @@ KDirInfo::~KDirInfo()
     {
 	delete _dotEntry;
     }
+
+    dropSortCache();
 }
 
 
@@ -144,10 +150,18 @@ KDirInfo::recalc()
     _totalFiles		= 0;
     _latestMtime	= _mtime;
 
+    for ( int bucket=0; bucket < KAgeBuckets; bucket++ )
+	_totalAgeSizes[ bucket ] = 0;
+
+    _totalAgeSizes[ _ageBucket ] = _size;
+
     KFileInfoIterator it( this, KDotEntryAsSubDir );
 
     while ( *it )
     {
+	for ( int bucket=0; bucket < KAgeBuckets; bucket++ )
+	    _totalAgeSizes[ bucket ] += (*it)->totalAgeSize( bucket );
+
 	_totalSize	+= (*it)->totalSize();
 	_totalBlocks	+= (*it)->totalBlocks();
 	_totalItems	+= (*it)->totalItems() + 1;
@@ -169,6 +183,18 @@ KDirInfo::recalc()
     }
 
     _summaryDirty = false;
+
+    // The children may have been sorted by their old totals, e.g. while
+    // this recalc was deferred.
+
+    dropSortCache();
+}
+
+
+bool
+KDirInfo::recalcDeferred() const
+{
+    return _tree && _tree->isRecalcPending();
 }
 
 
@@ -182,7 +208,7 @@ KDirInfo::setMountPoint( bool isMountPoint )
 KFileSize
 KDirInfo::totalSize()
 {
-    if ( _summaryDirty )
+    if ( _summaryDirty && ! recalcDeferred() )
 	recalc();
 
     return _totalSize;
@@ -192,7 +218,7 @@ KDirInfo::totalSize()
 KFileSize
 KDirInfo::totalBlocks()
 {
-    if ( _summaryDirty )
+    if ( _summaryDirty && ! recalcDeferred() )
 	recalc();
 
     return _totalBlocks;
@@ -202,7 +228,7 @@ KDirInfo::totalBlocks()
 int
 KDirInfo::totalItems()
 {
-    if ( _summaryDirty )
+    if ( _summaryDirty && ! recalcDeferred() )
 	recalc();
 
     return _totalItems;
@@ -212,7 +238,7 @@ KDirInfo::totalItems()
 int
 KDirInfo::totalSubDirs()
 {
-    if ( _summaryDirty )
+    if ( _summaryDirty && ! recalcDeferred() )
 	recalc();
 
     return _totalSubDirs;
@@ -222,7 +248,7 @@ KDirInfo::totalSubDirs()
 int
 KDirInfo::totalFiles()
 {
-    if ( _summaryDirty )
+    if ( _summaryDirty && ! recalcDeferred() )
 	recalc();
 
     return _totalFiles;
@@ -232,13 +258,46 @@ KDirInfo::totalFiles()
 time_t
 KDirInfo::latestMtime()
 {
-    if ( _summaryDirty )
+    if ( _summaryDirty && ! recalcDeferred() )
 	recalc();
 
     return _latestMtime;
 }
 
 
+KFileSize
+KDirInfo::totalAgeSize( int bucket )
+{
+    if ( bucket < 0 || bucket >= KAgeBuckets )
+	return 0;
+
+    if ( _summaryDirty && ! recalcDeferred() )
+	recalc();
+
+    return _totalAgeSizes[ bucket ];
+}
+
+
+KFileSize
+KDirInfo::totalFilteredSize()
+{
+    if ( _tree && _tree->fileFilter() )
+	return _totalFilteredSize;
+
+    return totalSize();
+}
+
+
+int
+KDirInfo::totalFilteredFiles()
+{
+    if ( _tree && _tree->fileFilter() )
+	return _totalFilteredFiles;
+
+    return totalFiles();
+}
+
+
 bool
 KDirInfo::isFinished()
 {
@@ -286,15 +345,14 @@ KDirInfo::insertChild( KFileInfo *newChild )
 	 * In any of those cases, insert the new child in the children list.
 	 *
 	 * We don't bother with this list's order - it's explicitly declared to
-	 * be unordered, so be warned! We simply insert this new child at the
-	 * list head since this operation can be performed in constant time
-	 * without the need for any additional lastChild etc. pointers or -
-	 * even worse - seeking the correct place for insertion first. This is
-	 * none of our business; the corresponding "view" object for this tree
-	 * will take care of such niceties.
+	 * be unordered, so be warned! We simply append this new child to the
+	 * children array since this operation can be performed in (amortized)
+	 * constant time without seeking the correct place for insertion
+	 * first. This is none of our business; the corresponding "view" object
+	 * for this tree will take care of such niceties.
 	 **/
-	newChild->setNext( _firstChild );
-	_firstChild = newChild;
+	newChild->setChildIndex( _children.size() );
+	_children.push_back( newChild );
 	newChild->setParent( this );	// make sure the parent pointer is correct
 
 	childAdded( newChild );		// update summaries
@@ -313,10 +371,13 @@ KDirInfo::insertChild( KFileInfo *newChild )
 void
 KDirInfo::childAdded( KFileInfo *newChild )
 {
+    dropSortCache();
+
     if ( ! _summaryDirty )
     {
 	_totalSize	+= newChild->size();
-	_totalBlocks	+= newChild->blocks();
+	_totalBlocks	+= newChild->isDuplicateLink() ? 0 : newChild->blocks();
+	_totalAgeSizes[ newChild->ageBucket() ] += newChild->size();
 	_totalItems++;
 
 	if ( newChild->isDir() )
@@ -346,6 +407,17 @@ KDirInfo::childAdded( KFileInfo *newChild )
 }
 
 
+void
+KDirInfo::childChanged()
+{
+    _summaryDirty = true;
+    dropSortCache();
+
+    if ( _parent )
+	_parent->childChanged();
+}
+
+
 void
 KDirInfo::deletingChild( KFileInfo *deletedChild )
 {
@@ -363,6 +435,7 @@ KDirInfo::deletingChild( KFileInfo *deletedChild )
      **/
 
     _summaryDirty = true;
+    dropSortCache();
 
     if ( _parent )
 	_parent->deletingChild( deletedChild );
@@ -391,30 +464,28 @@ KDirInfo::unlinkChild( KFileInfo *deletedChild )
 	return;
     }
 
-    if ( deletedChild == _firstChild )
+    dropSortCache();
+
+    int index = deletedChild->childIndex();
+
+    if ( index < 0 || index >= (int) _children.size() || _children[ index ] != deletedChild )
     {
-	// kdDebug() << "Unlinking first child " << deletedChild << endl;
-	_firstChild = deletedChild->next();
+	kdError() << "Couldn't unlink " << deletedChild << " from "
+		  << this << " children list" << endl;
 	return;
     }
 
-    KFileInfo *child = firstChild();
-
-    while ( child )
-    {
-	if ( child->next() == deletedChild )
-	{
-	    // kdDebug() << "Unlinking " << deletedChild << endl;
-	    child->setNext( deletedChild->next() );
+    // kdDebug() << "Unlinking " << deletedChild << endl;
 
-	    return;
-	}
+    // The children are unordered anyway, so simply move the last child into
+    // the gap rather than shifting all children behind it.
 
-	child = child->next();
-    }
+    KFileInfo * last = _children.back();
+    _children[ index ] = last;
+    last->setChildIndex( index );
+    _children.pop_back();
 
-    kdError() << "Couldn't unlink " << deletedChild << " from "
-	      << this << " children list" << endl;
+    deletedChild->setChildIndex( -1 );
 }
 
 
@@ -461,16 +532,12 @@ KDirInfo::finalizeAll()
     if ( _isDotEntry )
 	return;
 
-    KFileInfo *child = firstChild();
-
-    while ( child )
+    for ( uint i=0; i < _children.size(); i++ )
     {
-	KDirInfo * dir = dynamic_cast<KDirInfo *> (child);
+	KDirInfo * dir = dynamic_cast<KDirInfo *> ( _children[i] );
 
 	if ( dir && ! dir->isDotEntry() )
 	    dir->finalizeAll();
-
-	child = child->next();
     }
 
     // Optimization: As long as this directory is not finalized yet, it does
@@ -487,6 +554,30 @@ KDirInfo::finalizeAll()
 }
 
 
+KFileInfoSortCache *
+KDirInfo::sortCache()
+{
+    if ( ! _sortCache )
+    {
+	_sortCache = new KFileInfoSortCache( this );
+	CHECK_PTR( _sortCache );
+    }
+
+    return _sortCache;
+}
+
+
+void
+KDirInfo::dropSortCache()
+{
+    if ( _sortCache )
+    {
+	delete _sortCache;
+	_sortCache = 0;
+    }
+}
+
+
 KDirReadState
 KDirInfo::readState() const
 {
@@ -503,21 +594,24 @@ KDirInfo::cleanupDotEntries()
     if ( ! _dotEntry || _isDotEntry )
 	return;
 
+    dropSortCache();
+
     // Reparent dot entry children if there are no subdirectories on this level
 
-    if ( ! _firstChild )
+    if ( _children.isEmpty() )
     {
 	// kdDebug() << "Reparenting children of solo dot entry " << this << endl;
 
-	KFileInfo *child = _dotEntry->firstChild();
-	_firstChild = child;		// Move the entire children chain here.
-	_dotEntry->setFirstChild( 0 );	// _dotEntry will be deleted below.
+	KDirInfo * dotEntry = (KDirInfo *) _dotEntry;
+
+	_children = dotEntry->_children;	// Move the entire children array here;
+	dotEntry->_children.clear();		// _dotEntry will be deleted below.
+	dotEntry->dropSortCache();
+
+	// The children keep their indices.
 
-	while ( child )
-	{
-	    child->setParent( this );
-	    child = child->next();
-	}
+	for ( uint i=0; i < _children.size(); i++ )
+	    _children[i]->setParent( this );
     }
 
 
@@ -23,6 +23,7 @@
 
 #include <kdebug.h>
 #include <kfileitem.h>
+#include <qvaluevector.h>
 #include "kfileinfo.h"
 
 #ifndef NOT_USED
@@ -37,6 +38,7 @@ namespace KDirStat
 {
     // Forward declarations
     class KDirTree;
+    class KFileInfoSortCache;
 
 
     /**
@@ -138,6 +140,36 @@ namespace KDirStat
 	 **/
 	virtual time_t		latestMtime();
 
+	/**
+	 * Returns the total size of all items in this subtree in age bucket
+	 * 'bucket'.
+	 *
+	 * Reimplemented - inherited from @ref KFileInfo.
+	 **/
+	virtual KFileSize	totalAgeSize( int bucket );
+
+	/**
+	 * Returns the total size of all items in this subtree that are
+	 * accepted by the tree's file filter.
+	 *
+	 * Reimplemented - inherited from @ref KFileInfo.
+	 **/
+	virtual KFileSize	totalFilteredSize();
+
+	/**
+	 * Returns the total number of plain files in this subtree that are
+	 * accepted by the tree's file filter.
+	 *
+	 * Reimplemented - inherited from @ref KFileInfo.
+	 **/
+	virtual int		totalFilteredFiles();
+
+	/**
+	 * Set the filtered totals. This is done only by @ref KFilterTotals.
+	 **/
+	void			setFilteredTotals( KFileSize size, int files )
+	    { _totalFilteredSize = size; _totalFilteredFiles = files; }
+
 	/**
 	 * Returns 'true' if this had been excluded while reading.
 	 **/
@@ -193,22 +225,31 @@ namespace KDirStat
 	 * Returns the first child of this item or 0 if there is none.
 	 * Use the child's next() method to get the next child.
 	 **/
-	virtual KFileInfo * firstChild() const { return _firstChild;	}
+	virtual KFileInfo * firstChild() const
+	    { return _children.isEmpty() ? 0 : _children.first(); }
+
+	/**
+	 * Returns the number of direct children, not counting the dot entry.
+	 *
+	 * Reimplemented - inherited from @ref KFileInfo.
+	 **/
+	virtual int	childCount() const { return _children.size(); }
 
 	/**
-	 * Set this entry's first child.
-	 * Use this method only if you know exactly what you are doing.
+	 * Returns the child with index 'index' or 0 if there is none.
 	 *
 	 * Reimplemented - inherited from @ref KFileInfo.
 	 **/
-	virtual void	setFirstChild( KFileInfo *newfirstChild )
-	    { _firstChild = newfirstChild; }
+	virtual KFileInfo * childAt( int index ) const
+	    { return index >= 0 && index < (int) _children.size() ? _children[ index ] : 0; }
 
 	/**
 	 * Insert a child into the children list.
 	 *
 	 * The order of children in this list is absolutely undefined;
-	 * don't rely on any implementation-specific order.
+	 * don't rely on any implementation-specific order. New children are
+	 * appended, so the index of a child doesn't change when others are
+	 * inserted. Unlinking a child moves the last child into its place.
 	 **/
 	virtual void insertChild( KFileInfo *newChild );
 
@@ -224,7 +265,8 @@ namespace KDirStat
 	/**
 	 * Set a "Dot Entry". This makes sense for directories only.
 	 **/
-	virtual void setDotEntry( KFileInfo *newDotEntry ) { _dotEntry = newDotEntry; }
+	virtual void setDotEntry( KFileInfo *newDotEntry )
+	    { _dotEntry = newDotEntry; dropSortCache(); }
 
 	/**
 	 * Returns true if this is a "Dot Entry". See @ref dotEntry() for
@@ -241,6 +283,14 @@ namespace KDirStat
 	 **/
 	virtual void childAdded( KFileInfo *newChild );
 
+	/**
+	 * Notification that the size of a child somewhere in the subtree
+	 * changed: Mark the summary fields of this directory and all its
+	 * ancestors as dirty. They are recalculated upon the next access or
+	 * by the tree's background recalculation.
+	 **/
+	void childChanged();
+
 	/**
 	 * Remove a child from the children list.
 	 *
@@ -323,17 +373,56 @@ namespace KDirStat
 	 **/
 	virtual bool isDirInfo() const { return true; }
 
+	/**
+	 * Returns the cache for this directory's children in various sort
+	 * orders. This creates an empty cache if there is none yet.
+	 *
+	 * Normally, this is used only by @ref KFileInfoSortedIterator.
+	 **/
+	KFileInfoSortCache * sortCache();
 
-    protected:
+	/**
+	 * Discard the sorted children lists cached for this directory.
+	 *
+	 * This happens automatically whenever children are added or removed
+	 * anywhere in this subtree: Even if this directory's children remain
+	 * the same, their totals change, and so does their order by size.
+	 **/
+	void dropSortCache();
+
+	/**
+	 * Returns 'true' if the summary fields (total size etc.) are outdated
+	 * and need to be recalculated.
+	 **/
+	bool isSummaryDirty() const { return _summaryDirty; }
+
+	/**
+	 * Mark the summary fields as outdated: The next access to any of them
+	 * triggers a @ref recalc().
+	 *
+	 * Normally, this happens only when children are deleted.
+	 **/
+	void markSummaryDirty() { _summaryDirty = true; }
 
 	/**
 	 * Recursively recalculate the summary fields when they are dirty.
 	 *
 	 * This is a _very_ expensive operation since the entire subtree may
-	 * recursively be traversed.
+	 * recursively be traversed - unless all subdirectories are already
+	 * up to date, which is what @ref KDirTreeRecalc makes use of.
 	 **/
 	void		recalc();
 
+
+    protected:
+
+	/**
+	 * Returns 'true' if recalculating dirty summary fields is left to the
+	 * tree's background recalculation. The summary accessors return the
+	 * old values in that case.
+	 **/
+	bool		recalcDeferred() const;
+
 	/**
 	 * Clean up unneeded / undesired dot entries:
 	 * Delete dot entries that don't have any children,
@@ -354,8 +443,10 @@ namespace KDirStat
 
 	// Children management
 
-	KFileInfo *	_firstChild;		// pointer to the first child
+	QValueVector<KFileInfo *> _children;	// direct children (only subdirs unless
+						// this is a dot entry or finalized)
 	KFileInfo *	_dotEntry;		// pseudo entry to hold non-dir children
+	KFileInfoSortCache * _sortCache;	// sorted children lists (on demand)
 
 	// Some cached values
 
@@ -365,6 +456,9 @@ namespace KDirStat
 	int		_totalSubDirs;
 	int		_totalFiles;
 	time_t		_latestMtime;
+	KFileSize	_totalAgeSizes[ KAgeBuckets ];	// age histogram
+	KFileSize	_totalFilteredSize;	// overlay of the tree's file filter
+	int		_totalFilteredFiles;
 
 	bool		_summaryDirty:1;	// dirty flag for the cached values
 	bool		_beingDestroyed:1;
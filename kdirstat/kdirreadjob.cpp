@@ -91,6 +91,7 @@ KDirReadJob::finished()
 void
 KDirReadJob::childAdded( KFileInfo *newChild )
 {
+    _tree->scanStats()->addEntry( newChild );
     _tree->childAddedNotify( newChild );
 }
 
@@ -138,9 +139,40 @@ KLocalDirReadJob::startReading()
 	    if ( entryName != "."  &&
 		 entryName != ".."   )
 	    {
-		QString fullName = dirName + "/" + entryName;
+		// Check the name rules before doing anything else with this
+		// entry. Where the directory entry tells that it is a
+		// directory, an excluded directory does not even cost an
+		// lstat().
+
+#ifdef _DIRENT_HAVE_D_TYPE
+		bool maybeDir = entry->d_type == DT_DIR || entry->d_type == DT_UNKNOWN;
+#else
+		bool maybeDir = true;
+#endif
+		bool excludedByName = maybeDir && KExcludeRules::excludeRules()->matchName( entry->d_name );
+
+#ifdef _DIRENT_HAVE_D_TYPE
+		if ( excludedByName && entry->d_type == DT_DIR )
+		{
+		    KDirInfo *subDir = new KDirInfo( _tree, _dir, entryName,
+						     S_IFDIR,	// mode
+						     0,		// size
+						     0 );	// mtime - unknown
+		    _dir->insertChild( subDir );
+		    childAdded( subDir );
+
+		    subDir->setExcluded();
+		    subDir->setReadState( KDirOnRequestOnly );
+		    _tree->sendFinalizeLocal( subDir );
+		    subDir->finalizeLocal();
+		    continue;
+		}
+#endif
+
+		QString	     fullName = dirName + "/" + entryName;
+		const char * path     = fullName;	// converted only once
 
-		if ( lstat( fullName, &statInfo ) == 0 )	// lstat() OK
+		if ( _tree->scanStats()->lstat( path, &statInfo, _dir ) == 0 )	// lstat() OK
 		{
 		    if ( S_ISDIR( statInfo.st_mode ) )	// directory child?
 		    {
@@ -148,7 +180,7 @@ KLocalDirReadJob::startReading()
 			_dir->insertChild( subDir );
 			childAdded( subDir );
 
-			if ( KExcludeRules::excludeRules()->match( fullName ) )
+			if ( excludedByName || KExcludeRules::excludeRules()->match( path ) )
 			{
 			    subDir->setExcluded();
 			    subDir->setReadState( KDirOnRequestOnly );
@@ -521,7 +553,9 @@ KCacheReadJob::read()
 	finished();
 
     // kdDebug() << "Reading 1000 cache lines" << endl;
+    int lineNo = _reader->lineNo();
     _reader->read( 1000 );
+    _tree->scanStats()->addCacheLines( _reader->lineNo() - lineNo );
     _tree->sendProgressInfo( "" );
 
     if ( _reader->eof() || ! _reader->ok() )
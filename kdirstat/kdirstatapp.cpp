@@ -28,6 +28,7 @@
 #include <klocale.h>
 #include <kmenubar.h>
 #include <kmessagebox.h>
+#include <kprogress.h>
 #include <krun.h>
 #include <kstatusbar.h>
 #include <kstdaction.h>
@@ -43,6 +44,14 @@
 #include "kactivitytracker.h"
 #include "kdirtreeview.h"
 #include "kdirstatsettings.h"
+#include "ktopndialog.h"
+#include "kfiletypestatsdialog.h"
+#include "kownerstatsdialog.h"
+#include "kduplicatesdialog.h"
+#include "kfilefilterdialog.h"
+#include "kcleanupjobsdialog.h"
+#include "kcleanupbatch.h"
+#include "kscanstatsdialog.h"
 #include "kdirtreecache.h"
 #include "kexcluderules.h"
 
@@ -72,7 +81,15 @@ KDirStatApp::KDirStatApp( QWidget* , const char* name )
     // Those will be created delayed, only when needed
 
     _settingsDialog 	= 0;
+    _topNDialog		= 0;
+    _fileTypeStatsDialog = 0;
+    _ownerStatsDialog	= 0;
+    _duplicatesDialog	= 0;
+    _fileFilterDialog	= 0;
+    _cleanupJobsDialog	= 0;
+    _scanStatsDialog	= 0;
     _feedbackDialog 	= 0;
+    _deleteProgressDialog = 0;
     _treemapView	= 0;
     _pacMan		= 0;
     _pacManDelimiter	= 0;
@@ -109,6 +126,15 @@ KDirStatApp::KDirStatApp( QWidget* , const char* name )
     connect( _treeView, SIGNAL( finished()		), this, SLOT( createTreemapViewDelayed() ) );
     connect( _treeView, SIGNAL( aborted()		), this, SLOT( createTreemapViewDelayed() ) );
     connect( _treeView, SIGNAL( startingReading()	), this, SLOT( deleteTreemapView() ) );
+    connect( _treeView, SIGNAL( startingReading()	), this, SLOT( createTreemapViewDelayed() ) );
+
+    KDeleteJob * deleteJob = _treeView->tree()->deleteJob();
+
+    connect( deleteJob,	SIGNAL( progress( int, int ) ),
+	     this,	SLOT  ( deleteProgress( int, int ) ) );
+
+    connect( deleteJob,	SIGNAL( finished()	     ),
+	     this,	SLOT  ( deleteFinished()     ) );
 
     connect( _treeView, SIGNAL( startingReading()	), this, SLOT( updateActions() ) );
     connect( _treeView, SIGNAL( finished()        	), this, SLOT( updateActions() ) );
@@ -207,6 +233,10 @@ KDirStatApp::initActions()
 				       this, SLOT( treemapRebuild() ),
 				       actionCollection(), "treemap_rebuild" );
 
+    _treemapColorByAge	= new KToggleAction( i18n( "Color by File &Age" ), 0,
+					     this, SLOT( treemapColorByAge() ),
+					     actionCollection(), "treemap_color_by_age" );
+
     _showTreemapView	= new KToggleAction( i18n( "Show Treemap" ), Key_F9,
 					     this, SLOT( toggleTreemapView() ),
 					     actionCollection(), "options_show_treemap" );
@@ -221,6 +251,42 @@ KDirStatApp::initActions()
 				       _treeView, SLOT( sendMailToOwner() ),
 				       actionCollection(), "report_mail_to_owner" );
 
+    _reportTopN		= new KAction( i18n( "&Largest Items..." ), "viewmag", 0,
+				       this, SLOT( reportTopN() ),
+				       actionCollection(), "report_top_n" );
+
+    _reportFileTypeStats = new KAction( i18n( "File &Type Statistics..." ), 0,
+					this, SLOT( reportFileTypeStats() ),
+					actionCollection(), "report_file_type_stats" );
+
+    _reportOwnerStats	= new KAction( i18n( "Disk Usage per &Owner..." ), 0,
+				       this, SLOT( reportOwnerStats() ),
+				       actionCollection(), "report_owner_stats" );
+
+    _reportDuplicates	= new KAction( i18n( "&Duplicate Files..." ), 0,
+				       this, SLOT( reportDuplicates() ),
+				       actionCollection(), "report_duplicates" );
+
+    _reportScanStats	= new KAction( i18n( "&Scan Statistics..." ), 0,
+				       this, SLOT( reportScanStats() ),
+				       actionCollection(), "report_scan_stats" );
+
+    _fileFilter		= new KAction( i18n( "&Filter Files..." ), "filter", 0,
+				       this, SLOT( fileFilter() ),
+				       actionCollection(), "options_file_filter" );
+
+    _clearFileFilter	= new KAction( i18n( "&Remove File Filter" ), 0,
+				       this, SLOT( clearFileFilter() ),
+				       actionCollection(), "options_clear_file_filter" );
+
+    _watchForChanges	= new KToggleAction( i18n( "&Watch for Changes" ), 0,
+					     this, SLOT( watchForChanges() ),
+					     actionCollection(), "options_watch_for_changes" );
+
+    _cleanupJobs	= new KAction( i18n( "Cleanup &Jobs..." ), 0,
+				       this, SLOT( cleanupJobs() ),
+				       actionCollection(), "cleanup_jobs" );
+
     _helpSendFeedbackMail = new KAction( i18n( "Send &Feedback Mail..." ), 0,
 					 this, SLOT( sendFeedbackMail() ),
 					 actionCollection(), "help_send_feedback_mail" );
@@ -240,13 +306,23 @@ KDirStatApp::initActions()
     _fileQuit->setStatusText		( i18n( "Quits the application" 		) );
     _editCopy->setStatusText		( i18n( "Copies the URL of the selected item to the clipboard" ) );
     _cleanupOpenWith->setStatusText	( i18n( "Open file or directory with arbitrary application" ) );
+    _cleanupJobs->setStatusText		( i18n( "Shows the cleanups running in the background and their output" ) );
     _showTreemapView->setStatusText	( i18n( "Enables/disables the treemap view" 	) );
     _treemapZoomIn->setStatusText	( i18n( "Zoom treemap in"		 	) );
     _treemapZoomOut->setStatusText	( i18n( "Zoom treemap out"		 	) );
     _treemapSelectParent->setStatusText	( i18n( "Select parent"			 	) );
     _treemapRebuild->setStatusText	( i18n( "Rebuild treemap to fit into available space" ) );
+    _treemapColorByAge->setStatusText	( i18n( "Colors treemap tiles by the age of their files rather than by file type" ) );
     pref->setStatusText			( i18n( "Opens the preferences dialog"		) );
     _reportMailToOwner->setStatusText	( i18n( "Sends a mail to the owner of the selected subtree" ) );
+    _reportTopN->setStatusText		( i18n( "Lists the largest files, directories or file types" ) );
+    _reportFileTypeStats->setStatusText	( i18n( "Shows how much space each file type takes" ) );
+    _reportOwnerStats->setStatusText	( i18n( "Shows how much space each user or group takes" ) );
+    _reportDuplicates->setStatusText	( i18n( "Finds files with identical contents" ) );
+    _reportScanStats->setStatusText	( i18n( "Shows how fast directories are read and where the time goes" ) );
+    _fileFilter->setStatusText		( i18n( "Shows subtree totals of only some files without reading anything again" ) );
+    _clearFileFilter->setStatusText	( i18n( "Goes back to the totals of all files" ) );
+    _watchForChanges->setStatusText	( i18n( "Keeps the directory tree up to date when files are created, changed or deleted" ) );
 }
 
 
@@ -267,6 +343,9 @@ KDirStatApp::initCleanups()
 
     connect( this,               SIGNAL( saveConfig( void ) ),
 	     _cleanupCollection, SIGNAL( saveConfig( void ) ) );
+
+    connect( _cleanupCollection, SIGNAL( batchStarted  ( KCleanupBatch * ) ),
+	     this,		 SLOT  ( cleanupStarted( KCleanupBatch * ) ) );
 }
 
 
@@ -370,6 +449,12 @@ void KDirStatApp::readMainWinConfig()
     _showTreemapView->setChecked( config->readBoolEntry( "Show Treemap", true ) );
     toggleTreemapView();
 
+    config->setGroup( "Treemaps" );
+    _treemapColorByAge->setChecked( config->readBoolEntry( "ColorByAge", false ) );
+    config->setGroup( "Directory Reading" );
+    _watchForChanges->setChecked( config->readBoolEntry( "WatchForChanges", false ) );
+    config->setGroup( "General Options" );
+
 
     // Position settings of the various bars
 
@@ -402,7 +487,16 @@ void KDirStatApp::readMainWinConfig()
 	kdDebug() << "Adding exclude rule: " << ruleText << endl;
     }
 
-    if ( excludeRules.size() == 0 )
+    QStringList excludeNames = config->readListEntry ( "ExcludeNames" );
+
+    for ( QStringList::Iterator it = excludeNames.begin(); it != excludeNames.end(); ++it )
+    {
+	QString name = *it;
+	KExcludeRules::excludeRules()->add( new KExcludeRule( QRegExp( name, true, true ), true ) );
+	kdDebug() << "Adding exclude name: " << name << endl;
+    }
+
+    if ( excludeRules.size() == 0 && excludeNames.size() == 0 )
 	kdDebug() << "No exclude rules defined" << endl;
 }
 
@@ -729,6 +823,18 @@ KDirStatApp::treemapRebuild()
 }
 
 
+void
+KDirStatApp::treemapColorByAge()
+{
+    KConfig * config = kapp->config();
+    config->setGroup( "Treemaps" );
+    config->writeEntry( "ColorByAge", _treemapColorByAge->isChecked() );
+
+    if ( _treemapView )
+	_treemapView->setColorByAge( _treemapColorByAge->isChecked() );
+}
+
+
 void
 KDirStatApp::treemapHelp()
 {
@@ -752,6 +858,209 @@ KDirStatApp::toggleTreemapView()
 }
 
 
+void
+KDirStatApp::reportTopN()
+{
+    if ( ! _topNDialog )
+    {
+	_topNDialog = new KDirStat::KTopNDialog( _treeView->tree(), this );
+	CHECK_PTR( _topNDialog );
+    }
+
+    if ( ! _topNDialog->isVisible() )
+    {
+	_topNDialog->show();
+	_topNDialog->refresh();
+    }
+}
+
+
+void
+KDirStatApp::reportFileTypeStats()
+{
+    if ( ! _fileTypeStatsDialog )
+    {
+	_fileTypeStatsDialog = new KDirStat::KFileTypeStatsDialog( _treeView->tree(), this );
+	CHECK_PTR( _fileTypeStatsDialog );
+    }
+
+    if ( ! _fileTypeStatsDialog->isVisible() )
+    {
+	_fileTypeStatsDialog->show();
+	_fileTypeStatsDialog->refresh();
+    }
+}
+
+
+void
+KDirStatApp::reportOwnerStats()
+{
+    if ( ! _ownerStatsDialog )
+    {
+	_ownerStatsDialog = new KDirStat::KOwnerStatsDialog( _treeView->tree(), this );
+	CHECK_PTR( _ownerStatsDialog );
+    }
+
+    if ( ! _ownerStatsDialog->isVisible() )
+    {
+	_ownerStatsDialog->show();
+	_ownerStatsDialog->refresh();
+    }
+}
+
+
+void
+KDirStatApp::reportDuplicates()
+{
+    if ( ! _duplicatesDialog )
+    {
+	_duplicatesDialog = new KDirStat::KDuplicatesDialog( _treeView->tree(), this );
+	CHECK_PTR( _duplicatesDialog );
+
+	connect( _duplicatesDialog, SIGNAL( contextMenu( KFileInfo *, const QPoint & ) ),
+		 this,		    SLOT  ( contextMenu( KFileInfo *, const QPoint & ) ) );
+    }
+
+    if ( ! _duplicatesDialog->isVisible() )
+    {
+	_duplicatesDialog->show();
+	_duplicatesDialog->refresh();
+    }
+}
+
+
+void
+KDirStatApp::reportScanStats()
+{
+    if ( ! _scanStatsDialog )
+    {
+	_scanStatsDialog = new KDirStat::KScanStatsDialog( _treeView->tree(), this );
+	CHECK_PTR( _scanStatsDialog );
+    }
+
+    if ( ! _scanStatsDialog->isVisible() )
+	_scanStatsDialog->show();
+}
+
+
+void
+KDirStatApp::fileFilter()
+{
+    if ( ! _fileFilterDialog )
+    {
+	_fileFilterDialog = new KDirStat::KFileFilterDialog( _treeView->tree(), this );
+	CHECK_PTR( _fileFilterDialog );
+    }
+
+    if ( ! _fileFilterDialog->isVisible() )
+	_fileFilterDialog->show();
+}
+
+
+void
+KDirStatApp::cleanupJobs()
+{
+    if ( ! _cleanupJobsDialog )
+    {
+	_cleanupJobsDialog = new KDirStat::KCleanupJobsDialog( this );
+	CHECK_PTR( _cleanupJobsDialog );
+    }
+
+    if ( ! _cleanupJobsDialog->isVisible() )
+	_cleanupJobsDialog->show();
+}
+
+
+void
+KDirStatApp::cleanupStarted( KCleanupBatch * batch )
+{
+    if ( ! _cleanupJobsDialog )
+    {
+	_cleanupJobsDialog = new KDirStat::KCleanupJobsDialog( this );
+	CHECK_PTR( _cleanupJobsDialog );
+    }
+
+    _cleanupJobsDialog->addBatch( batch );
+
+    statusMsg( i18n( "Started %1 - %2 cleanup jobs running." )
+	       .arg( batch->title() ).arg( _cleanupJobsDialog->runningCount() ) );
+}
+
+
+void
+KDirStatApp::clearFileFilter()
+{
+    _treeView->tree()->setFileFilter( 0 );
+}
+
+
+void
+KDirStatApp::watchForChanges()
+{
+    KConfig * config = kapp->config();
+    config->setGroup( "Directory Reading" );
+    config->writeEntry( "WatchForChanges", _watchForChanges->isChecked() );
+
+    if ( _treeView->tree() )
+	_treeView->tree()->setWatchForChanges( _watchForChanges->isChecked() );
+}
+
+
+void
+KDirStatApp::deleteProgress( int deletedCount, int totalCount )
+{
+    KDeleteJob * job = _treeView->tree()->deleteJob();
+
+    if ( ! job->isActive() )
+	return;
+
+    if ( ! _deleteProgressDialog )
+    {
+	_deleteProgressDialog = new KProgressDialog( this, 0,			// parent, name
+						     i18n( "Deleting" ),	// caption
+						     QString::null,		// text
+						     false );			// modal
+	CHECK_PTR( _deleteProgressDialog );
+
+	_deleteProgressDialog->setAutoClose( false );
+	_deleteProgressDialog->setAutoReset( false );
+
+	connect( _deleteProgressDialog, SIGNAL( cancelClicked() ),
+		 job,			SLOT  ( abort()		) );
+    }
+
+    // The total is only an estimate: There might be more on disk than the
+    // tree knows about.
+
+    _deleteProgressDialog->progressBar()->setTotalSteps( QMAX( totalCount, deletedCount ) );
+    _deleteProgressDialog->progressBar()->setProgress( deletedCount );
+    _deleteProgressDialog->setLabel( i18n( "Deleting %1" ).arg( job->currentPath() ) );
+}
+
+
+void
+KDirStatApp::deleteFinished()
+{
+    if ( _deleteProgressDialog )
+    {
+	delete _deleteProgressDialog;
+	_deleteProgressDialog = 0;
+    }
+
+    KDeleteJob * job = _treeView->tree()->deleteJob();
+
+    if ( job->errorCount() > 0 )
+    {
+	statusMsg( i18n( "Deleted %1 items; %2 items could not be deleted." )
+		   .arg( job->deletedCount() ).arg( job->errorCount() ) );
+    }
+    else
+    {
+	statusMsg( i18n( "Deleted %1 items." ).arg( job->deletedCount() ) );
+    }
+}
+
+
 void
 KDirStatApp::preferences()
 {
@@ -866,6 +1175,16 @@ KDirStatApp::contextMenu( KTreemapTile * tile, const QPoint &pos )
 }
 
 
+void
+KDirStatApp::contextMenu( KFileInfo * item, const QPoint &pos )
+{
+    NOT_USED( item );
+
+    if ( _treeViewContextMenu )
+	_treeViewContextMenu->popup( pos );
+}
+
+
 void
 KDirStatApp::createTreemapViewDelayed()
 {
@@ -879,6 +1198,19 @@ KDirStatApp::createTreemapView()
     if ( ! _showTreemapView->isChecked() || ! _treeView->tree() )
 	return;
 
+    if ( _treeView->tree()->isBusy() )
+    {
+	// Still reading - only create the treemap view now if it is supposed
+	// to be updated during reading. Otherwise it will be created when
+	// reading is finished.
+
+	KConfig * config = kapp->config();
+	config->setGroup( "Treemaps" );
+
+	if ( ! config->readBoolEntry( "ProgressiveTreemap", true ) )
+	    return;
+    }
+
     if ( _treemapView )
 	delete _treemapView;
 
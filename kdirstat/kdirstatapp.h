@@ -34,16 +34,25 @@ class KFeedbackDialog;
 class KFeedbackQuestion;
 class KPacMan;
 class KPacMan;
+class KProgressDialog;
 class KRecentFilesAction;
 class KToggleAction;
 
 namespace KDirStat
 {
     class KCleanupCollection;
+    class KCleanupBatch;
+    class KCleanupJobsDialog;
     class KDirTreeView;
     class KDirTreeViewItem;
     class KFileInfo;
     class KSettingsDialog;
+    class KTopNDialog;
+    class KFileTypeStatsDialog;
+    class KOwnerStatsDialog;
+    class KDuplicatesDialog;
+    class KFileFilterDialog;
+    class KScanStatsDialog;
     class KTreemapView;
     class KTreemapTile;
 }
@@ -183,6 +192,11 @@ public slots:
      **/
     void treemapRebuild();
 
+    /**
+     * Switch treemap colors between file types and file ages.
+     **/
+    void treemapColorByAge();
+
     /**
      * Invoke online help about treemaps.
      **/
@@ -193,6 +207,69 @@ public slots:
      **/
     void preferences();
 
+    /**
+     * Show the dialog with the largest files / directories / file types.
+     **/
+    void reportTopN();
+
+    /**
+     * Show the dialog with the sizes per file type.
+     **/
+    void reportFileTypeStats();
+
+    /**
+     * Show the dialog with the disk usage per user and group.
+     **/
+    void reportOwnerStats();
+
+    /**
+     * Show the dialog with the duplicate files.
+     **/
+    void reportDuplicates();
+
+    /**
+     * Show the dialog with the scan statistics.
+     **/
+    void reportScanStats();
+
+    /**
+     * Show the dialog to set the file filter.
+     **/
+    void fileFilter();
+
+    /**
+     * Remove the file filter.
+     **/
+    void clearFileFilter();
+
+    /**
+     * Start or stop watching the directories of the current tree for
+     * changes according to the "Watch for Changes" action.
+     **/
+    void watchForChanges();
+
+    /**
+     * Show the dialog with the cleanups running in the background.
+     **/
+    void cleanupJobs();
+
+    /**
+     * Notification that a cleanup started running 'batch' in the
+     * background: Add it to the cleanup jobs dialog.
+     **/
+    void cleanupStarted( KCleanupBatch * batch );
+
+    /**
+     * Show the progress of deleting items from disk (see @ref
+     * KDirStat::KDeleteJob).
+     **/
+    void deleteProgress( int deletedCount, int totalCount );
+
+    /**
+     * Notification that deleting items from disk is finished.
+     **/
+    void deleteFinished();
+
     /**
      * Changes the statusbar contents for the standard label permanently, used
      * to indicate current actions.
@@ -211,6 +288,12 @@ public slots:
      **/
     void contextMenu( KTreemapTile * tile, const QPoint &pos );
 
+    /**
+     * Opens the tree view context menu for an item selected elsewhere,
+     * e.g., in the duplicate files dialog.
+     **/
+    void contextMenu( KFileInfo * item, const QPoint &pos );
+
     /**
      * Create a treemap view. This makes only sense after a directory tree is
      * completely read.
@@ -388,7 +471,15 @@ protected:
     QPopupMenu *		_treeViewContextMenu;
     QPopupMenu *		_treemapContextMenu;
     KDirStat::KSettingsDialog *	_settingsDialog;
+    KDirStat::KTopNDialog *	_topNDialog;
+    KDirStat::KFileTypeStatsDialog * _fileTypeStatsDialog;
+    KDirStat::KOwnerStatsDialog * _ownerStatsDialog;
+    KDirStat::KDuplicatesDialog * _duplicatesDialog;
+    KDirStat::KFileFilterDialog * _fileFilterDialog;
+    KDirStat::KCleanupJobsDialog * _cleanupJobsDialog;
+    KDirStat::KScanStatsDialog * _scanStatsDialog;
     KFeedbackDialog *		_feedbackDialog;
+    KProgressDialog *		_deleteProgressDialog;
     KActivityTracker *		_activityTracker;
 
 
@@ -408,14 +499,24 @@ protected:
     KAction * 			_fileQuit;
     KAction * 			_editCopy;
     KAction * 			_cleanupOpenWith;
+    KAction *			_cleanupJobs;
     KAction *	 		_treemapZoomIn;
     KAction *			_treemapZoomOut;
     KAction *			_treemapSelectParent;
     KAction * 			_treemapRebuild;
 
     KAction *			_reportMailToOwner;
+    KAction *			_reportTopN;
+    KAction *			_reportFileTypeStats;
+    KAction *			_reportOwnerStats;
+    KAction *			_reportDuplicates;
+    KAction *			_reportScanStats;
+    KAction *			_fileFilter;
+    KAction *			_clearFileFilter;
+    KToggleAction *		_watchForChanges;
     KAction *			_helpSendFeedbackMail;
     KToggleAction * 		_showTreemapView;
+    KToggleAction *		_treemapColorByAge;
 
     KCleanupCollection *	_cleanupCollection;
 
@@ -0,0 +1,585 @@
+/*
+ *   File name:	kdirstatbench.cpp
+ *   Summary:	Benchmark for scanning, cache files and treemap layout
+ *   License:	GPL - See file COPYING for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <qfile.h>
+#include <kapp.h>
+#include <kaboutdata.h>
+#include <kcmdlineargs.h>
+#include <kdebug.h>
+#include <klocale.h>
+
+#include "kdirtree.h"
+#include "kdirtreeiterators.h"
+#include "kbatchjob.h"
+#include "kscanstats.h"
+#include "ktreemaplayout.h"
+
+
+using namespace KDirStat;
+
+
+static const char *description =
+	I18N_NOOP("KDirStat benchmark.\n"
+		  "\n"
+		  "Generates a synthetic directory tree (or uses Dir),\n"
+		  "then times reading it, writing and reading a cache file,\n"
+		  "recalculating the sums, sorted iteration and the treemap layout.\n"
+		  "\n"
+		  "Output is tab separated: run, phase, milliseconds, items\n"
+		  "and the peak resident set size so far in kB."
+		  );
+
+
+static KCmdLineOptions options[] =
+{
+    { "+[Dir]", I18N_NOOP("Existing directory to use instead of a synthetic tree"), 0 },
+    { "fan-out <N>", I18N_NOOP("Subdirectories per directory"), "6" },
+    { "depth <N>", I18N_NOOP("Levels of subdirectories"), "4" },
+    { "files <N>", I18N_NOOP("Files per directory"), "20" },
+    { "name-length <N>", I18N_NOOP("Minimum length of file and directory names"), "12" },
+    { "hard-links <percent>", I18N_NOOP("Percentage of files with an additional hard link"), "5" },
+    { "max-file-size <bytes>", I18N_NOOP("Maximum size of the generated files"), "4096" },
+    { "seed <N>", I18N_NOOP("Seed for names and file sizes"), "42" },
+    { "runs <N>", I18N_NOOP("Number of times to run all phases"), "3" },
+    { "size <WxH>", I18N_NOOP("Size of the treemap to lay out"), "1600x1200" },
+    { "work-dir <dir>", I18N_NOOP("Where to put the synthetic tree and the cache file"), "/tmp" },
+    { "keep", I18N_NOOP("Don't remove the synthetic tree and the cache file"), 0 },
+    { 0, 0, 0 }
+};
+
+
+/**
+ * Shape of a synthetic directory tree.
+ **/
+struct KBenchShape
+{
+    int		fanOut;
+    int		depth;
+    int		files;
+    int		nameLength;
+    int		hardLinks;	// percent
+    int		maxFileSize;
+};
+
+
+/**
+ * What was generated.
+ **/
+struct KBenchCounts
+{
+    KBenchCounts()
+	: dirs( 0 ), files( 0 ), links( 0 ), bytes( 0 ) {}
+
+    long	dirs;
+    long	files;
+    long	links;
+    KFileSize	bytes;
+};
+
+
+// Our own random numbers: The same seed has to give the same tree on any
+// platform, no matter what rand() does there.
+
+static unsigned long randomState = 42;
+
+
+/**
+ * Returns a pseudo random number from 0 to 'limit' - 1.
+ **/
+static int
+nextRandom( int limit )
+{
+    randomState = ( randomState * 1103515245 + 12345 ) & 0x7fffffff;
+
+    return limit > 0 ? (int) ( ( randomState >> 8 ) % limit ) : 0;
+}
+
+
+/**
+ * Returns a name that is unique in its directory for 'serial' and at least
+ * 'length' characters long.
+ **/
+static QString
+uniqueName( int serial, int length )
+{
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789_";
+
+    QString name = QString::number( serial, 36 ) + "_";
+
+    while ( (int) name.length() < length )
+	name += chars[ nextRandom( sizeof( chars ) - 1 ) ];
+
+    return name;
+}
+
+
+/**
+ * Returns the peak resident set size of this process so far in kB.
+ **/
+static long
+peakRss()
+{
+    struct rusage usage;
+
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+	return 0;
+
+    return usage.ru_maxrss;		// kB on Linux
+}
+
+
+/**
+ * Print the result of one phase.
+ **/
+static void
+report( int run, const char * phase, long long usec, long items )
+{
+    printf( "%d\t%s\t%.1f\t%ld\t%ld\n", run, phase, usec / 1000.0, items, peakRss() );
+    fflush( stdout );
+}
+
+
+/**
+ * Create file 'path' with 'size' bytes. Returns 'false' upon error.
+ **/
+static bool
+createFile( const QString & path, int size )
+{
+    static char buffer[ 8192 ];	// Contents don't matter - zeroes will do
+
+    int fd = open( QFile::encodeName( path ), O_WRONLY | O_CREAT | O_EXCL, 0644 );
+
+    if ( fd < 0 )
+	return false;
+
+    while ( size > 0 )
+    {
+	int chunk = size < (int) sizeof( buffer ) ? size : (int) sizeof( buffer );
+
+	if ( write( fd, buffer, chunk ) != chunk )
+	{
+	    close( fd );
+	    return false;
+	}
+
+	size -= chunk;
+    }
+
+    return close( fd ) == 0;
+}
+
+
+/**
+ * Fill existing directory 'path' on level 'level' of a synthetic tree of
+ * shape 'shape' and add what was created to 'counts'. Returns 'false' upon
+ * error.
+ **/
+static bool
+generateDir( const QString & path, int level, const KBenchShape & shape, KBenchCounts & counts )
+{
+    int serial = 0;
+
+    for ( int i=0; i < shape.files; i++ )
+    {
+	QString file = path + "/" + uniqueName( serial++, shape.nameLength );
+	int	size = nextRandom( shape.maxFileSize + 1 );
+
+	if ( ! createFile( file, size ) )
+	{
+	    kdError() << "Can't create " << file << ": " << strerror( errno ) << endl;
+	    return false;
+	}
+
+	counts.files++;
+	counts.bytes += size;
+
+	if ( nextRandom( 100 ) < shape.hardLinks )
+	{
+	    QString link = path + "/" + uniqueName( serial++, shape.nameLength );
+
+	    if ( ::link( QFile::encodeName( file ), QFile::encodeName( link ) ) != 0 )
+	    {
+		kdError() << "Can't link " << link << ": " << strerror( errno ) << endl;
+		return false;
+	    }
+
+	    counts.links++;
+	}
+    }
+
+    if ( level >= shape.depth )
+	return true;
+
+    for ( int i=0; i < shape.fanOut; i++ )
+    {
+	QString dir = path + "/" + uniqueName( serial++, shape.nameLength );
+
+	if ( mkdir( QFile::encodeName( dir ), 0755 ) != 0 )
+	{
+	    kdError() << "Can't create " << dir << ": " << strerror( errno ) << endl;
+	    return false;
+	}
+
+	counts.dirs++;
+
+	if ( ! generateDir( dir, level + 1, shape, counts ) )
+	    return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Callback for nftw() to remove one entry.
+ **/
+static int
+removeEntry( const char * path, const struct stat *, int, struct FTW * )
+{
+    if ( remove( path ) != 0 )
+	kdError() << "Can't remove " << path << ": " << strerror( errno ) << endl;
+
+    return 0;	// Keep going
+}
+
+
+/**
+ * Recursively mark the summary fields of 'dir' and all directories below it
+ * as dirty. Returns the number of directories.
+ **/
+static long
+markSummaryDirty( KDirInfo * dir )
+{
+    long count = 1;
+
+    dir->markSummaryDirty();
+    KFileInfoIterator it( dir, KDotEntryAsSubDir );
+
+    while ( *it )
+    {
+	if ( (*it)->isDirInfo() )
+	    count += markSummaryDirty( (KDirInfo *) *it );
+
+	++it;
+    }
+
+    return count;
+}
+
+
+/**
+ * Recursively iterate over 'dir' in sort order 'sortOrder'. Returns the
+ * number of items.
+ **/
+static long
+iterateSorted( KFileInfo * dir, KFileInfoSortOrder sortOrder )
+{
+    long count = 0;
+    KFileInfoSortedIterator it( dir, KDotEntryTransparent, sortOrder );
+
+    while ( *it )
+    {
+	count++;
+
+	if ( (*it)->isDirInfo() )
+	    count += iterateSorted( *it, sortOrder );
+
+	++it;
+    }
+
+    return count;
+}
+
+
+
+
+/**
+ * Batch job that reports how long reading took, then times the phases that
+ * work on the tree in memory.
+ **/
+class KBenchJob: public KBatchJob
+{
+public:
+
+    /**
+     * Constructor. 'input' is a directory or a cache file, 'readPhase' the
+     * name to report reading it with. The tree is written to 'cacheFile' if
+     * that is not empty. If 'treemapSize' is invalid, only reading is timed.
+     **/
+    KBenchJob( const QString &	input,
+	       int		run,
+	       const char *	readPhase,
+	       const QString &	cacheFile	= QString::null,
+	       const QSize &	treemapSize	= QSize() );
+
+
+protected:
+
+    /**
+     * Time the phases on the tree that was just read.
+     *
+     * Reimplemented - inherited from @ref KBatchJob.
+     **/
+    virtual bool process( KDirTree * tree );
+
+
+    int			_run;
+    const char *	_readPhase;
+    QString		_cacheFile;
+    QSize		_treemapSize;
+};
+
+
+KBenchJob::KBenchJob( const QString &	input,
+		      int		run,
+		      const char *	readPhase,
+		      const QString &	cacheFile,
+		      const QSize &	treemapSize )
+    : KBatchJob( input )
+    , _run( run )
+    , _readPhase( readPhase )
+    , _cacheFile( cacheFile )
+    , _treemapSize( treemapSize )
+{
+}
+
+
+bool
+KBenchJob::process( KDirTree * tree )
+{
+    const KScanStats * stats = tree->scanStats();
+    report( _run, _readPhase, (long long) stats->elapsedMillisec() * 1000, stats->entries() );
+
+    if ( ! tree->root() || ! tree->root()->isDirInfo() )
+    {
+	kdError() << "Nothing read from " << input() << endl;
+	return false;
+    }
+
+    KDirInfo * root = (KDirInfo *) tree->root();
+    long long  start;
+
+    if ( ! _cacheFile.isEmpty() )
+    {
+	start = KScanStats::now();
+
+	if ( ! tree->writeCache( _cacheFile ) )
+	{
+	    kdError() << "Can't write " << _cacheFile << endl;
+	    return false;
+	}
+
+	report( _run, "cache-write", KScanStats::now() - start, root->totalItems() + 1 );
+    }
+
+    if ( ! _treemapSize.isValid() )
+	return true;
+
+
+    // Recalculating the sums of all directories
+
+    long dirs = markSummaryDirty( root );
+    start     = KScanStats::now();
+    root->recalc();
+    report( _run, "recalc", KScanStats::now() - start, dirs );
+
+
+    // Sorted iteration: First with empty sort caches, then once more with
+    // the sorted lists cached
+
+    long items;
+
+    start = KScanStats::now();
+    items = iterateSorted( root, KSortByName );
+    report( _run, "sort-name", KScanStats::now() - start, items );
+
+    start = KScanStats::now();
+    items = iterateSorted( root, KSortByTotalSize );
+    report( _run, "sort-size", KScanStats::now() - start, items );
+
+    start = KScanStats::now();
+    items = iterateSorted( root, KSortByLatestMtime );
+    report( _run, "sort-mtime", KScanStats::now() - start, items );
+
+    start = KScanStats::now();
+    items = iterateSorted( root, KSortByTotalSize );
+    report( _run, "sort-size-cached", KScanStats::now() - start, items );
+
+
+    // Treemap layout including the cushions
+
+    KTreemapLayout layout;
+    layout.setMaxTiles( 0 );
+
+    start = KScanStats::now();
+    layout.layout( root, QRect( QPoint( 0, 0 ), _treemapSize ) );
+    report( _run, "treemap-layout", KScanStats::now() - start, layout.count() );
+
+    return true;
+}
+
+
+
+
+/**
+ * Returns the numeric value of option 'name' in 'result' or 'false' if it
+ * is not a number of at least 'min'.
+ **/
+static bool
+intOption( KCmdLineArgs * args, const char * name, int min, int & result )
+{
+    bool ok;
+    result = QString( args->getOption( name ) ).toInt( &ok );
+
+    if ( ! ok || result < min )
+    {
+	kdError() << "Invalid number for --" << name << ": " << args->getOption( name ) << endl;
+	return false;
+    }
+
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    KAboutData aboutData( "kdirstat-bench", "KDirStat Benchmark",
+			  VERSION, description, KAboutData::License_GPL,
+			  "(c) 1999-2008 Stefan Hundhammer", 0, 0,
+			  "sh@suse.de" );
+
+    KCmdLineArgs::init( argc, argv, &aboutData );
+    KCmdLineArgs::addCmdLineOptions( options );
+
+    // Reading, the cache file and the treemap layout use the settings of
+    // this program, not those of kdirstat - i.e. always the defaults.
+
+    KApplication   app( false, false );	// No styles, no GUI
+    KCmdLineArgs * args = KCmdLineArgs::parsedArgs();
+    KBenchShape	   shape;
+    int		   seed;
+    int		   runs;
+
+    if ( ! intOption( args, "fan-out",		0, shape.fanOut		) ||
+	 ! intOption( args, "depth",		0, shape.depth		) ||
+	 ! intOption( args, "files",		0, shape.files		) ||
+	 ! intOption( args, "name-length",	1, shape.nameLength	) ||
+	 ! intOption( args, "hard-links",	0, shape.hardLinks	) ||
+	 ! intOption( args, "max-file-size",	0, shape.maxFileSize	) ||
+	 ! intOption( args, "seed",		0, seed			) ||
+	 ! intOption( args, "runs",		1, runs			)   )
+    {
+	return 1;
+    }
+
+    QString sizeArg = args->getOption( "size" );
+    QSize   treemapSize( sizeArg.section( 'x', 0, 0 ).toInt(),
+			 sizeArg.section( 'x', 1, 1 ).toInt() );
+
+    if ( treemapSize.width() < 1 || treemapSize.height() < 1 )
+    {
+	kdError() << "Invalid treemap size \"" << sizeArg << "\" - use WIDTHxHEIGHT" << endl;
+	return 1;
+    }
+
+    QCString workDirTemplate = QFile::encodeName( QFile::decodeName( args->getOption( "work-dir" ) )
+						  + "/kdirstat-bench.XXXXXX" );
+
+    if ( ! mkdtemp( workDirTemplate.data() ) )
+    {
+	kdError() << "Can't create a directory in " << args->getOption( "work-dir" )
+		  << ": " << strerror( errno ) << endl;
+	return 1;
+    }
+
+    QString workDir   = QFile::decodeName( workDirTemplate );
+    QString cacheFile = workDir + "/tree.cache.gz";
+    QString input;
+    bool    keep      = args->isSet( "keep" );
+    bool    ok	      = true;
+
+    printf( "# run\tphase\tms\titems\tpeak_rss_kB\n" );
+
+    if ( args->count() > 0 )
+    {
+	input = QFile::decodeName( args->arg( 0 ) );
+    }
+    else
+    {
+	printf( "# fan-out %d, depth %d, files %d, name length %d, hard links %d%%, max file size %d, seed %d\n",
+		shape.fanOut, shape.depth, shape.files, shape.nameLength,
+		shape.hardLinks, shape.maxFileSize, seed );
+
+	input = workDir + "/tree";
+	randomState = seed;
+
+	KBenchCounts counts;
+	long long    start = KScanStats::now();
+
+	ok = mkdir( QFile::encodeName( input ), 0755 ) == 0;
+
+	if ( ! ok )
+	    kdError() << "Can't create " << input << ": " << strerror( errno ) << endl;
+	else
+	    ok = generateDir( input, 0, shape, counts );
+
+	if ( ok )
+	{
+	    report( 0, "generate", KScanStats::now() - start, counts.dirs + counts.files + counts.links );
+	    printf( "# %ld dirs, %ld files, %ld hard links, %lld bytes\n",
+		    counts.dirs + 1, counts.files, counts.links, counts.bytes );
+	}
+    }
+
+    args->clear();
+
+    for ( int run=1; run <= runs && ok; run++ )
+    {
+	KBenchJob scanJob( input, run, "scan", cacheFile, treemapSize );
+	scanJob.start();
+	app.exec();
+	ok = scanJob.ok();
+
+	if ( ok )
+	{
+	    KBenchJob cacheJob( cacheFile, run, "cache-read" );
+	    cacheJob.start();
+	    app.exec();
+	    ok = cacheJob.ok();
+	}
+    }
+
+    if ( keep )
+	printf( "# kept %s\n", (const char *) QFile::encodeName( workDir ) );
+    else
+	nftw( workDirTemplate, removeEntry, 32, FTW_DEPTH | FTW_PHYS );
+
+    return ok ? 0 : 1;
+}
+
+
+
+// EOF
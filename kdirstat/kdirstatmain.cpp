@@ -14,11 +14,19 @@
 #   include <config.h>
 #endif
 
+#include <qfile.h>
 #include <kcmdlineargs.h>
 #include <kaboutdata.h>
+#include <kdebug.h>
 #include <klocale.h>
 
 #include "kdirstatapp.h"
+#include "ktreemapexport.h"
+#include "ktopnquery.h"
+#include "kfiletypestats.h"
+#include "kownerstats.h"
+#include "kduplicates.h"
+#include "kscanstats.h"
 
 
 static const char *description =
@@ -39,9 +47,219 @@ static const char *description =
 static KCmdLineOptions options[] =
 {
     { "+[Dir/URL]", I18N_NOOP("Directory or URL to open"), 0 },
+    { "export-treemap <file>", I18N_NOOP("Export a treemap of Dir/URL or of a cache file\n"
+					 "to PNG file <file> and exit"), 0 },
+    { "size <WxH>", I18N_NOOP("Size of the exported treemap"), "1600x1200" },
+    { "top <N>", I18N_NOOP("Print the <N> largest items of Dir/URL or of a cache file\n"
+			   "to stdout and exit"), 0 },
+    { "top-type <type>", I18N_NOOP("What to print with --top: files, dirs or types"), "files" },
+    { "file-types", I18N_NOOP("Print the sizes per file type of Dir/URL or of a cache file\n"
+			      "to stdout and exit"), 0 },
+    { "owners", I18N_NOOP("Print the disk usage per user and group of Dir/URL or of a\n"
+			  "cache file to stdout and exit"), 0 },
+    { "duplicates", I18N_NOOP("Print all files with identical contents in Dir/URL\n"
+			      "to stdout and exit"), 0 },
+    { "min-size <bytes>", I18N_NOOP("Ignore smaller files with --duplicates"), "1" },
+    { "scan-stats <file>", I18N_NOOP("Write the scan statistics of any of the above to <file>\n"
+				     "in JSON format (\"-\" for stderr); alone, only read\n"
+				     "Dir/URL or a cache file and exit"), 0 },
     { 0, 0, 0 }
 };
 
+
+/**
+ * Export a treemap without any GUI and return the exit code.
+ **/
+static int
+exportTreemap( KCmdLineArgs * args )
+{
+    KApplication app( false, false );	// No styles, no GUI
+
+    if ( args->count() < 1 )
+    {
+	kdError() << "--export-treemap needs a directory or a cache file" << endl;
+	return 1;
+    }
+
+    QString sizeArg = args->getOption( "size" );
+    QSize   size( sizeArg.section( 'x', 0, 0 ).toInt(),
+		  sizeArg.section( 'x', 1, 1 ).toInt() );
+
+    if ( size.width() < 1 || size.height() < 1 )
+    {
+	kdError() << "Invalid treemap size \"" << sizeArg << "\" - use WIDTHxHEIGHT" << endl;
+	return 1;
+    }
+
+    KTreemapExportJob job( QFile::decodeName( args->arg( 0 ) ),
+			   QFile::decodeName( args->getOption( "export-treemap" ) ),
+			   size );
+    job.setScanStatsFile( QFile::decodeName( args->getOption( "scan-stats" ) ) );
+    args->clear();
+
+    job.start();
+    app.exec();
+
+    return job.ok() ? 0 : 1;
+}
+
+
+/**
+ * Print the largest items without any GUI and return the exit code.
+ **/
+static int
+printTopN( KCmdLineArgs * args )
+{
+    KApplication app( false, false );	// No styles, no GUI
+
+    if ( args->count() < 1 )
+    {
+	kdError() << "--top needs a directory or a cache file" << endl;
+	return 1;
+    }
+
+    int n = QString( args->getOption( "top" ) ).toInt();
+
+    if ( n < 1 )
+    {
+	kdError() << "Invalid number for --top: " << args->getOption( "top" ) << endl;
+	return 1;
+    }
+
+    QString   typeArg = args->getOption( "top-type" );
+    KTopNType type;
+
+    if	    ( typeArg == "files" )	type = KTopNFiles;
+    else if ( typeArg == "dirs"  )	type = KTopNDirs;
+    else if ( typeArg == "types" )	type = KTopNFileTypes;
+    else
+    {
+	kdError() << "Invalid --top-type \"" << typeArg << "\" - use files, dirs or types" << endl;
+	return 1;
+    }
+
+    KTopNJob job( QFile::decodeName( args->arg( 0 ) ), type, n );
+    job.setScanStatsFile( QFile::decodeName( args->getOption( "scan-stats" ) ) );
+    args->clear();
+
+    job.start();
+    app.exec();
+
+    return job.ok() ? 0 : 1;
+}
+
+
+/**
+ * Print the file type statistics without any GUI and return the exit code.
+ **/
+static int
+printFileTypeStats( KCmdLineArgs * args )
+{
+    KApplication app( false, false );	// No styles, no GUI
+
+    if ( args->count() < 1 )
+    {
+	kdError() << "--file-types needs a directory or a cache file" << endl;
+	return 1;
+    }
+
+    KFileTypeStatsJob job( QFile::decodeName( args->arg( 0 ) ) );
+    job.setScanStatsFile( QFile::decodeName( args->getOption( "scan-stats" ) ) );
+    args->clear();
+
+    job.start();
+    app.exec();
+
+    return job.ok() ? 0 : 1;
+}
+
+
+/**
+ * Print the disk usage per user and group without any GUI and return the
+ * exit code.
+ **/
+static int
+printOwnerStats( KCmdLineArgs * args )
+{
+    KApplication app( false, false );	// No styles, no GUI
+
+    if ( args->count() < 1 )
+    {
+	kdError() << "--owners needs a directory or a cache file" << endl;
+	return 1;
+    }
+
+    KOwnerStatsJob job( QFile::decodeName( args->arg( 0 ) ) );
+    job.setScanStatsFile( QFile::decodeName( args->getOption( "scan-stats" ) ) );
+    args->clear();
+
+    job.start();
+    app.exec();
+
+    return job.ok() ? 0 : 1;
+}
+
+
+/**
+ * Print the duplicate files without any GUI and return the exit code.
+ **/
+static int
+printDuplicates( KCmdLineArgs * args )
+{
+    KApplication app( false, false );	// No styles, no GUI
+
+    if ( args->count() < 1 )
+    {
+	kdError() << "--duplicates needs a directory or a cache file" << endl;
+	return 1;
+    }
+
+    bool ok;
+    KFileSize minSize = QString( args->getOption( "min-size" ) ).toLongLong( &ok );
+
+    if ( ! ok || minSize < 0 )
+    {
+	kdError() << "Invalid number for --min-size: " << args->getOption( "min-size" ) << endl;
+	return 1;
+    }
+
+    KDuplicatesJob job( QFile::decodeName( args->arg( 0 ) ), minSize );
+    job.setScanStatsFile( QFile::decodeName( args->getOption( "scan-stats" ) ) );
+    args->clear();
+
+    job.start();
+    app.exec();
+
+    return job.ok() ? 0 : 1;
+}
+
+
+/**
+ * Only read a directory or cache file without any GUI, write the scan
+ * statistics and return the exit code.
+ **/
+static int
+writeScanStats( KCmdLineArgs * args )
+{
+    KApplication app( false, false );	// No styles, no GUI
+
+    if ( args->count() < 1 )
+    {
+	kdError() << "--scan-stats needs a directory or a cache file" << endl;
+	return 1;
+    }
+
+    KScanStatsJob job( QFile::decodeName( args->arg( 0 ) ) );
+    job.setScanStatsFile( QFile::decodeName( args->getOption( "scan-stats" ) ) );
+    args->clear();
+
+    job.start();
+    app.exec();
+
+    return job.ok() ? 0 : 1;
+}
+
+
 int main(int argc, char *argv[])
 {
     KAboutData aboutData( "kdirstat", "KDirStat",
@@ -80,6 +298,24 @@ int main(int argc, char *argv[])
     KCmdLineArgs::init( argc, argv, &aboutData );
     KCmdLineArgs::addCmdLineOptions( options ); // Add our own options.
 
+    if ( KCmdLineArgs::parsedArgs()->isSet( "export-treemap" ) )
+	return exportTreemap( KCmdLineArgs::parsedArgs() );
+
+    if ( KCmdLineArgs::parsedArgs()->isSet( "top" ) )
+	return printTopN( KCmdLineArgs::parsedArgs() );
+
+    if ( KCmdLineArgs::parsedArgs()->isSet( "file-types" ) )
+	return printFileTypeStats( KCmdLineArgs::parsedArgs() );
+
+    if ( KCmdLineArgs::parsedArgs()->isSet( "owners" ) )
+	return printOwnerStats( KCmdLineArgs::parsedArgs() );
+
+    if ( KCmdLineArgs::parsedArgs()->isSet( "duplicates" ) )
+	return printDuplicates( KCmdLineArgs::parsedArgs() );
+
+    if ( KCmdLineArgs::parsedArgs()->isSet( "scan-stats" ) )
+	return writeScanStats( KCmdLineArgs::parsedArgs() );
+
     KApplication app;
 
     
@@ -728,6 +728,8 @@ KGeneralSettingsPage::KGeneralSettingsPage( KSettingsDialog *	dialog,
 
     _crossFileSystems		= new QCheckBox( i18n( "Cross &File System Boundaries" ), gbox );
     _enableLocalDirReader	= new QCheckBox( i18n( "Use Optimized &Local Directory Read Methods" ), gbox );
+    _countHardLinksOnce		= new QCheckBox( i18n( "Count &Hard Links Only Once" ), gbox );
+    _ageByAccessTime		= new QCheckBox( i18n( "Determine File Age by Last &Access Time" ), gbox );
 
     connect( _enableLocalDirReader,	SIGNAL( stateChanged( int ) ),
 	     this,			SLOT  ( checkEnabledState() ) );
@@ -745,11 +747,13 @@ KGeneralSettingsPage::KGeneralSettingsPage( KSettingsDialog *	dialog,
     layout->addWidget( excludeBox );
     
     _excludeRulesListView	= new QListView( excludeBox );
-    _excludeRulesListView->addColumn( i18n( "Exclude Rule (Regular Expression)" ), 300 );
+    _excludeRulesListView->addColumn( i18n( "Exclude Rule" ), 300 );
+    _excludeRulesListView->addColumn( i18n( "Matches" ) );
     _excludeRuleContextMenu	= 0;
 
     QGroupBox * buttonBox	= new QHGroupBox( excludeBox );
     _addExcludeRuleButton	= new QPushButton( i18n( "&Add"    ), buttonBox );
+    _addExcludeNameButton	= new QPushButton( i18n( "Add &Name" ), buttonBox );
     _editExcludeRuleButton	= new QPushButton( i18n( "&Edit"   ), buttonBox );
     _deleteExcludeRuleButton	= new QPushButton( i18n( "&Delete" ), buttonBox );
     
@@ -759,6 +763,9 @@ KGeneralSettingsPage::KGeneralSettingsPage( KSettingsDialog *	dialog,
     connect( _addExcludeRuleButton,	SIGNAL( clicked()        ),
 	     this,			SLOT  ( addExcludeRule() ) );
     
+    connect( _addExcludeNameButton,	SIGNAL( clicked()        ),
+	     this,			SLOT  ( addExcludeName() ) );
+    
     connect( _editExcludeRuleButton,	SIGNAL( clicked()         ),
 	     this,			SLOT  ( editExcludeRule() ) );
     
@@ -803,6 +810,8 @@ KGeneralSettingsPage::apply()
     config->setGroup( "Directory Reading" );
     config->writeEntry( "CrossFileSystems",	_crossFileSystems->isChecked()		);
     config->writeEntry( "EnableLocalDirReader", _enableLocalDirReader->isChecked()	);
+    config->writeEntry( "CountHardLinksOnce",	_countHardLinksOnce->isChecked()	);
+    config->writeEntry( "AgeByAccessTime",	_ageByAccessTime->isChecked()		);
 
     config->setGroup( "Animation" );
     config->writeEntry( "ToolbarPacMan",	_enableToolBarAnimation->isChecked()	);
@@ -814,19 +823,31 @@ KGeneralSettingsPage::apply()
     config->setGroup( "Exclude" );
     
     QStringList excludeRulesStringList;
+    QStringList excludeNamesStringList;
     KExcludeRules::excludeRules()->clear();
     QListViewItem * item = _excludeRulesListView->firstChild();
     
     while ( item )
     {
 	QString ruleText = item->text(0);
-	excludeRulesStringList.append( ruleText );
 	// kdDebug() << "Adding exclude rule " << ruleText << endl;
-	KExcludeRules::excludeRules()->add( new KExcludeRule( QRegExp( ruleText ) ) );
+
+	if ( isExcludeName( item ) )
+	{
+	    excludeNamesStringList.append( ruleText );
+	    KExcludeRules::excludeRules()->add( new KExcludeRule( QRegExp( ruleText, true, true ), true ) );
+	}
+	else
+	{
+	    excludeRulesStringList.append( ruleText );
+	    KExcludeRules::excludeRules()->add( new KExcludeRule( QRegExp( ruleText ) ) );
+	}
+
 	item = item->nextSibling();
     }
 
     config->writeEntry( "ExcludeRules", excludeRulesStringList );
+    config->writeEntry( "ExcludeNames", excludeNamesStringList );
 }
 
 
@@ -835,6 +856,8 @@ KGeneralSettingsPage::revertToDefaults()
 {
     _crossFileSystems->setChecked( false );
     _enableLocalDirReader->setChecked( true );
+    _countHardLinksOnce->setChecked( false );
+    _ageByAccessTime->setChecked( false );
 
     _enableToolBarAnimation->setChecked( true );
     _enableTreeViewAnimation->setChecked( false );
@@ -853,6 +876,8 @@ KGeneralSettingsPage::setup()
 
     _crossFileSystems->setChecked	( config->readBoolEntry( "CrossFileSystems"	, false) );
     _enableLocalDirReader->setChecked	( config->readBoolEntry( "EnableLocalDirReader" , true ) );
+    _countHardLinksOnce->setChecked	( config->readBoolEntry( "CountHardLinksOnce"	, false) );
+    _ageByAccessTime->setChecked	( config->readBoolEntry( "AgeByAccessTime"	, false) );
 
     _enableToolBarAnimation->setChecked ( _mainWin->pacManEnabled() );
     _enableTreeViewAnimation->setChecked( _treeView->doPacManAnimation() );
@@ -863,7 +888,9 @@ KGeneralSettingsPage::setup()
     while ( excludeRule )
     {
 	// _excludeRulesListView->insertItem();
-	new QListViewItem( _excludeRulesListView, excludeRule->regexp().pattern() );
+	new KExcludeRuleListItem( _excludeRulesListView,
+				  excludeRule->regexp().pattern(),
+				  excludeRule->byName() );
 	excludeRule = KExcludeRules::excludeRules()->next();
     }
     
@@ -875,6 +902,7 @@ void
 KGeneralSettingsPage::checkEnabledState()
 {
     _crossFileSystems->setEnabled( _enableLocalDirReader->isChecked() );
+    _countHardLinksOnce->setEnabled( _enableLocalDirReader->isChecked() );
 
     int excludeRulesCount = _excludeRulesListView->childCount();
     
@@ -895,14 +923,42 @@ KGeneralSettingsPage::addExcludeRule()
 					  this );
     if ( ok && ! text.isEmpty() )
     {
-	_excludeRulesListView->insertItem( new QListViewItem ( _excludeRulesListView, text ) );
-	
+	new KExcludeRuleListItem( _excludeRulesListView, text, false );
     }
     
     checkEnabledState();
 }
 
 
+void
+KGeneralSettingsPage::addExcludeName()
+{
+    bool ok;
+    QString text = QInputDialog::getText( i18n( "New exclude rule" ),
+					  i18n( "Exclude all directories with this name\n"
+						"(wildcards like \"*.snapshot\" are allowed):" ),
+					  QLineEdit::Normal,
+					  QString::null,
+					  &ok,
+					  this );
+    if ( ok && ! text.isEmpty() )
+    {
+	new KExcludeRuleListItem( _excludeRulesListView, text, true );
+    }
+
+    checkEnabledState();
+}
+
+
+bool
+KGeneralSettingsPage::isExcludeName( QListViewItem * item )
+{
+    // All items in the exclude rules list are KExcludeRuleListItems
+
+    return ( (KExcludeRuleListItem *) item )->byName();
+}
+
+
 void
 KGeneralSettingsPage::editExcludeRule()
 {
@@ -912,6 +968,8 @@ KGeneralSettingsPage::editExcludeRule()
     {
 	bool ok;
 	QString text = QInputDialog::getText( i18n( "Edit exclude rule" ),
+					      isExcludeName( item ) ?
+					      i18n( "Directory name (wildcards allowed):" ) :
 					      i18n( "Exclude rule (regular expression):" ),
 					      QLineEdit::Normal,
 					      item->text(0),
@@ -954,6 +1012,28 @@ KGeneralSettingsPage::deleteExcludeRule()
 /*--------------------------------------------------------------------------*/
 
 
+KExcludeRuleListItem::KExcludeRuleListItem( QListView *		listView,
+					    const QString &	pattern,
+					    bool		byName )
+    : QListViewItem( listView, pattern, typeText( byName ) )
+    , _byName( byName )
+{
+    // NOP
+}
+
+
+QString
+KExcludeRuleListItem::typeText( bool byName )
+{
+    return byName ?
+	i18n( "Directory Name (Wildcards)" ) :
+	i18n( "Full Path (Regular Expression)" );
+}
+
+
+/*--------------------------------------------------------------------------*/
+
+
 KTreemapPage::KTreemapPage( KSettingsDialog *	dialog,
 					    QWidget *		parent,
 					    KDirStatApp *	mainWin )
@@ -1059,6 +1139,7 @@ KTreemapPage::KTreemapPage( KSettingsDialog *	dialog,
     grid->addWidget( _minTileSize,	1, 1 );
 
     _autoResize		= new QCheckBox( i18n( "Auto-&Resize Treemap" ), vbox );
+    _progressive	= new QCheckBox( i18n( "Upda&te Treemap While Reading" ), vbox );
 
 
 
@@ -1106,6 +1187,7 @@ KTreemapPage::apply()
     config->writeEntry( "ForceCushionGrid",	_forceCushionGrid->isChecked()		);
     config->writeEntry( "MinTileSize",		_minTileSize->value()			);
     config->writeEntry( "AutoResize",		_autoResize->isChecked()		);
+    config->writeEntry( "ProgressiveTreemap",	_progressive->isChecked()		);
     config->writeEntry( "CushionGridColor",	_cushionGridColor->color()		);
     config->writeEntry( "OutlineColor",		_outlineColor->color()			);
     config->writeEntry( "FileFillColor",	_fileFillColor->color()			);
@@ -1132,6 +1214,7 @@ KTreemapPage::revertToDefaults()
     _forceCushionGrid->setChecked( false );
     _minTileSize->setValue( DefaultMinTileSize );
     _autoResize->setChecked( true );
+    _progressive->setChecked( true );
 
     _cushionGridColor->setColor ( QColor( 0x80, 0x80, 0x80 ) );
     _outlineColor->setColor	( black			     );
@@ -1156,6 +1239,7 @@ KTreemapPage::setup()
     _forceCushionGrid->setChecked	( config->readBoolEntry( "ForceCushionGrid"	, false ) );
     _minTileSize->setValue		( config->readNumEntry ( "MinTileSize"		, DefaultMinTileSize ) );
     _autoResize->setChecked		( config->readBoolEntry( "AutoResize"		, true	) );
+    _progressive->setChecked		( config->readBoolEntry( "ProgressiveTreemap"	, true	) );
 
     _cushionGridColor->setColor ( readColorEntry( config, "CushionGridColor"	, QColor( 0x80, 0x80, 0x80 ) ) );
     _outlineColor->setColor	( readColorEntry( config, "OutlineColor"	, black			     ) );
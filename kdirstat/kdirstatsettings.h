@@ -17,6 +17,7 @@
 #endif
 
 #include <qlistbox.h>
+#include <qlistview.h>
 #include <kdialogbase.h>
 #include "kcleanup.h"
 #include "kcleanupcollection.h"
@@ -561,6 +562,45 @@ namespace KDirStat
 
 
 
+    /**
+     * List view item for one exclude rule in a KGeneralSettingsPage.
+     **/
+    class KExcludeRuleListItem: public QListViewItem
+    {
+    public:
+
+	/**
+	 * Constructor. 'byName' tells whether 'pattern' is matched against
+	 * directory names (with wildcards) or against full paths (as a
+	 * regular expression).
+	 **/
+	KExcludeRuleListItem( QListView *	listView,
+			      const QString &	pattern,
+			      bool		byName );
+
+	/**
+	 * Returns 'true' if this is a rule for directory names.
+	 **/
+	bool byName() const { return _byName; }
+
+
+    protected:
+
+	/**
+	 * Returns the text for the "Matches" column for name rules (if
+	 * 'byName' is true) or full path rules.
+	 **/
+	static QString typeText( bool byName );
+
+
+	// Data members
+
+	bool _byName;
+
+    }; // class KExcludeRuleListItem
+
+
+
     /**
      * Settings tab page for general/misc settings.
      **/
@@ -620,6 +660,11 @@ namespace KDirStat
 	 **/
 	void addExcludeRule();
 
+	/**
+	 * Add a new exclude rule that matches directory names only.
+	 **/
+	void addExcludeName();
+
 	/**
 	 * Edit the currently selected exclude rule.
 	 **/
@@ -637,12 +682,19 @@ namespace KDirStat
 
     protected:
 
+	/**
+	 * Returns 'true' if exclude rules list item 'item' is a name rule.
+	 **/
+	static bool isExcludeName( QListViewItem * item );
+
 	// Data members
 
 	KDirStatApp *	_mainWin;
 	KDirTreeView *	_treeView;
 
 	QCheckBox *	_crossFileSystems;
+	QCheckBox *	_countHardLinksOnce;
+	QCheckBox *	_ageByAccessTime;
 	QCheckBox *	_enableLocalDirReader;
 
 	QCheckBox *	_enableToolBarAnimation;
@@ -650,6 +702,7 @@ namespace KDirStat
 
 	QListView *	_excludeRulesListView;
 	QPushButton * 	_addExcludeRuleButton;
+	QPushButton * 	_addExcludeNameButton;
 	QPushButton *	_editExcludeRuleButton;
 	QPushButton *	_deleteExcludeRuleButton;
 	QPopupMenu *	_excludeRuleContextMenu;
@@ -750,6 +803,7 @@ namespace KDirStat
 	KColorButton *		_highlightColor;
 	QSpinBox *		_minTileSize;
 	QCheckBox *		_autoResize;
+	QCheckBox *		_progressive;
 	
     }; // class KTreemapPage
 
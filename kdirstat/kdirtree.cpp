@@ -12,11 +12,14 @@
 #   include <config.h>
 #endif
 
+#include <time.h>
 #include <kapp.h>
 #include <kconfig.h>
+#include <qptrdict.h>
 #include "kdirtree.h"
 #include "kdirreadjob.h"
 #include "kdirtreecache.h"
+#include "kdirwatcher.h"
 
 using namespace KDirStat;
 
@@ -24,26 +27,49 @@ using namespace KDirStat;
 
 KDirTree::KDirTree()
     : QObject()
+    , _deleteJob( this )
 {
     _root		= 0;
     _selection		= 0;
     _isFileProtocol	= false;
     _isBusy		= false;
     _readMethod		= KDirReadUnknown;
+    _referenceTime	= time( 0 );
+    _fileFilter		= 0;
+    _watcher		= 0;
+    _updateLevel	= 0;
+    _updateChanged	= false;
 
     readConfig();
 
     connect( & _jobQueue, SIGNAL( finished()     ),
 	     this,        SLOT  ( slotFinished() ) );
+
+    connect( & _recalc,   SIGNAL( finished()       ),
+	     this,        SIGNAL( recalcFinished() ) );
+
+    connect( & _filterTotals, SIGNAL( finished()       ),
+	     this,            SIGNAL( filterFinished() ) );
+
+    connect( & _refreshTimer, SIGNAL( timeout()		    ),
+	     this,            SLOT  ( startPendingRefresh() ) );
 }
 
 
 KDirTree::~KDirTree()
 {
+    if ( _watcher )
+	delete _watcher;
+
+    _recalc.abort();
+    _filterTotals.abort();
     selectItem( 0 );
 
     if ( _root )
 	delete _root;
+
+    if ( _fileFilter )
+	delete _fileFilter;
 }
 
 
@@ -55,17 +81,29 @@ KDirTree::readConfig()
 
     _crossFileSystems		= config->readBoolEntry( "CrossFileSystems",     false );
     _enableLocalDirReader	= config->readBoolEntry( "EnableLocalDirReader", true  );
+    _countHardLinksOnce		= config->readBoolEntry( "CountHardLinksOnce",   false );
+    _ageByAccessTime		= config->readBoolEntry( "AgeByAccessTime",      false );
+    _watchForChanges		= config->readBoolEntry( "WatchForChanges",      false );
 }
 
 
 void
 KDirTree::setRoot( KFileInfo *newRoot )
 {
+    _recalc.abort();
+    _filterTotals.abort();
+
+    if ( _watcher )
+	_watcher->clear();
+
     if ( _root )
     {
 	selectItem( 0 );
+	forgetSelected( _root );
+	forgetPendingRefresh( 0 );
 	emit deletingChild( _root );
 	delete _root;
+	_hardLinks.applyPromotions();	// Only to forget about them
 	emit childDeleted();
     }
 
@@ -77,10 +115,18 @@ void
 KDirTree::clear( bool sendSignals )
 {
     _jobQueue.clear();
+    _recalc.abort();
+    _filterTotals.abort();
+    _deleteJob.detach();	// Nobody tells it about the items deleted here
+
+    if ( _watcher )
+	_watcher->clear();
 
     if ( _root )
     {
 	selectItem( 0 );
+	forgetSelected( _root );
+	forgetPendingRefresh( 0 );
 
 	if ( sendSignals )
 	    emit deletingChild( _root );
@@ -92,6 +138,9 @@ KDirTree::clear( bool sendSignals )
 	    emit childDeleted();
     }
 
+    _ownerTable.clear();	// No more items that refer to it
+    _hardLinks.clear();
+    _referenceTime = time( 0 );	// New tree, new ages
     _isBusy = false;
 }
 
@@ -133,6 +182,8 @@ KDirTree::startReading( const KURL & url )
 	_root 		= KioDirReadJob::stat( cleanUrl, this );
     }
 
+    setWatchForChanges( _watchForChanges );
+
     if ( _root )
     {
 	childAddedNotify( _root );
@@ -174,25 +225,73 @@ KDirTree::refresh( KFileInfo *subtree )
     }
     else	// Refresh subtree
     {
-	// Save some values from the old subtree.
+	QPtrList<KFileInfo> subtrees;
+	subtrees.append( subtree );
+	refresh( subtrees );
+    }
+}
+
+
+void
+KDirTree::refresh( const QPtrList<KFileInfo> & subtrees )
+{
+    if ( ! _root || subtrees.isEmpty() )
+	return;
+
+    // Dot entries cannot be read on their own, so read their directories
+    // instead.
+
+    QPtrList<KFileInfo> wanted;
+    QPtrListIterator<KFileInfo> it( subtrees );
+
+    for ( ; *it; ++it )
+    {
+	KFileInfo * item = *it;
+
+	if ( item->isDotEntry() )
+	    item = item->parent();
+
+	if ( ! item || ! item->parent() )
+	{
+	    refresh( (KFileInfo *) 0 );		// Refresh all
+	    return;
+	}
+
+	wanted.append( item );
+    }
+
+    // Read each subtree only once, and nothing that is read along with one
+    // of its ancestors anyway.
+
+    QPtrList<KFileInfo> coalesced = outermostItems( wanted );
+
 
-	KURL url		= subtree->url();
-	KDirInfo * parent	= subtree->parent();
+    // Get rid of the old subtrees, saving what it takes to read them again.
 
+    QValueList<KURL>	urls;
+    QPtrList<KDirInfo>	parents;
+
+    _recalc.abort();
+    _filterTotals.abort();
+
+    for ( KFileInfo * subtree = coalesced.first(); subtree; subtree = coalesced.next() )
+    {
+	urls.append( subtree->url() );
+	parents.append( subtree->parent() );
 
 	// Select nothing if the current selection is to be deleted
 
 	if ( _selection && _selection->isInSubtree( subtree ) )
 	    selectItem( 0 );
 
+	forgetSelected( subtree );
+	forgetPendingRefresh( subtree );
+
 
 	// Clear any old "excluded" status
 
 	subtree->setExcluded( false );
 
-	
-	// Get rid of the old subtree.
-
 	emit deletingChild( subtree );
 
 	// kdDebug() << "Deleting subtree " << subtree << endl;
@@ -206,17 +305,26 @@ KDirTree::refresh( KFileInfo *subtree )
 	 *
 	 * I just found that out the hard way by several hours of debugging. ;-}
 	 **/
-	parent->deletingChild( subtree );
+	subtree->parent()->deletingChild( subtree );
 	delete subtree;
-	emit childDeleted();
+    }
 
-	_isBusy = true;
-	emit startingReading();
-	
-	// Create new subtree root.
+    _hardLinks.applyPromotions();
+    _recalc.start( _root );
+    emit childDeleted();
+
+    _isBusy = true;
+    emit startingReading();
 
-	subtree = ( _readMethod == KDirReadLocal ) ?
-	    KLocalDirReadJob::stat( url, this, parent ) : KioDirReadJob::stat( url, this, parent );
+
+    // Create the new subtree roots.
+
+    QValueList<KURL>::ConstIterator urlIt = urls.begin();
+
+    for ( KDirInfo * parent = parents.first(); parent; parent = parents.next(), ++urlIt )
+    {
+	KFileInfo * subtree = ( _readMethod == KDirReadLocal ) ?
+	    KLocalDirReadJob::stat( *urlIt, this, parent ) : KioDirReadJob::stat( *urlIt, this, parent );
 
 	// kdDebug() << "New subtree: " << subtree << endl;
 
@@ -238,13 +346,114 @@ KDirTree::refresh( KFileInfo *subtree )
 		else
 		    addJob( new KioDirReadJob( this, dir ) );
 	    }
-	    else
-	    {
-		_isBusy = false;
-		emit finished();
-	    }
 	}
     }
+
+    if ( _jobQueue.isEmpty() )		// Nothing to read in the background
+    {
+	_isBusy = false;
+	emit finished();
+    }
+}
+
+
+void
+KDirTree::scheduleRefresh( KFileInfo *subtree )
+{
+    if ( ! subtree )
+	subtree = _root;
+
+    if ( ! subtree )
+	return;
+
+    _pendingRefresh.replace( subtree, subtree );
+
+    if ( ! _refreshTimer.isActive() )
+	_refreshTimer.start( RefreshDelayMillisec, true );	// single shot
+
+    emit pendingRefreshChanged();
+}
+
+
+void
+KDirTree::startPendingRefresh()
+{
+    if ( _pendingRefresh.isEmpty() || _isBusy )	// slotFinished() comes back here
+	return;
+
+    QPtrList<KFileInfo> subtrees;
+    QPtrDictIterator<KFileInfo> it( _pendingRefresh );
+
+    for ( ; it.current(); ++it )
+	subtrees.append( it.current() );
+
+    _pendingRefresh.clear();
+    refresh( subtrees );
+}
+
+
+void
+KDirTree::forgetPendingRefresh( KFileInfo * subtree )
+{
+    if ( _pendingRefresh.isEmpty() )
+	return;
+
+    if ( ! subtree )
+    {
+	_pendingRefresh.clear();
+    }
+    else
+    {
+	QPtrList<KFileInfo> forget;
+	QPtrDictIterator<KFileInfo> it( _pendingRefresh );
+
+	for ( ; it.current(); ++it )
+	{
+	    if ( it.current()->isInSubtree( subtree ) )
+		forget.append( it.current() );
+	}
+
+	if ( forget.isEmpty() )
+	    return;
+
+	for ( KFileInfo * item = forget.first(); item; item = forget.next() )
+	    _pendingRefresh.remove( item );
+    }
+
+    if ( _pendingRefresh.isEmpty() )
+	_refreshTimer.stop();
+
+    emit pendingRefreshChanged();
+}
+
+
+QPtrList<KFileInfo>
+KDirTree::outermostItems( const QPtrList<KFileInfo> & items )
+{
+    QPtrDict<KFileInfo> all( 2 * items.count() + 1 );
+    QPtrListIterator<KFileInfo> it( items );
+
+    for ( ; *it; ++it )
+	all.replace( *it, *it );
+
+    QPtrDict<KFileInfo> taken( 2 * items.count() + 1 );
+    QPtrList<KFileInfo> outermost;
+
+    for ( it.toFirst(); *it; ++it )
+    {
+	KFileInfo * ancestor = (*it)->parent();
+
+	while ( ancestor && ! all.find( ancestor ) )
+	    ancestor = ancestor->parent();
+
+	if ( ! ancestor && ! taken.find( *it ) )	// Take each one only once
+	{
+	    taken.insert( *it, *it );
+	    outermost.append( *it );
+	}
+    }
+
+    return outermost;
 }
 
 
@@ -255,8 +464,10 @@ KDirTree::abortReading()
 	return;
 
     _jobQueue.abort();
+    _scanStats.stop();
 
     _isBusy = false;
+    updateFilterTotals();
     emit aborted();
 }
 
@@ -264,14 +475,126 @@ KDirTree::abortReading()
 void
 KDirTree::slotFinished()
 {
+    _scanStats.stop();
     _isBusy = false;
+    updateFilterTotals();
     emit finished();
+
+    if ( ! _pendingRefresh.isEmpty() && ! _refreshTimer.isActive() )
+	_refreshTimer.start( RefreshDelayMillisec, true );	// single shot
+}
+
+
+void
+KDirTree::setFileFilter( KFileFilter * filter )
+{
+    _filterTotals.abort();
+
+    if ( _fileFilter )
+	delete _fileFilter;
+
+    _fileFilter = 0;
+
+    if ( filter && filter->isActive() )
+	_fileFilter = filter;
+    else if ( filter )
+	delete filter;
+
+    updateFilterTotals();
+
+    if ( ! _filterTotals.isActive() )	// Done right away (or no filter at all)
+	emit filterFinished();
+}
+
+
+void
+KDirTree::setWatchForChanges( bool watch )
+{
+    _watchForChanges = watch;
+
+    if ( ! watch || _readMethod != KDirReadLocal )
+    {
+	if ( _watcher )
+	{
+	    delete _watcher;
+	    _watcher = 0;
+	}
+
+	return;
+    }
+
+    if ( _watcher )
+	return;
+
+    _watcher = new KDirWatcher( this );
+    CHECK_PTR( _watcher );
+
+    if ( ! _watcher->ok() )
+    {
+	delete _watcher;
+	_watcher = 0;
+	return;
+    }
+
+    // Everything that is read later is watched automatically.
+
+    _watcher->watchSubtree( _root );
+}
+
+
+void
+KDirTree::readSubtree( KDirInfo * dir )
+{
+    if ( ! _isBusy )
+    {
+	_isBusy = true;
+	emit startingReading();
+    }
+
+    if ( _readMethod == KDirReadLocal )
+	addJob( new KLocalDirReadJob( this, dir ) );
+    else
+	addJob( new KioDirReadJob( this, dir ) );
+}
+
+
+void
+KDirTree::beginUpdate()
+{
+    _updateLevel++;
+}
+
+
+void
+KDirTree::endUpdate()
+{
+    if ( _updateLevel == 0 || --_updateLevel > 0 )
+	return;
+
+    if ( _updateChanged )
+    {
+	_updateChanged = false;
+	_recalc.start( _root );
+	updateFilterTotals();
+	emit childDeleted();
+    }
+}
+
+
+void
+KDirTree::updateFilterTotals()
+{
+    if ( _fileFilter && _root )
+	_filterTotals.start( _root, _fileFilter );
 }
 
 
 void
 KDirTree::childAddedNotify( KFileInfo *newChild )
 {
+    if ( _updateLevel > 0 )
+	_updateChanged = true;
+
     emit childAdded( newChild );
 
     if ( newChild->dotEntry() )
@@ -282,6 +605,11 @@ KDirTree::childAddedNotify( KFileInfo *newChild )
 void
 KDirTree::deletingChildNotify( KFileInfo *deletedChild )
 {
+    // The background recalculation and the filter aggregation might be
+    // holding pointers into the subtree that is about to be deleted.
+
+    _recalc.abort();
+    _filterTotals.abort();
     emit deletingChild( deletedChild );
 
     // Only now check for selection and root: Give connected objects
@@ -290,6 +618,9 @@ KDirTree::deletingChildNotify( KFileInfo *deletedChild )
     if ( _selection && _selection->isInSubtree( deletedChild ) )
 	 selectItem( 0 );
 
+    forgetSelected( deletedChild );
+    forgetPendingRefresh( deletedChild );
+
     if ( deletedChild == _root )
 	_root = 0;
 }
@@ -353,6 +684,7 @@ KDirTree::deleteSubtree( KFileInfo *subtree )
     }
 
     delete subtree;
+    _hardLinks.applyPromotions();
 
     if ( subtree == _root )
     {
@@ -360,6 +692,37 @@ KDirTree::deleteSubtree( KFileInfo *subtree )
 	_root = 0;
     }
 
+    if ( _updateLevel > 0 )	// The rest is done in endUpdate()
+    {
+	_updateChanged = true;
+	return;
+    }
+
+    // All ancestors of the deleted subtree are dirty now. Recalculate their
+    // summaries right away if that's quick, in the background otherwise.
+
+    _recalc.start( _root );
+    updateFilterTotals();
+    emit childDeleted();
+}
+
+
+void
+KDirTree::itemChangedNotify( KFileInfo *item )
+{
+    _hardLinks.applyPromotions();
+
+    if ( item->parent() )
+	item->parent()->childChanged();
+
+    if ( _updateLevel > 0 )	// The rest is done in endUpdate()
+    {
+	_updateChanged = true;
+	return;
+    }
+
+    _recalc.start( _root );
+    updateFilterTotals();
     emit childDeleted();
 }
 
@@ -367,7 +730,11 @@ KDirTree::deleteSubtree( KFileInfo *subtree )
 void
 KDirTree::addJob( KDirReadJob * job )
 {
+    if ( _jobQueue.isEmpty() )
+	_scanStats.start();
+
     _jobQueue.enqueue( job );
+    _scanStats.queueDepth( _jobQueue.count() );
 }
 
 
@@ -381,6 +748,15 @@ KDirTree::sendProgressInfo( const QString &infoLine )
 void
 KDirTree::sendFinalizeLocal( KDirInfo *dir )
 {
+    // Finalizing may delete dot entries that the background recalculation
+    // or the filter aggregation is still working on.
+
+    if ( _recalc.isActive() )
+	_recalc.restart();
+
+    if ( _filterTotals.isActive() )
+	_filterTotals.restart();
+
     emit finalizeLocal( dir );
 }
 
@@ -421,6 +797,52 @@ KDirTree::selectItem( KFileInfo *newSelection )
 
     _selection = newSelection;
     emit selectionChanged( _selection );
+
+    // Moving the current item within the selected items keeps them;
+    // anything else selects just that one item.
+
+    if ( ! _selection || _selectedItems.findRef( _selection ) < 0 )
+    {
+	_selectedItems.clear();
+
+	if ( _selection )
+	    _selectedItems.append( _selection );
+
+	emit selectedItemsChanged();
+    }
+}
+
+
+void
+KDirTree::setSelectedItems( const QPtrList<KFileInfo> & items )
+{
+    _selectedItems = items;
+    emit selectedItemsChanged();
+}
+
+
+void
+KDirTree::forgetSelected( KFileInfo * subtree )
+{
+    bool changed = false;
+    KFileInfo * item = _selectedItems.first();
+
+    while ( item )
+    {
+	if ( item->isInSubtree( subtree ) )
+	{
+	    _selectedItems.remove();	// The next one becomes current
+	    item    = _selectedItems.current();
+	    changed = true;
+	}
+	else
+	{
+	    item = _selectedItems.next();
+	}
+    }
+
+    if ( changed )
+	emit selectedItemsChanged();
 }
 
 
@@ -432,6 +854,17 @@ KDirTree::writeCache( const QString & cacheFileName )
 }
 
 
+KTopNList
+KDirTree::topN( KTopNType	type,
+		int		n,
+		KFileInfo *	subtree )
+{
+    KTopNQuery query( type, n );
+
+    return query.run( subtree ? subtree : _root );
+}
+
+
 void
 KDirTree::readCache( const QString & cacheFileName )
 {
@@ -20,14 +20,29 @@
 #include <limits.h>
 #include <dirent.h>
 #include <stdlib.h>
+#include <qptrdict.h>
+#include <qtimer.h>
 #include <kdebug.h>
 #include "kdirinfo.h"
 #include "kdirreadjob.h"
+#include "kdirtreerecalc.h"
+#include "ktopnquery.h"
+#include "kownerstats.h"
+#include "khardlinktable.h"
+#include "kfilefilter.h"
+#include "kdeletejob.h"
+#include "kscanstats.h"
 
 #ifndef NOT_USED
 #    define NOT_USED(PARAM)	( (void) (PARAM) )
 #endif
 
+// Milliseconds to wait before a scheduled refresh (see
+// KDirTree::scheduleRefresh()) is started. Everything that is scheduled
+// meanwhile is refreshed along with it.
+
+#define RefreshDelayMillisec	500
+
 // Open a new name space since KDE's name space is pretty much cluttered
 // already - all names that would even remotely match are already used up,
 // yet the resprective classes don't quite fit the purposes required here.
@@ -36,6 +51,7 @@ namespace KDirStat
 {
     // Forward declarations
     class KDirReadJob;
+    class KDirWatcher;
 
 
     /**
@@ -109,6 +125,30 @@ namespace KDirStat
 	 **/
 	void refresh( KFileInfo *subtree = 0 );
 
+	/**
+	 * Refresh several subtrees in one go: Each one is read only once, and
+	 * subtrees that are part of another one are read along with that
+	 * one. Directories are read in the background in one batch of jobs,
+	 * so there is only one @ref startingReading() and one @ref finished()
+	 * signal for all of them.
+	 *
+	 * If any of them is the root, the entire tree is refreshed.
+	 **/
+	void refresh( const QPtrList<KFileInfo> & subtrees );
+
+	/**
+	 * Refresh a subtree (or the entire tree if 0 is passed) a little
+	 * later: All refreshes that are scheduled within @ref
+	 * RefreshDelayMillisec are done in one go with @ref refresh(), so
+	 * each subtree is read only once no matter how often it was
+	 * scheduled, and subtrees are read along with their ancestors. While
+	 * the tree is busy reading, scheduled refreshes wait until it is done.
+	 *
+	 * Use this after cleanups rather than @ref refresh(): Several cleanups
+	 * in a row in the same directory cause only one refresh then.
+	 **/
+	void scheduleRefresh( KFileInfo *subtree = 0 );
+
 	/**
 	 * Select some other item in this tree. Triggers the @ref
 	 * selectionChanged() signal - even to the sender of this signal,
@@ -118,11 +158,27 @@ namespace KDirStat
 	 **/
 	void selectItem( KFileInfo *newSelection );
 
+	/**
+	 * Set all selected items (see @ref selectedItems() ). Triggers the
+	 * @ref selectedItemsChanged() signal - even to the sender of this
+	 * signal. This does not change the current @ref selection().
+	 **/
+	void setSelectedItems( const QPtrList<KFileInfo> & items );
+
 	/**
 	 * Delete a subtree.
 	 **/
 	void deleteSubtree( KFileInfo *subtree );
 
+	/**
+	 * Notification that an item's own fields (size, mtime, links, ...)
+	 * were updated in place (see @ref KFileInfo::update() ): Mark its
+	 * ancestors' summaries dirty and recalculate them - or leave that to
+	 * @ref endUpdate() if called between @ref beginUpdate() and
+	 * @ref endUpdate().
+	 **/
+	void itemChangedNotify( KFileInfo *item );
+
 
     public:
 
@@ -162,6 +218,13 @@ namespace KDirStat
 	KFileInfo *	locate( QString url, bool findDotEntries = false )
 	    { return _root ? _root->locate( url, findDotEntries ) : 0; }
 
+	/**
+	 * Returns the items of 'items' that are not in the subtree of any
+	 * other one of them, each one only once, in their original order.
+	 * This is what it takes to delete or read all of them.
+	 **/
+	static QPtrList<KFileInfo> outermostItems( const QPtrList<KFileInfo> & items );
+
 #if 0
 	/**
 	 * Notification of a finished directory read job.
@@ -197,6 +260,42 @@ namespace KDirStat
 	 **/
 	void	setCrossFileSystems( bool doCross ) { _crossFileSystems = doCross; }
 
+	/**
+	 * Should plain files with multiple hard links be counted only once,
+	 * i.e. should the disk space of an i-node be charged to one single
+	 * link rather than split among all its links?
+	 *
+	 * This only takes effect for items read after it was changed, and
+	 * only for local directories where the i-node number is known.
+	 **/
+	bool	countHardLinksOnce() const { return _countHardLinksOnce; }
+
+	/**
+	 * Set or unset the "count hard links once" flag.
+	 **/
+	void	setCountHardLinksOnce( bool once ) { _countHardLinksOnce = once; }
+
+	/**
+	 * Should the age of items (see @ref KFileInfo::ageBucket()) be based
+	 * on the last access time rather than on the last modification time?
+	 *
+	 * This only takes effect for items read after it was changed, and not
+	 * for items read from a cache file (there is no access time there).
+	 **/
+	bool	ageByAccessTime() const { return _ageByAccessTime; }
+
+	/**
+	 * Set or unset the "age by access time" flag.
+	 **/
+	void	setAgeByAccessTime( bool atime ) { _ageByAccessTime = atime; }
+
+	/**
+	 * Returns the time the ages of all items are calculated from: The
+	 * time the tree was last cleared, i.e. (roughly) when reading
+	 * started.
+	 **/
+	time_t	referenceTime() const { return _referenceTime; }
+
 	/**
 	 * Return the tree's current selection.
 	 *
@@ -211,6 +310,19 @@ namespace KDirStat
 	 **/
 	KFileInfo *	selection() const { return _selection; }
 
+	/**
+	 * Return all selected items of the tree, i.e. everything the user
+	 * selected in any view with Ctrl or Shift. The current @ref
+	 * selection() is one of them (unless the user deselected it again);
+	 * selecting any item that is not one of them with @ref selectItem()
+	 * selects that item only. Items are removed from this list when they
+	 * are deleted.
+	 *
+	 * Attached views should connect to the @ref selectedItemsChanged()
+	 * signal to be notified when this changes.
+	 **/
+	const QPtrList<KFileInfo> & selectedItems() const { return _selectedItems; }
+
 	/**
 	 * Notification that a child has been added.
 	 *
@@ -283,6 +395,131 @@ namespace KDirStat
 	 **/
 	bool writeCache( const QString & cacheFileName );
 
+	/**
+	 * Returns 'true' if dirty directory summaries are being recalculated
+	 * in the background. Until that is finished, summary values
+	 * (total size etc.) may be outdated.
+	 **/
+	bool isRecalcPending() const { return _recalc.isActive(); }
+
+	/**
+	 * Returns the file filter for the filtered totals (see @ref
+	 * KFileInfo::totalFilteredSize() ) or 0 if there is none.
+	 **/
+	const KFileFilter * fileFilter() const { return _fileFilter; }
+
+	/**
+	 * Set the file filter for the filtered totals. This transfers
+	 * ownership of 'filter' to the tree. 0 or a filter that is not active
+	 * removes any previous filter.
+	 *
+	 * The filtered totals are aggregated again for the entire tree, in
+	 * the background for large trees; @ref filterFinished() is emitted
+	 * when they are ready.
+	 **/
+	void setFileFilter( KFileFilter * filter );
+
+	/**
+	 * Returns 'true' if the filtered totals are being aggregated in the
+	 * background, i.e. if they may be outdated.
+	 **/
+	bool isFilterPending() const { return _filterTotals.isActive(); }
+
+	/**
+	 * Returns 'true' if a refresh of 'item' is scheduled (see @ref
+	 * scheduleRefresh() ). This is not checked for its ancestors.
+	 **/
+	bool isRefreshPending( KFileInfo * item ) const
+	    { return ! _pendingRefresh.isEmpty() && _pendingRefresh.find( item ); }
+
+	/**
+	 * Returns the job that deletes items of this tree from disk without
+	 * any external "rm" command (see @ref KDeleteJob). Use
+	 * KDeleteJob::add() to delete something; the tree is updated
+	 * accordingly while deleting.
+	 **/
+	KDeleteJob * deleteJob() { return &_deleteJob; }
+
+	/**
+	 * Returns the counters of the last (or current) scan of this tree.
+	 * They are reset whenever reading starts with no other read job
+	 * pending, e.g. for a refresh, too.
+	 **/
+	KScanStats * scanStats() { return &_scanStats; }
+
+	/**
+	 * Returns the number of directory read jobs that are pending.
+	 **/
+	int pendingReadJobs() const { return _jobQueue.count(); }
+
+	/**
+	 * Should the tree be kept up to date with the disk after reading,
+	 * i.e. should all local directories be watched for changes (see @ref
+	 * KDirWatcher)?
+	 **/
+	bool	watchForChanges() const { return _watchForChanges; }
+
+	/**
+	 * Set or unset the "watch for changes" flag. This takes effect right
+	 * away: All directories that are read are watched from now on, or
+	 * none any more. Only local directories read with opendir() and
+	 * lstat() can be watched.
+	 **/
+	void	setWatchForChanges( bool watch );
+
+	/**
+	 * Returns 'true' if the directories of this tree are actually
+	 * being watched for changes.
+	 **/
+	bool	isWatching() const { return _watcher != 0; }
+
+	/**
+	 * Read the contents of 'dir' that was just added to the tree outside
+	 * of a directory read job, e.g. by a @ref KDirWatcher. This makes the
+	 * tree busy until reading is finished, just like @ref refresh().
+	 **/
+	void	readSubtree( KDirInfo * dir );
+
+	/**
+	 * Start a batch of changes to the tree, i.e. several @ref
+	 * deleteSubtree() and @ref childAddedNotify() calls in a row: Until
+	 * the matching @ref endUpdate() call, the directory summaries and the
+	 * filtered totals are not recalculated, and no @ref childDeleted()
+	 * signal is emitted. Calls may be nested.
+	 **/
+	void	beginUpdate();
+
+	/**
+	 * End a batch of changes started with @ref beginUpdate(). If the tree
+	 * changed, this recalculates what needs to be recalculated and emits
+	 * one single @ref childDeleted() signal (even if children were only
+	 * added) so views can rebuild themselves.
+	 **/
+	void	endUpdate();
+
+	/**
+	 * Returns the 'n' largest files, directories or file types (depending
+	 * on 'type') in 'subtree', largest first. If 'subtree' is 0, the
+	 * entire tree is used.
+	 *
+	 * See @ref KTopNQuery for details.
+	 **/
+	KTopNList topN( KTopNType	type,
+			int		n,
+			KFileInfo *	subtree = 0 );
+
+	/**
+	 * Returns the table of all owners (uid and gid) of the items in this
+	 * tree. Each item only stores an index into this table.
+	 **/
+	KOwnerTable & ownerTable() { return _ownerTable; }
+
+	/**
+	 * Returns the table of all i-nodes with more than one hard link in
+	 * this tree if hard links are counted only once.
+	 **/
+	KHardLinkTable & hardLinks() { return _hardLinks; }
+
 	/**
 	 * Read a cache file.
 	 **/
@@ -338,6 +575,22 @@ namespace KDirStat
 	 **/
 	void finalizeLocal( KDirInfo *dir );
 
+	/**
+	 * Emitted when a background recalculation of directory summaries is
+	 * finished, i.e. all summary values are up to date again. Views that
+	 * display summary values should update themselves.
+	 *
+	 * This is not emitted if the recalculation could be done right away.
+	 **/
+	void recalcFinished();
+
+	/**
+	 * Emitted when the filtered totals are up to date after the file
+	 * filter was changed or the tree changed. Views that display filtered
+	 * totals should update themselves.
+	 **/
+	void filterFinished();
+
 	/**
 	 * Emitted when the current selection has changed, i.e. whenever some
 	 * attached view triggers the @ref selectItem() slot or when the
@@ -347,6 +600,18 @@ namespace KDirStat
 	 **/
 	void selectionChanged( KFileInfo *newSelection );
 
+	/**
+	 * Emitted when the selected items (see @ref selectedItems() ) have
+	 * changed.
+	 **/
+	void selectedItemsChanged();
+
+	/**
+	 * Emitted when the refreshes scheduled with @ref scheduleRefresh()
+	 * change, so views can show which items are about to be refreshed.
+	 **/
+	void pendingRefreshChanged();
+
 	/**
 	 * Single line progress information, emitted when the read status
 	 * changes - typically when a new directory is being read. Connect to a
@@ -368,14 +633,55 @@ namespace KDirStat
 	 **/
 	void slotFinished();
 
+	/**
+	 * Aggregate the filtered totals for the entire tree again if there is
+	 * a file filter.
+	 **/
+	void updateFilterTotals();
+
+	/**
+	 * Refresh everything that is scheduled for a refresh - unless the
+	 * tree is busy reading.
+	 **/
+	void startPendingRefresh();
+
 	
     protected:
 
+	/**
+	 * Remove all items in 'subtree' from the selected items.
+	 **/
+	void forgetSelected( KFileInfo * subtree );
+
+	/**
+	 * Cancel all scheduled refreshes of items in 'subtree' - 0 means all
+	 * of them.
+	 **/
+	void forgetPendingRefresh( KFileInfo * subtree );
+
+
 	KFileInfo *		_root;
 	KFileInfo *		_selection;
+	QPtrList<KFileInfo>	_selectedItems;
 	KDirReadJobQueue	_jobQueue;
+	KDirTreeRecalc		_recalc;
+	KFileFilter *		_fileFilter;
+	KFilterTotals		_filterTotals;
+	KDeleteJob		_deleteJob;
+	KScanStats		_scanStats;
+	QPtrDict<KFileInfo>	_pendingRefresh;
+	QTimer			_refreshTimer;
+	KDirWatcher *		_watcher;
+	KOwnerTable		_ownerTable;
+	KHardLinkTable		_hardLinks;
 	KDirReadMethod		_readMethod;
 	bool			_crossFileSystems;
+	bool			_countHardLinksOnce;
+	bool			_ageByAccessTime;
+	bool			_watchForChanges;
+	int			_updateLevel;
+	bool			_updateChanged;
+	time_t			_referenceTime;
 	bool			_enableLocalDirReader;
 	bool			_isFileProtocol;
 	bool			_isBusy;
@@ -57,8 +57,14 @@ KCacheWriter::writeCache( const QString & fileName, KDirTree *tree )
     gzprintf( cache,
 	     "# Do not edit!\n"
 	     "#\n"
-	     "# Type\tpath\t\tsize\tmtime\t\t<optional fields>\n"
-	     "\n" );
+	     "# Type\tpath\t\tsize\tmtime\t\t<optional fields>\n" );
+
+    // Without this, a reader cannot trust the "dup:" fields
+
+    if ( tree->countHardLinksOnce() )
+	gzprintf( cache, "%s\n", LINKS_ONCE_COMMENT );
+
+    gzprintf( cache, "\n" );
 
     writeTree( cache, tree->root() );
     gzclose( cache );
@@ -91,13 +97,10 @@ KCacheWriter::writeTree( gzFile cache, KFileInfo * item )
     // Recurse through subdirectories
     //
 
-    KFileInfo * child = item->firstChild();
+    int count = item->childCount();
 
-    while ( child )
-    {
-	writeTree( cache, child );
-	child = child->next();
-    }
+    for ( int i=0; i < count; i++ )
+	writeTree( cache, item->childAt( i ) );
 }
 
 
@@ -153,6 +156,37 @@ KCacheWriter::writeItem( gzFile cache, KFileInfo * item )
     if ( item->isFile() && item->links() > 1 )
 	gzprintf( cache, "\tlinks: %u", (unsigned) item->links() );
 
+    if ( item->isDuplicateLink() )
+	gzprintf( cache, "\tdup: 1" );
+
+    dev_t dev;
+    ino_t ino;
+
+    if ( item->countsLinksOnce() && item->tree() &&
+	 item->tree()->hardLinks().inode( item, dev, ino ) )
+    {
+	gzprintf( cache, "\tdev: %llu\tino: %llu",
+		  (unsigned long long) dev, (unsigned long long) ino );
+    }
+
+    if ( item->hasOwner() )
+    {
+	// Items other than directories inherit the owner of their directory
+	// unless they have a different one - most files in a directory
+	// usually belong to the same user.
+
+	KFileInfo * dir = item->parent();
+
+	if ( dir && dir->isDotEntry() )
+	    dir = dir->parent();
+
+	if ( item->isDirInfo() || ! dir || dir->ownerIndex() != item->ownerIndex() )
+	{
+	    gzprintf( cache, "\tuid: %u\tgid: %u",
+		      (unsigned) item->uid(), (unsigned) item->gid() );
+	}
+    }
+
     gzputc( cache, '\n' );
 }
 
@@ -204,6 +238,7 @@ KCacheReader::KCacheReader( const QString &	fileName,
     _toplevel		= parent;
     _lastDir		= 0;
     _lastExcludedDir	= 0;
+    _linksOnce		= false;
 
     _cache = gzopen( (const char *) fileName, "r" );
 
@@ -280,6 +315,11 @@ KCacheReader::addItem()
     char * mtime_str	= field( n++ );
     char * blocks_str	= 0;
     char * links_str	= 0;
+    char * uid_str	= 0;
+    char * gid_str	= 0;
+    char * dup_str	= 0;
+    char * dev_str	= 0;
+    char * ino_str	= 0;
 
     while ( fieldsCount() > n+1 )
     {
@@ -288,6 +328,11 @@ KCacheReader::addItem()
 
 	if ( strcasecmp( keyword, "blocks:" ) == 0 ) blocks_str = val_str;
 	if ( strcasecmp( keyword, "links:"  ) == 0 ) links_str  = val_str;
+	if ( strcasecmp( keyword, "uid:"    ) == 0 ) uid_str    = val_str;
+	if ( strcasecmp( keyword, "gid:"    ) == 0 ) gid_str    = val_str;
+	if ( strcasecmp( keyword, "dup:"    ) == 0 ) dup_str    = val_str;
+	if ( strcasecmp( keyword, "dev:"    ) == 0 ) dev_str    = val_str;
+	if ( strcasecmp( keyword, "ino:"    ) == 0 ) ino_str    = val_str;
     }
 
 
@@ -343,6 +388,13 @@ KCacheReader::addItem()
     int links = links_str ? atoi( links_str ) : 1;
 
 
+    // Owner
+
+    bool  hasOwner = uid_str || gid_str;
+    uid_t uid	   = uid_str ? (uid_t) strtoul( uid_str, 0, 10 ) : (uid_t) -1;
+    gid_t gid	   = gid_str ? (gid_t) strtoul( gid_str, 0, 10 ) : (gid_t) -1;
+
+
     //
     // Create a new item
     //
@@ -408,6 +460,10 @@ KCacheReader::addItem()
 	KDirInfo * dir = new KDirInfo( _tree, parent, name,
 				       mode, size, mtime );
 	dir->setReadState( KDirCached );
+
+	if ( hasOwner )
+	    dir->setOwner( uid, gid );
+
 	_lastDir = dir;
 
 	if ( parent )
@@ -449,6 +505,41 @@ KCacheReader::addItem()
 	    KFileInfo * item = new KFileInfo( _tree, parent, name,
 					      mode, size, mtime,
 					      blocks, links );
+
+	    // Unless the cache was written while counting hard links only
+	    // once, there is no telling which links are duplicates. Neither
+	    // for links without any hard link fields, e.g. links that were
+	    // read before that setting was switched on: Keep splitting the
+	    // size among all links then.
+
+	    if ( links > 1 && mode == S_IFREG && _linksOnce && _tree->countHardLinksOnce() )
+	    {
+		if ( dev_str && ino_str )
+		{
+		    dev_t dev = (dev_t) strtoull( dev_str, 0, 10 );
+		    ino_t ino = (ino_t) strtoull( ino_str, 0, 10 );
+
+		    item->setCountLinksOnce( ! _tree->hardLinks().addLink( dev, ino, item ) );
+		}
+		else if ( dup_str )
+		{
+		    item->setCountLinksOnce( atoi( dup_str ) != 0 );
+		}
+	    }
+
+	    // Without an owner of its own, an item has the owner of its directory
+
+	    if ( hasOwner )
+	    {
+		if ( ! uid_str ) uid = parent->uid();
+		if ( ! gid_str ) gid = parent->gid();
+		item->setOwner( uid, gid );
+	    }
+	    else
+	    {
+		item->setOwnerIndex( parent->ownerIndex() );
+	    }
+
 	    parent->insertChild( item );
 	    _tree->childAddedNotify( item );
 	}
@@ -573,6 +664,9 @@ KCacheReader::readLine()
 	_line = skipWhiteSpace( _buffer );
 	killTrailingWhiteSpace( _line );
 
+	if ( strcmp( _line, LINKS_ONCE_COMMENT ) == 0 )
+	    _linksOnce = true;
+
 	// kdDebug() << "line[ " << _lineNo << "]: \"" << _line<< "\"" << endl;
 
     } while ( ! gzeof( _cache ) &&
@@ -28,6 +28,7 @@
 #define DEFAULT_CACHE_NAME	".kdirstat.cache.gz"
 #define MAX_CACHE_LINE_LEN	1024
 #define MAX_FIELDS_PER_LINE	32
+#define LINKS_ONCE_COMMENT	"# Hard links: counted once"
 
 
 namespace KDirStat
@@ -128,6 +129,12 @@ namespace KDirStat
 	 **/
 	bool ok() const { return _ok; }
 
+	/**
+	 * Returns the number of lines read so far (including the header,
+	 * comments and empty lines).
+	 **/
+	int lineNo() const { return _lineNo; }
+
 	/**
 	 * Resets the reader so all data lines of the cache can be read with
 	 * subsequent read() calls.
@@ -246,6 +253,7 @@ namespace KDirStat
 	KDirInfo * 	_lastDir;
 	KDirInfo *	_lastExcludedDir;
 	QString		_lastExcludedDirUrl;
+	bool		_linksOnce;	// written while counting hard links once?
     };
 
 }	// namespace KDirStat
@@ -44,6 +44,7 @@ KFileInfoIterator::init( KFileInfo *		parent,
     _parent	= parent;
     _policy	= dotEntryPolicy;
     _current	= 0;
+    _childIndex	= 0;
 
     _directChildrenProcessed	= false;
     _dotEntryProcessed		= false;
@@ -66,11 +67,12 @@ void KFileInfoIterator::next()
     {
 	// Process direct children
 
-	_current = _current ? _current->next() : _parent->firstChild();
+	_current = _parent->childAt( _childIndex++ );
 
 	if ( ! _current )
 	{
 	    _directChildrenProcessed = true;
+	    _childIndex = 0;
 	    next();
 	}
 	else
@@ -104,9 +106,8 @@ void KFileInfoIterator::next()
 		{
 		    // Process dot entry children
 
-		    _current = _current ?
-			_current->next() :
-			( _parent->dotEntry() ? _parent->dotEntry()->firstChild() : 0 );
+		    _current = _parent->dotEntry() ?
+			_parent->dotEntry()->childAt( _childIndex++ ) : 0;
 
 		    if ( ! _current )
 		    {
@@ -131,17 +132,9 @@ void KFileInfoIterator::next()
 int
 KFileInfoIterator::count()
 {
-    int cnt = 0;
-
     // Count direct children
 
-    KFileInfo *child = _parent->firstChild();
-
-    while ( child )
-    {
-	cnt++;
-	child = child->next();
-    }
+    int cnt = _parent->childCount();
 
 
     // Handle the dot entry
@@ -150,15 +143,7 @@ KFileInfoIterator::count()
     {
 	case KDotEntryTransparent:	// Count the dot entry's children as well.
 	    if ( _parent->dotEntry() )
-	    {
-		child = _parent->dotEntry()->firstChild();
-
-		while ( child )
-		{
-		    cnt++;
-		    child = child->next();
-		}
-	    }
+		cnt += _parent->dotEntry()->childCount();
 	    break;
 
 	case KDotEntryAsSubDir:		// The dot entry counts as one item.
@@ -187,7 +172,8 @@ KFileInfoSortedIterator::KFileInfoSortedIterator( KFileInfo *		parent,
     _sortOrder			= sortOrder;
     _ascending			= ascending;
     _initComplete		= false;
-    _childrenList		= 0;
+    _index			= 0;
+    _end			= 0;
     _current			= 0;
 }
 
@@ -195,95 +181,44 @@ KFileInfoSortedIterator::KFileInfoSortedIterator( KFileInfo *		parent,
 void
 KFileInfoSortedIterator::delayedInit()
 {
-    _childrenList = new KFileInfoList( _sortOrder, _ascending );
-    CHECK_PTR( _childrenList );
+    // Dot entries get their children while their parent is being read
 
-    if ( _sortOrder == KSortByName )
-    {
-	makeDefaultOrderChildrenList();
-    }
-    else
-    {
-	makeChildrenList();
-    }
+    bool busy = _parent && ( _parent->isBusy() ||
+			     ( _parent->isDotEntry() && _parent->parent() && _parent->parent()->isBusy() ) );
 
-    _current = _childrenList->first();
-    _initComplete = true;
-}
-
-
-KFileInfoSortedIterator::~KFileInfoSortedIterator()
-{
-    if ( _childrenList )
-	delete _childrenList;
-}
-
-
-void KFileInfoSortedIterator::makeDefaultOrderChildrenList()
-{
-    // Fill children list with direct children
-
-    KFileInfo *child = _parent->firstChild();
-
-    while ( child )
-    {
-	_childrenList->append( child );
-	child = child->next();
-    }
-
-    _childrenList->sort();
-
-    if ( _policy == KDotEntryAsSubDir && _parent->dotEntry() )
+    if ( _parent && _parent->isDirInfo() && ! busy )
     {
-	// Append dot entry to the children list
+	// Keep a (shallow) copy of the sorted children: The parent might
+	// drop its sort cache while this iterator is still in use.
 
-	_childrenList->append( _parent->dotEntry() );
+	KDirInfo * dir = (KDirInfo *) _parent;
+	_sorted = dir->sortCache()->sortedChildren( _policy, _sortOrder, _ascending );
     }
-
-
-    // Append the dot entry's children to the children list
-
-    if ( _policy == KDotEntryTransparent && _parent->dotEntry() )
+    else if ( _parent && _parent->isDirInfo() )
     {
-	// Create a temporary list for the dot entry children
-
-	KFileInfoList dotEntryChildrenList( _sortOrder, _ascending );
-	child = _parent->dotEntry()->firstChild();
-
-	while ( child )
-	{
-	    dotEntryChildrenList.append( child );
-	    child = child->next();
-	}
+	// Children are still being added, and each of them would drop the
+	// cache again: Don't keep anything, and sort only what is needed.
 
-	dotEntryChildrenList.sort();
+	_sorted.sortOrder	= _sortOrder;
+	_sorted.policy		= _policy;
+	_sorted.ascending	= _ascending;
 
+	KFileInfoSortCache::build( _parent, _sorted, minSortSize() );
+    }
 
-	// Now append all of this dot entry children list to the children list
+    _index	= 0;
+    _end	= _sorted.children.size();
 
-	child = dotEntryChildrenList.first();
+    restrictRange();
 
-	while ( child )
-	{
-	    _childrenList->append( child );
-	    child = dotEntryChildrenList.next();
-	}
-    }
+    _current = _index < _end ? _sorted.children[ _index ] : 0;
+    _initComplete = true;
 }
 
 
-void
-KFileInfoSortedIterator::makeChildrenList()
+KFileInfoSortedIterator::~KFileInfoSortedIterator()
 {
-    KFileInfoIterator it( _parent, _policy );
-
-    while ( *it )
-    {
-	_childrenList->append( *it );
-	++it;
-    }
-
-    _childrenList->sort();
+    // NOP
 }
 
 
@@ -302,7 +237,10 @@ void KFileInfoSortedIterator::next()
     if ( ! _initComplete )
 	delayedInit();
 
-    _current = _childrenList->next();
+    if ( _index < _end )
+	_index++;
+
+    _current = _index < _end ? _sorted.children[ _index ] : 0;
 }
 
 
@@ -326,24 +264,206 @@ KFileInfoSortedBySizeIterator::KFileInfoSortedBySizeIterator( KFileInfo *		paren
 							      bool			ascending )
     : KFileInfoSortedIterator( parent, dotEntryPolicy, KSortByTotalSize, ascending )
     , _minSize( minSize )
+    , _prunedSize( 0 )
+    , _prunedCount( 0 )
 {
 }
 
 
 void
-KFileInfoSortedBySizeIterator::makeChildrenList()
+KFileInfoSortedBySizeIterator::restrictRange()
 {
-    KFileInfoIterator it( _parent, _policy );
+    const QValueVector<KFileInfo *> & children = _sorted.children;
+    const QValueVector<KFileSize>   & sums     = _sorted.sizeSums;
 
-    while ( *it )
+    // Children that were not even sorted
+
+    _prunedSize	 = _sorted.prunedSize;
+    _prunedCount = _sorted.prunedCount;
+
+    if ( children.isEmpty() || sums.size() != children.size() + 1 )
+	return;
+
+    // Binary search for the first child that is below minSize (descending
+    // order) or that is at least minSize (ascending order).
+
+    int low  = 0;
+    int high = children.size();
+
+    while ( low < high )
+    {
+	int mid = ( low + high ) / 2;
+	bool big = children[ mid ]->totalSize() >= _minSize;
+
+	if ( big == ! _ascending )
+	    low  = mid + 1;
+	else
+	    high = mid;
+    }
+
+    if ( _ascending )	// The small ones are first
+    {
+	_index		= low;
+	_prunedSize    += sums[ low ];
+	_prunedCount   += low;
+    }
+    else		// The small ones are last
     {
-	if ( (*it)->totalSize() >= _minSize )
-	    _childrenList->append( *it );
+	_end		= low;
+	_prunedSize    += sums[ children.size() ] - sums[ low ];
+	_prunedCount   += children.size() - low;
+    }
+}
+
+
+
+
+
+
+KFileInfoSortCache::KFileInfoSortCache( KFileInfo * parent )
+    : _parent( parent )
+{
+    // NOP
+}
+
+
+KFileInfoSortCache::~KFileInfoSortCache()
+{
+    // NOP
+}
+
+
+const KFileInfoSortedChildren &
+KFileInfoSortCache::sortedChildren( KDotEntryPolicy	policy,
+				    KFileInfoSortOrder	sortOrder,
+				    bool		ascending )
+{
+    QValueList<KFileInfoSortedChildren>::iterator it = _entries.begin();
+
+    while ( it != _entries.end() )
+    {
+	if ( (*it).sortOrder	== sortOrder &&
+	     (*it).policy	== policy    &&
+	     (*it).ascending	== ascending   )
+	{
+	    return *it;
+	}
 
 	++it;
     }
 
-    _childrenList->sort();
+    KFileInfoSortedChildren sorted;
+    sorted.sortOrder	= sortOrder;
+    sorted.policy	= policy;
+    sorted.ascending	= ascending;
+
+    build( _parent, sorted );
+
+    it = _entries.append( sorted );
+
+    return *it;
+}
+
+
+void
+KFileInfoSortCache::build( KFileInfo *			parent,
+			   KFileInfoSortedChildren &	sorted,
+			   KFileSize			minSize )
+{
+    KFileInfoList list( sorted.sortOrder, sorted.ascending );
+
+    if ( sorted.sortOrder == KSortByName )
+    {
+	// Direct children first
+
+	int count = parent->childCount();
+
+	for ( int i=0; i < count; i++ )
+	    list.append( parent->childAt( i ) );
+
+	list.sort();
+
+	if ( sorted.policy == KDotEntryAsSubDir && parent->dotEntry() )
+	{
+	    // Append dot entry to the children list
+
+	    list.append( parent->dotEntry() );
+	}
+
+
+	// Append the dot entry's children to the children list
+
+	if ( sorted.policy == KDotEntryTransparent && parent->dotEntry() )
+	{
+	    // Create a temporary list for the dot entry children
+
+	    KFileInfoList dotEntryChildrenList( sorted.sortOrder, sorted.ascending );
+	    KFileInfo * dotEntry = parent->dotEntry();
+	    count = dotEntry->childCount();
+
+	    for ( int i=0; i < count; i++ )
+		dotEntryChildrenList.append( dotEntry->childAt( i ) );
+
+	    dotEntryChildrenList.sort();
+
+
+	    // Now append all of this dot entry children list to the children list
+
+	    KFileInfo * child = dotEntryChildrenList.first();
+
+	    while ( child )
+	    {
+		list.append( child );
+		child = dotEntryChildrenList.next();
+	    }
+	}
+    }
+    else
+    {
+	KFileInfoIterator it( parent, sorted.policy );
+
+	while ( *it )
+	{
+	    if ( (*it)->totalSize() >= minSize )
+	    {
+		list.append( *it );
+	    }
+	    else
+	    {
+		sorted.prunedSize += (*it)->totalSize();
+		sorted.prunedCount++;
+	    }
+
+	    ++it;
+	}
+
+	list.sort();
+    }
+
+
+    // Copy the list into the (much more compact) vector
+
+    sorted.children.reserve( list.count() );
+    KFileInfoListIterator it( list );
+
+    while ( *it )
+    {
+	sorted.children.push_back( *it );
+	++it;
+    }
+
+    if ( sorted.sortOrder == KSortByTotalSize )
+    {
+	KFileSize sum = 0;
+	sorted.sizeSums.reserve( sorted.children.size() + 1 );
+	sorted.sizeSums.push_back( 0 );
+
+	for ( uint i=0; i < sorted.children.size(); i++ )
+	{
+	    sum += sorted.children[i]->totalSize();
+	    sorted.sizeSums.push_back( sum );
+	}
+    }
 }
 
 
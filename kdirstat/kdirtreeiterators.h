@@ -16,6 +16,8 @@
 #   include <config.h>
 #endif
 
+#include <qvaluelist.h>
+#include <qvaluevector.h>
 #include "kdirtree.h"
 
 
@@ -46,6 +48,117 @@ namespace KDirStat
     class KFileInfoList;
 
 
+
+    /**
+     * The children of a directory in one specific sort order, as kept by
+     * @ref KFileInfoSortCache.
+     *
+     * The vectors are implicitly shared, so copying this is cheap.
+     **/
+    class KFileInfoSortedChildren
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KFileInfoSortedChildren()
+	    : sortOrder( KUnsorted )
+	    , policy( KDotEntryTransparent )
+	    , ascending( true )
+	    , prunedSize( 0 )
+	    , prunedCount( 0 )
+	    {}
+
+	KFileInfoSortOrder		sortOrder;
+	KDotEntryPolicy			policy;
+	bool				ascending;
+	QValueVector<KFileInfo *>	children;
+
+	/**
+	 * Only for KSortByTotalSize: sizeSums[i] is the sum of the total
+	 * sizes of children[0] .. children[i-1], so there is one more entry
+	 * than there are children.
+	 **/
+	QValueVector<KFileSize>		sizeSums;
+
+	/**
+	 * Only for uncached lists built with a minimum size (see @ref
+	 * KFileInfoSortCache::build() ): The sum of the total sizes and the
+	 * number of the children that were left out.
+	 **/
+	KFileSize			prunedSize;
+	int				prunedCount;
+
+    };	// class KFileInfoSortedChildren
+
+
+
+    /**
+     * Cache for sorted children lists of a directory: Each sort order /
+     * dot entry policy combination is sorted only once and then reused
+     * until the directory drops the cache because its children or their
+     * totals changed (see @ref KDirInfo::dropSortCache()).
+     *
+     * This way, rebuilding a treemap of an unchanged tree doesn't sort
+     * anything.
+     *
+     * Normally, this is used only through @ref KFileInfoSortedIterator.
+     **/
+    class KFileInfoSortCache
+    {
+    public:
+
+	/**
+	 * Constructor for the cache of the children of 'parent'.
+	 **/
+	KFileInfoSortCache( KFileInfo * parent );
+
+	/**
+	 * Destructor.
+	 **/
+	~KFileInfoSortCache();
+
+	/**
+	 * Returns the children of the parent in the specified order,
+	 * sorting them only if that order is not cached yet.
+	 **/
+	const KFileInfoSortedChildren & sortedChildren( KDotEntryPolicy		policy,
+							KFileInfoSortOrder	sortOrder,
+							bool			ascending );
+
+	/**
+	 * Discard all cached sort orders.
+	 **/
+	void clear() { _entries.clear(); }
+
+	/**
+	 * Fill and sort 'sorted' with the children of 'parent' according to
+	 * its sort order and policy:
+	 *
+	 * For KSortByName, first all subdirectories sorted by name, then the
+	 * dot entry (depending on policy), then the dot entry's children
+	 * sorted by name (depending on policy).
+	 *
+	 * For any other order, all children (depending on policy) sorted
+	 * according to that order. Children with a total size below
+	 * 'minSize' are left out before sorting; see @ref
+	 * KFileInfoSortedChildren::prunedSize. Cached lists are always
+	 * complete, so this is only useful for lists that are not cached.
+	 **/
+	static void build( KFileInfo *			parent,
+			   KFileInfoSortedChildren &	sorted,
+			   KFileSize			minSize = 0 );
+
+
+    protected:
+
+	KFileInfo *				_parent;
+	QValueList<KFileInfoSortedChildren>	_entries;
+
+    };	// class KFileInfoSortCache
+
+
     /**
      * Iterator class for children of a @ref KFileInfo object. For optimum
      * performance, this iterator class does NOT return children in any
@@ -178,6 +291,7 @@ namespace KDirStat
 	KFileInfo *	_parent;
 	KDotEntryPolicy	_policy;
 	KFileInfo *	_current;
+	int		_childIndex;		// next index in the current children array
 	bool		_directChildrenProcessed;
 	bool		_dotEntryProcessed;
 	bool		_dotEntryChildrenProcessed;
@@ -193,6 +307,12 @@ namespace KDirStat
      * desired). Note: If you don't need the sorting feature, you might want to
      * use @ref KFileItemIterator instead which has better performance.
      *
+     * The sorted children lists are cached in the parent directory (see
+     * @ref KFileInfoSortCache), so iterating over the same unchanged
+     * directory again in the same order doesn't sort anything. Directories
+     * that are still being read don't get a cache: Each child added to them
+     * would discard it again anyway.
+     *
      * @short sorted iterator for @ref KFileInfo children.
      **/
     class KFileInfoSortedIterator: public KFileInfoIterator
@@ -248,24 +368,24 @@ namespace KDirStat
 	void delayedInit();
 
 	/**
-	 * Make a 'default order' children list:
-	 * First all subdirectories sorted by name,
-	 * then the dot entry (depending on policy),
-	 * then the dot entry's children (depending on policy).
+	 * Restrict the range [_index, _end) of the sorted children to
+	 * iterate over. This default implementation does nothing.
 	 **/
-	virtual void makeDefaultOrderChildrenList();
+	virtual void restrictRange() {}
 
 	/**
-	 * Make a sorted children list according to the current sort
-	 * criteria - unless KSortByName is requested, in which case
-	 * makeDefaultOrderChildrenList() above is used.
+	 * Returns the minimum total size of the children to sort if they
+	 * are sorted without using the parent's sort cache. This default
+	 * implementation returns 0, i.e. all children are sorted.
 	 **/
-	virtual void makeChildrenList();
+	virtual KFileSize minSortSize() const { return 0; }
 
 	
 	// Data members
 
-	KFileInfoList *		_childrenList;
+	KFileInfoSortedChildren	_sorted;
+	int			_index;
+	int			_end;
 	KFileInfoSortOrder	_sortOrder;
 	bool			_ascending;
 	bool			_initComplete;
@@ -303,19 +423,44 @@ namespace KDirStat
 	 **/
 	virtual ~KFileInfoSortedBySizeIterator() {};
 
+	/**
+	 * Returns the sum of the total sizes of all children that were
+	 * disregarded because they were below minSize. This is only
+	 * meaningful after the iterator was used for the first time.
+	 **/
+	KFileSize prunedSize() const { return _prunedSize; }
+
+	/**
+	 * Returns the number of children that were disregarded because they
+	 * were below minSize.
+	 **/
+	int prunedCount() const { return _prunedCount; }
+
 
     protected:
 
 	/**
-	 * Create the (sorted) children list. Disregard children below minSize.
+	 * Disregard children below minSize. Since the children are sorted by
+	 * size, this is just a binary search in the sorted children.
+	 *
+	 * Reimplemented from KFileInfoSortedIterator.
+	 **/
+	virtual void restrictRange();
+
+	/**
+	 * Directories that are still being read are sorted without the
+	 * cache; leave out the children below minSize right away then.
+	 *
 	 * Reimplemented from KFileInfoSortedIterator.
 	 **/
-	virtual void makeChildrenList();
+	virtual KFileSize minSortSize() const { return _minSize; }
 
 
 	// Data members
 	
 	KFileSize	_minSize;
+	KFileSize	_prunedSize;
+	int		_prunedCount;
 
     }; // class KFileInfoSortedBySizeIterator
 
@@ -0,0 +1,170 @@
+/*
+ *   File name:	kdirtreerecalc.cpp
+ *   Summary:	Support classes for KDirStat - time sliced summary recalculation
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qdatetime.h>
+#include <kdebug.h>
+
+#include "kdirtreerecalc.h"
+#include "kdirinfo.h"
+
+
+using namespace KDirStat;
+
+
+KDirTreeRecalc::KDirTreeRecalc()
+    : QObject()
+    , _root( 0 )
+    , _active( false )
+{
+    connect( &_timer, SIGNAL( timeout()          ),
+	     this,    SLOT  ( timeSlicedRecalc() ) );
+}
+
+
+KDirTreeRecalc::~KDirTreeRecalc()
+{
+    // NOP
+}
+
+
+void
+KDirTreeRecalc::start( KFileInfo * root )
+{
+    bool wasActive = _active;
+
+    _root = root;
+    restart();
+
+    if ( ! _active )
+	return;
+
+    if ( work( RecalcSliceMillisec ) )
+    {
+	// Done in the first slice - nobody needs to know that this was ever
+	// attempted in the background, unless a previous background run was
+	// still in progress.
+
+	_timer.stop();
+	_active = false;
+
+	if ( wasActive )
+	    emit finished();
+    }
+    else
+    {
+	// kdDebug() << "Continuing summary recalculation in the background" << endl;
+    }
+}
+
+
+void
+KDirTreeRecalc::restart()
+{
+    _stack.clear();
+    push( _root );
+
+    _active = ! _stack.isEmpty();
+
+    if ( _active )
+    {
+	if ( ! _timer.isActive() )
+	    _timer.start( 0 );
+    }
+    else
+    {
+	_timer.stop();
+    }
+}
+
+
+void
+KDirTreeRecalc::abort()
+{
+    _timer.stop();
+    _stack.clear();
+    _root   = 0;
+    _active = false;
+}
+
+
+void
+KDirTreeRecalc::timeSlicedRecalc()
+{
+    if ( work( RecalcSliceMillisec ) )
+    {
+	_timer.stop();
+	_active = false;
+
+	// kdDebug() << "Background summary recalculation finished" << endl;
+	emit finished();
+    }
+}
+
+
+bool
+KDirTreeRecalc::work( int millisec )
+{
+    QTime time;
+    time.start();
+    int steps = 0;
+
+    while ( ! _stack.isEmpty() )
+    {
+	StackEntry & top   = _stack.back();
+	int	     count = top.dir->childCount();
+
+	if ( top.index < count )
+	{
+	    push( top.dir->childAt( top.index++ ) );	// invalidates 'top'
+	}
+	else if ( top.index == count )
+	{
+	    top.index++;
+	    push( top.dir->dotEntry() );		// invalidates 'top'
+	}
+	else
+	{
+	    // All dirty children are up to date now, so this doesn't recurse
+	    // any more.
+
+	    top.dir->recalc();
+	    _stack.pop_back();
+	}
+
+	// Checking the clock is not exactly free - do it only every now and
+	// then.
+
+	if ( ++steps % 1024 == 0 && time.elapsed() >= millisec )
+	    return _stack.isEmpty();
+    }
+
+    return true;
+}
+
+
+void
+KDirTreeRecalc::push( KFileInfo * item )
+{
+    if ( item && item->isDirInfo() )
+    {
+	KDirInfo * dir = (KDirInfo *) item;
+
+	if ( dir->isSummaryDirty() )
+	    _stack.push_back( StackEntry( dir ) );
+    }
+}
+
+
+
+// EOF
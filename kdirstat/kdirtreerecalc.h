@@ -0,0 +1,161 @@
+/*
+ *   File name:	kdirtreerecalc.h
+ *   Summary:	Support classes for KDirStat - time sliced summary recalculation
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KDirTreeRecalc_h
+#define KDirTreeRecalc_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qobject.h>
+#include <qtimer.h>
+#include <qvaluevector.h>
+
+
+// Milliseconds to spend in one slice of a background recalculation before
+// returning to the event loop
+
+#define RecalcSliceMillisec	50
+
+
+namespace KDirStat
+{
+    // Forward declarations
+    class KFileInfo;
+    class KDirInfo;
+
+
+    /**
+     * Background recalculation of the dirty summary fields (total size,
+     * total items, latest mtime etc.) of a directory tree.
+     *
+     * After deleting a large subtree, all its ancestors are marked dirty,
+     * and the first one to ask any of them for a summary value would
+     * recursively recalculate everything below it - which may block the
+     * application for seconds on a huge tree. This class does the same
+     * work bottom-up without any recursion in small time slices from the
+     * event loop instead. While it is busy, @ref KDirInfo returns the old
+     * (stale) summary values rather than recalculating them on the spot.
+     *
+     * Only dirty directories are visited; subtrees that are still up to
+     * date are not traversed at all.
+     *
+     * Normally, this is used only through @ref KDirTree.
+     *
+     * @short Time sliced recalculation of dirty directory summaries
+     **/
+    class KDirTreeRecalc: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KDirTreeRecalc();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KDirTreeRecalc();
+
+	/**
+	 * Start recalculating all dirty directories below (and including)
+	 * 'root'. The first slice is done right away, so for small trees
+	 * everything is up to date when this returns, and finished() is not
+	 * emitted. Otherwise the rest is done in the background, and
+	 * finished() is emitted when it's done.
+	 **/
+	void start( KFileInfo * root );
+
+	/**
+	 * Start over from the root without doing any work right away.
+	 * Use this when the tree changed structurally (e.g., dot entries
+	 * were removed) while the recalculation is in progress.
+	 **/
+	void restart();
+
+	/**
+	 * Stop recalculating and forget everything about the tree. Use this
+	 * before deleting any part of the tree.
+	 **/
+	void abort();
+
+	/**
+	 * Returns 'true' if there is still work to do, i.e. if summary values
+	 * may be stale.
+	 **/
+	bool isActive() const { return _active; }
+
+
+    signals:
+
+	/**
+	 * Emitted when a background recalculation is finished, i.e. all
+	 * summary values are up to date again.
+	 **/
+	void finished();
+
+
+    protected slots:
+
+	/**
+	 * Do one time slice worth of recalculation.
+	 **/
+	void timeSlicedRecalc();
+
+
+    protected:
+
+	/**
+	 * Recalculate dirty directories for at most 'millisec' milliseconds.
+	 * Returns 'true' if everything is done.
+	 **/
+	bool work( int millisec );
+
+	/**
+	 * Push 'item' onto the stack if it is a directory with a dirty
+	 * summary.
+	 **/
+	void push( KFileInfo * item );
+
+
+	/**
+	 * One level of the traversal: The directory and the index of the next
+	 * child to visit. Index childCount() stands for the dot entry.
+	 **/
+	struct StackEntry
+	{
+	    StackEntry( KDirInfo * d = 0 ): dir( d ), index( 0 ) {}
+
+	    KDirInfo *	dir;
+	    int		index;
+	};
+
+
+	// Data members
+
+	KFileInfo *			_root;
+	QValueVector<StackEntry>	_stack;
+	QTimer				_timer;
+	bool				_active;
+
+    };	// class KDirTreeRecalc
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KDirTreeRecalc_h
+
+
+// EOF
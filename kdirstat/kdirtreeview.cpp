@@ -45,6 +45,7 @@ KDirTreeView::KDirTreeView( QWidget * parent )
     _tree		= 0;
     _updateTimer	= 0;
     _selection		= 0;
+    _syncingSelection	= false;
     _openLevel		= 1;
     _doLazyClone	= true;
     _doPacManAnimation	= false;
@@ -64,6 +65,7 @@ KDirTreeView::KDirTreeView( QWidget * parent )
     _readJobsCol	= -1;
 #endif
     setRootIsDecorated( false );
+    setSelectionMode( Extended );	// Cleanups can work on many items at once
 
     int numCol = 0;
     addColumn( i18n( "Name"			) ); _nameCol		= numCol;
@@ -77,6 +79,8 @@ KDirTreeView::KDirTreeView( QWidget * parent )
     addColumn( i18n( "Files"			) ); _totalFilesCol	= numCol++;
     addColumn( i18n( "Subdirs"			) ); _totalSubDirsCol	= numCol++;
     addColumn( i18n( "Last Change"		) ); _latestMtimeCol	= numCol++;
+    addColumn( i18n( "Older than 1 Year"	) ); _coldSizeCol	= numCol++;
+    addColumn( i18n( "Filtered Size"		) ); _filteredSizeCol	= numCol++;
 
 #if ! SEPARATE_READ_JOBS_COL
     _readJobsCol = _percentBarCol;
@@ -88,6 +92,8 @@ KDirTreeView::KDirTreeView( QWidget * parent )
     setColumnAlignment ( _totalItemsCol,	AlignRight );
     setColumnAlignment ( _totalFilesCol,	AlignRight );
     setColumnAlignment ( _totalSubDirsCol,	AlignRight );
+    setColumnAlignment ( _coldSizeCol,		AlignRight );
+    setColumnAlignment ( _filteredSizeCol,	AlignRight );
     setColumnAlignment ( _readJobsCol,		AlignRight );
 
 
@@ -120,8 +126,11 @@ KDirTreeView::KDirTreeView( QWidget * parent )
     connect( kapp,	SIGNAL( kdisplayPaletteChanged()	),
 	     this,	SLOT  ( paletteChanged()		) );
 
-    connect( this,	SIGNAL( selectionChanged	( QListViewItem * ) ),
-	     this,	SLOT  ( selectItem		( QListViewItem * ) ) );
+    connect( this,	SIGNAL( currentChanged		( QListViewItem * ) ),
+	     this,	SLOT  ( currentItemChanged	( QListViewItem * ) ) );
+
+    connect( this,	SIGNAL( selectionChanged	() ),
+	     this,	SLOT  ( pushSelectedItems	() ) );
 
     connect( this,	SIGNAL( rightButtonPressed	( QListViewItem *, const QPoint &, int ) ),
 	     this,	SLOT  ( popupContextMenu	( QListViewItem *, const QPoint &, int ) ) );
@@ -264,11 +273,32 @@ KDirTreeView::createTree()
     connect( _tree, SIGNAL( finalizeLocal( KDirInfo * ) ),
 	     this,  SLOT  ( finalizeLocal( KDirInfo * ) ) );
 
+    // The item texts are formatted on demand, so a repaint is all it takes
+    // to show the recalculated summaries.
+
+    connect( _tree, SIGNAL( recalcFinished() ),
+	     this,  SLOT  ( triggerUpdate()  ) );
+
+    connect( _tree, SIGNAL( filterFinished() ),
+	     this,  SLOT  ( triggerUpdate()  ) );
+
+    // Files that changed in place don't add or delete any list view items,
+    // and a quick recalc doesn't send recalcFinished().
+
+    connect( _tree, SIGNAL( childDeleted()   ),
+	     this,  SLOT  ( triggerUpdate()  ) );
+
     connect( this,  SIGNAL( selectionChanged( KFileInfo * ) ),
 	     _tree, SLOT  ( selectItem      ( KFileInfo * ) ) );
 
     connect( _tree, SIGNAL( selectionChanged( KFileInfo * ) ),
 	     this,  SLOT  ( selectItem      ( KFileInfo * ) ) );
+
+    connect( _tree, SIGNAL( selectedItemsChanged() ),
+	     this,  SLOT  ( syncSelectedItems()	   ) );
+
+    connect( _tree, SIGNAL( pendingRefreshChanged() ),
+	     this,  SLOT  ( triggerUpdate()	    ) );
 }
 
 
@@ -442,6 +472,8 @@ KDirTreeView::deleteChild( KFileInfo *child )
 	    parent = parent->parent();
 	}
 
+	triggerUpdate();
+
 	if ( nextSelection )
 	    selectItem( nextSelection );
     }
@@ -458,6 +490,11 @@ KDirTreeView::updateSummary()
 	child->updateSummary();
 	child = child->next();
     }
+
+    // Repaint the visible items - their texts are taken from the original
+    // tree while painting.
+
+    triggerUpdate();
 }
 
 
@@ -596,7 +633,16 @@ KDirTreeView::selectItem( QListViewItem *listViewItem )
     if ( _selection )
     {
 	// kdDebug() << k_funcinfo << " Selecting item " << _selection << endl;
+
+	// Select this item only
+
+	_syncingSelection = true;
+	QListView::clearSelection();
 	setSelected( _selection, true );
+	setCurrentItem( _selection );
+	_syncingSelection = false;
+
+	pushSelectedItems();
     }
     else
     {
@@ -610,6 +656,79 @@ KDirTreeView::selectItem( QListViewItem *listViewItem )
 }
 
 
+void
+KDirTreeView::currentItemChanged( QListViewItem *listViewItem )
+{
+    if ( _syncingSelection )
+	return;
+
+    _selection = dynamic_cast<KDirTreeViewItem *>( listViewItem );
+
+    // The list view takes care of selecting and deselecting items with
+    // Ctrl and Shift - don't interfere with that while the tree sends the
+    // new selection back.
+
+    _syncingSelection = true;
+    emit selectionChanged( _selection );
+    emit selectionChanged( _selection ? _selection->orig() : (KFileInfo *) 0 );
+    _syncingSelection = false;
+
+    // The tree selects just the new current item if it was not selected
+    // before - but this view knows better.
+
+    pushSelectedItems();
+}
+
+
+void
+KDirTreeView::pushSelectedItems()
+{
+    if ( _syncingSelection || ! _tree )
+	return;
+
+    QPtrList<KFileInfo> items;
+    QListViewItemIterator it( this, QListViewItemIterator::Selected );
+
+    while ( it.current() )
+    {
+	KDirTreeViewItem * item = dynamic_cast<KDirTreeViewItem *>( it.current() );
+
+	if ( item && item->orig() )
+	    items.append( item->orig() );
+
+	++it;
+    }
+
+    _syncingSelection = true;
+    _tree->setSelectedItems( items );
+    _syncingSelection = false;
+}
+
+
+void
+KDirTreeView::syncSelectedItems()
+{
+    if ( _syncingSelection || ! _tree )
+	return;
+
+    _syncingSelection = true;
+    QListView::clearSelection();
+
+    QPtrListIterator<KFileInfo> it( _tree->selectedItems() );
+
+    for ( ; *it; ++it )
+    {
+	KDirTreeViewItem * clone = locate( *it,
+					   false,	// lazy
+					   true );	// doClone
+	if ( clone )
+	    setSelected( clone, true );
+    }
+
+    _syncingSelection = false;
+}
+
+
 void
 KDirTreeView::selectItem( KFileInfo *newSelection )
 {
@@ -632,7 +751,13 @@ KDirTreeView::selectItem( KFileInfo *newSelection )
 	    _selection->setOpen( false );
 	    ensureItemVisible( _selection );
 	    emit selectionChanged( _selection );
+
+	    // The tree sends its selected items separately.
+
+	    _syncingSelection = true;
+	    setCurrentItem( _selection );
 	    setSelected( _selection, true );
+	    _syncingSelection = false;
 	}
 	else
 	    kdError() << "Couldn't clone item " << newSelection << endl;
@@ -829,8 +954,13 @@ KDirTreeView::popupContextMenu( QListViewItem *	listViewItem,
 	    // Make the item the context menu is popping up over the current
 	    // selection - all user operations refer to the current selection.
 	    // Just right-clicking on an item does not make it the current
-	    // item!
-	    selectItem( item );
+	    // item! If it is one of several selected items, keep the others
+	    // selected so cleanups can work on all of them.
+
+	    if ( item->isSelected() )
+		setCurrentItem( item );
+	    else
+		selectItem( item );
 
 	    // Let somebody from outside pop up the context menu, if so desired.
 	    emit contextMenu( item, pos );
@@ -887,6 +1017,37 @@ KDirTreeView::popupContextMenu( QListViewItem *	listViewItem,
 	popupContextInfo( pos, formatTimeDate( item->orig()->latestMtime() ) );
     }
 
+
+    // Show the complete age histogram in the "cold data" column.
+
+    if ( column == _coldSizeCol )
+    {
+	KFileInfo * orig = item->orig();
+	QString	    text;
+
+	for ( int bucket=0; bucket < KAgeBuckets; bucket++ )
+	{
+	    if ( ! text.isEmpty() )
+		text += "\n";
+
+	    text += i18n( "%1: %2" )
+		.arg( ageBucketName( bucket ) )
+		.arg( formatSize( orig->totalAgeSize( bucket ) ) );
+	}
+
+	popupContextInfo( pos, text );
+    }
+
+
+    // Show what the filter is and how many files it accepts.
+
+    if ( column == _filteredSizeCol && _tree->fileFilter() )
+    {
+	popupContextInfo( pos, i18n( "%1\n%2 files" )
+			  .arg( _tree->fileFilter()->description() )
+			  .arg( formatCount( item->orig()->totalFilteredFiles() ) ) );
+    }
+
     logActivity( 3 );
 }
 
@@ -1007,7 +1168,12 @@ KDirTreeView::sendMailToOwner()
 	return;
     }
 
-    QString owner = KioDirReadJob::owner( fixedUrl( _selection->orig()->url() ) );
+    // Use the owner recorded while reading if there is one; this saves a
+    // (possibly remote) stat() call.
+
+    KFileInfo * orig  = _selection->orig();
+    QString     owner = orig->hasOwner() ?
+	KOwnerTable::userName( orig->uid() ) : KioDirReadJob::owner( fixedUrl( orig->url() ) );
     QString subject = i18n( "Disk Usage" );
     QString body =
 	i18n("Please check your disk usage and clean up if you can. Thank you." )
@@ -1068,70 +1234,22 @@ KDirTreeViewItem::init( KDirTreeView *		view,
     _view 	= view;
     _parent	= parent;
     _orig	= orig;
-    _percent	= 0.0;
     _pacMan	= 0;
     _openCount	= 0;
 
     // _view->incDebugCount(1);
     // kdDebug() << "new KDirTreeViewItem for " << orig << endl;
 
+    // All column texts and icons are taken from the original tree only when
+    // they are needed for display (see text() and pixmap()), so there is no
+    // per-column data to set up here.
+
     if ( _orig->isDotEntry() )
     {
-       setText( view->nameCol(), i18n( "<Files>" ) );
        QListViewItem::setOpen ( false );
     }
     else
     {
-	setText( view->nameCol(), QString::fromLocal8Bit(_orig->name()) );
-
-	if ( ! _orig->isDevice() )
-	{
-	    QString text;
-
-	    if ( _orig->isFile() && ( _orig->links() > 1 ) ) // Regular file with multiple links
-	    {
-		if ( _orig->isSparseFile() )
-		{
-		    text = i18n( "%1 / %2 Links (allocated: %3)" )
-			.arg( formatSize( _orig->byteSize() ) )
-			.arg( formatSize( _orig->links() ) )
-			.arg( formatSize( _orig->allocatedSize() ) );
-		}
-		else
-		{
-		    text = i18n( "%1 / %2 Links" )
-			.arg( formatSize( _orig->byteSize() ) )
-			.arg( _orig->links() );
-		}
-	    }
-	    else // No multiple links or no regular file
-	    {
-		if ( _orig->isSparseFile() )
-		{
-		    text = i18n( "%1 (allocated: %2)" )
-			.arg( formatSize( _orig->byteSize() ) )
-			.arg( formatSize( _orig->allocatedSize() ) );
-		}
-		else
-		{
-		    text = formatSize( _orig->size() );
-		}
-	    }
-
-	    setText( view->ownSizeCol(), text );
-
-#ifdef NEVER_EXECUTED
-	    // Never executed because during init() a read job for this
-	    // directory will still be pending. Only the read job will figure
-	    // out if an exclude rule applies.
-
-	    if ( _orig->isExcluded() )
-	    {
-		setText( _view->percentBarCol(), i18n( "[excluded]" ) );
-	    }
-#endif
-	}
-
 	QListViewItem::setOpen ( _orig->treeLevel() < _view->openLevel() );
 	/*
 	 * Don't use KDirTreeViewItem::setOpen() here since this might call
@@ -1166,11 +1284,6 @@ KDirTreeViewItem::init( KDirTreeView *		view,
 	}
     }
 
-    if ( ! parent || parent->isOpen() )
-    {
-	setIcon();
-    }
-
     _openCount = isOpen() ? 1 : 0;
 }
 
@@ -1185,57 +1298,119 @@ KDirTreeViewItem::~KDirTreeViewItem()
 }
 
 
-void
-KDirTreeViewItem::setIcon()
+const QPixmap *
+KDirTreeViewItem::icon() const
 {
-    QPixmap icon;
-
     if ( _orig->isDotEntry() )
     {
-	icon = isOpen() ? _view->openDotEntryIcon() : _view->closedDotEntryIcon();
+	return isOpen() ? &_view->openDotEntryIcon() : &_view->closedDotEntryIcon();
     }
     else if ( _orig->isDir() )
     {
-	if  ( _orig->readState() == KDirAborted )
-	{
-	    icon = _view->stopIcon();
-	}
-	else if ( _orig->readState() == KDirError   )
+	if  ( _orig->readState() == KDirAborted )	return &_view->stopIcon();
+	if  ( _orig->readState() == KDirError   )	return &_view->unreadableDirIcon();
+	if  ( _orig->isMountPoint() )			return &_view->mountPointIcon();
+
+	return isOpen() ? &_view->openDirIcon() : &_view->closedDirIcon();
+    }
+    else if ( _orig->isFile() 		)	return &_view->fileIcon();
+    else if ( _orig->isSymLink() 	)	return &_view->symLinkIcon();
+    else if ( _orig->isBlockDevice() 	)	return &_view->blockDevIcon();
+    else if ( _orig->isCharDevice() 	)	return &_view->charDevIcon();
+    else if ( _orig->isSpecial() 	)	return &_view->fifoIcon();
+
+    return 0;
+}
+
+
+const QPixmap *
+KDirTreeViewItem::pixmap( int column ) const
+{
+    if ( column == _view->iconCol() )
+	return icon();
+
+    return 0;
+}
+
+
+QString
+KDirTreeViewItem::text( int column ) const
+{
+    if ( column == _view->nameCol() )
+    {
+	if ( _orig->isDotEntry() )
+	    return i18n( "<Files>" );
+	else
+	    return QString::fromLocal8Bit( _orig->name() );
+    }
+
+    if ( column == _view->latestMtimeCol() )
+    {
+	if ( _orig->latestMtime() == 0 )	// Unknown, e.g. for directories excluded by name
+	    return QString::null;
+
+	return "  " + localeTimeDate( _orig->latestMtime() );
+    }
+
+    if ( column == _view->filteredSizeCol() )
+    {
+	if ( ! _view->tree()->fileFilter() )
+	    return QString::null;
+
+	return " " + formatSize( _orig->totalFilteredSize() );
+    }
+
+    if ( column == _view->ownSizeCol() )
+    {
+	if ( _orig->isDotEntry() || _orig->isDevice() )
+	    return QString::null;
+
+	if ( _orig->isFile() && ( _orig->links() > 1 ) ) // Regular file with multiple links
 	{
-	    icon = _view->unreadableDirIcon();
-	    setExpandable( false );
+	    if ( _orig->isSparseFile() )
+	    {
+		return i18n( "%1 / %2 Links (allocated: %3)" )
+		    .arg( formatSize( _orig->byteSize() ) )
+		    .arg( formatSize( _orig->links() ) )
+		    .arg( formatSize( _orig->allocatedSize() ) );
+	    }
+	    else
+	    {
+		return i18n( "%1 / %2 Links" )
+		    .arg( formatSize( _orig->byteSize() ) )
+		    .arg( _orig->links() );
+	    }
 	}
-	else
+	else // No multiple links or no regular file
 	{
-	    if ( _orig->isMountPoint() )
+	    if ( _orig->isSparseFile() )
 	    {
-		icon = _view->mountPointIcon();
+		return i18n( "%1 (allocated: %2)" )
+		    .arg( formatSize( _orig->byteSize() ) )
+		    .arg( formatSize( _orig->allocatedSize() ) );
 	    }
 	    else
 	    {
-		icon = isOpen() ? _view->openDirIcon() : _view->closedDirIcon();
+		return formatSize( _orig->size() );
 	    }
 	}
     }
-    else if ( _orig->isFile() 		)	icon = _view->fileIcon();
-    else if ( _orig->isSymLink() 	)	icon = _view->symLinkIcon();
-    else if ( _orig->isBlockDevice() 	)	icon = _view->blockDevIcon();
-    else if ( _orig->isCharDevice() 	)	icon = _view->charDevIcon();
-    else if ( _orig->isSpecial() 	)	icon = _view->fifoIcon();
 
-    setPixmap( _view->iconCol(), icon );
-}
+    if ( column == _view->percentNumCol() )
+    {
+	float pct = percent();
 
+	return pct > 0.0 ? formatPercent( pct ) : QString::null;
+    }
 
-void
-KDirTreeViewItem::updateSummary()
-{
-    // _view->incDebugCount(2);
+    if ( column == _view->percentBarCol() && _orig->tree()->isRefreshPending( _orig ) )
+	return i18n( "[refresh pending]" );
 
-    // Update this item
+    if ( _orig->isDir() && _orig->isExcluded() && column == _view->percentBarCol() )
+	return i18n( "[excluded]" );
 
-    setIcon();
-    setText( _view->latestMtimeCol(),		"  " + localeTimeDate( _orig->latestMtime() ) );
+    if ( _orig->isDir() && column == _view->totalSubDirsCol() )
+	return " " + formatCount( _orig->totalSubDirs() );
 
     if ( _orig->isDir() || _orig->isDotEntry() )
     {
@@ -1244,53 +1419,57 @@ KDirTreeViewItem::updateSummary()
 	if ( _orig->readState() == KDirAborted )
 	    prefix = " >";
 
-	setText( _view->totalSizeCol(),		prefix + formatSize(  _orig->totalSize()	) );
-	setText( _view->totalItemsCol(),	prefix + formatCount( _orig->totalItems()	) );
-	setText( _view->totalFilesCol(),	prefix + formatCount( _orig->totalFiles()	) );
+	if ( column == _view->totalSizeCol()  )	return prefix + formatSize(  _orig->totalSize()  );
+	if ( column == _view->totalItemsCol() )	return prefix + formatCount( _orig->totalItems() );
+	if ( column == _view->totalFilesCol() )	return prefix + formatCount( _orig->totalFiles() );
+	if ( column == _view->coldSizeCol()   )	return prefix + formatSize(  _orig->totalColdSize() );
 
-	if ( _view->readJobsCol() >= 0 )
+	if ( column == _view->readJobsCol() )
 	{
 #if SEPARATE_READ_JOBS_COL
-	    setText( _view->readJobsCol(),	" " + formatCount( _orig->pendingReadJobs(), true ) );
+	    return " " + formatCount( _orig->pendingReadJobs(), true );
 #else
-	    int jobs 		= _orig->pendingReadJobs();
-	    QString text	= "";
+	    int jobs = _orig->pendingReadJobs();
 
 	    if ( jobs > 0 )
-	    {
-		text = i18n( "[%1 Read Jobs]" ).arg( formatCount( _orig->pendingReadJobs(), true ) );
-	    }
-
-	    setText( _view->readJobsCol(), text );
+		return i18n( "[%1 Read Jobs]" ).arg( formatCount( jobs, true ) );
 #endif
 	}
     }
 
-    if ( _orig->isDir() )
-    {
-	setText( _view->totalSubDirsCol(),	" " + formatCount( _orig->totalSubDirs() ) );
-
-	if ( _orig->isExcluded() )
-	    setText( _view->percentBarCol(),	i18n( "[excluded]" ) );
-    }
-
+    return QString::null;
+}
 
-    // Calculate and display percentage
 
+float
+KDirTreeViewItem::percent() const
+{
     if ( _orig->parent() &&				// only if there is a parent as calculation base
 	 _orig->parent()->pendingReadJobs() < 1	&&	// not before subtree is finished reading
 	 _orig->parent()->totalSize() > 0 &&		// avoid division by zero
 	 ! _orig->isExcluded() )			// not if this is an excluded object (dir)
     {
-	 _percent = ( 100.0 * _orig->totalSize() ) / (float) _orig->parent()->totalSize();
-	 setText( _view->percentNumCol(), formatPercent ( _percent ) );
-    }
-    else
-    {
-	_percent = 0.0;
-	setText( _view->percentNumCol(), "" );
+	 return ( 100.0 * _orig->totalSize() ) / (float) _orig->parent()->totalSize();
     }
 
+    return 0.0;
+}
+
+
+void
+KDirTreeViewItem::updateSummary()
+{
+    // _view->incDebugCount(2);
+
+    // Update this item.
+    //
+    // The texts and icons don't need any updating: They are taken from the
+    // original tree each time this item is painted. The view takes care of
+    // repainting the visible items.
+
+    if ( _orig->isDir() && _orig->readState() == KDirError )
+	setExpandable( false );
+
     if ( _view->doPacManAnimation() && _orig->isBusy() )
     {
 	if ( ! _pacMan )
@@ -1304,13 +1483,17 @@ KDirTreeViewItem::updateSummary()
 	return;		// -> don't update them.
 
 
-    // Update all children
+    // Update all children that might have children of their own. Plain
+    // files don't have anything to update - no matter how many of them
+    // there are.
 
     KDirTreeViewItem *child = firstChild();
 
     while ( child )
     {
-	child->updateSummary();
+	if ( child->orig()->isDirInfo() )
+	    child->updateSummary();
+
 	child = child->next();
     }
 }
@@ -1540,7 +1723,6 @@ KDirTreeViewItem::setOpen( bool open )
     }
 
     QListViewItem::setOpen( open );
-    setIcon();
 
     if ( open )
 	updateSummary();
@@ -1671,6 +1853,8 @@ KDirTreeViewItem::compare( QListViewItem *	otherListViewItem,
 	else if ( column == _view->totalFilesCol() )	return - compare( _orig->totalFiles(), 	 otherOrig->totalFiles()   );
 	else if ( column == _view->totalSubDirsCol() )	return - compare( _orig->totalSubDirs(), otherOrig->totalSubDirs() );
 	else if ( column == _view->latestMtimeCol() )	return - compare( _orig->latestMtime(),	 otherOrig->latestMtime()  );
+	else if ( column == _view->coldSizeCol() )	return - compare( _orig->totalColdSize(), otherOrig->totalColdSize() );
+	else if ( column == _view->filteredSizeCol() )	return - compare( _orig->totalFilteredSize(), otherOrig->totalFilteredSize() );
 	else
 	{
 	    if ( _orig->isDotEntry() )	// make sure dot entries are last in the list
@@ -1698,7 +1882,19 @@ KDirTreeViewItem::paintCell( QPainter *			painter,
     {
 	painter->setBackgroundColor( colorGroup.base() );
 
-	if ( _percent > 0.0 )
+	float pct = percent();
+
+	if ( _orig->tree()->isRefreshPending( _orig ) )
+	{
+	    // Show the text instead of the outdated percentage bar
+
+	    QListViewItem::paintCell( painter,
+				      colorGroup,
+				      column,
+				      width,
+				      alignment );
+	}
+	else if ( pct > 0.0 )
 	{
 	    if ( _pacMan )
 	    {
@@ -1707,7 +1903,7 @@ KDirTreeViewItem::paintCell( QPainter *			painter,
 	    }
 
 	    int level = _orig->treeLevel();
-	    paintPercentageBar ( _percent,
+	    paintPercentageBar ( pct,
 				 painter,
 				 _view->treeStepSize() * ( level-1 ),
 				 width,
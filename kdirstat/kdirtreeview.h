@@ -224,23 +224,25 @@ namespace KDirStat
 	int	totalFilesCol()		const	{ return _totalFilesCol;	}
 	int	totalSubDirsCol()	const	{ return _totalSubDirsCol;	}
 	int	latestMtimeCol()	const	{ return _latestMtimeCol;	}
+	int	coldSizeCol()		const	{ return _coldSizeCol;		}
+	int	filteredSizeCol()	const	{ return _filteredSizeCol;	}
 	int	readJobsCol()		const	{ return _readJobsCol;		}
 	int	sortCol()		const   { return _sortCol;		}
 
-	QPixmap	openDirIcon()		const	{ return _openDirIcon;		}
-	QPixmap	closedDirIcon()		const	{ return _closedDirIcon;	}
-	QPixmap	openDotEntryIcon()	const	{ return _openDotEntryIcon;	}
-	QPixmap	closedDotEntryIcon()	const	{ return _closedDotEntryIcon;	}
-	QPixmap	unreadableDirIcon()	const	{ return _unreadableDirIcon;	}
-	QPixmap mountPointIcon()	const	{ return _mountPointIcon;	}
-	QPixmap	fileIcon()		const	{ return _fileIcon;		}
-	QPixmap	symLinkIcon()		const	{ return _symLinkIcon;		}
-	QPixmap blockDevIcon()		const 	{ return _blockDevIcon;		}
-	QPixmap charDevIcon()		const 	{ return _charDevIcon;		}
-	QPixmap fifoIcon()		const 	{ return _fifoIcon;		}
-	QPixmap stopIcon()		const 	{ return _stopIcon;		}
-	QPixmap	workingIcon()		const	{ return _workingIcon;		}
-	QPixmap	readyIcon()		const	{ return _readyIcon;		}
+	const QPixmap &	openDirIcon()		const	{ return _openDirIcon;		}
+	const QPixmap &	closedDirIcon()		const	{ return _closedDirIcon;	}
+	const QPixmap &	openDotEntryIcon()	const	{ return _openDotEntryIcon;	}
+	const QPixmap &	closedDotEntryIcon()	const	{ return _closedDotEntryIcon;	}
+	const QPixmap &	unreadableDirIcon()	const	{ return _unreadableDirIcon;	}
+	const QPixmap & mountPointIcon()	const	{ return _mountPointIcon;	}
+	const QPixmap &	fileIcon()		const	{ return _fileIcon;		}
+	const QPixmap &	symLinkIcon()		const	{ return _symLinkIcon;		}
+	const QPixmap & blockDevIcon()		const 	{ return _blockDevIcon;		}
+	const QPixmap & charDevIcon()		const 	{ return _charDevIcon;		}
+	const QPixmap & fifoIcon()		const 	{ return _fifoIcon;		}
+	const QPixmap & stopIcon()		const 	{ return _stopIcon;		}
+	const QPixmap &	workingIcon()		const	{ return _workingIcon;		}
+	const QPixmap &	readyIcon()		const	{ return _readyIcon;		}
 
 
 	/**
@@ -458,6 +460,25 @@ namespace KDirStat
 	 **/
         void columnResized( int column, int oldSize, int newSize );
 
+	/**
+	 * Notification that the current item of the list view changed,
+	 * i.e. the user clicked on an item or moved there with the keyboard.
+	 * Triggers selectionChanged() signals.
+	 **/
+	void	currentItemChanged( QListViewItem * listViewItem );
+
+	/**
+	 * Tell the tree about all items that are selected in this view
+	 * (see @ref KDirTree::setSelectedItems() ).
+	 **/
+	void	pushSelectedItems();
+
+	/**
+	 * Select exactly the tree's selected items in this view. Used for
+	 * connecting the @ref KDirTree::selectedItemsChanged() signal.
+	 **/
+	void	syncSelectedItems();
+
 
     signals:
 
@@ -534,6 +555,7 @@ namespace KDirStat
 	QTime			_stopWatch;
 	QString			_currentDir;
 	KDirTreeViewItem *	_selection;
+	bool			_syncingSelection;
 	QPopupMenu *		_contextInfo;
 	int			_idContextInfo;
 
@@ -560,6 +582,8 @@ namespace KDirStat
 	int	_totalFilesCol;
 	int	_totalSubDirsCol;
 	int	_latestMtimeCol;
+	int	_coldSizeCol;
+	int	_filteredSizeCol;
 	int	_readJobsCol;
 	int	_sortCol;
 
@@ -692,6 +716,33 @@ namespace KDirStat
 			     int		col,
 			     bool		ascending ) const;
 
+	/**
+	 * Returns the text for column 'column'.
+	 *
+	 * The texts are not stored in the item, they are formatted from the
+	 * original tree each time they are needed. This way, an item only
+	 * costs memory for the QListViewItem itself, and updating the
+	 * display after the original tree changed doesn't need to touch any
+	 * items that are not visible.
+	 *
+	 * Reimplemented from @ref QListViewItem.
+	 **/
+	virtual QString text( int column ) const;
+
+	/**
+	 * Returns the icon for column 'column' (if any).
+	 * Like text(), this is not stored in the item.
+	 *
+	 * Reimplemented from @ref QListViewItem.
+	 **/
+	virtual const QPixmap * pixmap( int column ) const;
+
+	/**
+	 * Returns this item's percentage of its parent's total size or 0.0 if
+	 * that is not known (yet).
+	 **/
+	float percent() const;
+
 	/**
 	 * Perform any necessary pending updates when a branch is opened.
 	 * Reimplemented from @ref QListViewItem.
@@ -734,10 +785,10 @@ namespace KDirStat
     protected:
 
 	/**
-	 * Set the appropriate icon depending on this item's type and open /
+	 * Returns the appropriate icon depending on this item's type and open /
 	 * closed state.
 	 **/
-	void	setIcon();
+	const QPixmap * icon() const;
 
 	/**
 	 * Remove dot entry if it doesn't have any children.
@@ -810,7 +861,6 @@ namespace KDirStat
 	KDirTreeViewItem *	_parent;
 	KFileInfo *		_orig;
 	KPacManAnimation *	_pacMan;
-	float			_percent;
 	int			_openCount;
 
     };
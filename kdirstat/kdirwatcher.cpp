@@ -0,0 +1,486 @@
+/*
+ *   File name:	kdirwatcher.cpp
+ *   Summary:	Support classes for KDirStat - live updates of local trees
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+#   include <sys/inotify.h>
+#endif
+
+#include <qdict.h>
+#include <qsocketnotifier.h>
+#include <qvaluevector.h>
+#include <kdebug.h>
+
+#include "kdirwatcher.h"
+#include "kdirtree.h"
+#include "kdirtreeiterators.h"
+#include "kexcluderules.h"
+
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+// Everything that changes the entries of a directory or their sizes. Changes
+// of the watched directory itself are not interesting: The watch of its
+// parent takes care of those.
+
+#   ifdef IN_EXCL_UNLINK
+#	define WatchMask	( IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+				  IN_MODIFY | IN_ATTRIB | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK )
+#   else
+#	define WatchMask	( IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+				  IN_MODIFY | IN_ATTRIB | IN_ONLYDIR | IN_DONT_FOLLOW )
+#   endif
+
+#endif
+
+
+using namespace KDirStat;
+
+
+KDirWatcher::KDirWatcher( KDirTree * tree )
+    : QObject()
+    , _tree( tree )
+    , _fd( -1 )
+    , _notifier( 0 )
+    , _overflow( false )
+    , _limitReached( false )
+{
+    _pending.setAutoDelete( true );
+
+#ifdef HAVE_SYS_INOTIFY_H
+    _fd = inotify_init();
+
+    if ( _fd < 0 )
+    {
+	kdWarning() << "inotify_init() failed: " << strerror( errno ) << endl;
+    }
+    else
+    {
+	fcntl( _fd, F_SETFL, O_NONBLOCK );
+	fcntl( _fd, F_SETFD, FD_CLOEXEC );
+
+	_notifier = new QSocketNotifier( _fd, QSocketNotifier::Read, this );
+	CHECK_PTR( _notifier );
+
+	connect( _notifier,	SIGNAL( activated( int ) ),
+		 this,		SLOT  ( readEvents()	 ) );
+    }
+#endif
+
+    connect( &_timer,	SIGNAL( timeout()	),
+	     this,	SLOT  ( applyChanges()	) );
+
+    connect( _tree,	SIGNAL( finalizeLocal( KDirInfo * ) ),
+	     this,	SLOT  ( finalizeLocal( KDirInfo * ) ) );
+
+    connect( _tree,	SIGNAL( deletingChild( KFileInfo * ) ),
+	     this,	SLOT  ( deletingChild( KFileInfo * ) ) );
+}
+
+
+KDirWatcher::~KDirWatcher()
+{
+    clear();
+
+    if ( _notifier )
+	delete _notifier;
+
+    if ( _fd >= 0 )
+	::close( _fd );
+}
+
+
+void
+KDirWatcher::watchSubtree( KFileInfo * subtree )
+{
+    if ( ! ok() || ! subtree || ! subtree->isDirInfo() )
+	return;
+
+    // No recursion: Trees may be deep.
+
+    QValueVector<KDirInfo *> stack;
+    stack.push_back( (KDirInfo *) subtree );
+
+    while ( ! stack.isEmpty() && ! _limitReached )
+    {
+	KDirInfo * dir = stack.back();
+	stack.pop_back();
+
+	if ( dir->readState() == KDirFinished || dir->readState() == KDirCached )
+	    watch( dir );
+
+	for ( KFileInfo * child = dir->firstChild(); child; child = child->next() )
+	{
+	    if ( child->isDirInfo() && ! child->isDotEntry() )
+		stack.push_back( (KDirInfo *) child );
+	}
+    }
+}
+
+
+void
+KDirWatcher::clear()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    QMap<int, KDirInfo *>::Iterator it = _dirs.begin();
+
+    while ( it != _dirs.end() )
+    {
+	inotify_rm_watch( _fd, it.key() );
+	++it;
+    }
+#endif
+
+    _dirs.clear();
+    _watches.clear();
+    _pending.clear();
+    _timer.stop();
+    _overflow	  = false;
+    _limitReached = false;
+}
+
+
+void
+KDirWatcher::watch( KDirInfo * dir )
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    if ( ! ok() || _limitReached || _watches.contains( dir ) )
+	return;
+
+    QString	 dirName = dir->url();
+    const char * path	 = dirName;
+    int		 wd	 = inotify_add_watch( _fd, path, WatchMask );
+
+    if ( wd < 0 )
+    {
+	if ( errno == ENOSPC )
+	{
+	    _limitReached = true;
+
+	    kdWarning() << "inotify watch limit reached after " << _dirs.count()
+			<< " directories - see /proc/sys/fs/inotify/max_user_watches" << endl;
+	}
+
+	return;
+    }
+
+    // The same directory might be reachable under another name that is
+    // already watched (bind mounts). inotify hands out the same watch
+    // descriptor then; the newer one wins.
+
+    if ( _dirs.contains( wd ) )
+	_watches.remove( _dirs[ wd ] );
+
+    _dirs[ wd ]	   = dir;
+    _watches[ dir ] = wd;
+#else
+    NOT_USED( dir );
+#endif
+}
+
+
+void
+KDirWatcher::unwatch( KDirInfo * dir )
+{
+    _pending.remove( dir );
+
+    QMap<KDirInfo *, int>::Iterator it = _watches.find( dir );
+
+    if ( it == _watches.end() )
+	return;
+
+#ifdef HAVE_SYS_INOTIFY_H
+    inotify_rm_watch( _fd, it.data() );
+#endif
+
+    _dirs.remove( it.data() );
+    _watches.remove( it );
+}
+
+
+void
+KDirWatcher::finalizeLocal( KDirInfo * dir )
+{
+    if ( dir && ! dir->isDotEntry() &&
+	 ( dir->readState() == KDirFinished || dir->readState() == KDirCached ) )
+    {
+	watch( dir );
+    }
+}
+
+
+void
+KDirWatcher::deletingChild( KFileInfo * subtree )
+{
+    if ( ( _watches.isEmpty() && _pending.isEmpty() ) || ! subtree->isDirInfo() )
+	return;
+
+    if ( subtree == _tree->root() )
+    {
+	clear();
+	return;
+    }
+
+    QValueVector<KDirInfo *> stack;
+    stack.push_back( (KDirInfo *) subtree );
+
+    while ( ! stack.isEmpty() )
+    {
+	KDirInfo * dir = stack.back();
+	stack.pop_back();
+	unwatch( dir );
+
+	for ( KFileInfo * child = dir->firstChild(); child; child = child->next() )
+	{
+	    if ( child->isDirInfo() && ! child->isDotEntry() )
+		stack.push_back( (KDirInfo *) child );
+	}
+    }
+}
+
+
+void
+KDirWatcher::readEvents()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    long    buffer[ 4096 ];	// long for the alignment of struct inotify_event
+    ssize_t len;
+
+    while ( ( len = ::read( _fd, buffer, sizeof( buffer ) ) ) > 0 )
+    {
+	char * start = (char *) buffer;
+	char * ptr   = start;
+
+	while ( ptr < start + len )
+	{
+	    struct inotify_event * event = (struct inotify_event *) ptr;
+	    ptr += sizeof( struct inotify_event ) + event->len;
+
+	    if ( event->mask & IN_Q_OVERFLOW )
+	    {
+		_overflow = true;
+		continue;
+	    }
+
+	    QMap<int, KDirInfo *>::Iterator it = _dirs.find( event->wd );
+
+	    if ( it == _dirs.end() )	// Removed meanwhile
+		continue;
+
+	    KDirInfo * dir = it.data();
+
+	    if ( event->mask & IN_IGNORED )
+	    {
+		// The kernel removed the watch: The directory is gone. Its
+		// parent gets an event for that.
+
+		_watches.remove( dir );
+		_dirs.remove( it );
+		continue;
+	    }
+
+	    if ( event->len == 0 )	// Event for the directory itself
+		continue;
+
+	    KDirChanges * changes = _pending.find( dir );
+
+	    if ( ! changes )
+	    {
+		changes = new KDirChanges();
+		_pending.insert( dir, changes );
+	    }
+
+	    QString name    = event->name;
+	    bool    removed = event->mask & ( IN_DELETE | IN_MOVED_FROM );
+
+	    // Never reset the "removed" flag from an earlier event
+
+	    if ( removed || ! changes->contains( name ) )
+		(*changes)[ name ] = removed;
+	}
+    }
+
+    if ( ( _overflow || ! _pending.isEmpty() ) && ! _timer.isActive() )
+	_timer.start( WatchCoalesceMillisec, true );	// single shot
+#endif
+}
+
+
+void
+KDirWatcher::applyChanges()
+{
+    if ( _tree->isBusy() )
+    {
+	// Reading might make the pending changes obsolete, but it might just
+	// as well be reading something completely different. Try again later.
+
+	_timer.start( WatchCoalesceMillisec, true );	// single shot
+	return;
+    }
+
+    if ( _overflow )
+    {
+	kdWarning() << "inotify event queue overflow - reading the entire tree again" << endl;
+
+	_overflow = false;
+	_pending.clear();
+	_tree->refresh( 0 );
+
+	return;
+    }
+
+    _tree->beginUpdate();
+
+    // Stop when a new directory needs to be read: Deleting anything while
+    // there are read jobs for it would be fatal, so the rest has to wait
+    // until reading is finished.
+
+    while ( ! _pending.isEmpty() && ! _tree->isBusy() )
+    {
+	QPtrDictIterator<KDirChanges> it( _pending );
+	KDirInfo *    dir     = (KDirInfo *) it.currentKey();
+	KDirChanges * changes = _pending.take( dir );
+
+	applyChanges( dir, *changes );
+	delete changes;
+    }
+
+    _tree->endUpdate();
+
+    if ( ! _pending.isEmpty() )
+	_timer.start( WatchCoalesceMillisec, true );	// single shot
+}
+
+
+void
+KDirWatcher::applyChanges( KDirInfo * dir, const KDirChanges & changes )
+{
+    // Index the existing entries by name - once for all changes in this
+    // directory.
+
+    int count = dir->childCount();
+
+    if ( dir->dotEntry() )
+	count += dir->dotEntry()->childCount();
+
+    QDict<KFileInfo> entries( 2 * count + 1 );
+
+    for ( KFileInfoIterator it( dir, KDotEntryTransparent ); *it; ++it )
+	entries.insert( (*it)->name(), *it );
+
+    QString dirName = dir->url();
+
+    for ( KDirChanges::ConstIterator it = changes.begin(); it != changes.end(); ++it )
+    {
+	QString	     name     = it.key();
+	QString	     fullName = dirName + "/" + name;
+	const char * path     = fullName;
+	KFileInfo *  old      = entries.find( name );
+	struct stat  statInfo;
+	bool	     exists   = lstat( path, &statInfo ) == 0;
+
+	if ( old && exists && ! old->isDirInfo() &&
+	     ( old->mode() & S_IFMT ) == ( statInfo.st_mode & S_IFMT ) )
+	{
+	    // Same kind of file system object: Just take over the new size,
+	    // mtime etc. - even if it was replaced by another one with the
+	    // same name. Deleting and inserting it again would make the views
+	    // lose their current item and selection and the tree rebuild the
+	    // summaries of all its ancestors from scratch.
+
+	    if ( it.data() || isOutdated( old, &statInfo ) )
+	    {
+		old->update( &statInfo );
+		_tree->itemChangedNotify( old );
+	    }
+
+	    continue;
+	}
+
+	if ( old && ( ! exists || it.data() || isOutdated( old, &statInfo ) ) )
+	{
+	    entries.remove( name );
+	    _tree->deleteSubtree( old );
+	    old = 0;
+	}
+
+	if ( exists && ! old )
+	    addEntry( dir, name, &statInfo );
+    }
+}
+
+
+void
+KDirWatcher::addEntry( KDirInfo *		dir,
+		       const QString &		name,
+		       struct stat *		statInfo )
+{
+    if ( ! S_ISDIR( statInfo->st_mode ) )
+    {
+	KFileInfo * child = new KFileInfo( name, statInfo, _tree, dir );
+	dir->insertChild( child );
+	_tree->childAddedNotify( child );
+
+	return;
+    }
+
+    KDirInfo * subDir = new KDirInfo( name, statInfo, _tree, dir );
+    dir->insertChild( subDir );
+    _tree->childAddedNotify( subDir );
+
+    QString dirName = subDir->url();
+    bool excluded = KExcludeRules::excludeRules()->matchName( name ) ||
+	KExcludeRules::excludeRules()->match( dirName );
+
+    if ( subDir->device() != dir->device() )
+	subDir->setMountPoint();
+
+    if ( excluded )
+	subDir->setExcluded();
+
+    if ( excluded || ( subDir->isMountPoint() && ! _tree->crossFileSystems() ) )
+    {
+	subDir->setReadState( KDirOnRequestOnly );
+	_tree->sendFinalizeLocal( subDir );
+	subDir->finalizeLocal();
+    }
+    else
+    {
+	_tree->readSubtree( subDir );
+    }
+}
+
+
+bool
+KDirWatcher::isOutdated( KFileInfo * item, struct stat * statInfo )
+{
+    if ( ( item->mode() & S_IFMT ) != ( statInfo->st_mode & S_IFMT ) )
+	return true;
+
+    if ( item->isDirInfo() )
+	return false;
+
+    return item->byteSize() != statInfo->st_size
+	|| item->blocks()   != statInfo->st_blocks
+	|| item->mtime()    != statInfo->st_mtime
+	|| item->links()    != statInfo->st_nlink;
+}
+
+
+
+// EOF
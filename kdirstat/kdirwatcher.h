@@ -0,0 +1,196 @@
+/*
+ *   File name:	kdirwatcher.h
+ *   Summary:	Support classes for KDirStat - live updates of local trees
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KDirWatcher_h
+#define KDirWatcher_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <qobject.h>
+#include <qtimer.h>
+#include <qmap.h>
+#include <qptrdict.h>
+
+
+// Milliseconds to wait after the first change in a watched directory before
+// the tree is updated. All changes that come in meanwhile are applied in one
+// go, so a "make" or "tar xf" in a watched directory doesn't cause a tree
+// update for every single file.
+
+#define WatchCoalesceMillisec	1000
+
+
+class QSocketNotifier;
+
+
+namespace KDirStat
+{
+    // Forward declarations
+    class KFileInfo;
+    class KDirInfo;
+    class KDirTree;
+
+
+    /**
+     * Names of changed entries in one directory. The value is 'true' if the
+     * entry was removed or renamed at some point, i.e. if whatever is there
+     * now is not the same file system object any more even if it looks the
+     * same.
+     **/
+    typedef QMap<QString, bool> KDirChanges;
+
+
+    /**
+     * Live updates of a local directory tree after it was read: Watches all
+     * directories of a @ref KDirTree with the kernel's inotify facility and
+     * applies the changes to the tree - new entries are added (new
+     * directories are read), vanished ones are deleted, and entries that
+     * changed size or type are replaced. The totals, the filtered totals and
+     * all views are updated just like after a cleanup.
+     *
+     * Changes are not applied immediately: They are collected per directory
+     * for @ref WatchCoalesceMillisec, and then each changed directory entry
+     * is checked once with lstat(), no matter how many events there were for
+     * it. While the tree is busy reading, changes are deferred until it is
+     * done.
+     *
+     * If the kernel loses events (its event queue overflowed), the entire
+     * tree is read again.
+     *
+     * Normally, this is used only through @ref KDirTree::setWatchForChanges().
+     * Without inotify support on the build system, this does nothing, and
+     * @ref ok() returns 'false'.
+     *
+     * @short Live updates of a local directory tree
+     **/
+    class KDirWatcher: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KDirWatcher( KDirTree * tree );
+
+	/**
+	 * Destructor. Removes all watches.
+	 **/
+	virtual ~KDirWatcher();
+
+	/**
+	 * Returns 'true' if watching is possible at all.
+	 **/
+	bool ok() const { return _fd >= 0; }
+
+	/**
+	 * Watch all directories in 'subtree' that are completely read.
+	 * Directories that are read later are watched automatically.
+	 **/
+	void watchSubtree( KFileInfo * subtree );
+
+	/**
+	 * Remove all watches and forget all pending changes. Use this before
+	 * the tree is cleared without any signals.
+	 **/
+	void clear();
+
+	/**
+	 * Returns the number of watched directories.
+	 **/
+	int watchCount() const { return (int) _dirs.count(); }
+
+
+    protected slots:
+
+	/**
+	 * Read all events that are available from the inotify file
+	 * descriptor and remember the changed directory entries.
+	 **/
+	void readEvents();
+
+	/**
+	 * Apply all pending changes to the tree.
+	 **/
+	void applyChanges();
+
+	/**
+	 * Notification that a directory is read: Watch it if reading was OK.
+	 **/
+	void finalizeLocal( KDirInfo * dir );
+
+	/**
+	 * Notification that a subtree is about to be deleted: Remove the
+	 * watches for all directories in it.
+	 **/
+	void deletingChild( KFileInfo * subtree );
+
+
+    protected:
+
+	/**
+	 * Watch 'dir'. Does nothing if it is already watched.
+	 **/
+	void watch( KDirInfo * dir );
+
+	/**
+	 * Remove the watch for 'dir' (if any) and forget its pending changes.
+	 **/
+	void unwatch( KDirInfo * dir );
+
+	/**
+	 * Apply the changes of the entries 'changes' in 'dir' to the tree.
+	 **/
+	void applyChanges( KDirInfo * dir, const KDirChanges & changes );
+
+	/**
+	 * Add a new entry 'name' with the lstat() information 'statInfo' to
+	 * 'dir'. New directories are read (in the background), unless they are
+	 * excluded or mount points.
+	 **/
+	void addEntry( KDirInfo *		dir,
+		       const QString &		name,
+		       struct stat *		statInfo );
+
+	/**
+	 * Returns 'true' if 'item' is out of date according to 'statInfo'.
+	 * The contents of directories are not checked; they are watched
+	 * separately.
+	 **/
+	static bool isOutdated( KFileInfo * item, struct stat * statInfo );
+
+
+	// Data members
+
+	KDirTree *			_tree;
+	int				_fd;
+	QSocketNotifier *		_notifier;
+	QMap<int, KDirInfo *>		_dirs;		// watch descriptor -> dir
+	QMap<KDirInfo *, int>		_watches;	// dir -> watch descriptor
+	QPtrDict<KDirChanges>		_pending;	// dir -> changed entries
+	QTimer				_timer;
+	bool				_overflow;
+	bool				_limitReached;
+
+    };	// class KDirWatcher
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KDirWatcher_h
+
+
+// EOF
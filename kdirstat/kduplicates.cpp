@@ -0,0 +1,479 @@
+/*
+ *   File name:	kduplicates.cpp
+ *   Summary:	Support classes for KDirStat - duplicate file finder
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <qdatetime.h>
+#include <qmap.h>
+#include <qtl.h>
+#include <kdebug.h>
+
+#include "kduplicates.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KDuplicateFinder::KDuplicateFinder()
+    : QObject()
+    , _fileIndex( 0 )
+    , _fd( -1 )
+    , _offset( 0 )
+    , _minSize( 1 )
+    , _total( 0 )
+    , _checked( 0 )
+    , _active( false )
+    , _buffer( DuplicatesChunkSize )
+{
+    connect( &_timer, SIGNAL( timeout()           ),
+	     this,    SLOT  ( timeSlicedSearch()  ) );
+}
+
+
+KDuplicateFinder::~KDuplicateFinder()
+{
+    closeCurrent();
+}
+
+
+void
+KDuplicateFinder::start( KFileInfo * subtree )
+{
+    abort();
+    collect( subtree );
+
+    if ( _pending.isEmpty() )
+    {
+	emit finished();
+	return;
+    }
+
+    _active = true;
+    _timer.start( 0 );
+}
+
+
+void
+KDuplicateFinder::run( KFileInfo * subtree )
+{
+    abort();
+    collect( subtree );
+    _active = true;
+
+    while ( ! work( DuplicatesSliceMillisec ) )
+	;
+}
+
+
+void
+KDuplicateFinder::abort()
+{
+    _timer.stop();
+    closeCurrent();
+
+    _pending.clear();
+    _hashed.clear();
+    _result.clear();
+    _fileIndex	= 0;
+    _total	= 0;
+    _checked	= 0;
+    _active	= false;
+}
+
+
+void
+KDuplicateFinder::timeSlicedSearch()
+{
+    bool done = work( DuplicatesSliceMillisec );
+    emit progress( _checked, _total );
+
+    if ( done )
+    {
+	_timer.stop();
+	emit finished();
+    }
+}
+
+
+void
+KDuplicateFinder::collect( KFileInfo * subtree )
+{
+    if ( ! subtree )
+	return;
+
+    // Group the files by size. This needs only what is in memory anyway.
+    // Traverse the tree without any recursion since large trees can be
+    // very deep.
+
+    QMap<KFileSize, QValueVector<Candidate> > bySize;
+    QValueVector<KFileInfo *> stack;
+    stack.push_back( subtree );
+
+    while ( ! stack.isEmpty() )
+    {
+	KFileInfo * item = stack.back();
+	stack.pop_back();
+
+	if ( item->isFile() && item->isLocalFile() && item->byteSize() >= _minSize )
+	    bySize[ item->byteSize() ].push_back( Candidate( item ) );
+
+	if ( item->dotEntry() )
+	    stack.push_back( item->dotEntry() );
+
+	int count = item->childCount();
+
+	for ( int i=0; i < count; i++ )
+	    stack.push_back( item->childAt( i ) );
+    }
+
+
+    // Only sizes that occur more than once need to be looked at any
+    // closer. Start with the largest files: They are the most rewarding.
+
+    QMap<KFileSize, QValueVector<Candidate> >::iterator it = bySize.end();
+
+    while ( it != bySize.begin() )
+    {
+	--it;
+
+	if ( it.data().size() > 1 )
+	{
+	    Pending group( it.key(), false );
+	    group.files = it.data();
+	    _pending.append( group );
+	    _total += group.files.size();
+	}
+    }
+}
+
+
+bool
+KDuplicateFinder::work( int millisec )
+{
+    QTime time;
+    time.start();
+
+    while ( ! _pending.isEmpty() )
+    {
+	if ( _fileIndex >= (int) _pending.first().files.size() )
+	{
+	    // All files of this group are hashed
+
+	    partitionCurrent();
+	    _pending.pop_front();
+	    _hashed.clear();
+	    _fileIndex = 0;
+	}
+	else
+	{
+	    bool fileDone;
+
+	    if ( _fd < 0 )
+		fileDone = ! openCurrent() || hashChunk();
+	    else
+		fileDone = hashChunk();
+
+	    if ( fileDone )
+	    {
+		_fileIndex++;
+		_checked++;
+	    }
+	}
+
+	if ( time.elapsed() >= millisec )
+	    return _pending.isEmpty() ? finish() : false;
+    }
+
+    return finish();
+}
+
+
+bool
+KDuplicateFinder::finish()
+{
+    closeCurrent();
+    qHeapSort( _result );	// KDuplicateGroup::operator< sorts most wasted space first
+    _active = false;
+
+    return true;
+}
+
+
+bool
+KDuplicateFinder::openCurrent()
+{
+    Pending &	group	  = _pending.first();
+    Candidate & candidate = group.files[ _fileIndex ];
+
+    _fd = openFile( candidate.item );
+
+    if ( _fd < 0 )
+    {
+	kdWarning() << "Can't open " << candidate.item << ": " << strerror( errno ) << endl;
+	return false;
+    }
+
+    struct stat statInfo;
+
+    if ( fstat( _fd, &statInfo ) != 0		||
+	 ! S_ISREG( statInfo.st_mode )		||
+	 (KFileSize) statInfo.st_size != group.size )
+    {
+	// Changed since the tree was read - ignore it.
+
+	closeCurrent();
+	return false;
+    }
+
+    for ( uint i=0; i < _hashed.size(); i++ )
+    {
+	if ( _hashed[i].device == statInfo.st_dev && _hashed[i].inode == statInfo.st_ino )
+	{
+	    // Another link to a file that is already there: No extra disk
+	    // space to gain.
+
+	    closeCurrent();
+	    return false;
+	}
+    }
+
+    candidate.device = statInfo.st_dev;
+    candidate.inode  = statInfo.st_ino;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    if ( group.fullHash )
+	posix_fadvise( _fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+
+    _md5.reset();
+    _offset = 0;
+    readAheadNext();
+
+    return true;
+}
+
+
+bool
+KDuplicateFinder::hashChunk()
+{
+    const Pending & group = _pending.first();
+    KFileSize end = group.fullHash ? group.size : QMIN( group.size, (KFileSize) DuplicatesHeadSize );
+    int	len  = (int) QMIN( end - _offset, (KFileSize) _buffer.size() );
+    int done = 0;
+
+    while ( done < len )
+    {
+	ssize_t got = ::read( _fd, _buffer.data() + done, len - done );
+
+	if ( got < 0 && errno == EINTR )
+	    continue;
+
+	if ( got <= 0 )
+	{
+	    if ( got < 0 )
+		kdWarning() << "Error reading " << group.files[ _fileIndex ].item
+			    << ": " << strerror( errno ) << endl;
+
+	    // Unreadable or truncated in the meantime - drop this file.
+
+	    closeCurrent();
+	    return true;
+	}
+
+	done += got;
+    }
+
+    _md5.update( _buffer.data(), len );
+    _offset += len;
+
+    if ( _offset < end )
+	return false;
+
+    Candidate candidate = group.files[ _fileIndex ];
+    candidate.hash = _md5.hexDigest();
+    _hashed.push_back( candidate );
+    closeCurrent();
+
+    return true;
+}
+
+
+void
+KDuplicateFinder::readAheadNext()
+{
+#ifdef POSIX_FADV_WILLNEED
+    QValueList<Pending>::iterator group = _pending.begin();
+    uint index = _fileIndex + 1;
+
+    if ( index >= (*group).files.size() )
+    {
+	if ( ++group == _pending.end() )
+	    return;
+
+	index = 0;
+    }
+
+    int fd = openFile( (*group).files[ index ].item );
+
+    if ( fd < 0 )
+	return;
+
+    // This only starts reading in the background; the pages stay in the
+    // page cache after the file is closed.
+
+    off_t len = (*group).fullHash ? DuplicatesReadAhead : DuplicatesHeadSize;
+    posix_fadvise( fd, 0, len, POSIX_FADV_WILLNEED );
+    ::close( fd );
+#endif
+}
+
+
+void
+KDuplicateFinder::partitionCurrent()
+{
+    if ( _hashed.size() < 2 )
+	return;
+
+    KFileSize size	= _pending.first().size;
+    bool fullHash	= _pending.first().fullHash;
+
+    QMap<QCString, QValueVector<Candidate> > byHash;
+
+    for ( uint i=0; i < _hashed.size(); i++ )
+	byHash[ _hashed[i].hash ].push_back( _hashed[i] );
+
+    QMap<QCString, QValueVector<Candidate> >::iterator it;
+
+    for ( it = byHash.begin(); it != byHash.end(); ++it )
+    {
+	const QValueVector<Candidate> & files = it.data();
+
+	if ( files.size() < 2 )
+	    continue;
+
+	if ( ! fullHash && size > DuplicatesHeadSize )
+	{
+	    // Same size and same head - compare the complete contents.
+
+	    Pending fullGroup( size, true );
+	    fullGroup.files = files;
+	    _pending.append( fullGroup );
+	    _total += files.size();
+	}
+	else
+	{
+	    KDuplicateGroup duplicates( size );
+
+	    for ( uint i=0; i < files.size(); i++ )
+		duplicates.files.append( files[i].item );
+
+	    _result.append( duplicates );
+	}
+    }
+}
+
+
+void
+KDuplicateFinder::closeCurrent()
+{
+    if ( _fd >= 0 )
+    {
+	::close( _fd );
+	_fd = -1;
+    }
+}
+
+
+int
+KDuplicateFinder::openFile( KFileInfo * item )
+{
+    // Names hold the raw bytes from readdir() as Latin-1, so don't encode
+    // them once more.
+
+    QCString path = item->url().latin1();
+
+#ifdef O_NOATIME
+    int fd = ::open( path, O_RDONLY | O_NOATIME );
+
+    if ( fd < 0 && errno == EPERM )	// O_NOATIME is only permitted for the owner
+	fd = ::open( path, O_RDONLY );
+#else
+    int fd = ::open( path, O_RDONLY );
+#endif
+
+    return fd;
+}
+
+
+
+
+KDuplicatesJob::KDuplicatesJob( const QString & input, KFileSize minSize )
+    : KBatchJob( input )
+    , _minSize( minSize )
+{
+    // NOP
+}
+
+
+KDuplicatesJob::~KDuplicatesJob()
+{
+    // NOP
+}
+
+
+bool
+KDuplicatesJob::process( KDirTree * tree )
+{
+    if ( ! tree->root() )
+    {
+	kdError() << "Nothing read from " << _input << endl;
+	return false;
+    }
+
+    KDuplicateFinder finder;
+    finder.setMinSize( _minSize );
+    finder.run( tree->root() );
+
+    KDuplicateList::const_iterator it = finder.result().begin();
+    int set = 0;
+
+    while ( it != finder.result().end() )
+    {
+	++set;
+	QValueList<KFileInfo *>::const_iterator file = (*it).files.begin();
+
+	while ( file != (*it).files.end() )
+	{
+	    printf( "%d\t%lld\t%s\n",
+		    set,
+		    (long long) (*it).size,
+		    (*file)->url().latin1() );
+	    ++file;
+	}
+
+	++it;
+    }
+
+    return fflush( stdout ) == 0;
+}
+
+
+
+// EOF
@@ -0,0 +1,349 @@
+/*
+ *   File name:	kduplicates.h
+ *   Summary:	Support classes for KDirStat - duplicate file finder
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KDuplicates_h
+#define KDuplicates_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <qobject.h>
+#include <qcstring.h>
+#include <qtimer.h>
+#include <qvaluelist.h>
+#include <qvaluevector.h>
+#include <kmdcodec.h>
+#include "kfileinfo.h"
+#include "kbatchjob.h"
+
+
+// Milliseconds to spend in one slice of a background duplicate search
+// before returning to the event loop
+
+#define DuplicatesSliceMillisec	50
+
+// Number of bytes at the start of each file that are compared before
+// reading any file completely
+
+#define DuplicatesHeadSize	4096
+
+// Number of bytes to read at once when hashing complete files
+
+#define DuplicatesChunkSize	( 256 * 1024 )
+
+// Number of bytes to ask the kernel to read ahead for the next file while
+// the current one is being hashed
+
+#define DuplicatesReadAhead	( 1024 * 1024 )
+
+
+namespace KDirStat
+{
+    /**
+     * One set of files with identical contents found by @ref
+     * KDuplicateFinder.
+     **/
+    class KDuplicateGroup
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KDuplicateGroup( KFileSize fileSize = 0 )
+	    : size( fileSize )
+	    {}
+
+	/**
+	 * Returns the disk space that could be reclaimed by keeping only one
+	 * of the files.
+	 **/
+	KFileSize wasted() const
+	    { return files.count() > 1 ? size * ( files.count() - 1 ) : 0; }
+
+	/**
+	 * Sort order for reports: Most wasted space first.
+	 **/
+	bool operator<( const KDuplicateGroup & other ) const
+	    { return wasted() > other.wasted(); }
+
+	KFileSize			size;	// byte size of each file
+	QValueList<KFileInfo *>		files;
+
+    };	// class KDuplicateGroup
+
+
+    typedef QValueList<KDuplicateGroup> KDuplicateList;
+
+
+    /**
+     * Finds files with identical contents in a subtree.
+     *
+     * Files can only be identical if they have the same size, and the sizes
+     * are already in the tree in memory, so the files are first grouped by
+     * size without any disk access at all. Only files that share their size
+     * with another one are read, in two stages: First only the first @ref
+     * DuplicatesHeadSize bytes of each file are hashed, which separates most
+     * files of the same size right away. Only files that have the same size
+     * and the same head are then hashed completely. Several links to the
+     * same i-node are not duplicates; they count as one file.
+     *
+     * The files are read one at a time in small time slices from the event
+     * loop like @ref KDirTreeRecalc does, so the application remains
+     * usable; the kernel is asked to read ahead the next file while one is
+     * being hashed. Files are opened with O_NOATIME where possible so
+     * searching for duplicates does not change their access times.
+     *
+     * The result refers to the items in the tree; abort() the search and
+     * throw the result away before deleting anything in the tree.
+     *
+     * @short Duplicate file finder
+     **/
+    class KDuplicateFinder: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KDuplicateFinder();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KDuplicateFinder();
+
+	/**
+	 * Start searching for duplicates in 'subtree' in the background.
+	 * finished() is emitted when the search is done.
+	 **/
+	void start( KFileInfo * subtree );
+
+	/**
+	 * Search for duplicates in 'subtree' and return only when done.
+	 * Intended for batch jobs without a GUI.
+	 **/
+	void run( KFileInfo * subtree );
+
+	/**
+	 * Stop searching and discard everything.
+	 **/
+	void abort();
+
+	/**
+	 * Returns 'true' if a search is in progress.
+	 **/
+	bool isActive() const { return _active; }
+
+	/**
+	 * Returns the groups of identical files found, most wasted space
+	 * first. This is only complete after the search is finished.
+	 **/
+	const KDuplicateList & result() const { return _result; }
+
+	/**
+	 * Returns the number of files that need to be read so far.
+	 **/
+	int total() const { return _total; }
+
+	/**
+	 * Returns the number of files that were already read.
+	 **/
+	int checked() const { return _checked; }
+
+	/**
+	 * Files smaller than this are ignored. The default is 1, i.e. only
+	 * empty files are ignored.
+	 **/
+	void setMinSize( KFileSize minSize ) { _minSize = minSize; }
+
+	/**
+	 * Returns the minimum file size to consider.
+	 **/
+	KFileSize minSize() const { return _minSize; }
+
+
+    signals:
+
+	/**
+	 * Emitted after each time slice of a background search.
+	 **/
+	void progress( int checked, int total );
+
+	/**
+	 * Emitted when a background search is finished.
+	 **/
+	void finished();
+
+
+    protected slots:
+
+	/**
+	 * Do one time slice worth of searching.
+	 **/
+	void timeSlicedSearch();
+
+
+    protected:
+
+	/**
+	 * One file that is a candidate for being a duplicate.
+	 **/
+	struct Candidate
+	{
+	    Candidate( KFileInfo * i = 0 ): item( i ), device( 0 ), inode( 0 ) {}
+
+	    KFileInfo *	item;
+	    dev_t	device;
+	    ino_t	inode;
+	    QCString	hash;
+	};
+
+	/**
+	 * Files of the same size that still need to be hashed. 'fullHash'
+	 * tells whether to hash only the head or the complete files.
+	 **/
+	struct Pending
+	{
+	    Pending( KFileSize s = 0, bool full = false ): size( s ), fullHash( full ) {}
+
+	    KFileSize			size;
+	    bool			fullHash;
+	    QValueVector<Candidate>	files;
+	};
+
+
+	/**
+	 * Group all eligible files in 'subtree' by size and queue all groups
+	 * with more than one file.
+	 **/
+	void collect( KFileInfo * subtree );
+
+	/**
+	 * Hash files for at most 'millisec' milliseconds. Returns 'true' if
+	 * everything is done.
+	 **/
+	bool work( int millisec );
+
+	/**
+	 * Clean up after the last file and sort the result. Returns 'true'.
+	 **/
+	bool finish();
+
+	/**
+	 * Open the current file and prepare hashing it. Returns 'false' if
+	 * the file cannot be used.
+	 **/
+	bool openCurrent();
+
+	/**
+	 * Hash the next chunk of the current file. Returns 'true' when the
+	 * file is done.
+	 **/
+	bool hashChunk();
+
+	/**
+	 * Ask the kernel to read ahead the file after the current one.
+	 **/
+	void readAheadNext();
+
+	/**
+	 * Sort the files of the current group by hash and queue or report
+	 * all subgroups of identical files.
+	 **/
+	void partitionCurrent();
+
+	/**
+	 * Close the current file if it is open.
+	 **/
+	void closeCurrent();
+
+	/**
+	 * Open 'item' for reading without changing its access time. Returns
+	 * the file descriptor or -1.
+	 **/
+	static int openFile( KFileInfo * item );
+
+
+	// Data members
+
+	QValueList<Pending>	_pending;
+	QValueVector<Candidate>	_hashed;	// files of the current group done so far
+	int			_fileIndex;	// current file in _pending.first()
+	int			_fd;		// current file
+	KFileSize		_offset;	// bytes of the current file read so far
+	KMD5			_md5;
+
+	KDuplicateList		_result;
+	KFileSize		_minSize;
+	int			_total;
+	int			_checked;
+	bool			_active;
+	QTimer			_timer;
+	QByteArray		_buffer;
+
+    };	// class KDuplicateFinder
+
+
+
+    /**
+     * Batch driver for KDuplicateFinder: Reads a directory or a cache file,
+     * searches it for duplicates and prints each set of identical files to
+     * stdout, most wasted space first, one file per line:
+     *
+     *     <set number> TAB <size in bytes> TAB <path>
+     *
+     * Used for "kdirstat --duplicates". Reading a cache file only makes
+     * sense if the files it describes are still there.
+     *
+     * @short Batch output of duplicate files
+     **/
+    class KDuplicatesJob: public KBatchJob
+    {
+    public:
+
+	/**
+	 * Constructor. 'input' is either a directory (path or URL) or a
+	 * KDirStat cache file.
+	 **/
+	KDuplicatesJob( const QString & input, KFileSize minSize = 1 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KDuplicatesJob();
+
+
+    protected:
+
+	/**
+	 * Search and print the duplicates.
+	 *
+	 * Reimplemented - inherited from @ref KBatchJob.
+	 **/
+	virtual bool process( KDirTree * tree );
+
+
+	KFileSize	_minSize;
+
+    };	// class KDuplicatesJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KDuplicates_h
+
+
+// EOF
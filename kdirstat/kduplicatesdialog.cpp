@@ -0,0 +1,335 @@
+/*
+ *   File name:	kduplicatesdialog.cpp
+ *   Summary:	Dialog listing files with identical contents
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qlabel.h>
+#include <qlayout.h>
+
+#include <klistview.h>
+#include <klocale.h>
+
+#include "kduplicatesdialog.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KDuplicatesDialog::KDuplicatesDialog( KDirTree * tree, QWidget * parent )
+    : KDialogBase( Plain,				// dialogFace
+		   i18n( "Duplicate Files" ),		// caption
+		   User1 | Close,			// buttonMask
+		   User1,				// defaultButton
+		   parent,				// parent
+		   0,					// name
+		   false )				// modal
+    , _tree( tree )
+{
+    setButtonText( User1, i18n( "&Refresh" ) );
+
+    QWidget *	  page	 = plainPage();
+    QVBoxLayout * layout = new QVBoxLayout( page, 0, spacingHint() );
+
+    _subtreeLabel = new QLabel( page );
+    layout->addWidget( _subtreeLabel );
+
+    _statusLabel = new QLabel( page );
+    layout->addWidget( _statusLabel );
+
+    _list = new KListView( page );
+    _list->addColumn( i18n( "Name"	) );
+    _list->addColumn( i18n( "Size"	) );
+    _list->addColumn( i18n( "Files"	) );
+    _list->addColumn( i18n( "Wasted"	) );
+    _list->setColumnAlignment( 1, AlignRight );
+    _list->setColumnAlignment( 2, AlignRight );
+    _list->setColumnAlignment( 3, AlignRight );
+    _list->setAllColumnsShowFocus( true );
+    _list->setRootIsDecorated( true );
+    _list->setSorting( 3, false );		// most wasted space first
+    layout->addWidget( _list, 1 );
+
+    connect( _list,	SIGNAL( selectionChanged( QListViewItem * ) ),
+	     this,	SLOT  ( selectItem	( QListViewItem * ) ) );
+
+    connect( _list,	SIGNAL( contextMenu	  ( KListView *, QListViewItem *, const QPoint & ) ),
+	     this,	SLOT  ( requestContextMenu( KListView *, QListViewItem *, const QPoint & ) ) );
+
+    connect( &_finder,	SIGNAL( progress	( int, int ) ),
+	     this,	SLOT  ( searchProgress	( int, int ) ) );
+
+    connect( &_finder,	SIGNAL( finished()	 ),
+	     this,	SLOT  ( searchFinished() ) );
+
+    // Reading a new tree or refreshing a subtree deletes the old items
+    // first, so this takes care of those cases, too.
+
+    connect( _tree,	SIGNAL( deletingChild	( KFileInfo * )	),
+	     this,	SLOT  ( deletingChild	( KFileInfo * ) ) );
+
+    resize( 650, 450 );
+}
+
+
+KDuplicatesDialog::~KDuplicatesDialog()
+{
+    // NOP
+}
+
+
+void
+KDuplicatesDialog::slotUser1()
+{
+    refresh();
+}
+
+
+void
+KDuplicatesDialog::slotClose()
+{
+    _finder.abort();
+    KDialogBase::slotClose();
+}
+
+
+void
+KDuplicatesDialog::clear()
+{
+    _finder.abort();
+    _list->clear();
+    _subtreeLabel->setText( "" );
+    _statusLabel->setText( "" );
+}
+
+
+void
+KDuplicatesDialog::refresh()
+{
+    clear();
+
+    if ( ! _tree->root() || _tree->isBusy() )
+	return;
+
+    // Use the selected directory if there is one, the entire tree otherwise.
+
+    KFileInfo * subtree = _tree->selection();
+
+    if ( ! subtree || ! subtree->isDirInfo() )
+	subtree = _tree->root();
+
+    _subtreeLabel->setText( i18n( "In %1" ).arg( subtree->url() ) );
+    _statusLabel->setText( i18n( "Searching..." ) );
+    _finder.start( subtree );
+}
+
+
+void
+KDuplicatesDialog::searchProgress( int checked, int total )
+{
+    _statusLabel->setText( i18n( "Comparing files: %1 of %2" ).arg( checked ).arg( total ) );
+}
+
+
+void
+KDuplicatesDialog::searchFinished()
+{
+    const KDuplicateList & result = _finder.result();
+    KDuplicateList::const_iterator it = result.begin();
+
+    while ( it != result.end() )
+    {
+	new KDuplicatesListItem( _list, *it );
+	++it;
+    }
+
+    showSummary();
+}
+
+
+void
+KDuplicatesDialog::showSummary()
+{
+    KFileSize wasted = 0;
+    int	      sets   = 0;
+
+    for ( QListViewItem * item = _list->firstChild(); item; item = item->nextSibling() )
+    {
+	wasted += ( (KDuplicatesListItem *) item )->wasted();
+	sets++;
+    }
+
+    if ( sets == 0 )
+	_statusLabel->setText( i18n( "No duplicate files found." ) );
+    else
+	_statusLabel->setText( i18n( "%1 sets of identical files, %2 wasted" )
+			       .arg( sets ).arg( formatSize( wasted ) ) );
+}
+
+
+void
+KDuplicatesDialog::selectItem( QListViewItem * listItem )
+{
+    KDuplicatesListItem * item = dynamic_cast<KDuplicatesListItem *>( listItem );
+
+    if ( item && item->file() )
+	_tree->selectItem( item->file() );
+}
+
+
+void
+KDuplicatesDialog::requestContextMenu( KListView *, QListViewItem * listItem, const QPoint & pos )
+{
+    KDuplicatesListItem * item = dynamic_cast<KDuplicatesListItem *>( listItem );
+
+    if ( item && item->file() )
+    {
+	_tree->selectItem( item->file() );
+	emit contextMenu( item->file(), pos );
+    }
+}
+
+
+void
+KDuplicatesDialog::deletingChild( KFileInfo * subtree )
+{
+    if ( _finder.isActive() )
+    {
+	// The search holds pointers into the tree - better start over.
+
+	clear();
+	_statusLabel->setText( i18n( "Search aborted since files were deleted." ) );
+	return;
+    }
+
+    if ( subtree == _tree->root() )
+    {
+	clear();
+	return;
+    }
+
+    bool changed = false;
+    QListViewItem * set = _list->firstChild();
+
+    while ( set )
+    {
+	QListViewItem * nextSet = set->nextSibling();
+	QListViewItem * item	= set->firstChild();
+
+	while ( item )
+	{
+	    QListViewItem * next = item->nextSibling();
+	    KFileInfo *	    file = ( (KDuplicatesListItem *) item )->file();
+
+	    if ( file && file->isInSubtree( subtree ) )
+	    {
+		delete item;
+		changed = true;
+	    }
+
+	    item = next;
+	}
+
+	if ( set->childCount() < 2 )	// Nothing left to choose from
+	    delete set;
+	else
+	    ( (KDuplicatesListItem *) set )->updateSummary();
+
+	set = nextSet;
+    }
+
+    if ( changed )
+	showSummary();
+}
+
+
+
+
+KDuplicatesListItem::KDuplicatesListItem( QListView *			parent,
+					  const KDuplicateGroup &	group )
+    : QListViewItem( parent )
+    , _file( 0 )
+    , _size( group.size )
+{
+    QValueList<KFileInfo *>::const_iterator it = group.files.begin();
+
+    while ( it != group.files.end() )
+    {
+	new KDuplicatesListItem( this, *it );
+	++it;
+    }
+
+    if ( ! group.files.isEmpty() )
+	setText( 0, group.files.first()->name() );
+
+    setText( 1, formatSize( _size ) );
+    updateSummary();
+}
+
+
+KDuplicatesListItem::KDuplicatesListItem( KDuplicatesListItem * parent, KFileInfo * file )
+    : QListViewItem( parent )
+    , _file( file )
+    , _size( parent->size() )
+{
+    setText( 0, file->url() );
+}
+
+
+void
+KDuplicatesListItem::updateSummary()
+{
+    if ( _file )
+	return;
+
+    setText( 2, QString::number( childCount() ) );
+    setText( 3, formatSize( wasted() ) );
+}
+
+
+int
+KDuplicatesListItem::compare( QListViewItem *	otherListViewItem,
+			      int		col,
+			      bool		ascending ) const
+{
+    KDuplicatesListItem * other = dynamic_cast<KDuplicatesListItem *>( otherListViewItem );
+
+    if ( other && ! _file )
+    {
+	switch ( col )
+	{
+	    case 1:
+		if ( _size < other->size() ) return -1;
+		if ( _size > other->size() ) return  1;
+		return 0;
+
+	    case 2:
+		if ( childCount() < other->childCount() ) return -1;
+		if ( childCount() > other->childCount() ) return  1;
+		return 0;
+
+	    case 3:
+		if ( wasted() < other->wasted() ) return -1;
+		if ( wasted() > other->wasted() ) return  1;
+		return 0;
+
+	    default:
+		break;
+	}
+    }
+
+    return QListViewItem::compare( otherListViewItem, col, ascending );
+}
+
+
+
+// EOF
@@ -0,0 +1,207 @@
+/*
+ *   File name:	kduplicatesdialog.h
+ *   Summary:	Dialog listing files with identical contents
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KDuplicatesDialog_h
+#define KDuplicatesDialog_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qlistview.h>
+#include <kdialogbase.h>
+#include "kduplicates.h"
+
+
+class QLabel;
+class KListView;
+
+
+namespace KDirStat
+{
+    class KDirTree;
+
+
+    /**
+     * Non-modal dialog that searches the selected subtree (or the entire
+     * tree if nothing or a file is selected) for files with identical
+     * contents and lists them, most wasted space first. The search runs in
+     * the background; the dialog shows its progress.
+     *
+     * Clicking a file selects it in the tree, so all cleanup actions can be
+     * used on it; the context menu of a file is the same as in the tree
+     * view. Files that are deleted from the tree disappear from the list,
+     * so duplicates can be removed one after the other.
+     *
+     * @short Dialog for duplicate files
+     **/
+    class KDuplicatesDialog: public KDialogBase
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KDuplicatesDialog( KDirTree * tree, QWidget * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KDuplicatesDialog();
+
+
+    public slots:
+
+	/**
+	 * Start a new search for the current selection.
+	 **/
+	void refresh();
+
+	/**
+	 * Stop searching and clear the list.
+	 **/
+	void clear();
+
+
+    signals:
+
+	/**
+	 * Emitted when the context menu for 'item' (which is already
+	 * selected in the tree) should be opened at 'pos'.
+	 **/
+	void contextMenu( KFileInfo * item, const QPoint & pos );
+
+
+    protected slots:
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Refresh" button.
+	 **/
+	virtual void slotUser1();
+
+	/**
+	 * Reimplemented from @ref KDialogBase: Stop searching when the dialog
+	 * is closed.
+	 **/
+	virtual void slotClose();
+
+	/**
+	 * Select the file of list item 'item' in the tree.
+	 **/
+	void selectItem( QListViewItem * item );
+
+	/**
+	 * Select the file of list item 'item' in the tree and request its
+	 * context menu.
+	 **/
+	void requestContextMenu( KListView *, QListViewItem * item, const QPoint & pos );
+
+	/**
+	 * Show the progress of the search.
+	 **/
+	void searchProgress( int checked, int total );
+
+	/**
+	 * Fill the list with the result of the search.
+	 **/
+	void searchFinished();
+
+	/**
+	 * Remove all files in 'subtree' from the list. Stops any search in
+	 * progress.
+	 **/
+	void deletingChild( KFileInfo * subtree );
+
+
+    protected:
+
+	/**
+	 * Show the number of sets and the wasted space of what is in the
+	 * list.
+	 **/
+	void showSummary();
+
+
+	KDirTree *		_tree;
+	KDuplicateFinder	_finder;
+	QLabel *		_subtreeLabel;
+	QLabel *		_statusLabel;
+	KListView *		_list;
+
+    };	// class KDuplicatesDialog
+
+
+
+    /**
+     * List item in a @ref KDuplicatesDialog: Either a set of identical
+     * files (toplevel) or one file of such a set. Sorts numerically by
+     * size, number of files and wasted space.
+     **/
+    class KDuplicatesListItem: public QListViewItem
+    {
+    public:
+
+	/**
+	 * Constructor for a set of identical files. This creates the items
+	 * for all files as well.
+	 **/
+	KDuplicatesListItem( QListView * parent, const KDuplicateGroup & group );
+
+	/**
+	 * Constructor for one file of a set.
+	 **/
+	KDuplicatesListItem( KDuplicatesListItem * parent, KFileInfo * file );
+
+	/**
+	 * Returns the file this item displays or 0 if this is a set.
+	 **/
+	KFileInfo * file() const { return _file; }
+
+	/**
+	 * Returns the size of each file of the set.
+	 **/
+	KFileSize size() const { return _size; }
+
+	/**
+	 * Returns the disk space that could be reclaimed in this set.
+	 **/
+	KFileSize wasted() const { return childCount() > 1 ? _size * ( childCount() - 1 ) : 0; }
+
+	/**
+	 * Update the texts of a set after files were removed.
+	 **/
+	void updateSummary();
+
+	/**
+	 * Comparison function used for sorting the list.
+	 *
+	 * Reimplemented from @ref QListViewItem.
+	 **/
+	virtual int compare( QListViewItem *	other,
+			     int		col,
+			     bool		ascending ) const;
+
+    protected:
+
+	KFileInfo *	_file;
+	KFileSize	_size;
+
+    };	// class KDuplicatesListItem
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KDuplicatesDialog_h
+
+
+// EOF
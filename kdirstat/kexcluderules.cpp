@@ -4,7 +4,7 @@
  *   License:	LGPL - See file COPYING.LIB for details.
  *   Author:	Stefan Hundhammer <sh@suse.de>
  *
- *   Updated:	2008-12-18
+ *   Updated:	2026-10-18
  */
 
 
@@ -12,6 +12,7 @@
 #   include <config.h>
 #endif
 
+#include <string.h>
 #include <kdebug.h>
 #include "kexcluderules.h"
 
@@ -20,11 +21,30 @@
 using namespace KDirStat;
 
 
-KExcludeRule::KExcludeRule( const QRegExp & regexp )
+/**
+ * Returns 'true' if the character at 'pos' in 'pattern' is escaped with a
+ * backslash, i.e. if there is an odd number of backslashes before it.
+ **/
+static bool
+isEscaped( const QString & pattern, int pos )
+{
+    int backslashes = 0;
+
+    while ( --pos >= 0 && pattern[ pos ] == '\\' )
+	backslashes++;
+
+    return backslashes % 2 == 1;
+}
+
+
+
+
+KExcludeRule::KExcludeRule( const QRegExp & regexp, bool byName )
     : _regexp( regexp )
     , _enabled( true )
+    , _byName( byName )
 {
-    // NOP
+    compile();
 }
 
 
@@ -34,21 +54,178 @@ KExcludeRule::~KExcludeRule()
 }
 
 
+void
+KExcludeRule::setRegexp( const QRegExp & regexp )
+{
+    _regexp = regexp;
+    compile();
+}
+
+
+void
+KExcludeRule::compile()
+{
+    _kind    = KExcludeRegExp;
+    _literal = QCString();
+
+    if ( ! _regexp.caseSensitive() || ! _regexp.isValid() )
+	return;
+
+    QString pattern   = _regexp.pattern();
+    int	    begin     = 0;
+    int	    end	      = pattern.length();
+    bool    anyBefore = false;
+    bool    anyAfter  = false;
+    QString special;
+
+    if ( _regexp.wildcard() )
+    {
+	if ( pattern.startsWith( "*" ) )
+	{
+	    anyBefore = true;
+	    begin++;
+	}
+
+	if ( end > begin && pattern[ end-1 ] == '*' )
+	{
+	    anyAfter = true;
+	    end--;
+	}
+
+	special = "*?[]\\";
+    }
+    else
+    {
+	// Anchors are redundant since the whole text has to match anyway
+
+	if ( pattern.startsWith( "^" ) )
+	    begin++;
+
+	if ( end > begin && pattern[ end-1 ] == '$' && ! isEscaped( pattern, end-1 ) )
+	    end--;
+
+	if ( end - begin >= 2 && pattern.mid( begin, 2 ) == ".*" )
+	{
+	    anyBefore = true;
+	    begin += 2;
+	}
+
+	if ( end - begin >= 2 && pattern.mid( end-2, 2 ) == ".*" && ! isEscaped( pattern, end-2 ) )
+	{
+	    anyAfter = true;
+	    end -= 2;
+	}
+
+	special = "^$.[]()|*+?{}";
+    }
+
+
+    // Everything in between has to be a plain string
+
+    QString literal;
+
+    for ( int i = begin; i < end; i++ )
+    {
+	QChar c = pattern[i];
+
+	if ( c == '\\' && ! _regexp.wildcard() )
+	{
+	    if ( ++i >= end )
+		return;
+
+	    c = pattern[i];
+
+	    if ( c.isLetterOrNumber() )		// \d, \s, \1 etc.
+		return;
+	}
+	else if ( special.find( c ) >= 0 )
+	{
+	    return;
+	}
+
+	if ( c.unicode() > 255 )		// Not representable in Latin-1
+	    return;
+
+	literal += c;
+    }
+
+    if ( literal.isEmpty() )
+	return;
+
+    _literal = literal.latin1();
+
+    if	    ( anyBefore && anyAfter )	_kind = KExcludeContains;
+    else if ( anyBefore )		_kind = KExcludeSuffix;
+    else if ( anyAfter  )		_kind = KExcludePrefix;
+    else				_kind = KExcludeExact;
+}
+
+
 bool
-KExcludeRule::match( const QString & text )
+KExcludeRule::match( const QString & text ) const
 {
     if ( text.isEmpty() || ! _enabled )
 	return false;
 
-    return _regexp.exactMatch( text );
+    if ( _byName )		// Only the last path component counts
+    {
+	int slash = text.findRev( '/' );
+
+	if ( slash >= 0 )
+	    return match( text.mid( slash + 1 ) );
+    }
+
+    if ( _kind == KExcludeRegExp )
+	return _regexp.exactMatch( text );
+
+    const char * path = text.latin1();
+
+    return match( path, strlen( path ) );
+}
+
+
+bool
+KExcludeRule::match( const char * path, int len ) const
+{
+    if ( len == 0 || ! _enabled )
+	return false;
+
+    const char * literal = _literal.data();
+    int		 litLen	 = _literal.length();
+
+    switch ( _kind )
+    {
+	case KExcludeExact:
+	    return len == litLen && memcmp( path, literal, len ) == 0;
+
+	case KExcludePrefix:
+	    return len >= litLen && memcmp( path, literal, litLen ) == 0;
+
+	case KExcludeSuffix:
+	    return len >= litLen && memcmp( path + len - litLen, literal, litLen ) == 0;
+
+	case KExcludeContains:
+	    return len >= litLen && strstr( path, literal ) != 0;
+
+	case KExcludeRegExp:
+	    return _regexp.exactMatch( QString::fromLatin1( path, len ) );
+    }
+
+    return false;
 }
 
 
 
+
 KExcludeRules::KExcludeRules()
 {
-    // Make the rules list automatically delete
+    // Make the rules list automatically delete. The indices only refer to
+    // the rules in that list.
     _rules.setAutoDelete( true );
+
+    // The indices own the lists of rules for each key, not the rules.
+    _exact.setAutoDelete( true );
+    _names.setAutoDelete( true );
 }
 
 
@@ -74,54 +251,197 @@ KExcludeRules * KExcludeRules::excludeRules()
 
 void KExcludeRules::add( KExcludeRule * rule )
 {
-    if ( rule )
-	_rules.append( rule );
+    if ( ! rule )
+	return;
+
+    _rules.append( rule );
+
+    const QCString & literal = rule->literal();
+
+    if ( rule->byName() )
+    {
+	if ( rule->kind() == KExcludeExact )
+	    insert( _names, literal, rule );
+	else
+	    _nameOthers.append( rule );
+
+	return;
+    }
+
+    switch ( rule->kind() )
+    {
+	case KExcludeExact:
+	    insert( _exact, literal, rule );
+	    break;
+
+	case KExcludeSuffix:
+
+	    // ".*/name" matches exactly the paths whose last component is "name"
+
+	    if ( literal[0] == '/' && literal.find( '/', 1 ) < 0 )
+	    {
+		insert( _names, literal.data() + 1, rule );
+		break;
+	    }
+
+	    // Fall through
+
+	default:
+	    _others.append( rule );
+	    break;
+    }
+}
+
+
+void
+KExcludeRules::clear()
+{
+    _exact.clear();
+    _names.clear();
+    _others.clear();
+    _nameOthers.clear();
+    _rules.clear();
 }
 
 
 bool
-KExcludeRules::match( const QString & text )
+KExcludeRules::match( const QString & text ) const
 {
     if ( text.isEmpty() )
 	return false;
 
-    KExcludeRule * rule = _rules.first();
+    return match( text.latin1() );
+}
+
+
+bool
+KExcludeRules::match( const char * path ) const
+{
+    if ( ! path || ! *path )
+	return false;
+
+    const KExcludeRule * rule = find( _exact, path );
 
-    while ( rule )
+    if ( ! rule )
     {
-	if ( rule->match( text ) )
-	{
+	const char * slash = strrchr( path, '/' );
+
+	if ( slash && matchName( slash + 1 ) )
+	    return true;
+
+	rule = find( _others, path, strlen( path ) );
+    }
+
 #if VERBOSE_EXCLUDE_MATCHES
-	    
-	    kdDebug() << text << " matches exclude rule "
-		      << rule->regexp().pattern()
-		      << endl;
+
+    if ( rule )
+    {
+	kdDebug() << path << " matches exclude rule "
+		  << rule->regexp().pattern()
+		  << endl;
+    }
 
 #endif
-	    return true;
-	}
 
-	rule = _rules.next();
+    return rule != 0;
+}
+
+
+bool
+KExcludeRules::matchName( const char * name ) const
+{
+    if ( ! name || ! *name )
+	return false;
+
+    const KExcludeRule * rule = find( _names, name );
+
+    if ( ! rule )
+	rule = find( _nameOthers, name, strlen( name ) );
+
+#if VERBOSE_EXCLUDE_MATCHES
+
+    if ( rule )
+    {
+	kdDebug() << name << " matches exclude rule "
+		  << rule->regexp().pattern()
+		  << endl;
     }
 
-    return false;
+#endif
+
+    return rule != 0;
+}
+
+
+const KExcludeRule *
+KExcludeRules::find( const QPtrList<KExcludeRule> & rules,
+		     const char * text, int len )
+{
+    QPtrListIterator<KExcludeRule> it( rules );
+
+    while ( *it )
+    {
+	if ( (*it)->match( text, len ) )
+	    return *it;
+
+	++it;
+    }
+
+    return 0;
+}
+
+
+const KExcludeRule *
+KExcludeRules::find( const KExcludeRuleDict & dict, const char * key )
+{
+    QPtrList<KExcludeRule> * rules = dict.find( key );
+
+    if ( ! rules )
+	return 0;
+
+    QPtrListIterator<KExcludeRule> it( *rules );
+
+    while ( *it )
+    {
+	if ( (*it)->isEnabled() )
+	    return *it;
+
+	++it;
+    }
+
+    return 0;
+}
+
+
+void
+KExcludeRules::insert( KExcludeRuleDict & dict, const char * key, KExcludeRule * rule )
+{
+    QPtrList<KExcludeRule> * rules = dict.find( key );
+
+    if ( ! rules )
+    {
+	rules = new QPtrList<KExcludeRule>;
+	dict.insert( key, rules );
+    }
+
+    rules->append( rule );
 }
 
 
 const KExcludeRule *
-KExcludeRules::matchingRule( const QString & text )
+KExcludeRules::matchingRule( const QString & text ) const
 {
     if ( text.isEmpty() )
-	return false;
+	return 0;
 
-    KExcludeRule * rule = _rules.first();
+    QPtrListIterator<KExcludeRule> it( _rules );
 
-    while ( rule )
+    while ( *it )
     {
-	if ( rule->match( text ) )
-	    return rule;
+	if ( (*it)->match( text ) )
+	    return *it;
 
-	rule = _rules.next();
+	++it;
     }
 
     return 0;
@@ -4,7 +4,7 @@
  *   License:	LGPL - See file COPYING.LIB for details.
  *   Author:	Stefan Hundhammer <sh@suse.de>
  *
- *   Updated:	2008-12-18
+ *   Updated:	2026-10-18
  */
 
 
@@ -17,25 +17,52 @@
 #endif
 
 #include <qstring.h>
+#include <qcstring.h>
 #include <qregexp.h>
 #include <qptrlist.h>
+#include <qasciidict.h>
 
 
 namespace KDirStat
 {
+    /**
+     * How an exclude rule is matched. Most exclude rules are just a fixed
+     * path, a fixed path with anything below it or anything that ends with
+     * a fixed string like "/\.snapshot". Those are compared as plain
+     * strings rather than with a regular expression. The same goes for
+     * wildcard patterns for names like "node_modules" or "*.snapshot".
+     **/
+    typedef enum
+    {
+	KExcludeExact,		// "/proc"		"node_modules"
+	KExcludePrefix,		// "/mnt/.*"		"tmp*"
+	KExcludeSuffix,		// ".*/\.snapshot"	"*.ccache"
+	KExcludeContains,	// ".*/CVS/.*"		"*backup*"
+	KExcludeRegExp		// anything else
+    } KExcludeRuleKind;
+
+
     /**
      * One single exclude rule to check text (file names) against.
      * It can be enabled or disabled. Only enabled rules can ever match; a
      * disabled exclude rule will never exclude anything.
+     *
+     * Normal exclude rules are matched against the full path of a
+     * directory. Name rules are matched only against the last path
+     * component, i.e. the directory name; the directory readers can check
+     * those before they even build the full path.
      **/
     class KExcludeRule
     {
     public:
 
 	/**
-	 * Constructor.
+	 * Constructor. If 'byName' is 'true', this is a name rule. Name rules
+	 * usually use a wildcard regexp, e.g.
+	 *
+	 *     new KExcludeRule( QRegExp( "*.snapshot", true, true ), true )
 	 **/
-	KExcludeRule( const QRegExp & regexp );
+	KExcludeRule( const QRegExp & regexp, bool byName = false );
 
 	/**
 	 * Destructor.
@@ -49,8 +76,19 @@ namespace KDirStat
 	 *
 	 * Only enabled exclude rules will ever match; as long as it is
 	 * disabled, this will always return 'false'.
+	 *
+	 * Name rules only check the part after the last '/'.
 	 **/
-	bool match( const QString & text );
+	bool match( const QString & text ) const;
+
+	/**
+	 * Check the 'len' bytes at 'path' against this exclude rule. 'path'
+	 * is expected in the 8 bit form the directory readers use (see @ref
+	 * KExcludeRules::match( const char * ) ) and needs to be 0-terminated
+	 * as well. For name rules, this has to be the name only. Unless this
+	 * rule needs a regular expression, no QString is created.
+	 **/
+	bool match( const char * path, int len ) const;
 
 	/**
 	 * Returns this rule's regular expression.
@@ -59,8 +97,11 @@ namespace KDirStat
 
 	/**
 	 * Change this rule's regular expression.
+	 *
+	 * Don't do this while this rule is in a @ref KExcludeRules set: The
+	 * set only looks at the regexp when the rule is added.
 	 **/
-	void setRegexp( const QRegExp & regexp ) { _regexp = regexp; }
+	void setRegexp( const QRegExp & regexp );
 
 	/**
 	 * Check if this rule is enabled.
@@ -73,17 +114,64 @@ namespace KDirStat
 	 **/
 	void enable( bool enable = true ) { _enabled = enable; }
 
+	/**
+	 * Returns 'true' if this rule is matched only against directory names
+	 * rather than against full paths.
+	 **/
+	bool byName() const { return _byName; }
+
+	/**
+	 * Returns how this rule is matched.
+	 **/
+	KExcludeRuleKind kind() const { return _kind; }
+
+	/**
+	 * Returns the fixed string that is compared for all kinds except
+	 * @ref KExcludeRegExp.
+	 **/
+	const QCString & literal() const { return _literal; }
+
 
     private:
 
-	QRegExp	_regexp;
-	bool	_enabled;
+	/**
+	 * Find out if the regexp is really just a fixed string with ".*"
+	 * (or "*" for wildcard regexps) before and / or after it and set
+	 * _kind and _literal accordingly.
+	 **/
+	void compile();
+
+
+	QRegExp			_regexp;
+	bool			_enabled;
+	bool			_byName;
+	KExcludeRuleKind	_kind;
+	QCString		_literal;
     };
 
 
+    /**
+     * Index of exclude rules by their literal: All rules with that literal,
+     * in the order they were added.
+     **/
+    typedef QAsciiDict< QPtrList<KExcludeRule> > KExcludeRuleDict;
+
+
     /**
      * Container for multiple exclude rules.
      *
+     * The rules are indexed when they are added: Fixed paths, fixed names
+     * and path rules that only match the last path component (any path
+     * ending with "/\.snapshot") are found with one hash lookup each, no
+     * matter how many of them there are. Only the remaining rules are
+     * tried one by one, and only the ones that really are regular
+     * expressions use QRegExp.
+     *
+     * match() and matchingRule() don't change anything in the rule set, so
+     * they can be called while iterating over the rules with first() and
+     * next(). The QRegExp fallback is not reentrant, though; this is not an
+     * issue as long as all directory reading is done in the main thread.
+     *
      * Normal usage:
      *
      *     KExcludeRules::excludeRules()->add( new KExcludeRule( ... ) );
@@ -126,10 +214,36 @@ namespace KDirStat
 	/**
 	 * Check a string against the exclude rules.
 	 * This will return 'true' if the text matches any (enabled) rule.
+	 **/
+	bool match( const QString & text ) const;
+
+	/**
+	 * Check the 0-terminated path 'path' against the exclude rules. This
+	 * includes the name rules for the last path component.
 	 *
-	 * Note that this operation will move current().
+	 * 'path' is expected in the same 8 bit encoding the directory readers
+	 * pass to lstat() (i.e. what QString's const char * conversion
+	 * returns). This is the fast way for the directory readers that have
+	 * that form at hand anyway.
+	 **/
+	bool match( const char * path ) const;
+
+	/**
+	 * Check the 0-terminated directory name 'name' (without any path)
+	 * against the name rules and against the path rules that only
+	 * depend on the last path component. 'name' is in the same encoding
+	 * as for match().
+	 *
+	 * If this returns 'true', match() would also return 'true' for the
+	 * full path, so directory readers can use this on the raw directory
+	 * entry before doing anything else with it.
+	 **/
+	bool matchName( const char * name ) const;
+
+	/**
+	 * Returns 'true' if there are any rules that matchName() checks.
 	 **/
-	bool match( const QString & text );
+	bool hasNameRules() const { return ! _names.isEmpty() || ! _nameOthers.isEmpty(); }
 
 	/**
 	 * Find the exclude rule that matches 'text'.
@@ -137,20 +251,20 @@ namespace KDirStat
 	 *
 	 * This is intended to explain to the user which rule matched.
 	 **/
-	const KExcludeRule * matchingRule( const QString & text );
+	const KExcludeRule * matchingRule( const QString & text ) const;
 
 	/**
 	 * Returns the first exclude rule of this rule set
 	 * or 0 if there is none.
 	 **/
 	KExcludeRule * first() { return _rules.first(); }
-	
+
 	/**
 	 * Returns the next exclude rule (after first() or next() )
 	 * of this rule set or 0 if there is no more.
 	 **/
 	KExcludeRule * next() { return _rules.next(); }
-	
+
 	/**
 	 * Returns the current exclude rule of this rule set
 	 * or 0 if there is none.
@@ -160,11 +274,37 @@ namespace KDirStat
 	/**
 	 * Clear (delete) all exclude rules.
 	 **/
-	void clear() { _rules.clear(); }
+	void clear();
 
     private:
 
-	QPtrList<KExcludeRule>    _rules;
+	/**
+	 * Returns the first enabled rule in 'rules' that matches the 'len'
+	 * bytes at 'text' or 0 if there is none.
+	 **/
+	static const KExcludeRule * find( const QPtrList<KExcludeRule> & rules,
+					  const char * text, int len );
+
+	/**
+	 * Returns the first enabled rule in 'dict' for 'key' or 0 if there
+	 * is none. There may be several rules with the same literal, and any
+	 * of them may be disabled at any time.
+	 **/
+	static const KExcludeRule * find( const KExcludeRuleDict & dict,
+					  const char * key );
+
+	/**
+	 * Add 'rule' to the rules for 'key' in 'dict'.
+	 **/
+	static void insert( KExcludeRuleDict & dict,
+			    const char * key, KExcludeRule * rule );
+
+
+	QPtrList<KExcludeRule>		_rules;		// all rules, owns them
+	KExcludeRuleDict		_exact;		// by full path
+	KExcludeRuleDict		_names;		// by last path component
+	QPtrList<KExcludeRule>		_others;	// other path rules
+	QPtrList<KExcludeRule>		_nameOthers;	// other name rules
     };
 
 }	// namespace KDirStat
@@ -174,4 +314,3 @@ namespace KDirStat
 
 
 // EOF
-
@@ -0,0 +1,395 @@
+/*
+ *   File name:	kfilefilter.cpp
+ *   Summary:	Support classes for KDirStat - file filters and filtered totals
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <time.h>
+#include <qdatetime.h>
+#include <qstringlist.h>
+#include <kapp.h>
+#include <kconfig.h>
+#include <klocale.h>
+#include <kdebug.h>
+
+#include "kfilefilter.h"
+#include "kdirinfo.h"
+#include "kdirtree.h"
+#include "ktreemapcolors.h"
+
+
+using namespace KDirStat;
+
+
+KFileFilter::KFileFilter()
+    : _exclude( false )
+    , _minSize( 0 )
+    , _maxSize( 0 )
+    , _minAgeDays( 0 )
+    , _maxAgeDays( 0 )
+    , _fileType( KFilterAnyType )
+{
+    _nameRules.setAutoDelete( true );
+}
+
+
+KFileFilter::~KFileFilter()
+{
+    // The name rules list will delete its rules since it has autoDelete
+    // enabled.
+}
+
+
+bool
+KFileFilter::isActive() const
+{
+    return ! _nameRules.isEmpty()
+	|| _minSize    > 0
+	|| _maxSize    > 0
+	|| _minAgeDays > 0
+	|| _maxAgeDays > 0
+	|| _fileType != KFilterAnyType
+	|| ! _category.isEmpty();
+}
+
+
+void
+KFileFilter::setNamePatterns( const QString & patterns )
+{
+    _namePatterns = patterns.simplifyWhiteSpace();
+    _nameRules.clear();
+
+    QStringList list = QStringList::split( ' ', _namePatterns );
+
+    for ( QStringList::Iterator it = list.begin(); it != list.end(); ++it )
+    {
+	// Name rules take care of plain strings and simple wildcards like
+	// "*.log" without any QRegExp.
+
+	_nameRules.append( new KExcludeRule( QRegExp( *it, true, true ), true ) );
+    }
+}
+
+
+void
+KFileFilter::setSizeRange( KFileSize minSize, KFileSize maxSize )
+{
+    _minSize = minSize > 0 ? minSize : 0;
+    _maxSize = maxSize > 0 ? maxSize : 0;
+}
+
+
+void
+KFileFilter::setAgeRange( int minAgeDays, int maxAgeDays )
+{
+    _minAgeDays = minAgeDays > 0 ? minAgeDays : 0;
+    _maxAgeDays = maxAgeDays > 0 ? maxAgeDays : 0;
+}
+
+
+bool
+KFileFilter::matches( KFileInfo * file ) const
+{
+    if ( ! file || isContainer( file ) )
+	return false;
+
+    // Cheapest checks first
+
+    switch ( _fileType )
+    {
+	case KFilterAnyType:						break;
+	case KFilterPlainFiles:		if ( ! file->isFile()    )	return false; break;
+	case KFilterSymLinks:		if ( ! file->isSymLink() )	return false; break;
+	case KFilterSpecialFiles:	if ( ! file->isSpecial() )	return false; break;
+    }
+
+    if ( _minSize > 0 && file->size() < _minSize )	return false;
+    if ( _maxSize > 0 && file->size() > _maxSize )	return false;
+
+    if ( _minAgeDays > 0 || _maxAgeDays > 0 )
+    {
+	time_t referenceTime = file->tree() ? file->tree()->referenceTime() : time( 0 );
+	time_t age = referenceTime - file->mtime();
+	const time_t day = 24*60*60;
+
+	if ( _minAgeDays > 0 && age <  _minAgeDays * day )	return false;
+	if ( _maxAgeDays > 0 && age >= _maxAgeDays * day )	return false;
+    }
+
+    if ( ! _category.isEmpty() &&
+	 KTreemapColors::treemapColors()->category( file ) != _category )
+    {
+	return false;
+    }
+
+    if ( _nameRules.isEmpty() )
+	return true;
+
+    QString name = file->name();
+    QPtrListIterator<KExcludeRule> it( _nameRules );
+
+    while ( *it )
+    {
+	if ( (*it)->match( name ) )
+	    return true;
+
+	++it;
+    }
+
+    return false;
+}
+
+
+QString
+KFileFilter::description() const
+{
+    if ( ! isActive() )
+	return QString::null;
+
+    QStringList criteria;
+
+    if ( ! _namePatterns.isEmpty() )
+	criteria << _namePatterns;
+
+    if ( ! _category.isEmpty() )
+	criteria << _category;
+
+    switch ( _fileType )
+    {
+	case KFilterAnyType:						break;
+	case KFilterPlainFiles:		criteria << i18n( "plain files"	  ); break;
+	case KFilterSymLinks:		criteria << i18n( "symbolic links" ); break;
+	case KFilterSpecialFiles:	criteria << i18n( "special files"  ); break;
+    }
+
+    if ( _minSize > 0 )		criteria << i18n( ">= %1"		).arg( formatSize( _minSize ) );
+    if ( _maxSize > 0 )		criteria << i18n( "<= %1"		).arg( formatSize( _maxSize ) );
+    if ( _minAgeDays > 0 )	criteria << i18n( "older than %1 days"	).arg( _minAgeDays );
+    if ( _maxAgeDays > 0 )	criteria << i18n( "newer than %1 days"	).arg( _maxAgeDays );
+
+    QString text = criteria.join( ", " );
+
+    return _exclude ? i18n( "Without %1" ).arg( text ) : i18n( "Only %1" ).arg( text );
+}
+
+
+void
+KFileFilter::readConfig()
+{
+    KConfig * config = kapp->config();
+    config->setGroup( "File Filter" );
+
+    setExclude	   ( config->readBoolEntry( "Exclude",     false ) );
+    setNamePatterns( config->readEntry    ( "NamePatterns"	 ) );
+    setSizeRange   ( config->readEntry    ( "MinSize", "0" ).toLongLong(),
+		     config->readEntry    ( "MaxSize", "0" ).toLongLong() );
+    setAgeRange    ( config->readNumEntry ( "MinAgeDays",  0     ),
+		     config->readNumEntry ( "MaxAgeDays",  0     ) );
+    setFileType	   ( (KFilterFileType) config->readNumEntry( "FileType", KFilterAnyType ) );
+    setCategory	   ( config->readEntry	  ( "Category"		 ) );
+}
+
+
+void
+KFileFilter::writeConfig() const
+{
+    KConfig * config = kapp->config();
+    config->setGroup( "File Filter" );
+
+    config->writeEntry( "Exclude",	_exclude		    );
+    config->writeEntry( "NamePatterns", _namePatterns		    );
+    config->writeEntry( "MinSize",	QString::number( _minSize ) );
+    config->writeEntry( "MaxSize",	QString::number( _maxSize ) );
+    config->writeEntry( "MinAgeDays",	_minAgeDays		    );
+    config->writeEntry( "MaxAgeDays",	_maxAgeDays		    );
+    config->writeEntry( "FileType",	(int) _fileType		    );
+    config->writeEntry( "Category",	_category		    );
+}
+
+
+
+
+KFilterTotals::KFilterTotals()
+    : QObject()
+    , _root( 0 )
+    , _filter( 0 )
+    , _active( false )
+{
+    connect( &_timer, SIGNAL( timeout()        ),
+	     this,    SLOT  ( timeSlicedWork() ) );
+}
+
+
+KFilterTotals::~KFilterTotals()
+{
+    // NOP
+}
+
+
+void
+KFilterTotals::start( KFileInfo * root, const KFileFilter * filter )
+{
+    bool wasActive = _active;
+
+    _root   = root;
+    _filter = filter;
+    restart();
+
+    if ( ! _active )
+	return;
+
+    if ( work( FilterSliceMillisec ) )
+    {
+	_timer.stop();
+	_active = false;
+
+	if ( wasActive )
+	    emit finished();
+    }
+}
+
+
+void
+KFilterTotals::restart()
+{
+    _stack.clear();
+
+    if ( _root && _filter )
+    {
+	if ( _root->isDirInfo() )
+	{
+	    _stack.push_back( StackEntry( (KDirInfo *) _root ) );
+
+	    if ( _filter->accepts( _root ) )
+		_stack.back().size = _root->size();
+	}
+
+	_root->setFilteredOut( ! _filter->accepts( _root ) );
+    }
+
+    _active = ! _stack.isEmpty();
+
+    if ( _active )
+    {
+	if ( ! _timer.isActive() )
+	    _timer.start( 0 );
+    }
+    else
+    {
+	_timer.stop();
+    }
+}
+
+
+void
+KFilterTotals::abort()
+{
+    _timer.stop();
+    _stack.clear();
+    _root   = 0;
+    _filter = 0;
+    _active = false;
+}
+
+
+void
+KFilterTotals::timeSlicedWork()
+{
+    if ( work( FilterSliceMillisec ) )
+    {
+	_timer.stop();
+	_active = false;
+
+	emit finished();
+    }
+}
+
+
+bool
+KFilterTotals::work( int millisec )
+{
+    QTime time;
+    time.start();
+    int steps = 0;
+
+    while ( ! _stack.isEmpty() )
+    {
+	StackEntry & top   = _stack.back();
+	int	     count = top.dir->childCount();
+
+	if ( top.index < count )
+	{
+	    add( top.dir->childAt( top.index++ ) );	// may invalidate 'top'
+	}
+	else if ( top.index == count )
+	{
+	    top.index++;
+
+	    if ( top.dir->dotEntry() )
+		add( top.dir->dotEntry() );		// invalidates 'top'
+	}
+	else
+	{
+	    // All children are done: This directory's totals are complete
+	    // and go to its parent.
+
+	    KFileSize size  = top.size;
+	    int	      files = top.files;
+
+	    top.dir->setFilteredTotals( size, files );
+	    _stack.pop_back();
+
+	    if ( ! _stack.isEmpty() )
+	    {
+		_stack.back().size  += size;
+		_stack.back().files += files;
+	    }
+	}
+
+	// Checking the clock is not exactly free - do it only every now and
+	// then.
+
+	if ( ++steps % 1024 == 0 && time.elapsed() >= millisec )
+	    return _stack.isEmpty();
+    }
+
+    return true;
+}
+
+
+void
+KFilterTotals::add( KFileInfo * item )
+{
+    bool accepted = _filter->accepts( item );
+    item->setFilteredOut( ! accepted );
+
+    if ( item->isDirInfo() )
+    {
+	StackEntry entry( (KDirInfo *) item );
+
+	if ( accepted )
+	    entry.size = item->size();
+
+	_stack.push_back( entry );
+    }
+    else if ( accepted )
+    {
+	StackEntry & top = _stack.back();
+	top.size += item->size();
+
+	if ( item->isFile() )
+	    top.files++;
+    }
+}
+
+
+
+// EOF
@@ -0,0 +1,331 @@
+/*
+ *   File name:	kfilefilter.h
+ *   Summary:	Support classes for KDirStat - file filters and filtered totals
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KFileFilter_h
+#define KFileFilter_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qobject.h>
+#include <qtimer.h>
+#include <qptrlist.h>
+#include <qvaluevector.h>
+#include "kfileinfo.h"
+#include "kexcluderules.h"
+
+
+// Milliseconds to spend in one slice of a background aggregation of
+// filtered totals before returning to the event loop
+
+#define FilterSliceMillisec	50
+
+
+namespace KDirStat
+{
+    /**
+     * Types of files a @ref KFileFilter can be restricted to.
+     **/
+    typedef enum
+    {
+	KFilterAnyType,		// Anything but directories
+	KFilterPlainFiles,	// Regular files only
+	KFilterSymLinks,	// Symbolic links only
+	KFilterSpecialFiles	// Block and char devices, FIFOs, sockets
+    } KFilterFileType;
+
+
+    /**
+     * Predicate for the files in a @ref KDirTree: A combination of name
+     * patterns, a size range, an age range, a file type and a file category
+     * (as used for the treemap colors, see @ref KTreemapColors). A file
+     * matches if it fulfills all criteria that are set.
+     *
+     * Directories never match; they are only containers for the files that
+     * do. Either way, directories and dot entries are always accepted, so
+     * their own size is always counted and they are never grayed out. Of
+     * all other items, in exclude mode everything that does not match is
+     * accepted; otherwise only the matching ones are.
+     * So "how big is this without *.log" is an exclude filter for "*.log",
+     * "how much space do videos take" an include filter for that category.
+     *
+     * Set a filter for a tree with @ref KDirTree::setFileFilter(); the
+     * filtered totals are then available with @ref
+     * KFileInfo::totalFilteredSize().
+     *
+     * @short File filter predicate
+     **/
+    class KFileFilter
+    {
+    public:
+
+	/**
+	 * Constructor. The new filter does not have any criteria, i.e. it is
+	 * not active.
+	 **/
+	KFileFilter();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KFileFilter();
+
+	/**
+	 * Returns 'true' if any criterion is set. An inactive filter accepts
+	 * everything.
+	 **/
+	bool isActive() const;
+
+	/**
+	 * Returns 'true' if matching files are ignored rather than counted.
+	 **/
+	bool exclude() const { return _exclude; }
+
+	/**
+	 * Set exclude mode.
+	 **/
+	void setExclude( bool exclude ) { _exclude = exclude; }
+
+	/**
+	 * Set the name patterns: Wildcards separated by whitespace, e.g.
+	 * "*.log *.tmp core". A file matches if its name matches any of
+	 * them. An empty string matches any name.
+	 **/
+	void setNamePatterns( const QString & patterns );
+
+	/**
+	 * Returns the name patterns as set with setNamePatterns().
+	 **/
+	QString namePatterns() const { return _namePatterns; }
+
+	/**
+	 * Set the size range in bytes. 0 means no limit for either.
+	 **/
+	void setSizeRange( KFileSize minSize, KFileSize maxSize );
+
+	KFileSize minSize() const { return _minSize; }
+	KFileSize maxSize() const { return _maxSize; }
+
+	/**
+	 * Set the range of ages in days (by mtime, relative to the tree's
+	 * reference time). 0 means no limit for either.
+	 **/
+	void setAgeRange( int minAgeDays, int maxAgeDays );
+
+	int minAgeDays() const { return _minAgeDays; }
+	int maxAgeDays() const { return _maxAgeDays; }
+
+	/**
+	 * Set the type of files that match.
+	 **/
+	void setFileType( KFilterFileType type ) { _fileType = type; }
+
+	KFilterFileType fileType() const { return _fileType; }
+
+	/**
+	 * Set the category ("Image", "Compressed", ...) of files that match.
+	 * An empty string matches any category.
+	 **/
+	void setCategory( const QString & category ) { _category = category; }
+
+	QString category() const { return _category; }
+
+	/**
+	 * Returns 'true' if 'file' fulfills all criteria. Directories and dot
+	 * entries never match.
+	 **/
+	bool matches( KFileInfo * file ) const;
+
+	/**
+	 * Returns 'true' if 'item' is a directory or a dot entry, i.e. one of
+	 * the items that never match but are always accepted.
+	 **/
+	static bool isContainer( KFileInfo * item )
+	    { return item && ( item->isDirInfo() || item->isDir() ); }
+
+	/**
+	 * Returns 'true' if 'item' is to be counted, i.e. if it matches and
+	 * this is an include filter or if it doesn't match and this is an
+	 * exclude filter. Directories and dot entries are always counted in
+	 * either mode.
+	 **/
+	bool accepts( KFileInfo * item ) const
+	    { return ! isActive() || isContainer( item ) || matches( item ) != _exclude; }
+
+	/**
+	 * Returns a short human readable description of this filter, e.g.
+	 * for a status bar.
+	 **/
+	QString description() const;
+
+	/**
+	 * Read and write the filter criteria from / to the global @ref
+	 * KConfig object.
+	 **/
+	void readConfig();
+	void writeConfig() const;
+
+
+    protected:
+
+	bool			_exclude;
+	QString			_namePatterns;
+	QPtrList<KExcludeRule>	_nameRules;
+	KFileSize		_minSize;
+	KFileSize		_maxSize;
+	int			_minAgeDays;
+	int			_maxAgeDays;
+	KFilterFileType		_fileType;
+	QString			_category;
+
+
+    private:
+
+	// Disable copying: The name rules are owned by the filter.
+	KFileFilter( const KFileFilter & );
+	KFileFilter & operator=( const KFileFilter & );
+
+    };	// class KFileFilter
+
+
+
+    /**
+     * Aggregation of the filtered totals of a directory tree: Applies a
+     * @ref KFileFilter to all items below a root and stores the sum of the
+     * sizes of the accepted items in each directory (see @ref
+     * KDirInfo::setFilteredTotals()) and a flag in each item that was not
+     * accepted (see @ref KFileInfo::setFilteredOut()). Nothing is copied;
+     * the results are an overlay over the existing tree.
+     *
+     * This works like @ref KDirTreeRecalc: A bottom-up traversal without
+     * recursion in small time slices from the event loop, so even huge
+     * trees can be filtered again without blocking the application. Each
+     * item is visited exactly once.
+     *
+     * Normally, this is used only through @ref KDirTree.
+     *
+     * @short Time sliced aggregation of filtered totals
+     **/
+    class KFilterTotals: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KFilterTotals();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KFilterTotals();
+
+	/**
+	 * Start aggregating the totals of everything below (and including)
+	 * 'root' with 'filter'. The first slice is done right away, so for
+	 * small trees everything is up to date when this returns, and
+	 * finished() is not emitted. Otherwise the rest is done in the
+	 * background, and finished() is emitted when it's done.
+	 *
+	 * 'filter' is not owned by this object; it has to stay valid until
+	 * this is finished or aborted.
+	 **/
+	void start( KFileInfo * root, const KFileFilter * filter );
+
+	/**
+	 * Start over from the root without doing any work right away.
+	 * Use this when the tree changed structurally while the aggregation
+	 * is in progress.
+	 **/
+	void restart();
+
+	/**
+	 * Stop aggregating and forget everything about the tree. Use this
+	 * before deleting any part of the tree.
+	 **/
+	void abort();
+
+	/**
+	 * Returns 'true' if there is still work to do, i.e. if filtered
+	 * totals may be stale.
+	 **/
+	bool isActive() const { return _active; }
+
+
+    signals:
+
+	/**
+	 * Emitted when a background aggregation is finished, i.e. all
+	 * filtered totals are up to date.
+	 **/
+	void finished();
+
+
+    protected slots:
+
+	/**
+	 * Do one time slice worth of aggregation.
+	 **/
+	void timeSlicedWork();
+
+
+    protected:
+
+	/**
+	 * Aggregate for at most 'millisec' milliseconds.
+	 * Returns 'true' if everything is done.
+	 **/
+	bool work( int millisec );
+
+	/**
+	 * Apply the filter to 'item': Add it to the directory on top of the
+	 * stack if it is a plain file, push it if it is a directory.
+	 **/
+	void add( KFileInfo * item );
+
+
+	/**
+	 * One level of the traversal: The directory, the index of the next
+	 * child to visit (index childCount() stands for the dot entry) and
+	 * the totals of the accepted items so far.
+	 **/
+	struct StackEntry
+	{
+	    StackEntry( KDirInfo * d = 0 )
+		: dir( d ), index( 0 ), size( 0 ), files( 0 ) {}
+
+	    KDirInfo *	dir;
+	    int		index;
+	    KFileSize	size;
+	    int		files;
+	};
+
+
+	// Data members
+
+	KFileInfo *			_root;
+	const KFileFilter *		_filter;
+	QValueVector<StackEntry>	_stack;
+	QTimer				_timer;
+	bool				_active;
+
+    };	// class KFilterTotals
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KFileFilter_h
+
+
+// EOF
@@ -0,0 +1,220 @@
+/*
+ *   File name:	kfilefilterdialog.cpp
+ *   Summary:	Dialog to set the file filter of a directory tree
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qcombobox.h>
+#include <qlabel.h>
+#include <qlayout.h>
+#include <qlineedit.h>
+#include <qspinbox.h>
+
+#include <klocale.h>
+
+#include "kfilefilterdialog.h"
+#include "kfilefilter.h"
+#include "kdirtree.h"
+#include "ktreemapcolors.h"
+
+
+// Sizes are entered in MB
+
+#define SizeUnit	( 1024LL * 1024LL )
+
+
+using namespace KDirStat;
+
+
+KFileFilterDialog::KFileFilterDialog( KDirTree * tree, QWidget * parent )
+    : KDialogBase( Plain,				// dialogFace
+		   i18n( "File Filter" ),		// caption
+		   Apply | User1 | Close,		// buttonMask
+		   Apply,				// defaultButton
+		   parent,				// parent
+		   0,					// name
+		   false )				// modal
+    , _tree( tree )
+{
+    setButtonText( User1, i18n( "&Remove Filter" ) );
+
+    QWidget *	  page	 = plainPage();
+    QVBoxLayout * layout = new QVBoxLayout( page, 0, spacingHint() );
+    QGridLayout * grid	 = new QGridLayout( layout, 7, 4 );
+    int		  row	 = 0;
+
+    _mode = new QComboBox( false, page );
+    _mode->insertItem( i18n( "Count only files that match" ) );
+    _mode->insertItem( i18n( "Ignore files that match"	    ) );
+    grid->addMultiCellWidget( _mode, row, row, 0, 3 );
+    row++;
+
+    _namePatterns = new QLineEdit( page );
+    grid->addWidget( new QLabel( _namePatterns, i18n( "&Names:" ), page ), row, 0 );
+    grid->addMultiCellWidget( _namePatterns, row, row, 1, 3 );
+    row++;
+
+    _category = new QComboBox( false, page );
+    _category->insertItem( i18n( "Any" ) );
+    _category->insertStringList( KTreemapColors::categoryNames() );
+    grid->addWidget( new QLabel( _category, i18n( "&Category:" ), page ), row, 0 );
+    grid->addMultiCellWidget( _category, row, row, 1, 3 );
+    row++;
+
+    // Same order as KFilterFileType
+
+    _fileType = new QComboBox( false, page );
+    _fileType->insertItem( i18n( "Any"		  ) );
+    _fileType->insertItem( i18n( "Plain Files"	  ) );
+    _fileType->insertItem( i18n( "Symbolic Links" ) );
+    _fileType->insertItem( i18n( "Special Files"  ) );
+    grid->addWidget( new QLabel( _fileType, i18n( "&Type:" ), page ), row, 0 );
+    grid->addMultiCellWidget( _fileType, row, row, 1, 3 );
+    row++;
+
+    _minSize = new QSpinBox( 0, 1000000, 1, page );
+    _maxSize = new QSpinBox( 0, 1000000, 1, page );
+    _minSize->setSuffix( " MB" );
+    _maxSize->setSuffix( " MB" );
+    _minSize->setSpecialValueText( i18n( "No Limit" ) );
+    _maxSize->setSpecialValueText( i18n( "No Limit" ) );
+    grid->addWidget( new QLabel( _minSize, i18n( "&Size from:" ), page ), row, 0 );
+    grid->addWidget( _minSize, row, 1 );
+    grid->addWidget( new QLabel( _maxSize, i18n( "t&o:" ), page ), row, 2 );
+    grid->addWidget( _maxSize, row, 3 );
+    row++;
+
+    _minAge = new QSpinBox( 0, 100000, 1, page );
+    _maxAge = new QSpinBox( 0, 100000, 1, page );
+    _minAge->setSuffix( i18n( " days" ) );
+    _maxAge->setSuffix( i18n( " days" ) );
+    _minAge->setSpecialValueText( i18n( "No Limit" ) );
+    _maxAge->setSpecialValueText( i18n( "No Limit" ) );
+    grid->addWidget( new QLabel( _minAge, i18n( "&Older than:" ), page ), row, 0 );
+    grid->addWidget( _minAge, row, 1 );
+    grid->addWidget( new QLabel( _maxAge, i18n( "&Newer than:" ), page ), row, 2 );
+    grid->addWidget( _maxAge, row, 3 );
+    row++;
+
+    _totalsLabel = new QLabel( page );
+    layout->addWidget( _totalsLabel );
+    layout->addStretch();
+
+    connect( _tree,	SIGNAL( filterFinished() ),
+	     this,	SLOT  ( showTotals()	 ) );
+
+    connect( _tree,	SIGNAL( childDeleted()	 ),
+	     this,	SLOT  ( showTotals()	 ) );
+
+    connect( _tree,	SIGNAL( finished()	 ),
+	     this,	SLOT  ( showTotals()	 ) );
+
+    if ( _tree->fileFilter() )
+    {
+	setup( *_tree->fileFilter() );
+    }
+    else
+    {
+	KFileFilter lastFilter;
+	lastFilter.readConfig();
+	setup( lastFilter );
+    }
+
+    showTotals();
+}
+
+
+KFileFilterDialog::~KFileFilterDialog()
+{
+    // NOP
+}
+
+
+void
+KFileFilterDialog::setup( const KFileFilter & filter )
+{
+    _mode->setCurrentItem( filter.exclude() ? 1 : 0 );
+    _namePatterns->setText( filter.namePatterns() );
+    _fileType->setCurrentItem( (int) filter.fileType() );
+    _minSize->setValue( (int) ( filter.minSize() / SizeUnit ) );
+    _maxSize->setValue( (int) ( filter.maxSize() / SizeUnit ) );
+    _minAge->setValue( filter.minAgeDays() );
+    _maxAge->setValue( filter.maxAgeDays() );
+    _category->setCurrentItem( 0 );
+
+    for ( int i=1; i < _category->count(); i++ )
+    {
+	if ( _category->text( i ) == filter.category() )
+	    _category->setCurrentItem( i );
+    }
+}
+
+
+KFileFilter *
+KFileFilterDialog::createFilter() const
+{
+    KFileFilter * filter = new KFileFilter();
+    CHECK_PTR( filter );
+
+    filter->setExclude( _mode->currentItem() == 1 );
+    filter->setNamePatterns( _namePatterns->text() );
+    filter->setFileType( (KFilterFileType) _fileType->currentItem() );
+    filter->setSizeRange( _minSize->value() * SizeUnit, _maxSize->value() * SizeUnit );
+    filter->setAgeRange( _minAge->value(), _maxAge->value() );
+
+    if ( _category->currentItem() > 0 )
+	filter->setCategory( _category->currentText() );
+
+    return filter;
+}
+
+
+void
+KFileFilterDialog::slotApply()
+{
+    KFileFilter * filter = createFilter();
+    filter->writeConfig();
+
+    _totalsLabel->setText( i18n( "Filtering..." ) );
+    _tree->setFileFilter( filter );	// Transfers ownership
+}
+
+
+void
+KFileFilterDialog::slotUser1()
+{
+    _tree->setFileFilter( 0 );
+}
+
+
+void
+KFileFilterDialog::showTotals()
+{
+    KFileInfo * root = _tree->root();
+
+    if ( ! _tree->fileFilter() || ! root )
+    {
+	_totalsLabel->setText( i18n( "No filter." ) );
+	return;
+    }
+
+    if ( _tree->isFilterPending() )
+	return;
+
+    _totalsLabel->setText( i18n( "%1 of %2 in %3 files" )
+			   .arg( formatSize( root->totalFilteredSize() ) )
+			   .arg( formatSize( root->totalSize() ) )
+			   .arg( root->totalFilteredFiles() ) );
+}
+
+
+
+// EOF
@@ -0,0 +1,114 @@
+/*
+ *   File name:	kfilefilterdialog.h
+ *   Summary:	Dialog to set the file filter of a directory tree
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KFileFilterDialog_h
+#define KFileFilterDialog_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <kdialogbase.h>
+
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QSpinBox;
+
+
+namespace KDirStat
+{
+    class KDirTree;
+    class KFileFilter;
+
+
+    /**
+     * Non-modal dialog to set the file filter of a @ref KDirTree (see @ref
+     * KFileFilter): Name patterns, size and age ranges, file type and file
+     * category, and whether matching files are the only ones to count or
+     * the ones to ignore.
+     *
+     * "Apply" sets the filter; the tree view then shows the filtered totals
+     * in its "Filtered Size" column, and the treemap grays out everything
+     * that is filtered out. "Remove Filter" goes back to the normal totals.
+     * The criteria are saved in the config file for the next time.
+     *
+     * @short Dialog for the file filter
+     **/
+    class KFileFilterDialog: public KDialogBase
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KFileFilterDialog( KDirTree * tree, QWidget * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KFileFilterDialog();
+
+
+    protected slots:
+
+	/**
+	 * Reimplemented from @ref KDialogBase: Set the filter.
+	 **/
+	virtual void slotApply();
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Remove Filter" button.
+	 **/
+	virtual void slotUser1();
+
+	/**
+	 * Show the filtered totals of the entire tree.
+	 **/
+	void showTotals();
+
+
+    protected:
+
+	/**
+	 * Fill the widgets with the criteria of 'filter'.
+	 **/
+	void setup( const KFileFilter & filter );
+
+	/**
+	 * Create a new filter from the criteria in the widgets.
+	 **/
+	KFileFilter * createFilter() const;
+
+
+	KDirTree *	_tree;
+	QComboBox *	_mode;
+	QLineEdit *	_namePatterns;
+	QComboBox *	_category;
+	QComboBox *	_fileType;
+	QSpinBox *	_minSize;
+	QSpinBox *	_maxSize;
+	QSpinBox *	_minAge;
+	QSpinBox *	_maxAge;
+	QLabel *	_totalsLabel;
+
+    };	// class KFileFilterDialog
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KFileFilterDialog_h
+
+
+// EOF
@@ -21,6 +21,7 @@
 #include "kfileinfo.h"
 #include "kdirinfo.h"
 #include "kdirsaver.h"
+#include "kdirtree.h"
 
 // Some file systems (NTFS seems to be among them) may handle block fragments well.
 // Don't report files as "sparse" files if the block size is only a few bytes
@@ -36,11 +37,17 @@ KFileInfo::KFileInfo( KDirTree   *	tree,
 		      KDirInfo   *	parent,
 		      const char *	name )
     : _parent( parent )
-    , _next( 0 )
+    , _childIndex( -1 )
     , _tree( tree )
 {
     _isLocalFile	= true;
     _isSparseFile	= false;
+    _countsLinksOnce	= false;
+    _isDuplicateLink	= false;
+    _isFilteredOut	= false;
+    _ageBucket		= 0;
+    _linkIndex		= 0;
+    _owner		= NoOwner;
     _name	 	= name ? name : "";
     _device	 	= 0;
     _mode	 	= 0;
@@ -56,18 +63,43 @@ KFileInfo::KFileInfo( const QString &	filenameWithoutPath,
 		      KDirTree    *	tree,
 		      KDirInfo	  *	parent )
     : _parent( parent )
-    , _next( 0 )
+    , _childIndex( -1 )
     , _tree( tree )
+{
+    _isLocalFile   = true;
+    _name	   = filenameWithoutPath;
+    _isFilteredOut = false;
+    _linkIndex	   = 0;
+
+    update( statInfo );
+
+#if 0
+#warning Debug mode: Huge sizes
+    _size <<= 10;
+#endif
+}
+
+
+void
+KFileInfo::update( struct stat * statInfo )
 {
     CHECK_PTR( statInfo );
 
-    _isLocalFile = true;
-    _name	 = filenameWithoutPath;
+    // This might not even be the same i-node any more: Let go of the old
+    // one first.
+
+    if ( _linkIndex && _tree )
+	_tree->hardLinks().removeLink( this );
 
     _device	 = statInfo->st_dev;
     _mode	 = statInfo->st_mode;
     _links	 = statInfo->st_nlink;
     _mtime	 = statInfo->st_mtime;
+    _owner	 = _tree ? _tree->ownerTable().index( statInfo->st_uid, statInfo->st_gid ) : NoOwner;
+    _countsLinksOnce = false;
+    _isDuplicateLink = false;
+    _ageBucket	 = ! _tree ? 0 :
+	KDirStat::ageBucket( _tree->ageByAccessTime() ? statInfo->st_atime : _mtime, _tree->referenceTime() );
 
     if ( isSpecial() )
     {
@@ -98,12 +130,13 @@ KFileInfo::KFileInfo( const QString &	filenameWithoutPath,
 	    kdDebug() << _links << " hard links: " << this << endl;
 	}
 #endif
-    }
 
-#if 0
-#warning Debug mode: Huge sizes
-    _size <<= 10;
-#endif
+	if ( isFile() && _links > 1 && _tree && _tree->countHardLinksOnce() )
+	{
+	    _countsLinksOnce = true;
+	    _isDuplicateLink = ! _tree->hardLinks().addLink( statInfo->st_dev, statInfo->st_ino, this );
+	}
+    }
 }
 
 
@@ -111,7 +144,7 @@ KFileInfo::KFileInfo(  const KFileItem	* fileItem,
 		       KDirTree    	* tree,
 		       KDirInfo		* parent )
     : _parent( parent )
-    , _next( 0 )
+    , _childIndex( -1 )
     , _tree( tree )
 {
     CHECK_PTR( fileItem );
@@ -121,6 +154,7 @@ KFileInfo::KFileInfo(  const KFileItem	* fileItem,
     _device	 = 0;
     _mode	 = fileItem->mode();
     _links	 = 1;
+    _owner	 = NoOwner;	// KFileItem only has the user and group names
 
 
     if ( isSpecial() )
@@ -148,6 +182,13 @@ KFileInfo::KFileInfo(  const KFileItem	* fileItem,
     }
 
     _mtime	 = fileItem->time( KIO::UDS_MODIFICATION_TIME );
+    _countsLinksOnce = false;
+    _isDuplicateLink = false;
+    _isFilteredOut   = false;
+    _linkIndex	 = 0;
+    _ageBucket	 = ! tree ? 0 :
+	KDirStat::ageBucket( tree->ageByAccessTime() ? fileItem->time( KIO::UDS_ACCESS_TIME ) : _mtime,
+		   tree->referenceTime() );
 }
 
 
@@ -160,7 +201,7 @@ KFileInfo::KFileInfo( KDirTree * 	tree,
 		      KFileSize	   	blocks,
 		      nlink_t	   	links )
     : _parent( parent )
-    , _next( 0 )
+    , _childIndex( -1 )
     , _tree( tree )
 {
     _name		= filenameWithoutPath;
@@ -169,6 +210,12 @@ KFileInfo::KFileInfo( KDirTree * 	tree,
     _size	 	= size;
     _mtime	 	= mtime;
     _links	 	= links;
+    _owner		= NoOwner;
+    _countsLinksOnce	= false;
+    _isDuplicateLink	= false;
+    _isFilteredOut	= false;
+    _linkIndex		= 0;
+    _ageBucket		= tree ? KDirStat::ageBucket( _mtime, tree->referenceTime() ) : 0;
 
     if ( blocks < 0 )
     {
@@ -190,7 +237,11 @@ KFileInfo::KFileInfo( KDirTree * 	tree,
 
 KFileInfo::~KFileInfo()
 {
-    // NOP
+    // If this link is charged with the disk space of its i-node, hand that
+    // over to another link that is still in the tree.
+
+    if ( _linkIndex && _tree )
+	_tree->hardLinks().removeLink( this );
 
 
     /**
@@ -206,6 +257,28 @@ KFileInfo::~KFileInfo()
 }
 
 
+uid_t
+KFileInfo::uid() const
+{
+    return _tree ? _tree->ownerTable().uid( _owner ) : (uid_t) -1;
+}
+
+
+gid_t
+KFileInfo::gid() const
+{
+    return _tree ? _tree->ownerTable().gid( _owner ) : (gid_t) -1;
+}
+
+
+void
+KFileInfo::setOwner( uid_t uid, gid_t gid )
+{
+    if ( _tree )
+	_owner = _tree->ownerTable().index( uid, gid );
+}
+
+
 KFileSize
 KFileInfo::allocatedSize() const
 {
@@ -218,13 +291,46 @@ KFileInfo::size() const
 {
     KFileSize sz = _isSparseFile ? allocatedSize() : _size;
 
-    if ( _links > 1 )
+    if ( _countsLinksOnce )
+    {
+	if ( _isDuplicateLink )
+	    sz = 0;
+    }
+    else if ( _links > 1 )
+    {
 	sz /= _links;
+    }
 
     return sz;
 }
 
 
+KFileSize
+KFileInfo::totalColdSize()
+{
+    KFileSize sum = 0;
+
+    for ( int bucket = KColdAgeBucket; bucket < KAgeBuckets; bucket++ )
+	sum += totalAgeSize( bucket );
+
+    return sum;
+}
+
+
+KFileSize
+KFileInfo::totalFilteredSize()
+{
+    return isFilteredOut() ? 0 : size();
+}
+
+
+bool
+KFileInfo::isFilteredOut() const
+{
+    return _isFilteredOut && _tree && _tree->fileFilter();
+}
+
+
 QString
 KFileInfo::url() const
 {
@@ -298,6 +404,16 @@ KFileInfo::treeLevel() const
 }
 
 
+KFileInfo *
+KFileInfo::next() const
+{
+    if ( ! _parent || _childIndex < 0 )
+	return 0;
+
+    return _parent->childAt( _childIndex + 1 );
+}
+
+
 bool
 KFileInfo::hasChildren() const
 {
@@ -346,16 +462,14 @@ KFileInfo::locate( QString url, bool findDotEntries )
 
 	// Search all children
 
-	KFileInfo *child = firstChild();
+	int count = childCount();
 
-	while ( child )
+	for ( int i=0; i < count; i++ )
 	{
-	    KFileInfo *foundChild = child->locate( url, findDotEntries );
+	    KFileInfo *foundChild = childAt( i )->locate( url, findDotEntries );
 
 	    if ( foundChild )
 		return foundChild;
-	    else
-		child = child->next();
 	}
 
 
@@ -428,6 +542,37 @@ KDirStat::fixedUrl( const QString & dirtyUrl )
 
 
 
+int
+KDirStat::ageBucket( time_t time, time_t referenceTime )
+{
+    const time_t day = 24*60*60;
+    time_t	 age = referenceTime - time;
+
+    if ( age < 30	* day )	return 0;
+    if ( age < 182	* day )	return 1;
+    if ( age < 365	* day )	return 2;
+    if ( age < 2 * 365	* day )	return 3;
+
+    return 4;
+}
+
+
+QString
+KDirStat::ageBucketName( int bucket )
+{
+    switch ( bucket )
+    {
+	case 0:	return i18n( "Less than 1 Month"	);
+	case 1:	return i18n( "1 - 6 Months"		);
+	case 2:	return i18n( "6 - 12 Months"		);
+	case 3:	return i18n( "1 - 2 Years"		);
+	case 4:	return i18n( "More than 2 Years"	);
+    }
+
+    return QString::null;
+}
+
+
 QString
 KDirStat::formatSize( KFileSize lSize )
 {
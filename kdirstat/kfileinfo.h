@@ -40,6 +40,18 @@ namespace KDirStat
     // This is how much bytes this program can handle.
 #define KFileSizeMax 9223372036854775807LL
 
+    // Compact reference to one (uid, gid) pair in the KOwnerTable of a
+    // KDirTree. NoOwner is for items whose owner is not known (remote files,
+    // old cache files).
+    typedef unsigned short KOwnerIndex;
+#define NoOwner 0
+
+    // Age buckets for the age histograms of directories: Number of buckets
+    // and the first bucket that is considered "cold" data (older than one
+    // year). See ageBucket().
+#define KAgeBuckets	5
+#define KColdAgeBucket	3
+
     // Forward declarations
     class KDirInfo;
     class KDirTree;
@@ -102,6 +114,13 @@ namespace KDirStat
 		   KDirTree    *	tree,
 		   KDirInfo    *	parent = 0 );
 
+	/**
+	 * Take over size, blocks, mtime, links etc. from a new stat buffer,
+	 * e.g. when the file changed on disk. The caller is responsible for
+	 * notifying the tree (see @ref KDirTree::itemChangedNotify() ).
+	 **/
+	void update( struct stat * statInfo );
+
 	/**
 	 * Constructor from a KFileItem, i.e. from a @ref KIO::StatJob
 	 **/
@@ -197,6 +216,40 @@ namespace KDirStat
 	 **/
 	nlink_t			links()		const { return _links;	}
 
+	/**
+	 * Returns 'true' if the owner of this item is known. This is only the
+	 * case for local files and for cache files that contain the owners.
+	 **/
+	bool			hasOwner()	const { return _owner != NoOwner; }
+
+	/**
+	 * The user ID of the owner or (uid_t) -1 if it is not known.
+	 **/
+	uid_t			uid()		const;
+
+	/**
+	 * The group ID of the owner or (gid_t) -1 if it is not known.
+	 **/
+	gid_t			gid()		const;
+
+	/**
+	 * Set the owner. This adds 'uid' and 'gid' to the owner table of the
+	 * tree if necessary.
+	 **/
+	void			setOwner( uid_t uid, gid_t gid );
+
+	/**
+	 * The index of the owner in the owner table of the tree (see @ref
+	 * KDirTree::ownerTable()) or @ref NoOwner. Intended for fast
+	 * aggregation per owner.
+	 **/
+	KOwnerIndex		ownerIndex()	const { return _owner; }
+
+	/**
+	 * Set the owner by index in the owner table of the tree.
+	 **/
+	void			setOwnerIndex( KOwnerIndex index ) { _owner = index; }
+
 	/**
 	 * The file size in bytes. This does not take unused space in the last
 	 * disk block (cluster) into account, yet it is the only size all kinds
@@ -229,6 +282,10 @@ namespace KDirStat
 	 * the true allocated size for sparse files. For plain files with
 	 * multiple links this will be size/no_links, for sparse files it is
 	 * the number of bytes actually allocated.
+	 *
+	 * If hard links are counted only once (see @ref countsLinksOnce()),
+	 * plain files with multiple links have their full size if they are
+	 * the first link to their i-node in the tree and 0 otherwise.
 	 **/
 	KFileSize		size()		const;
 
@@ -258,7 +315,7 @@ namespace KDirStat
 	 * Returns the total size in blocks of this subtree.
 	 * Derived classes that have children should overwrite this.
 	 **/
-	virtual KFileSize	totalBlocks()	{ return _blocks; }
+	virtual KFileSize	totalBlocks()	{ return _isDuplicateLink ? 0 : _blocks; }
 
 	/**
 	 * Returns the total number of children in this subtree, excluding this item.
@@ -286,6 +343,57 @@ namespace KDirStat
 	 **/
 	virtual time_t		latestMtime()	{ return _mtime;  }
 
+	/**
+	 * Returns the age bucket (0 .. KAgeBuckets-1, see @ref
+	 * KDirStat::ageBucket() ) of this item. This is based on the
+	 * modification time or, if the tree was configured to do that while
+	 * this was read, on the access time.
+	 **/
+	int			ageBucket()	const { return _ageBucket; }
+
+	/**
+	 * Returns the total size of all items in this subtree (including this
+	 * item) in age bucket 'bucket'. The sizes of all buckets add up to
+	 * @ref totalSize().
+	 * Derived classes that have children should overwrite this.
+	 **/
+	virtual KFileSize	totalAgeSize( int bucket )
+	    { return bucket == _ageBucket ? size() : 0; }
+
+	/**
+	 * Returns the total size of all items in this subtree that are older
+	 * than one year ("cold" data), i.e. the sum of the age buckets from
+	 * KColdAgeBucket on.
+	 **/
+	KFileSize		totalColdSize();
+
+	/**
+	 * Returns the total size of all items in this subtree (including this
+	 * item) that are accepted by the tree's file filter (see @ref
+	 * KDirTree::setFileFilter() ). This is the same as totalSize() if
+	 * there is no filter.
+	 * Derived classes that have children should overwrite this.
+	 **/
+	virtual KFileSize	totalFilteredSize();
+
+	/**
+	 * Returns the total number of plain files in this subtree that are
+	 * accepted by the tree's file filter.
+	 * Derived classes that have children should overwrite this.
+	 **/
+	virtual int		totalFilteredFiles()	{ return 0; }
+
+	/**
+	 * Returns 'true' if the tree has a file filter that does not accept
+	 * this item.
+	 **/
+	bool			isFilteredOut() const;
+
+	/**
+	 * Set the "filtered out" flag. This is done only by @ref KFilterTotals.
+	 **/
+	void			setFilteredOut( bool filteredOut ) { _isFilteredOut = filteredOut; }
+
 	/**
 	 * Returns 'true' if this had been excluded while reading.
 	 * Derived classes may want to overwrite this.
@@ -365,13 +473,23 @@ namespace KDirStat
 	/**
 	 * Returns a pointer to the next entry on the same level
 	 * or 0 if there is none.
+	 *
+	 * This is a lookup in the parent's children array. When iterating
+	 * over all children, childAt() with an index is cheaper.
 	 **/
-	KFileInfo *	next()			const { return _next;	}
+	KFileInfo *	next()			const;
 
 	/**
-	 * Set the "next" pointer.
+	 * Returns this entry's index in its parent's children array or -1 if
+	 * it is not (or no longer) stored there.
+	 **/
+	int		childIndex()		const { return _childIndex; }
+
+	/**
+	 * Set the index in the parent's children array.
+	 * Use this method only if you know exactly what you are doing.
 	 **/
-	void		setNext( KFileInfo *newNext ) { _next = newNext; }
+	void		setChildIndex( int index ) { _childIndex = index; }
 
 	/**
 	 * Returns the first child of this item or 0 if there is none.
@@ -382,14 +500,22 @@ namespace KDirStat
 	virtual KFileInfo * firstChild()	const { return 0;	}
 
 	/**
-	 * Set this entry's first child.
-	 * Use this method only if you know exactly what you are doing.
+	 * Returns the number of direct children of this item, not counting
+	 * the dot entry.
 	 *
-	 * This default implementation does nothing.
-	 * Derived classes might want to overwrite this.
+	 * This default implementation always returns 0.
+	 **/
+	virtual int	childCount()		const { return 0;	}
+
+	/**
+	 * Returns the child with index 'index' or 0 if there is none.
+	 * Together with childCount() this is the fastest way to iterate over
+	 * all direct children.
+	 *
+	 * This default implementation always returns 0.
 	 **/
-	virtual void	setFirstChild( KFileInfo *newFirstChild )
-	    { NOT_USED( newFirstChild ); }
+	virtual KFileInfo * childAt( int index ) const
+	    { NOT_USED( index ); return 0; }
 
 	/**
 	 * Returns true if this entry has any children.
@@ -522,6 +648,37 @@ namespace KDirStat
 	 **/
 	bool isSparseFile() const { return _isSparseFile; }
 
+	/**
+	 * Returns 'true' if this is a plain file with multiple hard links
+	 * that was read while hard links were to be counted only once (see
+	 * @ref KDirTree::countHardLinksOnce()): Its disk space is charged to
+	 * one single link to its i-node rather than split among all links.
+	 **/
+	bool countsLinksOnce() const { return _countsLinksOnce; }
+
+	/**
+	 * Returns 'true' if this is a hard link that is not charged with any
+	 * disk space since another link to the same i-node already is.
+	 **/
+	bool isDuplicateLink() const { return _isDuplicateLink; }
+
+	/**
+	 * Charge this item with the entire disk space of its i-node (if
+	 * 'isDuplicate' is false) or with none at all (if 'isDuplicate' is
+	 * true) rather than splitting it among all links.
+	 **/
+	void setCountLinksOnce( bool isDuplicate )
+	    { _countsLinksOnce = true; _isDuplicateLink = isDuplicate; }
+
+	/**
+	 * Returns the index of this link in the tree's hard link table (see
+	 * @ref KHardLinkTable) or 0 if it is not in there.
+	 *
+	 * Normally, this is used only by @ref KHardLinkTable.
+	 **/
+	uint linkIndex() const { return _linkIndex; }
+	void setLinkIndex( uint index ) { _linkIndex = index; }
+
 
 	//
 	// File type / mode convenience methods.
@@ -590,6 +747,12 @@ namespace KDirStat
 	QString		_name;			// the file name (without path!)
 	bool		_isLocalFile  :1;	// flag: local or remote file?
 	bool		_isSparseFile :1;	// (cache) flag: sparse file (file with "holes")?
+	bool		_countsLinksOnce :1;	// (cache) flag: charge all space to one hard link?
+	bool		_isDuplicateLink :1;	// (cache) flag: hard link not charged with any space?
+	unsigned	_ageBucket :3;		// (cache) age bucket by mtime or atime
+	bool		_isFilteredOut :1;	// (overlay) flag: not accepted by the tree's file filter?
+	KOwnerIndex	_owner;			// index of uid and gid in the tree's owner table
+	uint		_linkIndex;		// index in the tree's hard link table or 0
 	dev_t		_device;		// device this object resides on
 	mode_t		_mode;			// file permissions + object type
 	nlink_t		_links;			// number of links
@@ -598,7 +761,7 @@ namespace KDirStat
 	time_t		_mtime;			// modification time
 
 	KDirInfo *	_parent;		// pointer to the parent entry
-	KFileInfo *	_next;			// pointer to the next entry
+	int		_childIndex;		// index in the parent's children array
 	KDirTree  *	_tree;			// pointer to the parent tree
 	
     };	// class KFileInfo
@@ -627,6 +790,26 @@ namespace KDirStat
     QString formatSize ( KFileSize lSize );
 
 
+    /**
+     * Returns the age bucket (0 .. KAgeBuckets-1) of time stamp 'time' at
+     * 'referenceTime' (usually when the tree was read):
+     *
+     *	   0	less than 1 month old
+     *	   1	1 - 6 months
+     *	   2	6 - 12 months
+     *	   3	1 - 2 years
+     *	   4	more than 2 years
+     **/
+    int ageBucket( time_t time, time_t referenceTime );
+
+
+    /**
+     * Returns a human readable name for age bucket 'bucket'
+     * ("1 - 6 Months", ...).
+     **/
+    QString ageBucketName( int bucket );
+
+
     /**
      * Print the debugUrl() of a @ref KFileInfo in a debug stream.
      **/
@@ -0,0 +1,286 @@
+/*
+ *   File name:	kfiletypestats.cpp
+ *   Summary:	Support classes for KDirStat - sizes per file type
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <stdio.h>
+#include <qtl.h>
+#include <qvaluevector.h>
+#include <kdebug.h>
+
+#include "kfiletypestats.h"
+#include "ktreemapcolors.h"
+#include "ktopnquery.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KFileTypeStats::KFileTypeStats( KDirTree * tree, QObject * parent )
+    : QObject( parent )
+    , _tree( tree )
+    , _subtree( 0 )
+    , _active( false )
+    , _suffixes( 1009 )
+    , _categories( 17 )
+    , _totalCount( 0 )
+    , _totalSize( 0 )
+{
+    _suffixes.setAutoDelete( true );
+    _categories.setAutoDelete( true );
+
+    connect( _tree, SIGNAL( childAdded	( KFileInfo * ) ),
+	     this,  SLOT  ( childAdded	( KFileInfo * ) ) );
+
+    connect( _tree, SIGNAL( deletingChild( KFileInfo * ) ),
+	     this,  SLOT  ( deletingChild( KFileInfo * ) ) );
+
+    connect( _tree, SIGNAL( startingReading() ),
+	     this,  SLOT  ( startingReading() ) );
+}
+
+
+KFileTypeStats::~KFileTypeStats()
+{
+    // The dicts will delete their entries since they have autoDelete enabled.
+}
+
+
+void
+KFileTypeStats::clear()
+{
+    _suffixes.clear();
+    _categories.clear();
+    _totalCount = 0;
+    _totalSize	= 0;
+}
+
+
+void
+KFileTypeStats::collect( KFileInfo * subtree )
+{
+    clear();
+    _subtree = subtree;
+    _active  = true;
+
+    KFileInfo * root = _subtree ? _subtree : _tree->root();
+
+    if ( root )
+	addSubtree( root, 1 );
+}
+
+
+void
+KFileTypeStats::addSubtree( KFileInfo * subtree, int sign )
+{
+    // Traverse the tree without any recursion: Large trees can be very
+    // deep, and there is nothing to be gained from recursion here anyway.
+
+    QValueVector<KFileInfo *> stack;
+    stack.push_back( subtree );
+
+    while ( ! stack.isEmpty() )
+    {
+	KFileInfo * item = stack.back();
+	stack.pop_back();
+
+	if ( item->isFile() )
+	    add( item, sign );
+
+	if ( item->dotEntry() )
+	    stack.push_back( item->dotEntry() );
+
+	int count = item->childCount();
+
+	for ( int i=0; i < count; i++ )
+	{
+	    KFileInfo * child = item->childAt( i );
+
+	    if ( child->isDirInfo() )
+		stack.push_back( child );
+	    else if ( child->isFile() )
+		add( child, sign );
+	}
+    }
+}
+
+
+void
+KFileTypeStats::add( KFileInfo * file, int sign )
+{
+    QString suffix   = KTopNQuery::suffix( file->name() );
+    QString category = KTreemapColors::treemapColors()->category( file );
+
+    addToEntry( _suffixes,
+		suffix.isEmpty() ? QString( NoneKey ) : suffix,
+		suffix, category, file->size(), sign );
+
+    addToEntry( _categories,
+		category.isEmpty() ? QString( NoneKey ) : category,
+		category, category, file->size(), sign );
+
+    _totalCount += sign;
+    _totalSize	+= sign * file->size();
+}
+
+
+void
+KFileTypeStats::addToEntry( QDict<KFileTypeStatsEntry> &	dict,
+			    const QString &			key,
+			    const QString &			name,
+			    const QString &			category,
+			    KFileSize				size,
+			    int					sign )
+{
+    KFileTypeStatsEntry * entry = dict.find( key );
+
+    if ( ! entry )
+    {
+	if ( sign < 0 )
+	{
+	    kdError() << "No file type statistics for " << key << endl;
+	    return;
+	}
+
+	entry = new KFileTypeStatsEntry( name, category );
+	CHECK_PTR( entry );
+	dict.insert( key, entry );
+    }
+
+    entry->size	 += sign * size;
+    entry->count += sign;
+
+    if ( entry->count <= 0 )
+	dict.remove( key );		// autoDelete deletes the entry
+}
+
+
+KFileTypeStatsList
+KFileTypeStats::sorted( const QDict<KFileTypeStatsEntry> & dict )
+{
+    KFileTypeStatsList list;
+    QDictIterator<KFileTypeStatsEntry> it( dict );
+
+    while ( it.current() )
+    {
+	list.append( *it.current() );
+	++it;
+    }
+
+    qHeapSort( list );		// KFileTypeStatsEntry::operator< sorts largest first
+
+    return list;
+}
+
+
+void
+KFileTypeStats::childAdded( KFileInfo * newChild )
+{
+    if ( newChild->isFile() && tracks( newChild ) )
+	add( newChild, 1 );
+}
+
+
+void
+KFileTypeStats::deletingChild( KFileInfo * deletedChild )
+{
+    if ( ! _active )
+	return;
+
+    if ( _subtree && _subtree->isInSubtree( deletedChild ) )
+    {
+	// The subtree itself is being deleted - nothing left to keep track of
+
+	clear();
+	_subtree = 0;
+	_active  = false;
+    }
+    else if ( ! _subtree && deletedChild == _tree->root() )
+    {
+	clear();
+    }
+    else if ( tracks( deletedChild ) )
+    {
+	addSubtree( deletedChild, -1 );
+    }
+}
+
+
+void
+KFileTypeStats::startingReading()
+{
+    // If there is no root, the old tree was cleared without any deletingChild()
+    // signal, and this is a completely new tree.
+
+    if ( ! _tree->root() )
+    {
+	clear();
+
+	if ( _subtree )
+	{
+	    _subtree = 0;
+	    _active  = false;
+	}
+    }
+}
+
+
+
+
+KFileTypeStatsJob::KFileTypeStatsJob( const QString & input )
+    : KBatchJob( input )
+{
+    // NOP
+}
+
+
+KFileTypeStatsJob::~KFileTypeStatsJob()
+{
+    // NOP
+}
+
+
+bool
+KFileTypeStatsJob::process( KDirTree * tree )
+{
+    if ( ! tree->root() )
+    {
+	kdError() << "Nothing read from " << _input << endl;
+	return false;
+    }
+
+    KFileTypeStats stats( tree );
+    stats.collect();
+
+    KFileTypeStatsList list = KFileTypeStats::sorted( stats.suffixes() );
+    KFileTypeStatsList::const_iterator it = list.begin();
+
+    // Suffixes come from file names, i.e. the raw bytes from readdir() as
+    // Latin-1. Category names are plain ASCII config keys.
+
+    while ( it != list.end() )
+    {
+	printf( "%s\t%s\t%d\t%lld\n",
+		(*it).category.isEmpty() ? "Other" : (const char *) (*it).category.latin1(),
+		(*it).name.isEmpty()	 ? "-"     : (const char *) (*it).name.latin1(),
+		(*it).count,
+		(long long) (*it).size );
+	++it;
+    }
+
+    return fflush( stdout ) == 0;
+}
+
+
+
+// EOF
@@ -0,0 +1,264 @@
+/*
+ *   File name:	kfiletypestats.h
+ *   Summary:	Support classes for KDirStat - sizes per file type
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KFileTypeStats_h
+#define KFileTypeStats_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qobject.h>
+#include <qdict.h>
+#include <qvaluelist.h>
+#include "kfileinfo.h"
+#include "kbatchjob.h"
+
+
+// Dict key for files without a suffix / without a category in
+// KFileTypeStats. '/' can't be part of a file name, so it can't be a suffix.
+
+#define NoneKey		"/"
+
+
+namespace KDirStat
+{
+    class KDirTree;
+
+
+    /**
+     * Number of files and sum of their sizes for one filename suffix or one
+     * file category in @ref KFileTypeStats.
+     **/
+    class KFileTypeStatsEntry
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KFileTypeStatsEntry( const QString & nam = QString( "" ),
+			     const QString & cat = QString( "" ) )
+	    : name( nam )
+	    , category( cat )
+	    , size( 0 )
+	    , count( 0 )
+	    {}
+
+	/**
+	 * Sort order for reports: Larger sizes first.
+	 **/
+	bool operator<( const KFileTypeStatsEntry & other ) const
+	    { return size > other.size; }
+
+	QString		name;		// suffix (lowercase, without '.') or category
+	QString		category;	// category of a suffix; empty for "other"
+	KFileSize	size;		// sum of the sizes of all files
+	int		count;		// number of files
+
+    };	// class KFileTypeStatsEntry
+
+
+    typedef QValueList<KFileTypeStatsEntry> KFileTypeStatsList;
+
+
+    /**
+     * Statistics about how much space each file type takes: The number of
+     * files and the sum of their sizes per filename suffix (".o", ".log",
+     * ...) and per category ("Object", "Document", ...) in a subtree.
+     *
+     * The categories are the same as for the treemap colors (see @ref
+     * KTreemapColors), so they can be changed in the config file.
+     *
+     * collect() makes one pass over the tree in memory; after that, the
+     * statistics are kept up to date as the tree emits its childAdded() and
+     * deletingChild() signals, so they can be displayed again at any time
+     * without any traversal.
+     *
+     * @short Sizes per file type
+     **/
+    class KFileTypeStats: public QObject
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KFileTypeStats( KDirTree * tree, QObject * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KFileTypeStats();
+
+	/**
+	 * Discard everything and collect the statistics for 'subtree' - or
+	 * for the entire tree if 'subtree' is 0. The entire tree includes
+	 * anything that is read into the tree later.
+	 **/
+	void collect( KFileInfo * subtree = 0 );
+
+	/**
+	 * Returns the subtree the statistics are for or 0 for the entire
+	 * tree.
+	 **/
+	KFileInfo * subtree() const { return _subtree; }
+
+	/**
+	 * Returns 'true' if the statistics are being kept up to date, 'false'
+	 * if they were discarded because the subtree was deleted.
+	 **/
+	bool isActive() const { return _active; }
+
+	/**
+	 * Returns the statistics per filename suffix. The keys are the
+	 * lowercase suffixes; files without a suffix are counted with key "/".
+	 **/
+	const QDict<KFileTypeStatsEntry> & suffixes() const { return _suffixes; }
+
+	/**
+	 * Returns the statistics per category. Files that don't belong to any
+	 * category are counted with key "/".
+	 **/
+	const QDict<KFileTypeStatsEntry> & categories() const { return _categories; }
+
+	/**
+	 * Returns the entries of 'dict', largest first.
+	 **/
+	static KFileTypeStatsList sorted( const QDict<KFileTypeStatsEntry> & dict );
+
+	/**
+	 * Returns the total number of files.
+	 **/
+	int totalCount() const { return _totalCount; }
+
+	/**
+	 * Returns the sum of the sizes of all files.
+	 **/
+	KFileSize totalSize() const { return _totalSize; }
+
+	/**
+	 * Discard all statistics.
+	 **/
+	void clear();
+
+
+    public slots:
+
+	/**
+	 * Notification that a child has been added to the tree.
+	 **/
+	void childAdded( KFileInfo * newChild );
+
+	/**
+	 * Notification that a child is about to be deleted from the tree.
+	 **/
+	void deletingChild( KFileInfo * deletedChild );
+
+	/**
+	 * Notification that the tree starts reading.
+	 **/
+	void startingReading();
+
+
+    protected:
+
+	/**
+	 * Add 'file' to the statistics (if 'sign' is 1) or remove it
+	 * (if 'sign' is -1).
+	 **/
+	void add( KFileInfo * file, int sign );
+
+	/**
+	 * Add or remove all files in 'subtree', depending on 'sign'.
+	 **/
+	void addSubtree( KFileInfo * subtree, int sign );
+
+	/**
+	 * Add 'size' and 'sign' to the entry with key 'key' in 'dict',
+	 * creating it if necessary and removing it when its count drops to
+	 * zero.
+	 **/
+	void addToEntry( QDict<KFileTypeStatsEntry> &	dict,
+			 const QString &		key,
+			 const QString &		name,
+			 const QString &		category,
+			 KFileSize			size,
+			 int				sign );
+
+	/**
+	 * Returns 'true' if 'item' is in the subtree the statistics are for.
+	 **/
+	bool tracks( KFileInfo * item ) const
+	    { return _active && ( ! _subtree || item->isInSubtree( _subtree ) ); }
+
+
+	// Data members
+
+	KDirTree *			_tree;
+	KFileInfo *			_subtree;
+	bool				_active;
+	QDict<KFileTypeStatsEntry>	_suffixes;
+	QDict<KFileTypeStatsEntry>	_categories;
+	int				_totalCount;
+	KFileSize			_totalSize;
+
+    };	// class KFileTypeStats
+
+
+
+    /**
+     * Batch driver for KFileTypeStats: Reads a directory or a cache file and
+     * prints the statistics per suffix to stdout, largest first, one per
+     * line:
+     *
+     *     <category> TAB <suffix> TAB <number of files> TAB <size in bytes>
+     *
+     * Used for "kdirstat --file-types".
+     *
+     * @short Batch output of the file type statistics
+     **/
+    class KFileTypeStatsJob: public KBatchJob
+    {
+    public:
+
+	/**
+	 * Constructor. 'input' is either a directory (path or URL) or a
+	 * KDirStat cache file.
+	 **/
+	KFileTypeStatsJob( const QString & input );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KFileTypeStatsJob();
+
+
+    protected:
+
+	/**
+	 * Collect and print the statistics.
+	 *
+	 * Reimplemented - inherited from @ref KBatchJob.
+	 **/
+	virtual bool process( KDirTree * tree );
+
+    };	// class KFileTypeStatsJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KFileTypeStats_h
+
+
+// EOF
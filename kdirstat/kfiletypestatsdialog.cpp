@@ -0,0 +1,221 @@
+/*
+ *   File name:	kfiletypestatsdialog.cpp
+ *   Summary:	Dialog with the sizes per file type
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qdict.h>
+#include <qlabel.h>
+#include <qlayout.h>
+
+#include <kapp.h>
+#include <klistview.h>
+#include <klocale.h>
+
+#include "kfiletypestatsdialog.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KFileTypeStatsDialog::KFileTypeStatsDialog( KDirTree * tree, QWidget * parent )
+    : KDialogBase( Plain,				// dialogFace
+		   i18n( "File Type Statistics" ),	// caption
+		   User1 | Close,			// buttonMask
+		   User1,				// defaultButton
+		   parent,				// parent
+		   0,					// name
+		   false )				// modal
+    , _tree( tree )
+{
+    setButtonText( User1, i18n( "&Refresh" ) );
+
+    _stats = new KFileTypeStats( _tree, this );
+    CHECK_PTR( _stats );
+
+    QWidget *	  page	 = plainPage();
+    QVBoxLayout * layout = new QVBoxLayout( page, 0, spacingHint() );
+
+    _subtreeLabel = new QLabel( page );
+    layout->addWidget( _subtreeLabel );
+
+    _list = new KListView( page );
+    _list->addColumn( i18n( "Name"	) );
+    _list->addColumn( i18n( "Files"	) );
+    _list->addColumn( i18n( "Size"	) );
+    _list->addColumn( i18n( "%"		) );
+    _list->setColumnAlignment( 1, AlignRight );
+    _list->setColumnAlignment( 2, AlignRight );
+    _list->setColumnAlignment( 3, AlignRight );
+    _list->setAllColumnsShowFocus( true );
+    _list->setRootIsDecorated( true );
+    _list->setSorting( 2, false );		// largest first
+    layout->addWidget( _list, 1 );
+
+    connect( _tree,	SIGNAL( finished()	),
+	     this,	SLOT  ( populate()	) );
+
+    connect( _tree,	SIGNAL( childDeleted()	),
+	     this,	SLOT  ( populate()	) );
+
+    resize( 500, 450 );
+}
+
+
+KFileTypeStatsDialog::~KFileTypeStatsDialog()
+{
+    // NOP
+}
+
+
+void
+KFileTypeStatsDialog::slotUser1()
+{
+    refresh();
+}
+
+
+void
+KFileTypeStatsDialog::refresh()
+{
+    // Use the selected directory if there is one, the entire tree otherwise.
+
+    KFileInfo * subtree = _tree->selection();
+
+    if ( subtree && ! subtree->isDirInfo() )
+	subtree = 0;
+
+    kapp->setOverrideCursor( waitCursor );
+    _stats->collect( subtree );
+    kapp->restoreOverrideCursor();
+
+    populate();
+}
+
+
+void
+KFileTypeStatsDialog::populate()
+{
+    _list->clear();
+
+    if ( ! _stats->isActive() )
+    {
+	_subtreeLabel->setText( "" );
+	return;
+    }
+
+    KFileInfo * subtree = _stats->subtree() ? _stats->subtree() : _tree->root();
+    _subtreeLabel->setText( subtree ? i18n( "In %1" ).arg( subtree->url() ) : QString( "" ) );
+
+    KFileSize totalSize = _stats->totalSize();
+
+
+    // Categories
+
+    QDict<KFileTypeStatsListItem> categoryItems( 17 );
+    QDictIterator<KFileTypeStatsEntry> it( _stats->categories() );
+
+    while ( it.current() )
+    {
+	categoryItems.insert( it.currentKey(),
+			      new KFileTypeStatsListItem( _list, *it.current(), totalSize ) );
+	++it;
+    }
+
+
+    // Suffixes below their categories
+
+    QDictIterator<KFileTypeStatsEntry> suffixIt( _stats->suffixes() );
+
+    while ( suffixIt.current() )
+    {
+	const QString & category = suffixIt.current()->category;
+	KFileTypeStatsListItem * parent =
+	    categoryItems.find( category.isEmpty() ? QString( NoneKey ) : category );
+
+	if ( parent )
+	    new KFileTypeStatsListItem( parent, *suffixIt.current(), totalSize );
+
+	++suffixIt;
+    }
+}
+
+
+
+
+KFileTypeStatsListItem::KFileTypeStatsListItem( QListView *			parent,
+						const KFileTypeStatsEntry &	entry,
+						KFileSize			totalSize )
+    : QListViewItem( parent )
+    , _entry( entry )
+{
+    init( entry.name.isEmpty() ? i18n( "Other" ) : i18n( entry.name.utf8() ),
+	  totalSize );
+}
+
+
+KFileTypeStatsListItem::KFileTypeStatsListItem( QListViewItem *			parent,
+						const KFileTypeStatsEntry &	entry,
+						KFileSize			totalSize )
+    : QListViewItem( parent )
+    , _entry( entry )
+{
+    init( entry.name.isEmpty() ? i18n( "<no extension>" ) : "*." + entry.name,
+	  totalSize );
+}
+
+
+void
+KFileTypeStatsListItem::init( const QString & name, KFileSize totalSize )
+{
+    setText( 0, name );
+    setText( 1, QString::number( _entry.count ) );
+    setText( 2, formatSize( _entry.size ) );
+
+    if ( totalSize > 0 )
+	setText( 3, QString::number( 100.0 * _entry.size / totalSize, 'f', 1 ) + "%" );
+}
+
+
+int
+KFileTypeStatsListItem::compare( QListViewItem *	otherListViewItem,
+				 int			col,
+				 bool			ascending ) const
+{
+    KFileTypeStatsListItem * other = dynamic_cast<KFileTypeStatsListItem *>( otherListViewItem );
+
+    if ( other )
+    {
+	switch ( col )
+	{
+	    case 1:
+		if ( _entry.count < other->_entry.count ) return -1;
+		if ( _entry.count > other->_entry.count ) return  1;
+		return 0;
+
+	    case 2:
+	    case 3:
+		if ( _entry.size < other->_entry.size ) return -1;
+		if ( _entry.size > other->_entry.size ) return  1;
+		return 0;
+
+	    default:
+		break;
+	}
+    }
+
+    return QListViewItem::compare( otherListViewItem, col, ascending );
+}
+
+
+
+// EOF
@@ -0,0 +1,145 @@
+/*
+ *   File name:	kfiletypestatsdialog.h
+ *   Summary:	Dialog with the sizes per file type
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KFileTypeStatsDialog_h
+#define KFileTypeStatsDialog_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qlistview.h>
+#include <kdialogbase.h>
+#include "kfiletypestats.h"
+
+
+class QLabel;
+class KListView;
+
+
+namespace KDirStat
+{
+    class KDirTree;
+
+
+    /**
+     * Non-modal dialog that shows a table with the number of files and the
+     * sum of their sizes per file category and, below each category, per
+     * filename suffix for the selected subtree (or for the entire tree if
+     * nothing or a file is selected).
+     *
+     * The underlying @ref KFileTypeStats are kept up to date while the tree
+     * changes; the table is redisplayed when reading is finished or after
+     * anything was deleted. "Refresh" collects the statistics again for the
+     * current selection.
+     *
+     * @short Dialog for the sizes per file type
+     **/
+    class KFileTypeStatsDialog: public KDialogBase
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KFileTypeStatsDialog( KDirTree * tree, QWidget * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KFileTypeStatsDialog();
+
+
+    public slots:
+
+	/**
+	 * Collect the statistics again for the current selection and display
+	 * them.
+	 **/
+	void refresh();
+
+	/**
+	 * Display the current statistics.
+	 **/
+	void populate();
+
+
+    protected slots:
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Refresh" button.
+	 **/
+	virtual void slotUser1();
+
+
+    protected:
+
+	KDirTree *		_tree;
+	KFileTypeStats *	_stats;
+	QLabel *		_subtreeLabel;
+	KListView *		_list;
+
+    };	// class KFileTypeStatsDialog
+
+
+
+    /**
+     * List item for one @ref KFileTypeStatsEntry in a @ref
+     * KFileTypeStatsDialog. Sorts numerically by number of files, size and
+     * percentage.
+     **/
+    class KFileTypeStatsListItem: public QListViewItem
+    {
+    public:
+
+	/**
+	 * Constructor for a toplevel (category) item.
+	 **/
+	KFileTypeStatsListItem( QListView *			parent,
+				const KFileTypeStatsEntry &	entry,
+				KFileSize			totalSize );
+
+	/**
+	 * Constructor for a suffix item below a category item.
+	 **/
+	KFileTypeStatsListItem( QListViewItem *			parent,
+				const KFileTypeStatsEntry &	entry,
+				KFileSize			totalSize );
+
+	/**
+	 * Comparison function used for sorting the list.
+	 *
+	 * Reimplemented from @ref QListViewItem.
+	 **/
+	virtual int compare( QListViewItem *	other,
+			     int		col,
+			     bool		ascending ) const;
+
+    protected:
+
+	/**
+	 * Set the column texts.
+	 **/
+	void init( const QString & name, KFileSize totalSize );
+
+	KFileTypeStatsEntry	_entry;
+
+    };	// class KFileTypeStatsListItem
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KFileTypeStatsDialog_h
+
+
+// EOF
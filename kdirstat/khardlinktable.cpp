@@ -0,0 +1,305 @@
+/*
+ *   File name:	khardlinktable.cpp
+ *   Summary:	Support classes for KDirStat - hard link bookkeeping
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "khardlinktable.h"
+#include "kdirinfo.h"
+
+
+#define InitialSlots	1024	// must be a power of 2
+
+
+using namespace KDirStat;
+
+
+KHardLinkTable::KHardLinkTable()
+{
+    clear();
+}
+
+
+KHardLinkTable::~KHardLinkTable()
+{
+    // NOP
+}
+
+
+void
+KHardLinkTable::clear()
+{
+    _slots.clear();
+    _links.clear();
+    _inodes.clear();
+    _promoted.clear();
+
+    // Entry 0 of each is a dummy so 0 can mean "none"
+
+    _links.push_back( Link() );
+    _inodes.push_back( Inode() );
+
+    _freeLinks	= 0;
+    _freeInodes	= 0;
+    _count	= 0;
+}
+
+
+uint
+KHardLinkTable::homeSlot( dev_t dev, ino_t ino ) const
+{
+    // Mix device and i-node number; i-node numbers are often sequential, so
+    // multiply to spread them over the table.
+
+    Q_ULLONG hash = ( (Q_ULLONG) ino ) * 0x9E3779B97F4A7C15ULL + (Q_ULLONG) dev;
+
+    return (uint) ( hash >> 32 ) & ( _slots.size() - 1 );
+}
+
+
+uint
+KHardLinkTable::findSlot( dev_t dev, ino_t ino ) const
+{
+    uint mask = _slots.size() - 1;
+    uint i    = homeSlot( dev, ino );
+
+    while ( _slots[i] != 0 &&
+	    ( _inodes[ _slots[i] ].ino != ino || _inodes[ _slots[i] ].dev != dev ) )
+    {
+	i = ( i + 1 ) & mask;
+    }
+
+    return i;
+}
+
+
+void
+KHardLinkTable::removeSlot( uint slot )
+{
+    uint mask = _slots.size() - 1;
+    uint i    = slot;
+
+    while ( true )
+    {
+	i = ( i + 1 ) & mask;
+
+	if ( _slots[i] == 0 )
+	    break;
+
+	// Leave entries alone that would not be found any more when moved
+	// in front of their home slot (cyclically).
+
+	const Inode & inode = _inodes[ _slots[i] ];
+	uint home = homeSlot( inode.dev, inode.ino );
+
+	bool stays = slot <= i ?
+	    ( slot < home && home <= i ) :
+	    ( slot < home || home <= i );
+
+	if ( ! stays )
+	{
+	    _slots[ slot ] = _slots[i];
+	    slot = i;
+	}
+    }
+
+    _slots[ slot ] = 0;
+}
+
+
+void
+KHardLinkTable::grow()
+{
+    QValueVector<uint> oldSlots = _slots;
+
+    _slots.clear();
+    _slots.resize( oldSlots.isEmpty() ? InitialSlots : 2 * oldSlots.size(), 0 );
+
+    for ( uint i=0; i < oldSlots.size(); i++ )
+    {
+	if ( oldSlots[i] != 0 )
+	{
+	    const Inode & inode = _inodes[ oldSlots[i] ];
+	    _slots[ findSlot( inode.dev, inode.ino ) ] = oldSlots[i];
+	}
+    }
+}
+
+
+uint
+KHardLinkTable::newLink()
+{
+    if ( _freeLinks == 0 )
+    {
+	_links.push_back( Link() );
+	return _links.size() - 1;
+    }
+
+    uint i = _freeLinks;
+    _freeLinks = _links[i].next;
+    _links[i] = Link();
+
+    return i;
+}
+
+
+uint
+KHardLinkTable::newInode()
+{
+    if ( _freeInodes == 0 )
+    {
+	_inodes.push_back( Inode() );
+	return _inodes.size() - 1;
+    }
+
+    uint i = _freeInodes;
+    _freeInodes = _inodes[i].first;
+    _inodes[i] = Inode();
+
+    return i;
+}
+
+
+bool
+KHardLinkTable::addLink( dev_t dev, ino_t ino, KFileInfo * item )
+{
+    // Keep the load factor below 3/4 so the probe sequences stay short
+
+    if ( 4 * ( _count + 1 ) > 3 * (int) _slots.size() )
+	grow();
+
+    uint slot = findSlot( dev, ino );
+
+    if ( _slots[ slot ] == 0 )		// New i-node
+    {
+	uint i = newInode();
+	_inodes[i].dev	= dev;
+	_inodes[i].ino	= ino;
+	_slots[ slot ]	= i;
+	_count++;
+    }
+
+    uint   i	  = _slots[ slot ];
+    uint   link	  = newLink();
+    Inode & inode = _inodes[i];
+
+    _links[ link ].item	 = item;
+    _links[ link ].inode = i;
+    _links[ link ].prev	 = inode.last;
+
+    if ( inode.last )
+	_links[ inode.last ].next = link;
+    else
+	inode.first = link;
+
+    inode.last = link;
+    item->setLinkIndex( link );
+
+    // If all previous links were deleted, this one takes over.
+
+    return inode.first == link;
+}
+
+
+void
+KHardLinkTable::removeLink( KFileInfo * item )
+{
+    uint link = item->linkIndex();
+
+    if ( link == 0 || link >= _links.size() || _links[ link ].item != item )
+	return;
+
+    Link    gone  = _links[ link ];
+    Inode & inode = _inodes[ gone.inode ];
+
+    if ( gone.prev )
+	_links[ gone.prev ].next = gone.next;
+    else
+	inode.first = gone.next;
+
+    if ( gone.next )
+	_links[ gone.next ].prev = gone.prev;
+    else
+	inode.last = gone.prev;
+
+    item->setLinkIndex( 0 );
+
+    _links[ link ]	= Link();
+    _links[ link ].next	= _freeLinks;
+    _freeLinks		= link;
+
+    if ( inode.first == 0 )
+    {
+	// That was the last link: Get rid of the i-node altogether.
+
+	removeSlot( findSlot( inode.dev, inode.ino ) );
+
+	inode		= Inode();
+	inode.first	= _freeInodes;
+	_freeInodes	= gone.inode;
+	_count--;
+    }
+    else if ( gone.prev == 0 )
+    {
+	// Promote the next link: It is charged with the disk space now.
+
+	Link & next = _links[ inode.first ];
+	next.item->setCountLinksOnce( false );
+
+	if ( ! next.promoted )
+	{
+	    next.promoted = true;
+	    _promoted.push_back( inode.first );
+	}
+    }
+}
+
+
+void
+KHardLinkTable::applyPromotions()
+{
+    for ( uint i=0; i < _promoted.size(); i++ )
+    {
+	// Links that were deleted in the meantime are no longer marked.
+
+	Link & link = _links[ _promoted[i] ];
+
+	if ( link.promoted )
+	{
+	    link.promoted = false;
+
+	    if ( link.item->parent() )
+		link.item->parent()->childChanged();
+	}
+    }
+
+    _promoted.clear();
+}
+
+
+bool
+KHardLinkTable::inode( const KFileInfo * item, dev_t & dev, ino_t & ino ) const
+{
+    uint link = item->linkIndex();
+
+    if ( link == 0 || link >= _links.size() || _links[ link ].item != item )
+	return false;
+
+    const Inode & inode = _inodes[ _links[ link ].inode ];
+    dev = inode.dev;
+    ino = inode.ino;
+
+    return true;
+}
+
+
+
+// EOF
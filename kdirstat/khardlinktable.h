@@ -0,0 +1,183 @@
+/*
+ *   File name:	khardlinktable.h
+ *   Summary:	Support classes for KDirStat - hard link bookkeeping
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KHardLinkTable_h
+#define KHardLinkTable_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <qvaluevector.h>
+#include "kfileinfo.h"
+
+
+namespace KDirStat
+{
+    /**
+     * Set of the i-nodes (device and i-node number) of all plain files with
+     * more than one hard link in a @ref KDirTree, together with the links
+     * to each of them that are in the tree. The first of them is charged
+     * with the disk space of that i-node. All other links of the same i-node
+     * are duplicates that don't take any disk space of their own.
+     *
+     * Only files with more than one link are ever added, so this doesn't
+     * cost any memory for all other files. Each link knows its own entry in
+     * this table (see @ref KFileInfo::linkIndex() ), and the links of each
+     * i-node are a doubly linked list of such entries, so adding and
+     * removing a link takes constant time. Entries of removed links and
+     * i-nodes are reused.
+     *
+     * @short Hard link bookkeeping for counting each i-node only once
+     **/
+    class KHardLinkTable
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KHardLinkTable();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KHardLinkTable();
+
+	/**
+	 * Add a link to i-node 'ino' on device 'dev'. Returns 'true' if
+	 * 'item' is the first link to that i-node and is to be charged with
+	 * its disk space, 'false' if it is a duplicate.
+	 **/
+	bool addLink( dev_t dev, ino_t ino, KFileInfo * item );
+
+	/**
+	 * Remove link 'item' because it is about to be deleted. If it was
+	 * charged with the disk space of its i-node, the next remaining link
+	 * takes over. The summaries of its ancestors are not touched yet; see
+	 * @ref applyPromotions().
+	 *
+	 * This is a NOP if 'item' is not in this table.
+	 **/
+	void removeLink( KFileInfo * item );
+
+	/**
+	 * Mark the summaries of the ancestors of all links that took over
+	 * their i-node's disk space since the last call as dirty.
+	 *
+	 * Deleting a subtree may remove many links, and many of the links
+	 * taking over may be deleted along with them, so this is done only
+	 * once afterwards - for the links that are still there.
+	 **/
+	void applyPromotions();
+
+	/**
+	 * Look up the i-node of link 'item'. Returns 'false' if 'item' is not
+	 * in this table.
+	 **/
+	bool inode( const KFileInfo * item, dev_t & dev, ino_t & ino ) const;
+
+	/**
+	 * Returns the number of i-nodes in this table.
+	 **/
+	int count() const { return _count; }
+
+	/**
+	 * Returns 'true' if there are no i-nodes in this table.
+	 **/
+	bool isEmpty() const { return _count == 0; }
+
+	/**
+	 * Discard all entries.
+	 **/
+	void clear();
+
+
+    protected:
+
+	/**
+	 * One link. Entry 0 is never used so 0 can mean "none". Unused
+	 * entries are chained via 'next'.
+	 **/
+	struct Link
+	{
+	    Link(): item( 0 ), inode( 0 ), prev( 0 ), next( 0 ), promoted( false ) {}
+
+	    KFileInfo *	item;
+	    uint	inode;		// index in _inodes
+	    uint	prev;		// previous link to the same i-node
+	    uint	next;		// next link to the same i-node
+	    bool	promoted;	// took over the disk space, ancestors not dirty yet
+	};
+
+	/**
+	 * One i-node with the list of its links. The first link is the one
+	 * charged with the disk space. Entry 0 is never used. Unused entries
+	 * are chained via 'first'.
+	 **/
+	struct Inode
+	{
+	    Inode(): dev( 0 ), ino( 0 ), first( 0 ), last( 0 ) {}
+
+	    dev_t	dev;
+	    ino_t	ino;
+	    uint	first;		// index in _links
+	    uint	last;		// index in _links
+	};
+
+	/**
+	 * Returns the slot where the hash table probing for 'dev' and 'ino'
+	 * starts.
+	 **/
+	uint homeSlot( dev_t dev, ino_t ino ) const;
+
+	/**
+	 * Returns the index of the slot for 'dev' and 'ino' or of the unused
+	 * slot where it would have to be inserted.
+	 **/
+	uint findSlot( dev_t dev, ino_t ino ) const;
+
+	/**
+	 * Empty slot 'slot' and move later slots of the same probe sequence
+	 * back so all remaining i-nodes can still be found.
+	 **/
+	void removeSlot( uint slot );
+
+	/**
+	 * Double the size of the hash table.
+	 **/
+	void grow();
+
+	/**
+	 * Return an unused entry of _links or _inodes, respectively.
+	 **/
+	uint newLink();
+	uint newInode();
+
+
+	QValueVector<uint>	_slots;		// index in _inodes or 0 if unused
+	QValueVector<Link>	_links;
+	QValueVector<Inode>	_inodes;
+	QValueVector<uint>	_promoted;	// index in _links
+	uint			_freeLinks;
+	uint			_freeInodes;
+	int			_count;
+
+    };	// class KHardLinkTable
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KHardLinkTable_h
+
+
+// EOF
@@ -0,0 +1,306 @@
+/*
+ *   File name:	kownerstats.cpp
+ *   Summary:	Support classes for KDirStat - disk usage per user and group
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <stdio.h>
+#include <pwd.h>
+#include <grp.h>
+#include <qtl.h>
+#include <kdebug.h>
+
+#include "kownerstats.h"
+#include "kdirtree.h"
+
+
+#define MaxOwnerIndex	65535
+
+
+using namespace KDirStat;
+
+
+KOwnerTable::KOwnerTable()
+{
+    clear();
+}
+
+
+KOwnerTable::~KOwnerTable()
+{
+    // NOP
+}
+
+
+void
+KOwnerTable::clear()
+{
+    _uids.clear();
+    _gids.clear();
+    _indices.clear();
+
+    // Index 0 is NoOwner
+
+    _uids.push_back( (uid_t) -1 );
+    _gids.push_back( (gid_t) -1 );
+    _lastIndex = NoOwner;
+}
+
+
+KOwnerIndex
+KOwnerTable::index( uid_t uid, gid_t gid )
+{
+    // Most files in a directory belong to the same owner, so check the last
+    // one first.
+
+    if ( _lastIndex != NoOwner && _uids[ _lastIndex ] == uid && _gids[ _lastIndex ] == gid )
+	return _lastIndex;
+
+    Q_ULLONG key = ( ( (Q_ULLONG) uid ) << 32 ) | (Q_ULLONG) gid;
+    QMap<Q_ULLONG, KOwnerIndex>::iterator it = _indices.find( key );
+
+    if ( it != _indices.end() )
+    {
+	_lastIndex = it.data();
+	return _lastIndex;
+    }
+
+    if ( _uids.size() > MaxOwnerIndex )
+    {
+	static bool warned = false;
+
+	if ( ! warned )
+	{
+	    kdWarning() << "Too many different owners - not recording any more" << endl;
+	    warned = true;
+	}
+
+	return NoOwner;
+    }
+
+    _lastIndex = _uids.size();
+    _uids.push_back( uid );
+    _gids.push_back( gid );
+    _indices.insert( key, _lastIndex );
+
+    return _lastIndex;
+}
+
+
+uid_t
+KOwnerTable::uid( KOwnerIndex index ) const
+{
+    return index < _uids.size() ? _uids[ index ] : (uid_t) -1;
+}
+
+
+gid_t
+KOwnerTable::gid( KOwnerIndex index ) const
+{
+    return index < _gids.size() ? _gids[ index ] : (gid_t) -1;
+}
+
+
+QString
+KOwnerTable::userName( uid_t uid )
+{
+    static QMap<uid_t, QString> names;
+
+    QMap<uid_t, QString>::iterator it = names.find( uid );
+
+    if ( it != names.end() )
+	return it.data();
+
+    struct passwd * pw = getpwuid( uid );
+    QString name = pw ? QString::fromLatin1( pw->pw_name ) : QString::number( uid );
+    names.insert( uid, name );
+
+    return name;
+}
+
+
+QString
+KOwnerTable::groupName( gid_t gid )
+{
+    static QMap<gid_t, QString> names;
+
+    QMap<gid_t, QString>::iterator it = names.find( gid );
+
+    if ( it != names.end() )
+	return it.data();
+
+    struct group * gr = getgrgid( gid );
+    QString name = gr ? QString::fromLatin1( gr->gr_name ) : QString::number( gid );
+    names.insert( gid, name );
+
+    return name;
+}
+
+
+
+
+KOwnerStats::KOwnerStats( KDirTree * tree )
+    : _tree( tree )
+    , _totalSize( 0 )
+{
+    // NOP
+}
+
+
+KOwnerStats::~KOwnerStats()
+{
+    // NOP
+}
+
+
+void
+KOwnerStats::collect( KFileInfo * subtree )
+{
+    _users.clear();
+    _groups.clear();
+    _totalSize = 0;
+
+    if ( ! subtree )
+	return;
+
+    const KOwnerTable & owners = _tree->ownerTable();
+
+
+    // Sum up the sizes per owner index. Only an array lookup per item, no
+    // name or map lookups. Traverse the tree without any recursion since
+    // large trees can be very deep.
+
+    QValueVector<KOwnerStatsEntry> perIndex( owners.count() );
+    QValueVector<KFileInfo *> stack;
+    stack.push_back( subtree );
+
+    while ( ! stack.isEmpty() )
+    {
+	KFileInfo * item = stack.back();
+	stack.pop_back();
+
+	if ( ! item->isDotEntry() && item->ownerIndex() < perIndex.size() )
+	{
+	    KOwnerStatsEntry & entry = perIndex[ item->ownerIndex() ];
+	    entry.size += item->size();
+	    entry.count++;
+	    _totalSize += item->size();
+	}
+
+	if ( item->dotEntry() )
+	    stack.push_back( item->dotEntry() );
+
+	int count = item->childCount();
+
+	for ( int i=0; i < count; i++ )
+	    stack.push_back( item->childAt( i ) );
+    }
+
+
+    // Add up the owner indices per user and per group
+
+    QMap<long, KOwnerStatsEntry> users;
+    QMap<long, KOwnerStatsEntry> groups;
+
+    for ( uint i=0; i < perIndex.size(); i++ )
+    {
+	const KOwnerStatsEntry & entry = perIndex[i];
+
+	if ( entry.count == 0 )
+	    continue;
+
+	long uid = i == NoOwner ? -1 : (long) owners.uid( i );
+	long gid = i == NoOwner ? -1 : (long) owners.gid( i );
+
+	KOwnerStatsEntry & user = users[ uid ];
+	user.id	    = uid;
+	user.size  += entry.size;
+	user.count += entry.count;
+
+	KOwnerStatsEntry & group = groups[ gid ];
+	group.id     = gid;
+	group.size  += entry.size;
+	group.count += entry.count;
+    }
+
+    QMap<long, KOwnerStatsEntry>::iterator it;
+
+    for ( it = users.begin(); it != users.end(); ++it )
+    {
+	it.data().name = it.key() < 0 ? QString( "?" ) : KOwnerTable::userName( (uid_t) it.key() );
+	_users.append( it.data() );
+    }
+
+    for ( it = groups.begin(); it != groups.end(); ++it )
+    {
+	it.data().name = it.key() < 0 ? QString( "?" ) : KOwnerTable::groupName( (gid_t) it.key() );
+	_groups.append( it.data() );
+    }
+
+    qHeapSort( _users );		// KOwnerStatsEntry::operator< sorts largest first
+    qHeapSort( _groups );
+}
+
+
+
+
+KOwnerStatsJob::KOwnerStatsJob( const QString & input )
+    : KBatchJob( input )
+{
+    // NOP
+}
+
+
+KOwnerStatsJob::~KOwnerStatsJob()
+{
+    // NOP
+}
+
+
+bool
+KOwnerStatsJob::process( KDirTree * tree )
+{
+    if ( ! tree->root() )
+    {
+	kdError() << "Nothing read from " << _input << endl;
+	return false;
+    }
+
+    KOwnerStats stats( tree );
+    stats.collect( tree->root() );
+
+    print( "user",  stats.users()  );
+    print( "group", stats.groups() );
+
+    return fflush( stdout ) == 0;
+}
+
+
+void
+KOwnerStatsJob::print( const char * kind, const KOwnerStatsList & list )
+{
+    KOwnerStatsList::const_iterator it = list.begin();
+
+    while ( it != list.end() )
+    {
+	printf( "%s\t%s\t%ld\t%d\t%lld\n",
+		kind,
+		(const char *) (*it).name.latin1(),
+		(*it).id,
+		(*it).count,
+		(long long) (*it).size );
+	++it;
+    }
+}
+
+
+
+// EOF
@@ -0,0 +1,256 @@
+/*
+ *   File name:	kownerstats.h
+ *   Summary:	Support classes for KDirStat - disk usage per user and group
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KOwnerStats_h
+#define KOwnerStats_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <qstring.h>
+#include <qmap.h>
+#include <qvaluelist.h>
+#include <qvaluevector.h>
+#include "kfileinfo.h"
+#include "kbatchjob.h"
+
+
+namespace KDirStat
+{
+    /**
+     * Table of all (uid, gid) pairs of the items in one @ref KDirTree.
+     *
+     * There are very few distinct owners even in huge trees, so each @ref
+     * KFileInfo stores only a small index into this table rather than the
+     * uid and gid themselves.
+     *
+     * @short Shared table of file owners
+     **/
+    class KOwnerTable
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KOwnerTable();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KOwnerTable();
+
+	/**
+	 * Returns the index for 'uid' and 'gid', adding them to the table if
+	 * they are not there yet. Returns @ref NoOwner if the table is full.
+	 **/
+	KOwnerIndex index( uid_t uid, gid_t gid );
+
+	/**
+	 * Returns the user ID for owner index 'index' or (uid_t) -1 for @ref
+	 * NoOwner.
+	 **/
+	uid_t uid( KOwnerIndex index ) const;
+
+	/**
+	 * Returns the group ID for owner index 'index' or (gid_t) -1 for
+	 * @ref NoOwner.
+	 **/
+	gid_t gid( KOwnerIndex index ) const;
+
+	/**
+	 * Returns the number of indices in use, including @ref NoOwner.
+	 **/
+	int count() const { return _uids.size(); }
+
+	/**
+	 * Discard all entries. Only call this when no @ref KFileInfo refers
+	 * to this table any more.
+	 **/
+	void clear();
+
+	/**
+	 * Returns the login name of user 'uid' or the number if there is no
+	 * such user. The result is cached since the lookup might go to a
+	 * name service like NIS or LDAP.
+	 *
+	 * Just like file names, the name holds the raw bytes as Latin-1.
+	 **/
+	static QString userName( uid_t uid );
+
+	/**
+	 * Returns the name of group 'gid' or the number if there is no such
+	 * group. The result is cached. The name holds the raw bytes as
+	 * Latin-1.
+	 **/
+	static QString groupName( gid_t gid );
+
+
+    protected:
+
+	QValueVector<uid_t>		_uids;
+	QValueVector<gid_t>		_gids;
+	QMap<Q_ULLONG, KOwnerIndex>	_indices;
+	KOwnerIndex			_lastIndex;	// cache for the last lookup
+
+    };	// class KOwnerTable
+
+
+
+    /**
+     * Disk usage of one user or one group in @ref KOwnerStats.
+     **/
+    class KOwnerStatsEntry
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KOwnerStatsEntry( long ownerId = -1 )
+	    : id( ownerId )
+	    , size( 0 )
+	    , count( 0 )
+	    {}
+
+	/**
+	 * Sort order for reports: Larger sizes first.
+	 **/
+	bool operator<( const KOwnerStatsEntry & other ) const
+	    { return size > other.size; }
+
+	long		id;	// uid or gid; -1 if unknown
+	QString		name;	// user or group name
+	KFileSize	size;	// sum of the sizes of all items
+	int		count;	// number of items
+
+    };	// class KOwnerStatsEntry
+
+
+    typedef QValueList<KOwnerStatsEntry> KOwnerStatsList;
+
+
+    /**
+     * Disk usage per user and per group in a subtree, like a quota report.
+     *
+     * Every item counts with its own size (see @ref KFileInfo::size()),
+     * directories included. collect() makes one pass over the tree in memory
+     * that only adds up sizes per owner index; the indices are mapped to
+     * users and groups afterwards, so this is cheap even for huge trees.
+     *
+     * Sample usage:
+     *
+     *     KOwnerStats stats( tree );
+     *     stats.collect( tree->root() );
+     *
+     *     KOwnerStatsList::const_iterator it = stats.users().begin();
+     *     ...
+     *
+     * @short Disk usage per user and group
+     **/
+    class KOwnerStats
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KOwnerStats( KDirTree * tree );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KOwnerStats();
+
+	/**
+	 * Discard everything and collect the statistics for 'subtree'.
+	 **/
+	void collect( KFileInfo * subtree );
+
+	/**
+	 * Returns the disk usage per user, largest first.
+	 **/
+	const KOwnerStatsList & users() const { return _users; }
+
+	/**
+	 * Returns the disk usage per group, largest first.
+	 **/
+	const KOwnerStatsList & groups() const { return _groups; }
+
+	/**
+	 * Returns the sum of the sizes of all items.
+	 **/
+	KFileSize totalSize() const { return _totalSize; }
+
+
+    protected:
+
+	KDirTree *		_tree;
+	KOwnerStatsList		_users;
+	KOwnerStatsList		_groups;
+	KFileSize		_totalSize;
+
+    };	// class KOwnerStats
+
+
+
+    /**
+     * Batch driver for KOwnerStats: Reads a directory or a cache file and
+     * prints the disk usage per user and then per group to stdout, largest
+     * first, one per line:
+     *
+     *     "user"|"group" TAB <name> TAB <id> TAB <number of items> TAB <size in bytes>
+     *
+     * Used for "kdirstat --owners".
+     *
+     * @short Batch output of the disk usage per user and group
+     **/
+    class KOwnerStatsJob: public KBatchJob
+    {
+    public:
+
+	/**
+	 * Constructor. 'input' is either a directory (path or URL) or a
+	 * KDirStat cache file.
+	 **/
+	KOwnerStatsJob( const QString & input );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KOwnerStatsJob();
+
+
+    protected:
+
+	/**
+	 * Collect and print the statistics.
+	 *
+	 * Reimplemented - inherited from @ref KBatchJob.
+	 **/
+	virtual bool process( KDirTree * tree );
+
+	/**
+	 * Print one list with 'kind' ("user" or "group") in the first column.
+	 **/
+	void print( const char * kind, const KOwnerStatsList & list );
+
+    };	// class KOwnerStatsJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KOwnerStats_h
+
+
+// EOF
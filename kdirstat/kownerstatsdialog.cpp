@@ -0,0 +1,204 @@
+/*
+ *   File name:	kownerstatsdialog.cpp
+ *   Summary:	Dialog with the disk usage per user and group
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qcombobox.h>
+#include <qlabel.h>
+#include <qlayout.h>
+
+#include <kapp.h>
+#include <klistview.h>
+#include <klocale.h>
+
+#include "kownerstatsdialog.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KOwnerStatsDialog::KOwnerStatsDialog( KDirTree * tree, QWidget * parent )
+    : KDialogBase( Plain,				// dialogFace
+		   i18n( "Disk Usage per Owner" ),	// caption
+		   User1 | Close,			// buttonMask
+		   User1,				// defaultButton
+		   parent,				// parent
+		   0,					// name
+		   false )				// modal
+    , _tree( tree )
+{
+    setButtonText( User1, i18n( "&Refresh" ) );
+
+    QWidget *	  page	 = plainPage();
+    QVBoxLayout * layout = new QVBoxLayout( page, 0, spacingHint() );
+    QHBoxLayout * hbox	 = new QHBoxLayout( layout );
+
+    _type = new QComboBox( false, page );
+    _type->insertItem( i18n( "Users"	) );
+    _type->insertItem( i18n( "Groups"	) );
+
+    QLabel * label = new QLabel( _type, i18n( "&Show:" ), page );
+    hbox->addWidget( label );
+    hbox->addWidget( _type );
+    hbox->addStretch();
+
+    _subtreeLabel = new QLabel( page );
+    layout->addWidget( _subtreeLabel );
+
+    _list = new KListView( page );
+    _list->addColumn( i18n( "Name"	) );
+    _list->addColumn( i18n( "ID"	) );
+    _list->addColumn( i18n( "Items"	) );
+    _list->addColumn( i18n( "Size"	) );
+    _list->addColumn( i18n( "%"		) );
+    _list->setColumnAlignment( 1, AlignRight );
+    _list->setColumnAlignment( 2, AlignRight );
+    _list->setColumnAlignment( 3, AlignRight );
+    _list->setColumnAlignment( 4, AlignRight );
+    _list->setAllColumnsShowFocus( true );
+    _list->setSorting( 3, false );		// largest first
+    layout->addWidget( _list, 1 );
+
+    connect( _type,	SIGNAL( activated( int ) ),
+	     this,	SLOT  ( refresh()	 ) );
+
+    connect( _tree,	SIGNAL( deletingChild	( KFileInfo * )	),
+	     this,	SLOT  ( clear()				) );
+
+    connect( _tree,	SIGNAL( startingReading() ),
+	     this,	SLOT  ( clear()		  ) );
+
+    resize( 500, 400 );
+}
+
+
+KOwnerStatsDialog::~KOwnerStatsDialog()
+{
+    // NOP
+}
+
+
+void
+KOwnerStatsDialog::slotUser1()
+{
+    refresh();
+}
+
+
+void
+KOwnerStatsDialog::clear()
+{
+    _list->clear();
+    _subtreeLabel->setText( "" );
+}
+
+
+void
+KOwnerStatsDialog::refresh()
+{
+    clear();
+
+    if ( ! _tree->root() || _tree->isBusy() )
+	return;
+
+    // Use the selected directory if there is one, the entire tree otherwise.
+
+    KFileInfo * subtree = _tree->selection();
+
+    if ( ! subtree || ! subtree->isDirInfo() )
+	subtree = _tree->root();
+
+    kapp->setOverrideCursor( waitCursor );
+
+    KOwnerStats stats( _tree );
+    stats.collect( subtree );
+
+    const KOwnerStatsList & list = _type->currentItem() == 0 ? stats.users() : stats.groups();
+    KOwnerStatsList::const_iterator it = list.begin();
+
+    while ( it != list.end() )
+    {
+	new KOwnerStatsListItem( _list, *it, stats.totalSize() );
+	++it;
+    }
+
+    kapp->restoreOverrideCursor();
+
+    _subtreeLabel->setText( i18n( "In %1" ).arg( subtree->url() ) );
+}
+
+
+
+
+KOwnerStatsListItem::KOwnerStatsListItem( QListView *			parent,
+					  const KOwnerStatsEntry &	entry,
+					  KFileSize			totalSize )
+    : QListViewItem( parent )
+    , _entry( entry )
+{
+    if ( entry.id < 0 )
+    {
+	setText( 0, i18n( "<unknown>" ) );
+    }
+    else
+    {
+	setText( 0, entry.name );
+	setText( 1, QString::number( entry.id ) );
+    }
+
+    setText( 2, QString::number( entry.count ) );
+    setText( 3, formatSize( entry.size ) );
+
+    if ( totalSize > 0 )
+	setText( 4, QString::number( 100.0 * entry.size / totalSize, 'f', 1 ) + "%" );
+}
+
+
+int
+KOwnerStatsListItem::compare( QListViewItem *	otherListViewItem,
+			      int		col,
+			      bool		ascending ) const
+{
+    KOwnerStatsListItem * other = dynamic_cast<KOwnerStatsListItem *>( otherListViewItem );
+
+    if ( other )
+    {
+	switch ( col )
+	{
+	    case 1:
+		if ( _entry.id < other->_entry.id ) return -1;
+		if ( _entry.id > other->_entry.id ) return  1;
+		return 0;
+
+	    case 2:
+		if ( _entry.count < other->_entry.count ) return -1;
+		if ( _entry.count > other->_entry.count ) return  1;
+		return 0;
+
+	    case 3:
+	    case 4:
+		if ( _entry.size < other->_entry.size ) return -1;
+		if ( _entry.size > other->_entry.size ) return  1;
+		return 0;
+
+	    default:
+		break;
+	}
+    }
+
+    return QListViewItem::compare( otherListViewItem, col, ascending );
+}
+
+
+
+// EOF
@@ -0,0 +1,130 @@
+/*
+ *   File name:	kownerstatsdialog.h
+ *   Summary:	Dialog with the disk usage per user and group
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KOwnerStatsDialog_h
+#define KOwnerStatsDialog_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qlistview.h>
+#include <kdialogbase.h>
+#include "kownerstats.h"
+
+
+class QComboBox;
+class QLabel;
+class KListView;
+
+
+namespace KDirStat
+{
+    class KDirTree;
+
+
+    /**
+     * Non-modal dialog that shows how much disk space each user or each
+     * group takes in the selected subtree (or in the entire tree if nothing
+     * or a file is selected).
+     *
+     * The list is cleared whenever anything in the tree is deleted or the
+     * tree is read again; use "Refresh" to collect the numbers again.
+     *
+     * @short Dialog for the disk usage per user and group
+     **/
+    class KOwnerStatsDialog: public KDialogBase
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KOwnerStatsDialog( KDirTree * tree, QWidget * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KOwnerStatsDialog();
+
+
+    public slots:
+
+	/**
+	 * Collect the statistics again for the current selection and display
+	 * them.
+	 **/
+	void refresh();
+
+	/**
+	 * Clear the list.
+	 **/
+	void clear();
+
+
+    protected slots:
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Refresh" button.
+	 **/
+	virtual void slotUser1();
+
+
+    protected:
+
+	KDirTree *	_tree;
+	QComboBox *	_type;
+	QLabel *	_subtreeLabel;
+	KListView *	_list;
+
+    };	// class KOwnerStatsDialog
+
+
+
+    /**
+     * List item for one @ref KOwnerStatsEntry in a @ref KOwnerStatsDialog.
+     * Sorts numerically by ID, number of items, size and percentage.
+     **/
+    class KOwnerStatsListItem: public QListViewItem
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KOwnerStatsListItem( QListView *		parent,
+			     const KOwnerStatsEntry &	entry,
+			     KFileSize			totalSize );
+
+	/**
+	 * Comparison function used for sorting the list.
+	 *
+	 * Reimplemented from @ref QListViewItem.
+	 **/
+	virtual int compare( QListViewItem *	other,
+			     int		col,
+			     bool		ascending ) const;
+
+    protected:
+
+	KOwnerStatsEntry	_entry;
+
+    };	// class KOwnerStatsListItem
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KOwnerStatsDialog_h
+
+
+// EOF
@@ -0,0 +1,297 @@
+/*
+ *   File name:	kscanstats.cpp
+ *   Summary:	Support classes for KDirStat - scan throughput counters
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "kscanstats.h"
+#include "kdirinfo.h"
+
+
+using namespace KDirStat;
+
+
+/**
+ * Returns 'str' as a JSON string literal.
+ **/
+static QString
+jsonString( const QString & str )
+{
+    QString result = "\"";
+
+    for ( uint i=0; i < str.length(); i++ )
+    {
+	QChar c = str[i];
+
+	if	( c == '"'  )		result += "\\\"";
+	else if ( c == '\\' )		result += "\\\\";
+	else if ( c == '\n' )		result += "\\n";
+	else if ( c == '\t' )		result += "\\t";
+	else if ( c.unicode() < 0x20 )	result += QString().sprintf( "\\u%04x", c.unicode() );
+	else				result += c;
+    }
+
+    return result + "\"";
+}
+
+
+/**
+ * Returns 'count' per second in 'millisec' milliseconds.
+ **/
+static double
+perSecond( double count, long millisec )
+{
+    return millisec > 0 ? 1000.0 * count / millisec : 0.0;
+}
+
+
+
+
+KScanStats::KScanStats()
+{
+    _running   = false;
+    _startTime = 0;
+    _stopTime  = 0;
+    start();
+    stop();
+}
+
+
+KScanStats::~KScanStats()
+{
+    // NOP
+}
+
+
+void
+KScanStats::start()
+{
+    _running		= true;
+    _startTime		= now();
+    _stopTime		= 0;
+    _dirs		= 0;
+    _entries		= 0;
+    _bytes		= 0;
+    _statCalls		= 0;
+    _statMicrosec	= 0;
+    _cacheLines		= 0;
+    _maxQueueDepth	= 0;
+
+    for ( int i=0; i < ScanStatsLatencyBuckets; i++ )
+	_latency[i] = 0;
+
+    _fileSystems.clear();
+}
+
+
+void
+KScanStats::stop()
+{
+    if ( _running )
+    {
+	_running  = false;
+	_stopTime = now();
+    }
+}
+
+
+long
+KScanStats::elapsedMillisec() const
+{
+    return ( ( _running ? now() : _stopTime ) - _startTime ) / 1000;
+}
+
+
+long long
+KScanStats::now()
+{
+    struct timeval tv;
+    gettimeofday( &tv, 0 );
+
+    return (long long) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+KScanFsStats &
+KScanStats::fileSystem( KFileInfo * item )
+{
+    KScanFsStatsMap::Iterator it = _fileSystems.find( item->device() );
+
+    if ( it != _fileSystems.end() )
+	return it.data();
+
+    // The first directory found on a file system is where it is mounted (or
+    // where reading it started).
+
+    KScanFsStats & fs = _fileSystems[ item->device() ];
+
+    if ( item->isDirInfo() || ! item->parent() )
+	fs.name = item->url();
+    else
+	fs.name = item->parent()->url();
+
+    return fs;
+}
+
+
+void
+KScanStats::addEntry( KFileInfo * item )
+{
+    if ( ! item || item->isDotEntry() )
+	return;
+
+    KScanFsStats & fs = fileSystem( item );
+
+    if ( item->isDirInfo() )
+    {
+	_dirs++;
+	fs.dirs++;
+    }
+
+    _entries++;
+    _bytes += item->size();
+
+    fs.entries++;
+    fs.bytes += item->size();
+}
+
+
+int
+KScanStats::lstat( const char * path, struct stat * statInfo, KDirInfo * dir )
+{
+    long long before = now();
+    int	      result = ::lstat( path, statInfo );
+    long long usec   = now() - before;
+
+    _statCalls++;
+    _statMicrosec += usec;
+
+    int bucket = 0;
+
+    while ( bucket < ScanStatsLatencyBuckets - 1 && usec >= ( 1LL << bucket ) )
+	bucket++;
+
+    _latency[ bucket ]++;
+
+    if ( dir )
+    {
+	KScanFsStats & fs = fileSystem( dir );
+	fs.statCalls++;
+	fs.statMicrosec += usec;
+    }
+
+    return result;
+}
+
+
+QString
+KScanStats::toJson() const
+{
+    long    millisec = elapsedMillisec();
+    QString json;
+
+    json += "{\n";
+    json += QString( "  \"elapsed_ms\": %1,\n"		).arg( millisec );
+    json += QString( "  \"finished\": %1,\n"		).arg( _running ? "false" : "true" );
+    json += QString( "  \"dirs\": %1,\n"		).arg( _dirs );
+    json += QString( "  \"entries\": %1,\n"		).arg( _entries );
+    json += QString( "  \"bytes\": %1,\n"		).arg( _bytes );
+    json += QString( "  \"cache_lines\": %1,\n"		).arg( _cacheLines );
+    json += QString( "  \"dirs_per_sec\": %1,\n"	).arg( perSecond( _dirs,	millisec ), 0, 'f', 1 );
+    json += QString( "  \"entries_per_sec\": %1,\n"	).arg( perSecond( _entries,	millisec ), 0, 'f', 1 );
+    json += QString( "  \"cache_lines_per_sec\": %1,\n"	).arg( perSecond( _cacheLines,	millisec ), 0, 'f', 1 );
+    json += QString( "  \"max_queue_depth\": %1,\n"	).arg( _maxQueueDepth );
+    json += QString( "  \"stat_calls\": %1,\n"		).arg( _statCalls );
+    json += QString( "  \"stat_us_total\": %1,\n"	).arg( _statMicrosec );
+
+
+    // The histogram: Only the buckets up to the last one that is used
+
+    int lastBucket = ScanStatsLatencyBuckets - 1;
+
+    while ( lastBucket > 0 && _latency[ lastBucket ] == 0 )
+	lastBucket--;
+
+    json += "  \"stat_latency_us\": [";
+
+    for ( int i=0; i <= lastBucket; i++ )
+    {
+	QString upper = i < ScanStatsLatencyBuckets - 1 ? QString::number( 1L << i ) : QString( "null" );
+
+	json += QString( "%1\n    { \"below\": %2, \"count\": %3 }" )
+	    .arg( i > 0 ? "," : "" ).arg( upper ).arg( _latency[i] );
+    }
+
+    json += "\n  ],\n";
+
+
+    // Per file system
+
+    json += "  \"filesystems\": [";
+
+    KScanFsStatsMap::ConstIterator it = _fileSystems.begin();
+    bool first = true;
+
+    while ( it != _fileSystems.end() )
+    {
+	const KScanFsStats & fs = it.data();
+
+	json += first ? "\n" : ",\n";
+
+	// The name goes last: Any '%' in it must not be taken for a place
+	// marker by arg().
+
+	json += QString( "    { \"device\": %1, \"dirs\": %2, \"entries\": %3, \"bytes\": %4,"
+			 " \"stat_calls\": %5, \"stat_us_total\": %6, \"name\": %7 }" )
+	    .arg( (unsigned long) it.key() )
+	    .arg( fs.dirs )
+	    .arg( fs.entries )
+	    .arg( fs.bytes )
+	    .arg( fs.statCalls )
+	    .arg( fs.statMicrosec )
+	    .arg( jsonString( fs.name ) );
+
+	first = false;
+	++it;
+    }
+
+    json += "\n  ]\n";
+    json += "}\n";
+
+    return json;
+}
+
+
+
+
+KScanStatsJob::KScanStatsJob( const QString & input )
+    : KBatchJob( input )
+{
+}
+
+
+KScanStatsJob::~KScanStatsJob()
+{
+}
+
+
+bool
+KScanStatsJob::process( KDirTree * )
+{
+    return true;
+}
+
+
+
+// EOF
@@ -0,0 +1,223 @@
+/*
+ *   File name:	kscanstats.h
+ *   Summary:	Support classes for KDirStat - scan throughput counters
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KScanStats_h
+#define KScanStats_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <qstring.h>
+#include <qmap.h>
+#include "kfileinfo.h"
+#include "kbatchjob.h"
+
+
+// Number of buckets of the lstat() latency histogram: Bucket i counts the
+// calls that took less than 2^i microseconds, the last one all that took
+// longer.
+
+#define ScanStatsLatencyBuckets	24
+
+
+namespace KDirStat
+{
+    /**
+     * What was found on one file system (one device) while scanning.
+     **/
+    struct KScanFsStats
+    {
+	KScanFsStats()
+	    : dirs( 0 ), entries( 0 ), bytes( 0 ), statCalls( 0 ), statMicrosec( 0 ) {}
+
+	QString		name;		// The first directory found on it
+	long		dirs;
+	long		entries;
+	KFileSize	bytes;
+	long		statCalls;
+	long long	statMicrosec;
+    };
+
+    typedef QMap<dev_t, KScanFsStats> KScanFsStatsMap;
+
+
+    /**
+     * Counters for the last scan of a @ref KDirTree: How many directories and
+     * entries were found, how much disk space they take, how long each
+     * lstat() call took (as a histogram and per file system), how many cache
+     * lines were read and how deep the read job queue got.
+     *
+     * This is meant to find out where the time goes when a scan is slow:
+     * E.g., a latency histogram with most calls in the milliseconds on one
+     * NFS file system points to the server, not to KDirStat.
+     *
+     * The counters are reset whenever the tree starts reading with an empty
+     * job queue. The rates are averages over the entire scan; for current
+     * rates, take the difference of two snapshots.
+     *
+     * Normally, this is used only through @ref KDirTree::scanStats().
+     *
+     * @short Scan throughput counters
+     **/
+    class KScanStats
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KScanStats();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KScanStats();
+
+	/**
+	 * Reset all counters and start the clock.
+	 **/
+	void start();
+
+	/**
+	 * Stop the clock.
+	 **/
+	void stop();
+
+	/**
+	 * Notification that 'item' was found.
+	 **/
+	void addEntry( KFileInfo * item );
+
+	/**
+	 * Call lstat() for 'path' in directory 'dir' and count how long it
+	 * took. Returns what lstat() returns.
+	 **/
+	int lstat( const char * path, struct stat * statInfo, KDirInfo * dir );
+
+	/**
+	 * Notification that 'lines' more lines of a cache file were read.
+	 **/
+	void addCacheLines( int lines ) { _cacheLines += lines; }
+
+	/**
+	 * Notification that the read job queue now has 'depth' jobs.
+	 **/
+	void queueDepth( int depth )
+	    { if ( depth > _maxQueueDepth ) _maxQueueDepth = depth; }
+
+	/**
+	 * Returns 'true' if the clock is running.
+	 **/
+	bool isRunning() const { return _running; }
+
+	/**
+	 * Returns the milliseconds since start() - until stop() if the scan
+	 * is done.
+	 **/
+	long elapsedMillisec() const;
+
+	long		dirs()		const { return _dirs;		}
+	long		entries()	const { return _entries;	}
+	KFileSize	bytes()		const { return _bytes;		}
+	long		statCalls()	const { return _statCalls;	}
+	long long	statMicrosec()	const { return _statMicrosec;	}
+	long		cacheLines()	const { return _cacheLines;	}
+	int		maxQueueDepth()	const { return _maxQueueDepth;	}
+
+	/**
+	 * Returns the number of lstat() calls in latency histogram bucket
+	 * 'bucket' (see @ref ScanStatsLatencyBuckets).
+	 **/
+	long latencyBucket( int bucket ) const { return _latency[ bucket ]; }
+
+	/**
+	 * Returns the counters per file system.
+	 **/
+	const KScanFsStatsMap & fileSystems() const { return _fileSystems; }
+
+	/**
+	 * Returns all counters in JSON format.
+	 **/
+	QString toJson() const;
+
+	/**
+	 * Returns the current time in microseconds.
+	 **/
+	static long long now();
+
+
+    protected:
+
+	/**
+	 * Returns the counters for the file system of 'item', creating them
+	 * if there are none yet.
+	 **/
+	KScanFsStats & fileSystem( KFileInfo * item );
+
+
+	bool			_running;
+	long long		_startTime;
+	long long		_stopTime;
+	long			_dirs;
+	long			_entries;
+	KFileSize		_bytes;
+	long			_statCalls;
+	long long		_statMicrosec;
+	long			_cacheLines;
+	int			_maxQueueDepth;
+	long			_latency[ ScanStatsLatencyBuckets ];
+	KScanFsStatsMap		_fileSystems;
+
+    };	// class KScanStats
+
+
+
+    /**
+     * Batch job that only reads a directory or cache file, so the scan
+     * statistics can be written (see @ref KBatchJob::setScanStatsFile() ).
+     **/
+    class KScanStatsJob: public KBatchJob
+    {
+    public:
+
+	/**
+	 * Constructor. 'input' is either a directory (path or URL) or a
+	 * KDirStat cache file.
+	 **/
+	KScanStatsJob( const QString & input );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KScanStatsJob();
+
+
+    protected:
+
+	/**
+	 * Nothing to do - reading was all this job is about.
+	 *
+	 * Reimplemented - inherited from @ref KBatchJob.
+	 **/
+	virtual bool process( KDirTree * tree );
+
+    };	// class KScanStatsJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KScanStats_h
+
+
+// EOF
@@ -0,0 +1,300 @@
+/*
+ *   File name:	kscanstatsdialog.cpp
+ *   Summary:	Dialog with the scan throughput counters
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qfile.h>
+#include <qgrid.h>
+#include <qlabel.h>
+#include <qlayout.h>
+#include <qtextstream.h>
+
+#include <kfiledialog.h>
+#include <klistview.h>
+#include <klocale.h>
+#include <kmessagebox.h>
+
+#include "kscanstatsdialog.h"
+#include "kdirtree.h"
+#include "kdirtreeview.h"
+
+
+using namespace KDirStat;
+
+
+/**
+ * Format a latency of 'usec' microseconds.
+ **/
+static QString
+formatLatency( double usec )
+{
+    if ( usec < 1000.0 )
+	return i18n( "%1 us" ).arg( usec, 0, 'f', usec < 10.0 ? 1 : 0 );
+
+    if ( usec < 1000000.0 )
+	return i18n( "%1 ms" ).arg( usec / 1000.0, 0, 'f', 1 );
+
+    return i18n( "%1 s" ).arg( usec / 1000000.0, 0, 'f', 1 );
+}
+
+
+/**
+ * Format a rate of 'count' in 'millisec' milliseconds.
+ **/
+static QString
+formatRate( long count, long millisec )
+{
+    if ( millisec <= 0 )
+	return "-";
+
+    return QString::number( 1000.0 * count / millisec, 'f', 0 );
+}
+
+
+/**
+ * Format counter 'count' with its current and average rate. 'rateNow' may
+ * be empty.
+ **/
+static QString
+formatCounter( long count, const QString & rateNow, const QString & rateAverage )
+{
+    if ( rateNow.isEmpty() )
+	return i18n( "%1  (%2/s on average)" ).arg( count ).arg( rateAverage );
+
+    return i18n( "%1  (%2/s now, %3/s on average)" ).arg( count ).arg( rateNow ).arg( rateAverage );
+}
+
+
+
+
+KScanStatsDialog::KScanStatsDialog( KDirTree * tree, QWidget * parent )
+    : KDialogBase( Plain,				// dialogFace
+		   i18n( "Scan Statistics" ),		// caption
+		   User1 | Close,			// buttonMask
+		   Close,				// defaultButton
+		   parent,				// parent
+		   0,					// name
+		   false )				// modal
+    , _tree( tree )
+    , _lastTime( 0 )
+    , _lastDirs( 0 )
+    , _lastEntries( 0 )
+    , _lastCacheLines( 0 )
+{
+    setButtonText( User1, i18n( "&Save as JSON..." ) );
+
+    QWidget *	  page	 = plainPage();
+    QVBoxLayout * layout = new QVBoxLayout( page, 0, spacingHint() );
+    QGrid *	  grid	 = new QGrid( 2, page );
+    grid->setSpacing( spacingHint() );
+    layout->addWidget( grid );
+
+    _status	= addValue( grid, i18n( "Status:"		) );
+    _elapsed	= addValue( grid, i18n( "Elapsed time:"		) );
+    _dirs	= addValue( grid, i18n( "Directories:"		) );
+    _entries	= addValue( grid, i18n( "Entries:"		) );
+    _bytes	= addValue( grid, i18n( "Size found:"		) );
+    _cacheLines	= addValue( grid, i18n( "Cache lines:"		) );
+    _queue	= addValue( grid, i18n( "Read queue:"		) );
+    _statCalls	= addValue( grid, i18n( "lstat() calls:"	) );
+
+    _latency = new KListView( page );
+    _latency->addColumn( i18n( "lstat() Latency" ) );
+    _latency->addColumn( i18n( "Calls"		 ) );
+    _latency->addColumn( i18n( "%"		 ) );
+    _latency->setColumnAlignment( 1, AlignRight );
+    _latency->setColumnAlignment( 2, AlignRight );
+    _latency->setSorting( -1 );
+    layout->addWidget( _latency, 1 );
+
+    _fileSystems = new KListView( page );
+    _fileSystems->addColumn( i18n( "File System"	) );
+    _fileSystems->addColumn( i18n( "Directories"	) );
+    _fileSystems->addColumn( i18n( "Entries"		) );
+    _fileSystems->addColumn( i18n( "Size"		) );
+    _fileSystems->addColumn( i18n( "lstat() Calls"	) );
+    _fileSystems->addColumn( i18n( "Avg. Latency"	) );
+    _fileSystems->setColumnAlignment( 1, AlignRight );
+    _fileSystems->setColumnAlignment( 2, AlignRight );
+    _fileSystems->setColumnAlignment( 3, AlignRight );
+    _fileSystems->setColumnAlignment( 4, AlignRight );
+    _fileSystems->setColumnAlignment( 5, AlignRight );
+    _fileSystems->setAllColumnsShowFocus( true );
+    _fileSystems->setSorting( -1 );
+    layout->addWidget( _fileSystems, 1 );
+
+    connect( &_timer,	SIGNAL( timeout() ),
+	     this,	SLOT  ( refresh() ) );
+
+    resize( 550, 600 );
+}
+
+
+KScanStatsDialog::~KScanStatsDialog()
+{
+    // NOP
+}
+
+
+QLabel *
+KScanStatsDialog::addValue( QWidget * parent, const QString & caption )
+{
+    new QLabel( caption, parent );
+
+    return new QLabel( parent );
+}
+
+
+void
+KScanStatsDialog::showEvent( QShowEvent * event )
+{
+    KDialogBase::showEvent( event );
+
+    _lastTime = 0;		// No current rates yet
+    refresh();
+    _timer.start( ScanStatsUpdateMillisec );
+}
+
+
+void
+KScanStatsDialog::hideEvent( QHideEvent * event )
+{
+    _timer.stop();
+    KDialogBase::hideEvent( event );
+}
+
+
+void
+KScanStatsDialog::slotUser1()
+{
+    QString fileName = KFileDialog::getSaveFileName( QString::null,
+						     "*.json",
+						     this,
+						     i18n( "Save Scan Statistics" ) );
+    if ( fileName.isEmpty() )
+	return;
+
+    QFile file( fileName );
+
+    if ( ! file.open( IO_WriteOnly ) )
+    {
+	KMessageBox::error( this, i18n( "Can't write %1" ).arg( fileName ) );
+	return;
+    }
+
+    QTextStream str( &file );
+    str << _tree->scanStats()->toJson();
+    file.close();
+}
+
+
+void
+KScanStatsDialog::refresh()
+{
+    const KScanStats * stats	= _tree->scanStats();
+    long	       millisec = stats->elapsedMillisec();
+    long long	       now	= KScanStats::now();
+
+
+    // Current rates: Since the last update as long as reading is in
+    // progress. Counters that went down were reset in between.
+
+    QString dirsNow, entriesNow, cacheLinesNow;
+
+    if ( stats->isRunning() && _lastTime > 0 )
+    {
+	long interval = (long) ( ( now - _lastTime ) / 1000 );
+
+	if ( stats->dirs() < _lastDirs || stats->entries() < _lastEntries || stats->cacheLines() < _lastCacheLines )
+	    _lastDirs = _lastEntries = _lastCacheLines = 0;
+
+	dirsNow	      = formatRate( stats->dirs()	- _lastDirs,	   interval );
+	entriesNow    = formatRate( stats->entries()	- _lastEntries,	   interval );
+	cacheLinesNow = formatRate( stats->cacheLines() - _lastCacheLines, interval );
+    }
+
+    _lastTime	    = now;
+    _lastDirs	    = stats->dirs();
+    _lastEntries    = stats->entries();
+    _lastCacheLines = stats->cacheLines();
+
+    _status->setText( stats->isRunning() ? i18n( "Reading" ) : i18n( "Finished" ) );
+    _elapsed->setText( formatTime( millisec, true ) );
+    _dirs->setText	 ( formatCounter( stats->dirs(),	dirsNow,	formatRate( stats->dirs(),	 millisec ) ) );
+    _entries->setText	 ( formatCounter( stats->entries(),	entriesNow,	formatRate( stats->entries(),	 millisec ) ) );
+    _cacheLines->setText ( formatCounter( stats->cacheLines(),	cacheLinesNow,	formatRate( stats->cacheLines(), millisec ) ) );
+    _bytes->setText( formatSize( stats->bytes() ) );
+    _queue->setText( i18n( "%1 pending, at most %2" )
+		     .arg( _tree->pendingReadJobs() ).arg( stats->maxQueueDepth() ) );
+
+    if ( stats->statCalls() > 0 )
+	_statCalls->setText( i18n( "%1  (%2 on average)" ).arg( stats->statCalls() )
+			     .arg( formatLatency( (double) stats->statMicrosec() / stats->statCalls() ) ) );
+    else
+	_statCalls->setText( "0" );
+
+
+    // Latency histogram: All buckets up to the last one that is used
+
+    _latency->clear();
+
+    int lastBucket = ScanStatsLatencyBuckets - 1;
+
+    while ( lastBucket > 0 && stats->latencyBucket( lastBucket ) == 0 )
+	lastBucket--;
+
+    QListViewItem * after = 0;
+
+    for ( int i=0; i <= lastBucket && stats->statCalls() > 0; i++ )
+    {
+	QString range;
+
+	if ( i < ScanStatsLatencyBuckets - 1 )
+	    range = "< " + formatLatency( 1L << i );
+	else
+	    range = ">= " + formatLatency( 1L << ( i-1 ) );
+
+	long count = stats->latencyBucket( i );
+
+	after = new QListViewItem( _latency, after,
+				   range,
+				   QString::number( count ),
+				   formatPercent( 100.0 * count / stats->statCalls() ) );
+    }
+
+
+    // Per file system
+
+    _fileSystems->clear();
+    after = 0;
+
+    KScanFsStatsMap::ConstIterator it = stats->fileSystems().begin();
+
+    while ( it != stats->fileSystems().end() )
+    {
+	const KScanFsStats & fs = it.data();
+
+	after = new QListViewItem( _fileSystems, after,
+				   fs.name,
+				   QString::number( fs.dirs ),
+				   QString::number( fs.entries ),
+				   formatSize( fs.bytes ),
+				   QString::number( fs.statCalls ),
+				   fs.statCalls > 0 ?
+				   formatLatency( (double) fs.statMicrosec / fs.statCalls ) : QString( "-" ) );
+	++it;
+    }
+}
+
+
+
+// EOF
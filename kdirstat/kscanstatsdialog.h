@@ -0,0 +1,127 @@
+/*
+ *   File name:	kscanstatsdialog.h
+ *   Summary:	Dialog with the scan throughput counters
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KScanStatsDialog_h
+#define KScanStatsDialog_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qtimer.h>
+#include <kdialogbase.h>
+
+
+// Milliseconds between two updates of the scan statistics dialog
+
+#define ScanStatsUpdateMillisec	1000
+
+
+class QLabel;
+class KListView;
+
+
+namespace KDirStat
+{
+    class KDirTree;
+
+
+    /**
+     * Non-modal dialog that shows the scan statistics of a tree (see @ref
+     * KScanStats) and updates them live while it is open: Directories and
+     * entries per second (right now and on average), the read job queue,
+     * the lstat() latency histogram and what was found on each file system.
+     *
+     * The statistics can be saved as a JSON file.
+     *
+     * @short Dialog for the scan throughput counters
+     **/
+    class KScanStatsDialog: public KDialogBase
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KScanStatsDialog( KDirTree * tree, QWidget * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KScanStatsDialog();
+
+
+    public slots:
+
+	/**
+	 * Display the current counters.
+	 **/
+	void refresh();
+
+
+    protected slots:
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Save as JSON" button.
+	 **/
+	virtual void slotUser1();
+
+
+    protected:
+
+	/**
+	 * Reimplemented from @ref QWidget: Start the live updates.
+	 **/
+	virtual void showEvent( QShowEvent * event );
+
+	/**
+	 * Reimplemented from @ref QWidget: Stop the live updates.
+	 **/
+	virtual void hideEvent( QHideEvent * event );
+
+	/**
+	 * Add a label 'caption' with a value label to the grid and return
+	 * the value label.
+	 **/
+	QLabel * addValue( QWidget * parent, const QString & caption );
+
+
+	KDirTree *	_tree;
+	QTimer		_timer;
+	QLabel *	_status;
+	QLabel *	_elapsed;
+	QLabel *	_dirs;
+	QLabel *	_entries;
+	QLabel *	_bytes;
+	QLabel *	_cacheLines;
+	QLabel *	_queue;
+	QLabel *	_statCalls;
+	KListView *	_latency;
+	KListView *	_fileSystems;
+
+	// The counters of the last update for the current rates
+
+	long long	_lastTime;
+	long		_lastDirs;
+	long		_lastEntries;
+	long		_lastCacheLines;
+
+    };	// class KScanStatsDialog
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KScanStatsDialog_h
+
+
+// EOF
@@ -0,0 +1,210 @@
+/*
+ *   File name:	ktopndialog.cpp
+ *   Summary:	Dialog listing the largest files / directories / file types
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qcombobox.h>
+#include <qlabel.h>
+#include <qlayout.h>
+#include <qspinbox.h>
+
+#include <kapp.h>
+#include <klistview.h>
+#include <klocale.h>
+
+#include "ktopndialog.h"
+#include "kdirtree.h"
+
+
+#define MaxTopNCount	100000
+
+
+using namespace KDirStat;
+
+
+KTopNDialog::KTopNDialog( KDirTree * tree, QWidget * parent )
+    : KDialogBase( Plain,				// dialogFace
+		   i18n( "Largest Items" ),		// caption
+		   User1 | Close,			// buttonMask
+		   User1,				// defaultButton
+		   parent,				// parent
+		   0,					// name
+		   false )				// modal
+    , _tree( tree )
+{
+    setButtonText( User1, i18n( "&Refresh" ) );
+
+    QWidget *	  page	 = plainPage();
+    QVBoxLayout * layout = new QVBoxLayout( page, 0, spacingHint() );
+    QHBoxLayout * hbox	 = new QHBoxLayout( layout );
+
+    _type = new QComboBox( false, page );
+    _type->insertItem( i18n( "Files"		) );	// KTopNFiles
+    _type->insertItem( i18n( "Directories"	) );	// KTopNDirs
+    _type->insertItem( i18n( "File Types"	) );	// KTopNFileTypes
+
+    QLabel * label = new QLabel( _type, i18n( "&Show largest:" ), page );
+    hbox->addWidget( label );
+    hbox->addWidget( _type );
+    hbox->addSpacing( 10 );
+
+    _count = new QSpinBox( 1, MaxTopNCount, 10, page );
+    _count->setValue( DefaultTopNCount );
+
+    label = new QLabel( _count, i18n( "&Number:" ), page );
+    hbox->addWidget( label );
+    hbox->addWidget( _count );
+    hbox->addStretch();
+
+    _subtreeLabel = new QLabel( page );
+    layout->addWidget( _subtreeLabel );
+
+    _list = new KListView( page );
+    _list->addColumn( i18n( "Size"	) );
+    _list->addColumn( i18n( "Files"	) );
+    _list->addColumn( i18n( "Name"	) );
+    _list->setColumnAlignment( 0, AlignRight );
+    _list->setColumnAlignment( 1, AlignRight );
+    _list->setAllColumnsShowFocus( true );
+    _list->setSorting( 0, false );		// largest first
+    layout->addWidget( _list, 1 );
+
+    connect( _type,	SIGNAL( activated( int ) ),
+	     this,	SLOT  ( refresh()	 ) );
+
+    connect( _list,	SIGNAL( selectionChanged( QListViewItem * ) ),
+	     this,	SLOT  ( selectItem	( QListViewItem * ) ) );
+
+    // Any deletion might leave the list with dangling pointers.
+
+    connect( _tree,	SIGNAL( deletingChild	( KFileInfo * )	),
+	     this,	SLOT  ( clear()				) );
+
+    connect( _tree,	SIGNAL( startingReading() ),
+	     this,	SLOT  ( clear()		  ) );
+
+    resize( 600, 450 );
+}
+
+
+KTopNDialog::~KTopNDialog()
+{
+    // NOP
+}
+
+
+void
+KTopNDialog::slotUser1()
+{
+    refresh();
+}
+
+
+void
+KTopNDialog::clear()
+{
+    _list->clear();
+    _subtreeLabel->setText( "" );
+}
+
+
+void
+KTopNDialog::refresh()
+{
+    clear();
+
+    if ( ! _tree->root() || _tree->isBusy() )
+	return;
+
+    // Use the selected directory if there is one, the entire tree otherwise.
+
+    KFileInfo * subtree = _tree->selection();
+
+    if ( ! subtree || ! subtree->isDirInfo() )
+	subtree = _tree->root();
+
+    KTopNType type = (KTopNType) _type->currentItem();
+
+    kapp->setOverrideCursor( waitCursor );
+    KTopNList result = _tree->topN( type, _count->value(), subtree );
+
+    for ( uint i=0; i < result.size(); i++ )
+	new KTopNListItem( _list, result[i] );
+
+    kapp->restoreOverrideCursor();
+
+    _subtreeLabel->setText( i18n( "In %1" ).arg( subtree->url() ) );
+}
+
+
+void
+KTopNDialog::selectItem( QListViewItem * listItem )
+{
+    KTopNListItem * item = dynamic_cast<KTopNListItem *>( listItem );
+
+    if ( item && item->entry().item )
+	_tree->selectItem( item->entry().item );
+}
+
+
+
+
+KTopNListItem::KTopNListItem( QListView * parent, const KTopNEntry & entry )
+    : QListViewItem( parent )
+    , _entry( entry )
+{
+    setText( 0, formatSize( entry.size ) );
+
+    if ( entry.item )
+    {
+	setText( 2, entry.item->url() );
+    }
+    else	// File type
+    {
+	setText( 1, QString::number( entry.count ) );
+	setText( 2, entry.name.isEmpty() ? i18n( "<no extension>" ) : "*." + entry.name );
+    }
+}
+
+
+int
+KTopNListItem::compare( QListViewItem *	otherListViewItem,
+			int		col,
+			bool		ascending ) const
+{
+    KTopNListItem * other = dynamic_cast<KTopNListItem *>( otherListViewItem );
+
+    if ( other )
+    {
+	switch ( col )
+	{
+	    case 0:
+		if ( _entry.size < other->entry().size ) return -1;
+		if ( _entry.size > other->entry().size ) return  1;
+		return 0;
+
+	    case 1:
+		if ( _entry.count < other->entry().count ) return -1;
+		if ( _entry.count > other->entry().count ) return  1;
+		return 0;
+
+	    default:
+		break;
+	}
+    }
+
+    return QListViewItem::compare( otherListViewItem, col, ascending );
+}
+
+
+
+// EOF
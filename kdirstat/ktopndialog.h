@@ -0,0 +1,140 @@
+/*
+ *   File name:	ktopndialog.h
+ *   Summary:	Dialog listing the largest files / directories / file types
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KTopNDialog_h
+#define KTopNDialog_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qlistview.h>
+#include <kdialogbase.h>
+#include "ktopnquery.h"
+
+
+class QComboBox;
+class QLabel;
+class QSpinBox;
+class KListView;
+
+
+namespace KDirStat
+{
+    class KDirTree;
+
+
+    /**
+     * Non-modal dialog that lists the largest files, directories or file
+     * types in the selected subtree (or in the entire tree if nothing or a
+     * file is selected). Clicking an entry selects it in the tree.
+     *
+     * The list is cleared whenever anything in the tree is deleted since its
+     * entries might refer to deleted items; use "Refresh" to run the query
+     * again.
+     *
+     * @short Dialog for the largest items in a subtree
+     **/
+    class KTopNDialog: public KDialogBase
+    {
+	Q_OBJECT
+
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KTopNDialog( KDirTree * tree, QWidget * parent = 0 );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KTopNDialog();
+
+
+    public slots:
+
+	/**
+	 * Run the query again with the current settings.
+	 **/
+	void refresh();
+
+	/**
+	 * Clear the result list.
+	 **/
+	void clear();
+
+
+    protected slots:
+
+	/**
+	 * Reimplemented from @ref KDialogBase: The "Refresh" button.
+	 **/
+	virtual void slotUser1();
+
+	/**
+	 * Select the file or directory of list item 'item' in the tree.
+	 **/
+	void selectItem( QListViewItem * item );
+
+
+    protected:
+
+	KDirTree *	_tree;
+	QComboBox *	_type;
+	QSpinBox *	_count;
+	QLabel *	_subtreeLabel;
+	KListView *	_list;
+
+    };	// class KTopNDialog
+
+
+
+    /**
+     * List item for one @ref KTopNEntry in a @ref KTopNDialog. Sorts
+     * numerically by size and number of files.
+     **/
+    class KTopNListItem: public QListViewItem
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KTopNListItem( QListView * parent, const KTopNEntry & entry );
+
+	/**
+	 * Returns the entry this item displays.
+	 **/
+	const KTopNEntry & entry() const { return _entry; }
+
+	/**
+	 * Comparison function used for sorting the list.
+	 *
+	 * Reimplemented from @ref QListViewItem.
+	 **/
+	virtual int compare( QListViewItem *	other,
+			     int		col,
+			     bool		ascending ) const;
+
+    protected:
+
+	KTopNEntry	_entry;
+
+    };	// class KTopNListItem
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KTopNDialog_h
+
+
+// EOF
@@ -0,0 +1,285 @@
+/*
+ *   File name:	ktopnquery.cpp
+ *   Summary:	Support classes for KDirStat - largest files / directories
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <stdio.h>
+#include <qdict.h>
+#include <kdebug.h>
+
+#include "ktopnquery.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KTopNQuery::KTopNQuery( KTopNType type, int n )
+    : _type( type )
+    , _n( n )
+{
+    if ( _n < 1 )
+	_n = 1;
+}
+
+
+KTopNQuery::~KTopNQuery()
+{
+    // NOP
+}
+
+
+const KTopNList &
+KTopNQuery::run( KFileInfo * subtree )
+{
+    _heap.clear();
+    _result.clear();
+
+    if ( ! subtree )
+	return _result;
+
+    _heap.reserve( _n );
+    collect( subtree );
+
+
+    // Take the smallest entry from the heap over and over again and fill
+    // the result from the end so it is sorted largest first.
+
+    _result.resize( _heap.size() );
+
+    for ( int i = _heap.size() - 1; i >= 0; i-- )
+    {
+	_result[ i ] = _heap[ 0 ];
+	_heap[ 0 ] = _heap.back();
+	_heap.pop_back();
+
+	if ( ! _heap.isEmpty() )
+	    siftDown( 0 );
+    }
+
+    return _result;
+}
+
+
+void
+KTopNQuery::collect( KFileInfo * subtree )
+{
+    // File types: Sum up the sizes per suffix first, then pick the largest
+    // sums. There are very few different suffixes compared to the number of
+    // files, so there is no need to be smart about that.
+
+    QDict<KTopNEntry> fileTypes( 1009 );
+    fileTypes.setAutoDelete( true );
+
+    // Traverse the tree without any recursion: Large trees can be very
+    // deep, and there is nothing to be gained from recursion here anyway.
+
+    QValueVector<KFileInfo *> stack;
+    stack.push_back( subtree );
+
+    while ( ! stack.isEmpty() )
+    {
+	KFileInfo * dir = stack.back();
+	stack.pop_back();
+
+	if ( _type == KTopNDirs && dir->isDir() && dir != subtree )
+	    offer( KTopNEntry( dir, dir->totalSize() ) );
+
+	if ( dir->dotEntry() )
+	    stack.push_back( dir->dotEntry() );
+
+	int count = dir->childCount();
+
+	for ( int i=0; i < count; i++ )
+	{
+	    KFileInfo * item = dir->childAt( i );
+
+	    if ( item->isDirInfo() )
+	    {
+		stack.push_back( item );
+	    }
+	    else if ( item->isFile() )
+	    {
+		if ( _type == KTopNFiles )
+		{
+		    offer( KTopNEntry( item, item->size() ) );
+		}
+		else if ( _type == KTopNFileTypes )
+		{
+		    QString name = suffix( item->name() );
+		    QString key  = name.isEmpty() ? QString( "/" ) : name;	// '/' can't be a suffix
+		    KTopNEntry * type = fileTypes.find( key );
+
+		    if ( type )
+		    {
+			type->size += item->size();
+			type->count++;
+		    }
+		    else
+		    {
+			type = new KTopNEntry( 0, item->size() );
+			CHECK_PTR( type );
+			type->name = name;
+			fileTypes.insert( key, type );
+		    }
+		}
+	    }
+	}
+    }
+
+    if ( _type == KTopNFileTypes )
+    {
+	QDictIterator<KTopNEntry> it( fileTypes );
+
+	while ( it.current() )
+	{
+	    offer( *it.current() );
+	    ++it;
+	}
+    }
+}
+
+
+void
+KTopNQuery::offer( const KTopNEntry & entry )
+{
+    if ( (int) _heap.size() < _n )
+    {
+	_heap.push_back( entry );
+	siftUp( _heap.size() - 1 );
+    }
+    else if ( entry.size > _heap[ 0 ].size )
+    {
+	_heap[ 0 ] = entry;
+	siftDown( 0 );
+    }
+}
+
+
+void
+KTopNQuery::siftUp( int pos )
+{
+    KTopNEntry entry = _heap[ pos ];
+
+    while ( pos > 0 )
+    {
+	int parent = ( pos - 1 ) / 2;
+
+	if ( _heap[ parent ].size <= entry.size )
+	    break;
+
+	_heap[ pos ] = _heap[ parent ];
+	pos = parent;
+    }
+
+    _heap[ pos ] = entry;
+}
+
+
+void
+KTopNQuery::siftDown( int pos )
+{
+    KTopNEntry entry = _heap[ pos ];
+    int size = _heap.size();
+
+    while ( true )
+    {
+	int child = 2 * pos + 1;
+
+	if ( child >= size )
+	    break;
+
+	if ( child + 1 < size && _heap[ child + 1 ].size < _heap[ child ].size )
+	    child++;
+
+	if ( entry.size <= _heap[ child ].size )
+	    break;
+
+	_heap[ pos ] = _heap[ child ];
+	pos = child;
+    }
+
+    _heap[ pos ] = entry;
+}
+
+
+QString
+KTopNQuery::suffix( const QString & fileName )
+{
+    int pos = fileName.findRev( '.' );
+
+    // No '.' at all, or only a leading one as in ".bashrc": No suffix.
+
+    if ( pos < 1 || pos == (int) fileName.length() - 1 )
+	return QString( "" );
+
+    return fileName.mid( pos + 1 ).lower();
+}
+
+
+
+
+KTopNJob::KTopNJob( const QString &	input,
+		    KTopNType		type,
+		    int			n )
+    : KBatchJob( input )
+    , _query( type, n )
+{
+    // NOP
+}
+
+
+KTopNJob::~KTopNJob()
+{
+    // NOP
+}
+
+
+bool
+KTopNJob::process( KDirTree * tree )
+{
+    if ( ! tree->root() )
+    {
+	kdError() << "Nothing read from " << _input << endl;
+	return false;
+    }
+
+    const KTopNList & result = _query.run( tree->root() );
+
+    // Names hold the raw bytes from readdir() as Latin-1: Print exactly
+    // those bytes, no matter what the locale is.
+
+    for ( uint i=0; i < result.size(); i++ )
+    {
+	const KTopNEntry & entry = result[i];
+
+	if ( entry.item )
+	{
+	    printf( "%lld\t%s\n",
+		    (long long) entry.size,
+		    (const char *) entry.item->url().latin1() );
+	}
+	else
+	{
+	    printf( "%lld\t%d\t%s\n",
+		    (long long) entry.size,
+		    entry.count,
+		    entry.name.isEmpty() ? "*" : (const char *) ( "*." + entry.name ).latin1() );
+	}
+    }
+
+    return fflush( stdout ) == 0;
+}
+
+
+
+// EOF
@@ -0,0 +1,218 @@
+/*
+ *   File name:	ktopnquery.h
+ *   Summary:	Support classes for KDirStat - largest files / directories
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KTopNQuery_h
+#define KTopNQuery_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qstring.h>
+#include <qvaluevector.h>
+#include "kfileinfo.h"
+#include "kbatchjob.h"
+
+
+#define DefaultTopNCount	100
+
+
+namespace KDirStat
+{
+    /**
+     * What to look for in a @ref KTopNQuery.
+     **/
+    typedef enum
+    {
+	KTopNFiles,		// Largest files
+	KTopNDirs,		// Largest directories (total size of the subtree)
+	KTopNFileTypes		// Filename suffixes with the largest sum of sizes
+    } KTopNType;
+
+
+    /**
+     * One result of a @ref KTopNQuery.
+     **/
+    class KTopNEntry
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KTopNEntry( KFileInfo * it = 0, KFileSize sz = 0 )
+	    : item( it )
+	    , size( sz )
+	    , count( 1 )
+	    {}
+
+	KFileInfo *	item;	// the file or directory; 0 for file types
+	QString		name;	// file types only: suffix without '.', lowercase
+	KFileSize	size;	// size or total size
+	int		count;	// file types only: number of files
+
+    };	// class KTopNEntry
+
+
+    typedef QValueVector<KTopNEntry> KTopNList;
+
+
+    /**
+     * Query for the N largest files, directories or file types in a
+     * subtree.
+     *
+     * The subtree is traversed only once, keeping only the N largest
+     * candidates so far in a min-heap: Most items are rejected by one single
+     * comparison with the smallest of those candidates, so this is much
+     * cheaper than sorting everything.
+     *
+     * Sample usage:
+     *
+     *     KTopNQuery query( KTopNFiles, 1000 );
+     *     const KTopNList & result = query.run( tree->root() );
+     *
+     *     for ( uint i=0; i < result.size(); i++ )
+     *         kdDebug() << result[i].item << ": " << result[i].size << endl;
+     *
+     * See also @ref KDirTree::topN() .
+     *
+     * @short Query for the N largest files, directories or file types
+     **/
+    class KTopNQuery
+    {
+    public:
+
+	/**
+	 * Constructor for a query for the 'n' largest items of type 'type'.
+	 **/
+	KTopNQuery( KTopNType type, int n = DefaultTopNCount );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KTopNQuery();
+
+	/**
+	 * Run the query on 'subtree' and return the result, largest first.
+	 **/
+	const KTopNList & run( KFileInfo * subtree );
+
+	/**
+	 * Returns the result of the last run(), largest first.
+	 **/
+	const KTopNList & result() const { return _result; }
+
+	/**
+	 * Returns the type of this query.
+	 **/
+	KTopNType type() const { return _type; }
+
+	/**
+	 * Returns the number of results this query is looking for.
+	 **/
+	int count() const { return _n; }
+
+	/**
+	 * Returns the lowercase filename suffix (without '.') used for
+	 * KTopNFileTypes or an empty string if there is none.
+	 **/
+	static QString suffix( const QString & fileName );
+
+
+    protected:
+
+	/**
+	 * Offer all candidates in 'subtree' to the heap.
+	 **/
+	void collect( KFileInfo * subtree );
+
+	/**
+	 * Offer 'entry' to the heap: Add it if the heap is not full yet,
+	 * replace the smallest entry if 'entry' is larger than that,
+	 * discard it otherwise.
+	 **/
+	void offer( const KTopNEntry & entry );
+
+	/**
+	 * Restore the heap property from heap position 'pos' upwards.
+	 **/
+	void siftUp( int pos );
+
+	/**
+	 * Restore the heap property from heap position 'pos' downwards.
+	 **/
+	void siftDown( int pos );
+
+
+	// Data members
+
+	KTopNType	_type;
+	int		_n;
+	KTopNList	_heap;		// min-heap: smallest entry at _heap[0]
+	KTopNList	_result;
+
+    };	// class KTopNQuery
+
+
+
+    /**
+     * Batch driver for KTopNQuery: Reads a directory or a cache file and
+     * prints the largest items to stdout, one per line:
+     *
+     *     <size in bytes> TAB <path>
+     *
+     * or, for file types:
+     *
+     *     <size in bytes> TAB <number of files> TAB *.<suffix>
+     *
+     * Used for "kdirstat --top".
+     *
+     * @short Batch output of the largest files / directories / file types
+     **/
+    class KTopNJob: public KBatchJob
+    {
+    public:
+
+	/**
+	 * Constructor. 'input' is either a directory (path or URL) or a
+	 * KDirStat cache file.
+	 **/
+	KTopNJob( const QString &	input,
+		  KTopNType		type,
+		  int			n );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KTopNJob();
+
+
+    protected:
+
+	/**
+	 * Run the query and print its result.
+	 *
+	 * Reimplemented - inherited from @ref KBatchJob.
+	 **/
+	virtual bool process( KDirTree * tree );
+
+
+	KTopNQuery	_query;
+
+    };	// class KTopNJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KTopNQuery_h
+
+
+// EOF
@@ -0,0 +1,313 @@
+/*
+ *   File name:	ktreemapcolors.cpp
+ *   Summary:	Filename suffix to treemap tile color table
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/stat.h>
+
+#include <kapp.h>
+#include <kconfig.h>
+
+#include "ktreemapcolors.h"
+#include "kfileinfo.h"
+
+
+using namespace KDirStat;
+
+
+/**
+ * Built-in color categories. Each of them can be overridden in the config
+ * file with <name>Color, <name>Suffixes and <name>CaseSensitiveSuffixes.
+ **/
+static const struct
+{
+    const char *	name;
+    QRgb		color;
+    const char *	caseSensitiveSuffixes;
+    const char *	suffixes;
+} defaultCategories[] =
+{
+    { "Backup",		0xd71e00, "~,bak",					"" },
+    { "Document",	0x007ec6, "c,cpp,cc,h,hpp,el",				"html,htm,txt,doc,pdf" },
+    { "Object",		0xf98d00, "o,lo,Po,al,moc.cpp,moc.cc,elc,la,a,rpm",	"dll" },
+    { "Archive",	0x55bb4d, "",						"tar.bz2,tar.gz,tgz,bz2,bz,gz,zip,arj" },
+    { "Image",		0x00b38a, "",						"png,jpg,jpeg,gif,tif,tiff,bmp,xpm,tga" },
+    { "Audio",		0xf1da00, "",						"wav,mp3" },
+    { "Video",		0xc0e30e, "",						"avi,mov,mpg,mpeg" },
+    { "Executable",	0xbd50a7, "",						"ps,exe,com" },
+    { 0, 0, 0, 0 }
+};
+
+
+KTreemapColors::KTreemapColors()
+    : _caseSensitive  ( 101, true  )
+    , _caseInsensitive( 101, true  )
+{
+    _caseSensitive.setAutoDelete  ( true );
+    _caseInsensitive.setAutoDelete( true );
+
+    readConfig();
+}
+
+
+KTreemapColors::~KTreemapColors()
+{
+    // The dicts will delete their entries since they have autoDelete enabled.
+}
+
+
+KTreemapColors * KTreemapColors::treemapColors()
+{
+    static KTreemapColors * singleton = 0;
+
+    if ( ! singleton )
+    {
+	singleton = new KTreemapColors();
+    }
+
+    return singleton;
+}
+
+
+void
+KTreemapColors::readConfig()
+{
+    clear();
+
+    KConfig * config = kapp->config();
+    config->setGroup( "Treemap Colors" );
+
+    for ( int i=0; defaultCategories[i].name; i++ )
+    {
+	QString name = defaultCategories[i].name;
+	QColor  defaultColor( defaultCategories[i].color );
+	QColor  color = config->readColorEntry( name + "Color", &defaultColor );
+
+	QStringList caseSensitiveSuffixes =
+	    config->readListEntry( name + "CaseSensitiveSuffixes" );
+
+	QStringList suffixes = config->readListEntry( name + "Suffixes" );
+
+	if ( ! config->hasKey( name + "CaseSensitiveSuffixes" ) )
+	    caseSensitiveSuffixes = QStringList::split( ',', defaultCategories[i].caseSensitiveSuffixes );
+
+	if ( ! config->hasKey( name + "Suffixes" ) )
+	    suffixes = QStringList::split( ',', defaultCategories[i].suffixes );
+
+	addSuffixes( caseSensitiveSuffixes, color, true,  name );
+	addSuffixes( suffixes,		    color, false, name );
+
+	if ( name == "Object"     )	_objectColor	 = color;
+	if ( name == "Backup"     )	_backupColor	 = color;
+	if ( name == "Executable" )	_executableColor = color;
+    }
+
+    _fileColor	= Qt::white;
+    _dirColor	= Qt::blue;
+}
+
+
+void
+KTreemapColors::clear()
+{
+    _caseSensitive.clear();
+    _caseInsensitive.clear();
+}
+
+
+void
+KTreemapColors::addSuffixes( const QStringList &	suffixes,
+			     const QColor &		color,
+			     bool			caseSensitive,
+			     const QString &		category )
+{
+    QStringList::const_iterator it = suffixes.begin();
+
+    while ( it != suffixes.end() )
+    {
+	addSuffix( (*it).stripWhiteSpace(), color, caseSensitive, category );
+	++it;
+    }
+}
+
+
+void
+KTreemapColors::addSuffix( const QString &	suffix,
+			   const QColor &	color,
+			   bool			caseSensitive,
+			   const QString &	category )
+{
+    if ( suffix.isEmpty() )
+	return;
+
+    QDict<SuffixEntry> & dict = caseSensitive ? _caseSensitive : _caseInsensitive;
+    QString key = caseSensitive ? suffix : suffix.lower();
+
+    if ( ! dict.find( key ) )
+	dict.insert( key, new SuffixEntry( color, category ) );
+}
+
+
+const QColor *
+KTreemapColors::suffixColor( const QString & name ) const
+{
+    const SuffixEntry * entry = suffixEntry( name );
+
+    return entry ? &entry->color : 0;
+}
+
+
+const KTreemapColors::SuffixEntry *
+KTreemapColors::suffixEntry( const QString & name ) const
+{
+    // Try every suffix of the name, longest first: "tar.bz2", then "bz2".
+    // Within the same suffix, case sensitive entries take precedence.
+
+    QString lowerName;
+    int pos = name.find( '.' );
+
+    while ( pos >= 0 )
+    {
+	QString suffix = name.mid( pos + 1 );
+
+	if ( ! suffix.isEmpty() )
+	{
+	    const SuffixEntry * entry = _caseSensitive.find( suffix );
+
+	    if ( entry )
+		return entry;
+
+	    if ( lowerName.isEmpty() )
+		lowerName = name.lower();
+
+	    entry = _caseInsensitive.find( lowerName.mid( pos + 1 ) );
+
+	    if ( entry )
+		return entry;
+	}
+
+	pos = name.find( '.', pos + 1 );
+    }
+
+    return 0;
+}
+
+
+QColor
+KTreemapColors::color( KFileInfo * file ) const
+{
+    if ( ! file )
+	return Qt::white;
+
+    if ( ! file->isFile() )
+    {
+	// TO DO
+	return _dirColor;
+    }
+
+    const QString & name = file->name();
+    const QColor * color = suffixColor( name );
+
+    if ( color )
+	return *color;
+
+    // Shared libs: "lib*.so*"
+
+    if ( name.startsWith( "lib" ) && name.find( ".so", 3 ) >= 0 )
+	return _objectColor;
+
+    // Very special, but common: Core dumps
+    if ( name == "core" )
+	return _backupColor;
+
+    // Special case: Executables
+    if ( ( file->mode() & S_IXUSR  ) == S_IXUSR )
+	return _executableColor;
+
+    return _fileColor;
+}
+
+
+QStringList
+KTreemapColors::categoryNames()
+{
+    QStringList names;
+
+    for ( int i=0; defaultCategories[i].name; i++ )
+	names << defaultCategories[i].name;
+
+    return names;
+}
+
+
+QString
+KTreemapColors::category( KFileInfo * file ) const
+{
+    if ( ! file || ! file->isFile() )
+	return QString( "" );
+
+    const QString & name = file->name();
+    const SuffixEntry * entry = suffixEntry( name );
+
+    if ( entry )
+	return entry->category;
+
+    if ( name.startsWith( "lib" ) && name.find( ".so", 3 ) >= 0 )
+	return QString( "Object" );
+
+    if ( name == "core" )
+	return QString( "Backup" );
+
+    if ( ( file->mode() & S_IXUSR  ) == S_IXUSR )
+	return QString( "Executable" );
+
+    return QString( "" );
+}
+
+
+QColor
+KTreemapColors::ageColor( int bucket ) const
+{
+    static const QColor ageColors[ KAgeBuckets ] =
+    {
+	QColor( 0xff, 0x40, 0x40 ),	// less than 1 month
+	QColor( 0xff, 0xa0, 0x30 ),	// 1 - 6 months
+	QColor( 0xe0, 0xe0, 0x40 ),	// 6 - 12 months
+	QColor( 0x40, 0xc0, 0xe0 ),	// 1 - 2 years
+	QColor( 0x30, 0x50, 0xe0 )	// more than 2 years
+    };
+
+    if ( bucket < 0 || bucket >= KAgeBuckets )
+	return _fileColor;
+
+    return ageColors[ bucket ];
+}
+
+
+QColor
+KTreemapColors::tileColor( KFileInfo * file, bool byAge ) const
+{
+    // Files the tree's file filter does not accept are grayed out, so the
+    // filtered totals are visible right in the treemap.
+
+    if ( file && file->isFilteredOut() )
+	return QColor( 0xd8, 0xd8, 0xd8 );
+
+    if ( byAge && file )
+	return ageColor( file->ageBucket() );
+
+    return color( file );
+}
+
+
+
+// EOF
@@ -0,0 +1,191 @@
+/*
+ *   File name:	ktreemapcolors.h
+ *   Summary:	Filename suffix to treemap tile color table
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KTreemapColors_h
+#define KTreemapColors_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qcolor.h>
+#include <qdict.h>
+#include <qstringlist.h>
+
+
+namespace KDirStat
+{
+    class KFileInfo;
+
+
+    /**
+     * Table that maps file names to treemap tile colors, mostly according to
+     * their filename suffix ("extension").
+     *
+     * The suffixes are grouped into categories ("Document", "Image",
+     * "Archive", ...) that share one color. Both the colors and the suffixes
+     * of each category can be changed in the "Treemap Colors" group of the
+     * config file:
+     *
+     *     [Treemap Colors]
+     *     ImageColor=0,179,138
+     *     ImageSuffixes=png,jpg,jpeg,gif
+     *     ObjectCaseSensitiveSuffixes=o,lo,Po
+     *
+     * Suffixes are compared case-insensitive unless listed in
+     * ...CaseSensitiveSuffixes.
+     *
+     * The table is built only once in readConfig(); looking up a file's color
+     * is just a few hash lookups, one for each suffix of the file name
+     * (e.g., "tar.bz2" and "bz2" for "foo.tar.bz2").
+     *
+     * The same categories are used for the file type statistics (see @ref
+     * KFileTypeStats), so category() classifies a file exactly like its
+     * treemap tile color does.
+     *
+     * Normal usage:
+     *
+     *     QColor color = KTreemapColors::treemapColors()->color( file );
+     **/
+    class KTreemapColors
+    {
+    public:
+
+	/**
+	 * Constructor. Reads the color table from the config file.
+	 *
+	 * Most applications will want to use treemapColors() instead to
+	 * create and use a singleton object of this class.
+	 **/
+	KTreemapColors();
+
+	/**
+	 * Destructor.
+	 **/
+	~KTreemapColors();
+
+	/**
+	 * Return the singleton object of this class.
+	 * This will create one if there is none yet.
+	 **/
+	static KTreemapColors * treemapColors();
+
+	/**
+	 * (Re-) build the color table from the config file.
+	 **/
+	void readConfig();
+
+	/**
+	 * Returns a suitable color for 'file' based on its filename suffix,
+	 * its name or its permissions.
+	 **/
+	QColor color( KFileInfo * file ) const;
+
+	/**
+	 * Returns the name of the category ("Document", "Image", ...) of
+	 * 'file' or an empty string if it doesn't belong to any category.
+	 * The same rules as in color() apply.
+	 **/
+	QString category( KFileInfo * file ) const;
+
+	/**
+	 * Returns the names of all categories category() can return.
+	 **/
+	static QStringList categoryNames();
+
+	/**
+	 * Returns the color for age bucket 'bucket' (see @ref
+	 * KDirStat::ageBucket() ): From red for recently changed files to blue
+	 * for "cold" data.
+	 **/
+	QColor ageColor( int bucket ) const;
+
+	/**
+	 * Returns the color of the treemap tile for 'file': Gray if the
+	 * tree's file filter does not accept it, otherwise by its age if
+	 * 'byAge' is set, by color() if not.
+	 *
+	 * This is what both the treemap view and the treemap export use.
+	 **/
+	QColor tileColor( KFileInfo * file, bool byAge ) const;
+
+	/**
+	 * Returns the color for a file named 'name' if it has a known filename
+	 * suffix or 0 if not.
+	 **/
+	const QColor * suffixColor( const QString & name ) const;
+
+	/**
+	 * Add suffix 'suffix' with color 'color' that belongs to category
+	 * 'category'. 'suffix' should be without the leading '.'. If the
+	 * suffix is already in the table, the existing entry takes
+	 * precedence.
+	 **/
+	void addSuffix( const QString &	suffix,
+			const QColor &	color,
+			bool		caseSensitive = false,
+			const QString &	category = QString::null );
+
+	/**
+	 * Remove all entries.
+	 **/
+	void clear();
+
+
+    protected:
+
+	/**
+	 * Add all suffixes in 'suffixes' with color 'color'.
+	 **/
+	void addSuffixes( const QStringList &	suffixes,
+			  const QColor &	color,
+			  bool			caseSensitive,
+			  const QString &	category );
+
+	/**
+	 * One entry of the suffix table.
+	 **/
+	struct SuffixEntry
+	{
+	    SuffixEntry( const QColor & col, const QString & cat )
+		: color( col ), category( cat ) {}
+
+	    QColor	color;
+	    QString	category;
+	};
+
+	/**
+	 * Returns the table entry for a file named 'name' if it has a known
+	 * filename suffix or 0 if not.
+	 **/
+	const SuffixEntry * suffixEntry( const QString & name ) const;
+
+
+	// Data members
+
+	QDict<SuffixEntry> _caseSensitive;
+	QDict<SuffixEntry> _caseInsensitive;	// keys are lowercase
+
+	QColor		_objectColor;		// shared libs
+	QColor		_backupColor;		// core dumps
+	QColor		_executableColor;	// files with the x bit set
+	QColor		_fileColor;		// everything else
+	QColor		_dirColor;
+
+    }; // class KTreemapColors
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KTreemapColors_h
+
+
+// EOF
@@ -0,0 +1,350 @@
+/*
+ *   File name:	ktreemapexport.cpp
+ *   Summary:	Headless treemap export to image files
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_LIBPNG
+#   include <png.h>
+#endif
+
+#include <qfile.h>
+#include <qimage.h>
+#include <qmemarray.h>
+
+#include <kapp.h>
+#include <kconfig.h>
+#include <kdebug.h>
+
+#include "ktreemapexport.h"
+#include "ktreemapcolors.h"
+#include "ktreemapview.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+
+
+KTreemapExporter::KTreemapExporter()
+    : _renderer( 0 )
+{
+    readConfig();
+}
+
+
+KTreemapExporter::~KTreemapExporter()
+{
+    if ( _renderer )
+	delete _renderer;
+}
+
+
+void
+KTreemapExporter::readConfig()
+{
+    _layout.readConfig();
+
+    KConfig * config = kapp->config();
+    config->setGroup( "Treemaps" );
+
+    QColor cushionGridColor( 0x80, 0x80, 0x80 );
+    QColor outlineColor    ( Qt::black );
+    QColor dirFillColor    ( 0x10, 0x7d, 0xb4 );
+    QColor smallItemsColor ( 0xa0, 0xa0, 0xa0 );
+
+    _ambientLight	= config->readNumEntry ( "AmbientLight"		, DefaultAmbientLight );
+    _doCushionShading	= config->readBoolEntry( "CushionShading"	, true	);
+    _ensureContrast	= config->readBoolEntry( "EnsureContrast"	, true	);
+    _forceCushionGrid	= config->readBoolEntry( "ForceCushionGrid"	, false	);
+    _colorByAge		= config->readBoolEntry( "ColorByAge"		, false	);
+
+    _cushionGridColor	= config->readColorEntry( "CushionGridColor"	, &cushionGridColor );
+    _outlineColor	= config->readColorEntry( "OutlineColor"	, &outlineColor	    );
+    _dirFillColor	= config->readColorEntry( "DirFillColor"	, &dirFillColor	    );
+    _smallItemsColor	= config->readColorEntry( "SmallItemsColor"	, &smallItemsColor  );
+
+    if ( _renderer )
+	delete _renderer;
+
+    KTreemapColors::treemapColors()->readConfig();
+
+    _renderer = new KCushionRenderer( _ambientLight,
+				      DefaultLightX, DefaultLightY, DefaultLightZ,
+				      _ensureContrast );
+    CHECK_PTR( _renderer );
+}
+
+
+bool
+KTreemapExporter::exportTreemap( KFileInfo *		root,
+				 const QSize &		size,
+				 const QString &	fileName )
+{
+    if ( ! root )
+    {
+	kdError() << "No tree to export to " << fileName << endl;
+	return false;
+    }
+
+    if ( size.width() < 1 || size.height() < 1 )
+    {
+	kdError() << "Invalid treemap size " << size.width() << "x" << size.height() << endl;
+	return false;
+    }
+
+    // There is no interactive view to keep responsive, so there is no need
+    // to limit the number of tiles.
+
+    _layout.setMaxTiles( 0 );
+    _layout.layout( root, QRect( QPoint( 0, 0 ), size ) );
+
+    bool ok = writePng( size, fileName );
+    _layout.clear();
+
+    return ok;
+}
+
+
+void
+KTreemapExporter::renderStrip( QImage & strip, int width, int y0 )
+{
+    QRect stripRect( 0, y0, width, strip.height() );
+    strip.fill( qRgb( 0xff, 0xff, 0xff ) );
+
+    // The layout nodes are in depth-first order, so each node is rendered
+    // after its parent and on top of it - just like the canvas items in the
+    // interactive view that are stacked by their depth.
+
+    for ( int i=0; i < _layout.count(); i++ )
+    {
+	const KTreemapNode & node = _layout.node( i );
+
+	if ( node.rect.intersects( stripRect ) )
+	    renderNode( strip, y0, i, stripRect );
+    }
+}
+
+
+void
+KTreemapExporter::renderNode( QImage &			strip,
+			      int			y0,
+			      int			index,
+			      const QRect &		clipRect )
+{
+    const KTreemapNode & node = _layout.node( index );
+    const QRect & rect = node.rect;
+
+    if ( rect.width() < 1 || rect.height() < 1 )
+	return;
+
+    if ( _doCushionShading )
+    {
+	if ( ( node.orig->isDir() || node.orig->isDotEntry() ) && ! node.isAggregate )
+	{
+	    fillRect( strip, y0, rect, clipRect, qRgb( 0x60, 0x60, 0x60 ) );
+	}
+	else
+	{
+	    _renderer->render( strip, QPoint( 0, y0 ), rect, clipRect,
+			       _layout.cushions(), index, nodeColor( node ) );
+
+	    if ( _forceCushionGrid )
+	    {
+		// Draw a clearly visible boundary
+
+		QRgb gridColor = _cushionGridColor.rgb();
+
+		if ( rect.x() > 0 )
+		    fillRect( strip, y0, QRect( rect.left(), rect.top(), 1, rect.height() + 1 ),
+			      clipRect, gridColor );
+
+		if ( rect.y() > 0 )
+		    fillRect( strip, y0, QRect( rect.left(), rect.top(), rect.width() + 1, 1 ),
+			      clipRect, gridColor );
+	    }
+	}
+    }
+    else	// No cushion shading, use plain tiles
+    {
+	QRgb outlineColor = _outlineColor.rgb();
+
+	fillRect( strip, y0, rect, clipRect, nodeColor( node ).rgb() );
+
+	fillRect( strip, y0, QRect( rect.left(),  rect.top(),    rect.width(), 1 ), clipRect, outlineColor );
+	fillRect( strip, y0, QRect( rect.left(),  rect.bottom(), rect.width(), 1 ), clipRect, outlineColor );
+	fillRect( strip, y0, QRect( rect.left(),  rect.top(),    1, rect.height() ), clipRect, outlineColor );
+	fillRect( strip, y0, QRect( rect.right(), rect.top(),    1, rect.height() ), clipRect, outlineColor );
+    }
+}
+
+
+void
+KTreemapExporter::fillRect( QImage &		strip,
+			    int			y0,
+			    const QRect &	rect,
+			    const QRect &	clipRect,
+			    QRgb		color )
+{
+    QRect fill = rect & clipRect;
+
+    for ( int y = fill.top(); y <= fill.bottom(); y++ )
+    {
+	QRgb * line = (QRgb *) strip.scanLine( y - y0 );
+
+	for ( int x = fill.left(); x <= fill.right(); x++ )
+	    line[ x ] = color;
+    }
+}
+
+
+QColor
+KTreemapExporter::nodeColor( const KTreemapNode & node ) const
+{
+    if ( node.isAggregate )
+	return _smallItemsColor;
+
+    if ( node.orig->isDir() || node.orig->isDotEntry() )
+	return _dirFillColor;
+
+    return KTreemapColors::treemapColors()->tileColor( node.orig, _colorByAge );
+}
+
+
+bool
+KTreemapExporter::writePng( const QSize & size, const QString & fileName )
+{
+#ifdef HAVE_LIBPNG
+
+    FILE * file = fopen( QFile::encodeName( fileName ), "wb" );
+
+    if ( ! file )
+    {
+	kdError() << "Can't open " << fileName << ": " << strerror( errno ) << endl;
+	return false;
+    }
+
+    png_structp png  = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
+    png_infop   info = png ? png_create_info_struct( png ) : 0;
+
+    if ( ! png || ! info )
+    {
+	kdError() << "Can't initialize libpng" << endl;
+	png_destroy_write_struct( &png, 0 );
+	fclose( file );
+	return false;
+    }
+
+    // Everything libpng might jump back over must already exist here.
+
+    QImage		strip( size.width(), QMIN( size.height(), ExportStripHeight ), 32 );
+    QMemArray<png_byte>	row( 3 * size.width() );
+
+    if ( setjmp( png_jmpbuf( png ) ) )
+    {
+	kdError() << "Error writing " << fileName << endl;
+	png_destroy_write_struct( &png, &info );
+	fclose( file );
+	return false;
+    }
+
+    png_init_io( png, file );
+    png_set_IHDR( png, info, size.width(), size.height(),
+		  8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+		  PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT );
+    png_write_info( png, info );
+
+    for ( int y0 = 0; y0 < size.height(); y0 += strip.height() )
+    {
+	renderStrip( strip, size.width(), y0 );
+
+	int lines = QMIN( strip.height(), size.height() - y0 );
+
+	for ( int y = 0; y < lines; y++ )
+	{
+	    QRgb *	line = (QRgb *) strip.scanLine( y );
+	    png_byte *	out  = row.data();
+
+	    for ( int x = 0; x < size.width(); x++ )
+	    {
+		*out++ = qRed  ( line[ x ] );
+		*out++ = qGreen( line[ x ] );
+		*out++ = qBlue ( line[ x ] );
+	    }
+
+	    png_write_row( png, row.data() );
+	}
+    }
+
+    png_write_end( png, info );
+    png_destroy_write_struct( &png, &info );
+
+    if ( fclose( file ) != 0 )
+    {
+	kdError() << "Error writing " << fileName << ": " << strerror( errno ) << endl;
+	return false;
+    }
+
+    return true;
+
+#else
+
+    // No libpng: Render the complete image in one big strip and let Qt
+    // handle the file format.
+
+    QImage image( size.width(), size.height(), 32 );
+    renderStrip( image, size.width(), 0 );
+
+    if ( ! image.save( fileName, "PNG" ) )
+    {
+	kdError() << "Error writing " << fileName << endl;
+	return false;
+    }
+
+    return true;
+
+#endif
+}
+
+
+
+
+KTreemapExportJob::KTreemapExportJob( const QString &	input,
+				      const QString &	fileName,
+				      const QSize &	size )
+    : KBatchJob( input )
+    , _fileName( fileName )
+    , _size( size )
+{
+    // NOP
+}
+
+
+KTreemapExportJob::~KTreemapExportJob()
+{
+    // NOP
+}
+
+
+bool
+KTreemapExportJob::process( KDirTree * tree )
+{
+    KTreemapExporter exporter;
+
+    return exporter.exportTreemap( tree->root(), _size, _fileName );
+}
+
+
+
+// EOF
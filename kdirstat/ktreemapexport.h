@@ -0,0 +1,193 @@
+/*
+ *   File name:	ktreemapexport.h
+ *   Summary:	Headless treemap export to image files
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KTreemapExport_h
+#define KTreemapExport_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qsize.h>
+#include "ktreemaplayout.h"
+#include "kbatchjob.h"
+
+
+#define DefaultExportWidth		1600
+#define DefaultExportHeight		1200
+#define ExportStripHeight		256
+
+
+namespace KDirStat
+{
+    class KDirTree;
+    class KFileInfo;
+
+
+    /**
+     * Renders a treemap of a directory tree into an image file without any
+     * widgets involved, so this works for any resolution, even far beyond
+     * the screen size.
+     *
+     * The treemap is rendered in horizontal strips of ExportStripHeight
+     * pixels that are written to the output file one by one, so memory
+     * usage only depends on the image width, not on the image height.
+     *
+     * The treemap parameters (colors, cushion shading, light) are taken
+     * from the "Treemaps" group of the config file, just like for the
+     * interactive treemap view.
+     *
+     * @short Headless treemap image export
+     **/
+    class KTreemapExporter
+    {
+    public:
+
+	/**
+	 * Constructor. Reads the treemap settings from the config file.
+	 **/
+	KTreemapExporter();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KTreemapExporter();
+
+	/**
+	 * Read the treemap parameters from the config file.
+	 **/
+	void readConfig();
+
+	/**
+	 * Render a treemap of 'root' with size 'size' and write it to PNG
+	 * file 'fileName'.
+	 *
+	 * Returns 'true' on success, 'false' on error.
+	 **/
+	bool exportTreemap( KFileInfo *		root,
+			    const QSize &	size,
+			    const QString &	fileName );
+
+	/**
+	 * Returns the treemap layout used for the export. Its parameters
+	 * can be changed before calling exportTreemap().
+	 **/
+	KTreemapLayout & layout() { return _layout; }
+
+
+    protected:
+
+	/**
+	 * Render the part of the treemap with width 'width' that starts at
+	 * treemap line 'y0' into 'strip'.
+	 **/
+	void renderStrip( QImage & strip, int width, int y0 );
+
+	/**
+	 * Render the part of layout node no. 'index' that is inside
+	 * 'clipRect' into 'strip' that starts at treemap line 'y0'.
+	 **/
+	void renderNode( QImage &		strip,
+			 int			y0,
+			 int			index,
+			 const QRect &		clipRect );
+
+	/**
+	 * Fill the part of 'rect' that is inside 'clipRect' with 'color'.
+	 **/
+	void fillRect( QImage &		strip,
+		       int		y0,
+		       const QRect &	rect,
+		       const QRect &	clipRect,
+		       QRgb		color );
+
+	/**
+	 * Returns the fill color for layout node 'node'.
+	 **/
+	QColor nodeColor( const KTreemapNode & node ) const;
+
+	/**
+	 * Write the treemap as PNG to 'fileName', streaming one strip after
+	 * the other. Uses libpng directly if available, otherwise renders the
+	 * complete image in memory and lets QImage write it.
+	 **/
+	bool writePng( const QSize & size, const QString & fileName );
+
+
+	// Data members
+
+	KTreemapLayout		_layout;
+	KCushionRenderer *	_renderer;
+
+	int			_ambientLight;
+	bool			_doCushionShading;
+	bool			_ensureContrast;
+	bool			_forceCushionGrid;
+	bool			_colorByAge;
+
+	QColor			_cushionGridColor;
+	QColor			_outlineColor;
+	QColor			_dirFillColor;
+	QColor			_smallItemsColor;
+
+    }; // class KTreemapExporter
+
+
+
+    /**
+     * Batch driver for KTreemapExporter: Reads a directory or a cache file
+     * and exports its treemap as soon as reading is finished, then quits
+     * the application.
+     *
+     * Used for "kdirstat --export-treemap".
+     *
+     * @short Batch treemap export
+     **/
+    class KTreemapExportJob: public KBatchJob
+    {
+    public:
+
+	/**
+	 * Constructor. 'input' is either a directory (path or URL) or a
+	 * KDirStat cache file.
+	 **/
+	KTreemapExportJob( const QString &	input,
+			   const QString &	fileName,
+			   const QSize &	size );
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KTreemapExportJob();
+
+
+    protected:
+
+	/**
+	 * Export the treemap of the tree that was just read.
+	 *
+	 * Reimplemented - inherited from @ref KBatchJob.
+	 **/
+	virtual bool process( KDirTree * tree );
+
+
+	QString		_fileName;
+	QSize		_size;
+
+    }; // class KTreemapExportJob
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KTreemapExport_h
+
+
+// EOF
@@ -0,0 +1,821 @@
+/*
+ *   File name:	ktreemaplayout.cpp
+ *   Summary:	Widget-independent treemap layout and cushion shading
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <math.h>
+#include <algorithm>
+
+#include <kapp.h>
+#include <kconfig.h>
+#include <kdebug.h>
+
+#include "ktreemaplayout.h"
+#include "kdirtree.h"
+
+
+using namespace KDirStat;
+using std::max;
+using std::min;
+
+
+KTreemapLayout::KTreemapLayout()
+    : _squarify( true )
+    , _minTileSize( DefaultMinTileSize )
+    , _heightScaleFactor( DefaultHeightScaleFactor )
+    , _maxTiles( 0 )
+    , _reservedTiles( 0 )
+{
+    // NOP
+}
+
+
+KTreemapLayout::~KTreemapLayout()
+{
+    // NOP
+}
+
+
+void
+KTreemapLayout::readConfig()
+{
+    KConfig * config = kapp->config();
+    config->setGroup( "Treemaps" );
+
+    _squarify		= config->readBoolEntry( "Squarify"		, true	);
+    _minTileSize	= config->readNumEntry ( "MinTileSize"		, DefaultMinTileSize );
+    _heightScaleFactor	= config->readDoubleNumEntry( "HeightScaleFactor" , DefaultHeightScaleFactor );
+}
+
+
+void
+KTreemapLayout::layout( KFileInfo * root, const QRect & rect )
+{
+    clear();
+    _reservedTiles = 0;
+
+    if ( root )
+	addNode( root, -1, rect, KCushionSurface(), KTreemapAuto );
+}
+
+
+int
+KTreemapLayout::addNode( KFileInfo *			orig,
+			 int				parent,
+			 const QRect &			rect,
+			 const KCushionSurface &	cushionSurface,
+			 KOrientation			orientation )
+{
+    KTreemapNode node;
+
+    node.orig		= orig;
+    node.rect		= rect;
+    node.parent		= parent;
+    node.depth		= parent >= 0 ? _nodes[ parent ].depth + 1 : 0;
+
+    _nodes.push_back( node );
+    int index = _cushions.append( cushionSurface );
+
+    createChildren( index, rect, orientation );
+
+    return index;
+}
+
+
+void
+KTreemapLayout::addAggregateNode( int			  parent,
+				  const QRect &		  rect,
+				  const KCushionSurface & cushionSurface,
+				  KFileSize		  aggregateSize )
+{
+    KTreemapNode node;
+
+    node.orig		= _nodes[ parent ].orig;
+    node.rect		= rect;
+    node.parent		= parent;
+    node.depth		= _nodes[ parent ].depth + 1;
+    node.aggregateSize	= aggregateSize;
+    node.isAggregate	= true;
+
+    _nodes.push_back( node );
+    _cushions.append( cushionSurface );
+
+    // No children - that's the whole point of this kind of node.
+}
+
+
+void
+KTreemapLayout::createChildren( int		parent,
+				const QRect &	rect,
+				KOrientation	orientation )
+{
+    KFileInfo * orig = _nodes[ parent ].orig;
+
+    if ( orig->totalSize() == 0 )	// Prevent division by zero
+	return;
+
+    if ( ! orig->isDirInfo() )		// Plain files don't have any children
+	return;
+
+    if ( rect.width()  < _minTileSize ||
+	 rect.height() < _minTileSize   )
+    {
+	// No child could possibly get a tile of the minimum size in here.
+	return;
+    }
+
+    if ( budgetExhausted() )
+	return;
+
+    if ( _squarify )
+	createSquarifiedChildren( parent, rect );
+    else
+	createChildrenSimple( parent, rect, orientation );
+}
+
+
+void
+KTreemapLayout::createChildrenSimple( int		parent,
+				      const QRect &	rect,
+				      KOrientation	orientation )
+{
+
+    KOrientation dir      = orientation;
+    KOrientation childDir = orientation;
+
+    if ( dir == KTreemapAuto )
+	dir = rect.width() > rect.height() ? KTreemapHorizontal : KTreemapVertical;
+
+    if ( orientation == KTreemapHorizontal	)	childDir = KTreemapVertical;
+    if ( orientation == KTreemapVertical	)	childDir = KTreemapHorizontal;
+
+    KFileInfo * orig = _nodes[ parent ].orig;
+
+    int offset	 = 0;
+    int size	 = dir == KTreemapHorizontal ? rect.width() : rect.height();
+    int count 	 = 0;
+    double scale = (double) size / (double) orig->totalSize();
+
+    _cushions.addRidge( parent, childDir, _cushions.height( parent ), rect );
+
+    KFileInfoSortedBySizeIterator it( orig,
+				      (KFileSize) ( _minTileSize / scale ),
+				      KDotEntryAsSubDir );
+
+    while ( *it && ! budgetExhausted() )
+    {
+	int childSize = 0;
+
+	childSize = (int) ( scale * (*it)->totalSize() );
+
+	if ( childSize >= _minTileSize )
+	{
+	    QRect childRect;
+
+	    if ( dir == KTreemapHorizontal )
+		childRect = QRect( rect.x() + offset, rect.y(), childSize, rect.height() );
+	    else
+		childRect = QRect( rect.x(), rect.y() + offset, rect.width(), childSize );
+
+	    double height = _cushions.height( parent );
+	    int child = addNode( *it, parent, childRect, _cushions.surface( parent ), childDir );
+
+	    _cushions.addRidge( child, dir, height * _heightScaleFactor, childRect );
+
+	    offset += childSize;
+	}
+
+	++count;
+	++it;
+    }
+}
+
+
+void
+KTreemapLayout::createSquarifiedChildren( int parent, const QRect & rect )
+{
+    KFileInfo * orig = _nodes[ parent ].orig;
+
+    if ( orig->totalSize() == 0 )
+    {
+	kdError() << k_funcinfo << "Zero totalSize()" << endl;
+	return;
+    }
+
+    double scale	= rect.width() * (double) rect.height() / orig->totalSize();
+
+    // A child will only get a tile of its own if it gets at least
+    // minTileSize pixels in both dimensions. Allowing for the rounding in
+    // layoutRow(), anything below this area can safely be disregarded
+    // right away without ever sorting it.
+
+    KFileSize minSize	= (KFileSize) ( _minTileSize * ( _minTileSize - 0.5 ) / scale );
+
+    KFileInfoSortedBySizeIterator it( orig, minSize, KDotEntryAsSubDir );
+    QRect	childrenRect = rect;
+    KFileSize	smallSize    = 0;
+
+    // Keep one slot of the budget for this directory's "small items" node:
+    // Its subdirectories must not use it up.
+
+    _reservedTiles++;
+
+    while ( *it )
+    {
+	KFileInfoList row;
+	QRect newRect = childrenRect;
+
+	if ( ! budgetExhausted() )
+	{
+	    row = squarify( childrenRect, scale, it );
+	    smallSize += pruneRow( childrenRect, row );
+
+	    if ( budgetAllows( row.count() ) )
+		newRect = layoutRow( parent, childrenRect, scale, row, smallSize );
+	}
+
+	if ( newRect == childrenRect )
+	{
+	    // This row was too thin to be laid out (or there is no budget
+	    // for any more nodes). The remaining children are even smaller,
+	    // so don't bother trying any more: They all go to the "small
+	    // items" node.
+
+	    smallSize += row.sumTotalSizes();
+
+	    while ( *it )
+	    {
+		smallSize += (*it)->totalSize();
+		++it;
+	    }
+	}
+
+	childrenRect = newRect;
+    }
+
+    smallSize += it.prunedSize();
+    _reservedTiles--;
+
+    if ( smallSize > 0 &&
+	 childrenRect.width()  >= _minTileSize &&
+	 childrenRect.height() >= _minTileSize   )
+    {
+	KCushionSurface smallCushionSurface = _cushions.surface( parent );
+	double height = smallCushionSurface.height() * _heightScaleFactor;
+
+	smallCushionSurface.addRidge( KTreemapHorizontal, height, childrenRect );
+	smallCushionSurface.addRidge( KTreemapVertical,   height, childrenRect );
+
+	addAggregateNode( parent, childrenRect, smallCushionSurface, smallSize );
+    }
+}
+
+
+KFileInfoList
+KTreemapLayout::squarify( const QRect & 			rect,
+			  double			scale,
+			  KFileInfoSortedBySizeIterator & it   )
+{
+    // kdDebug() << "squarify() " << rect << endl;
+
+    KFileInfoList row;
+    int length = max( rect.width(), rect.height() );
+
+    if ( length == 0 )	// Sanity check
+    {
+	kdWarning() << k_funcinfo << "Zero length" << endl;
+
+	if ( *it )	// Prevent endless loop in case of error:
+	    ++it;	// Advance iterator.
+
+	return row;
+    }
+
+
+    bool	improvingAspectRatio 	= true;
+    double	lastWorstAspectRatio	= -1.0;
+    double	sum 			= 0;
+
+    // This is a bit ugly, but doing all calculations in the 'size' dimension
+    // is more efficient here since that requires only one scaling before
+    // doing all other calculations in the loop.
+    const double scaledLengthSquare = length * (double) length / scale;
+
+    while ( *it && improvingAspectRatio )
+    {
+	sum += (*it)->totalSize();
+
+	if ( ! row.isEmpty() && sum != 0 && (*it)->totalSize() != 0 )
+	{
+	    double sumSquare        = sum * sum;
+	    double worstAspectRatio = max( scaledLengthSquare * row.first()->totalSize() / sumSquare,
+					   sumSquare / ( scaledLengthSquare * (*it)->totalSize() ) );
+
+	    if ( lastWorstAspectRatio >= 0.0 &&
+		worstAspectRatio > lastWorstAspectRatio )
+	    {
+		improvingAspectRatio = false;
+	    }
+
+	    lastWorstAspectRatio = worstAspectRatio;
+	}
+
+	if ( improvingAspectRatio )
+	{
+	    // kdDebug() << "Adding " << *it << " size " << (*it)->totalSize() << endl;
+	    row.append( *it );
+	    ++it;
+	}
+	else
+	{
+	    // kdDebug() << "Getting worse after adding " << *it << " size " << (*it)->totalSize() << endl;
+	}
+    }
+
+    return row;
+}
+
+
+
+KFileSize
+KTreemapLayout::pruneRow( const QRect & rect, KFileInfoList & row )
+{
+    int	      primary = max( rect.width(), rect.height() );
+    KFileSize sum     = row.sumTotalSizes();
+    KFileSize pruned  = 0;
+
+    // The row is sorted by size, so only the last children can be too
+    // small. Each one taken away leaves more room for the others.
+
+    while ( ! row.isEmpty() && sum > 0 )
+    {
+	KFileSize last = row.getLast()->totalSize();
+
+	if ( (int) ( last / (double) sum * primary + 0.5 ) >= _minTileSize )
+	    break;
+
+	row.removeLast();
+	sum    -= last;
+	pruned += last;
+    }
+
+    return pruned;
+}
+
+
+QRect
+KTreemapLayout::layoutRow( int			parent,
+			   const QRect &	rect,
+			   double		scale,
+			   KFileInfoList & 	row,
+			   KFileSize &		smallSize )
+{
+    if ( row.isEmpty() )
+	return rect;
+
+    // Determine the direction in which to subdivide.
+    // We always use the longer side of the rectangle.
+    KOrientation dir = rect.width() > rect.height() ? KTreemapHorizontal : KTreemapVertical;
+
+    // This row's primary length is the longer one.
+    int primary = max( rect.width(), rect.height() );
+
+    // This row's secondary length is determined by the area (the number of
+    // pixels) to be allocated for all of the row's items.
+    KFileSize sum = row.sumTotalSizes();
+    int secondary = (int) ( sum * scale / primary );
+
+    if ( sum == 0 )	// Prevent division by zero.
+	return rect;
+
+    if ( secondary < _minTileSize )	// We don't want tiles that small.
+	return rect;
+
+
+    // Set up a cushion surface for this layout row:
+    // Add another ridge perpendicular to the row's direction
+    // that optically groups this row's tiles together.
+
+    KCushionSurface rowCushionSurface = _cushions.surface( parent );
+
+    rowCushionSurface.addRidge( dir == KTreemapHorizontal ? KTreemapVertical : KTreemapHorizontal,
+				rowCushionSurface.height() * _heightScaleFactor,
+				rect );
+
+    int offset = 0;
+    int remaining = primary;
+    KFileInfoListIterator it( row );
+
+    // The caller made sure the entire row fits into the budget. Keep it
+    // reserved so the subdirectories of the first tiles don't use up the
+    // slots of the later ones.
+
+    _reservedTiles += row.count();
+
+    while ( *it )
+    {
+	_reservedTiles--;
+
+	int childSize = (int) ( (*it)->totalSize() / (double) sum * primary + 0.5 );
+
+	if ( childSize > remaining )	// Prevent overflow because of accumulated rounding errors
+	    childSize = remaining;
+
+	remaining -= childSize;
+
+	if ( childSize >= _minTileSize )
+	{
+	    QRect childRect;
+
+	    if ( dir == KTreemapHorizontal )
+		childRect = QRect( rect.x() + offset, rect.y(), childSize, secondary );
+	    else
+		childRect = QRect( rect.x(), rect.y() + offset, secondary, childSize );
+
+	    int child = addNode( *it, parent, childRect, rowCushionSurface, KTreemapAuto );
+
+	    _cushions.addRidge( child, dir,
+				rowCushionSurface.height() * _heightScaleFactor,
+				childRect );
+	    offset += childSize;
+	}
+	else
+	{
+	    // Only possible because of rounding errors after pruneRow():
+	    // Don't lose this one altogether.
+
+	    smallSize += (*it)->totalSize();
+	}
+
+	++it;
+    }
+
+
+    // Subtract the layouted area from the rectangle.
+
+    QRect newRect;
+
+    if ( dir == KTreemapHorizontal )
+	newRect = QRect( rect.x(), rect.y() + secondary, rect.width(), rect.height() - secondary );
+    else
+	newRect = QRect( rect.x() + secondary, rect.y(), rect.width() - secondary, rect.height() );
+
+    // kdDebug() << "Left over:" << " " << newRect << endl;
+
+    return newRect;
+}
+
+
+
+
+
+
+KCushionRenderer::KCushionRenderer( int		ambientLight,
+				    double	lightX,
+				    double	lightY,
+				    double	lightZ,
+				    bool	ensureContrast )
+    : _ambientLight( ambientLight )
+    , _lightX( lightX )
+    , _lightY( lightY )
+    , _lightZ( lightZ )
+    , _ensureContrast( ensureContrast )
+{
+    // NOP
+}
+
+
+QRgb
+KCushionRenderer::pixel( const KCushionBuffer &	cushions,
+			 int				index,
+			 const QColor &			color,
+			 int				x,
+			 int				y ) const
+{
+    int maxRed		= max( 0, color.red()   - _ambientLight );
+    int maxGreen	= max( 0, color.green() - _ambientLight );
+    int maxBlue		= max( 0, color.blue()  - _ambientLight );
+
+    double nx   = 2.0 * cushions.xx2( index ) * x + cushions.xx1( index );
+    double ny   = 2.0 * cushions.yy2( index ) * y + cushions.yy1( index );
+    double cosa = ( nx * _lightX + ny * _lightY + _lightZ ) / sqrt( nx*nx + ny*ny + 1.0 );
+
+    int red	= max( 0, (int) ( maxRed   * cosa + 0.5 ) );
+    int green	= max( 0, (int) ( maxGreen * cosa + 0.5 ) );
+    int blue	= max( 0, (int) ( maxBlue  * cosa + 0.5 ) );
+
+    return qRgb( red   + _ambientLight,
+		 green + _ambientLight,
+		 blue  + _ambientLight );
+}
+
+
+void
+KCushionRenderer::render( QImage &			image,
+			  const QPoint &		imageOrigin,
+			  const QRect &			tileRect,
+			  const QRect &			clipRect,
+			  const KCushionBuffer &	cushions,
+			  int				index,
+			  const QColor &		color ) const
+{
+    QRect rect = tileRect & clipRect;
+
+    if ( rect.width() < 1 || rect.height() < 1 )
+	return;
+
+    double 	nx;
+    double 	ny;
+    double 	cosa;
+    int		x, y;
+    int		red, green, blue;
+
+
+    // Cache some values. They are used for each loop iteration, so let's try
+    // to keep multiple indirect references down.
+
+    double	xx2		= cushions.xx2( index );
+    double	xx1		= cushions.xx1( index );
+    double	yy2		= cushions.yy2( index );
+    double	yy1		= cushions.yy1( index );
+
+    int		maxRed		= max( 0, color.red()   - _ambientLight );
+    int		maxGreen	= max( 0, color.green() - _ambientLight );
+    int		maxBlue		= max( 0, color.blue()  - _ambientLight );
+
+    for ( y = rect.top(); y <= rect.bottom(); y++ )
+    {
+	QRgb * line = (QRgb *) image.scanLine( y - imageOrigin.y() );
+	ny = 2.0 * yy2 * y + yy1;
+
+	for ( x = rect.left(); x <= rect.right(); x++ )
+	{
+	    nx = 2.0 * xx2 * x + xx1;
+	    cosa  = ( nx * _lightX + ny * _lightY + _lightZ ) / sqrt( nx*nx + ny*ny + 1.0 );
+
+	    red	  = (int) ( maxRed   * cosa + 0.5 );
+	    green = (int) ( maxGreen * cosa + 0.5 );
+	    blue  = (int) ( maxBlue  * cosa + 0.5 );
+
+	    if ( red   < 0 )	red   = 0;
+	    if ( green < 0 )	green = 0;
+	    if ( blue  < 0 )	blue  = 0;
+
+	    red   += _ambientLight;
+	    green += _ambientLight;
+	    blue  += _ambientLight;
+
+	    line[ x - imageOrigin.x() ] = qRgb( red, green, blue );
+	}
+    }
+
+    if ( _ensureContrast )
+    {
+	bool rightLine;
+	bool bottomLine;
+	QRgb rightColor;
+	QRgb bottomColor;
+
+	checkContrast( tileRect, cushions, index, color,
+		       rightLine, rightColor, bottomLine, bottomColor );
+
+	if ( rightLine && rect.right() == tileRect.right() )
+	{
+	    for ( y = rect.top(); y <= rect.bottom(); y++ )
+		image.setPixel( rect.right() - imageOrigin.x(), y - imageOrigin.y(), rightColor );
+	}
+
+	if ( bottomLine && rect.bottom() == tileRect.bottom() )
+	{
+	    for ( x = rect.left(); x <= rect.right(); x++ )
+		image.setPixel( x - imageOrigin.x(), rect.bottom() - imageOrigin.y(), bottomColor );
+	}
+    }
+}
+
+
+void
+KCushionRenderer::checkContrast( const QRect &			tileRect,
+				 const KCushionBuffer &		cushions,
+				 int				index,
+				 const QColor &			color,
+				 bool &				rightLine,
+				 QRgb &				rightColor,
+				 bool &				bottomLine,
+				 QRgb &				bottomColor ) const
+{
+    int x0	= tileRect.x();
+    int y0	= tileRect.y();
+    int width	= tileRect.width();
+    int height	= tileRect.height();
+
+    rightLine	= false;
+    bottomLine	= false;
+    rightColor	= 0;
+    bottomColor	= 0;
+
+    if ( width > 5 )
+    {
+	// Check contrast along the right boundary:
+	//
+	// Compare samples from the outmost boundary to samples a few pixels to
+	// the inside and count identical pixel values. A number of identical
+	// pixels are tolerated, but not too many.
+
+	int x1 = width - 6;
+	int x2 = width - 1;
+	int interval = max( height / 10, 5 );
+	int sameColorCount = 0;
+
+
+	// Take samples
+
+	for ( int y = interval; y < height; y+= interval )
+	{
+	    if ( pixel( cushions, index, color, x0 + x1, y0 + y ) ==
+		 pixel( cushions, index, color, x0 + x2, y0 + y ) )
+	    {
+		sameColorCount++;
+	    }
+	}
+
+	if ( sameColorCount * 10 > height )
+	{
+	    // Add a line at the right boundary
+
+	    rightLine  = true;
+	    rightColor = contrastingColor( pixel( cushions, index, color, x0 + x2, y0 + height / 2 ) );
+	}
+    }
+
+
+    if ( height > 5 )
+    {
+	// Check contrast along the bottom boundary
+
+	int y1 = height - 6;
+	int y2 = height - 1;
+	int interval = max( width / 10, 5 );
+	int sameColorCount = 0;
+
+	for ( int x = interval; x < width; x += interval )
+	{
+	    if ( pixel( cushions, index, color, x0 + x, y0 + y1 ) ==
+		 pixel( cushions, index, color, x0 + x, y0 + y2 ) )
+	    {
+		sameColorCount++;
+	    }
+	}
+
+	if ( sameColorCount * 10 > height )
+	{
+	    // Add a grey line at the bottom boundary
+
+	    bottomLine  = true;
+	    bottomColor = contrastingColor( pixel( cushions, index, color, x0 + width / 2, y0 + y2 ) );
+	}
+    }
+}
+
+
+QRgb
+KCushionRenderer::contrastingColor( QRgb col )
+{
+    if ( qGray( col ) < 128 )
+	return qRgb( qRed( col ) * 2, qGreen( col ) * 2, qBlue( col ) * 2 );
+    else
+	return qRgb( qRed( col ) / 2, qGreen( col ) / 2, qBlue( col ) / 2 );
+}
+
+
+
+
+
+
+void
+KCushionBuffer::clear()
+{
+    _xx2.clear();
+    _xx1.clear();
+    _yy2.clear();
+    _yy1.clear();
+    _height.clear();
+}
+
+
+int
+KCushionBuffer::append( const KCushionSurface & surface )
+{
+    _xx2.push_back   ( surface.xx2()	);
+    _xx1.push_back   ( surface.xx1()	);
+    _yy2.push_back   ( surface.yy2()	);
+    _yy1.push_back   ( surface.yy1()	);
+    _height.push_back( surface.height() );
+
+    return _xx2.size() - 1;
+}
+
+
+KCushionSurface
+KCushionBuffer::surface( int index ) const
+{
+    return KCushionSurface( _xx2[ index ], _xx1[ index ],
+			    _yy2[ index ], _yy1[ index ],
+			    _height[ index ] );
+}
+
+
+void
+KCushionBuffer::addRidge( int index, KOrientation dim, double height, const QRect & rect )
+{
+    _height[ index ] = height;
+
+    if ( dim == KTreemapHorizontal )
+    {
+	_xx2[ index ] = KCushionSurface::squareRidge( _xx2[ index ], height, rect.left(), rect.right() );
+	_xx1[ index ] = KCushionSurface::linearRidge( _xx1[ index ], height, rect.left(), rect.right() );
+    }
+    else
+    {
+	_yy2[ index ] = KCushionSurface::squareRidge( _yy2[ index ], height, rect.top(), rect.bottom() );
+	_yy1[ index ] = KCushionSurface::linearRidge( _yy1[ index ], height, rect.top(), rect.bottom() );
+    }
+}
+
+
+
+
+
+
+KCushionSurface::KCushionSurface()
+{
+    _xx2 	= 0.0;
+    _xx1 	= 0.0;
+    _yy2 	= 0.0;
+    _yy1 	= 0.0;
+    _height	= CushionHeight;
+}
+
+
+KCushionSurface::KCushionSurface( double xx2, double xx1,
+				  double yy2, double yy1,
+				  double height )
+    : _xx2( xx2 )
+    , _xx1( xx1 )
+    , _yy2( yy2 )
+    , _yy1( yy1 )
+    , _height( height )
+{
+    // NOP
+}
+
+
+void
+KCushionSurface::addRidge( KOrientation dim, double height, const QRect & rect )
+{
+    _height = height;
+
+    if ( dim == KTreemapHorizontal )
+    {
+	_xx2 = squareRidge( _xx2, _height, rect.left(), rect.right() );
+	_xx1 = linearRidge( _xx1, _height, rect.left(), rect.right() );
+    }
+    else
+    {
+	_yy2 = squareRidge( _yy2, _height, rect.top(), rect.bottom() );
+	_yy1 = linearRidge( _yy1, _height, rect.top(), rect.bottom() );
+    }
+}
+
+
+double
+KCushionSurface::squareRidge( double squareCoefficient, double height, int x1, int x2 )
+{
+    if ( x2 != x1 ) // Avoid division by zero
+	squareCoefficient -= 4.0 * height / ( x2 - x1 );
+
+    return squareCoefficient;
+}
+
+
+double
+KCushionSurface::linearRidge( double linearCoefficient, double height, int x1, int x2 )
+{
+    if ( x2 != x1 ) // Avoid division by zero
+	linearCoefficient += 4.0 * height * ( x2 + x1 ) / ( x2 - x1 );
+
+    return linearCoefficient;
+}
+
+
+
+// EOF
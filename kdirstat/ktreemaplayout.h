@@ -0,0 +1,540 @@
+/*
+ *   File name:	ktreemaplayout.h
+ *   Summary:	Widget-independent treemap layout and cushion shading
+ *   License:	LGPL - See file COPYING.LIB for details.
+ *   Author:	Stefan Hundhammer <sh@suse.de>
+ *
+ *   Updated:	2026-10-18
+ */
+
+
+#ifndef KTreemapLayout_h
+#define KTreemapLayout_h
+
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <qcolor.h>
+#include <qimage.h>
+#include <qrect.h>
+#include <qvaluevector.h>
+#include "kdirtreeiterators.h"
+
+
+#define DefaultHeightScalePercent	100
+#define DefaultHeightScaleFactor	( DefaultHeightScalePercent / 100.0 )
+
+#define DefaultMinTileSize		3
+#define CushionHeight			1.0
+
+// Default values for light sources taken from Wiik / Wetering's paper
+// about "cushion treemaps".
+
+#define DefaultLightX			0.09759
+#define DefaultLightY			0.19518
+#define DefaultLightZ			0.9759
+
+
+namespace KDirStat
+{
+    class KFileInfo;
+
+    enum KOrientation
+    {
+	KTreemapHorizontal,
+	KTreemapVertical,
+	KTreemapAuto
+    };
+
+
+    /**
+     * Helper class for cushioned treemaps: This class holds the polynome
+     * parameters for the cushion surface. The height of each point of such a
+     * surface is defined as:
+     *
+     *     z(x, y) = a*x^2 + b*y^2 + c*x + d*y
+     * or
+     *     z(x, y) = xx2*x^2 + yy2*y^2 + xx1*x + yy1*y
+     *
+     * to better keep track of which coefficient belongs where.
+     **/
+    class KCushionSurface
+    {
+    public:
+	/**
+	 * Constructor. All polynome coefficients are set to 0.
+	 **/
+	KCushionSurface();
+
+	/**
+	 * Constructor with all polynome coefficients and the height.
+	 **/
+	KCushionSurface( double xx2, double xx1,
+			 double yy2, double yy1,
+			 double height );
+
+	/**
+	 * Adds a ridge of the specified height in dimension 'dim' within
+	 * rectangle 'rect' to this surface. It's real voodo magic.
+	 *
+	 * Just kidding - read the paper about "cushion treemaps" by Jarke
+	 * J. van Wiik and Huub van de Wetering from the TU Eindhoven, NL for
+	 * more details.
+	 *
+	 * If you don't want to get all that involved: The coefficients are
+	 * changed in some way.
+	 **/
+	void addRidge( KOrientation dim, double height, const QRect & rect );
+
+	/**
+	 * Set the cushion's height.
+	 **/
+	void setHeight( double newHeight ) { _height = newHeight; }
+
+	/**
+	 * Returns the cushion's height.
+	 **/
+	double height() const { return _height; }
+
+	/**
+	 * Returns the polynomal coefficient of the second order for X direction.
+	 **/
+	double xx2() const { return _xx2; }
+
+	/**
+	 * Returns the polynomal coefficient of the first order for X direction.
+	 **/
+	double xx1() const { return _xx1; }
+
+	/**
+	 * Returns the polynomal coefficient of the second order for Y direction.
+	 **/
+	double yy2() const { return _yy2; }
+
+	/**
+	 * Returns the polynomal coefficient of the first order for Y direction.
+	 **/
+	double yy1() const { return _yy1; }
+
+
+	/**
+	 * Calculate a new square polynomal coefficient for adding a ridge of
+	 * specified height between x1 and x2.
+	 **/
+	static double squareRidge( double squareCoefficient, double height, int x1, int x2 );
+
+	/**
+	 * Calculate a new linear polynomal coefficient for adding a ridge of
+	 * specified height between x1 and x2.
+	 **/
+	static double linearRidge( double linearCoefficient, double height, int x1, int x2 );
+
+
+    protected:
+
+	// Data members
+
+	double _xx2, _xx1;
+	double _yy2, _yy1;
+	double _height;
+
+    }; // class KCushionSurface
+
+
+
+    /**
+     * The cushion surfaces of all tiles of a treemap layout, stored as one
+     * array per polynome coefficient ("structure of arrays") rather than as
+     * one @ref KCushionSurface per tile. Entry no. i belongs to layout node
+     * no. i.
+     *
+     * The arrays are implicitly shared, so copying a buffer is cheap.
+     **/
+    class KCushionBuffer
+    {
+    public:
+
+	/**
+	 * Returns the number of cushion surfaces in this buffer.
+	 **/
+	int count() const { return _xx2.size(); }
+
+	/**
+	 * Remove all cushion surfaces.
+	 **/
+	void clear();
+
+	/**
+	 * Append 'surface' and return its index.
+	 **/
+	int append( const KCushionSurface & surface );
+
+	/**
+	 * Returns cushion surface no. 'index' as a separate object.
+	 **/
+	KCushionSurface surface( int index ) const;
+
+	/**
+	 * Add a ridge to cushion surface no. 'index'.
+	 * See @ref KCushionSurface::addRidge() for details.
+	 **/
+	void addRidge( int index, KOrientation dim, double height, const QRect & rect );
+
+	/**
+	 * Accessors for the polynome coefficients of surface no. 'index'.
+	 **/
+	double xx2   ( int index ) const { return _xx2   [ index ]; }
+	double xx1   ( int index ) const { return _xx1   [ index ]; }
+	double yy2   ( int index ) const { return _yy2   [ index ]; }
+	double yy1   ( int index ) const { return _yy1   [ index ]; }
+	double height( int index ) const { return _height[ index ]; }
+
+
+    protected:
+
+	QValueVector<double>	_xx2;
+	QValueVector<double>	_xx1;
+	QValueVector<double>	_yy2;
+	QValueVector<double>	_yy1;
+	QValueVector<double>	_height;
+
+    }; // class KCushionBuffer
+
+
+
+    /**
+     * Renders cushion surfaces into images, using a directed light source
+     * and some ambient light as described in "cushioned treemaps" by Jarke
+     * J. van Wijk and Huub van de Wetering  of the TU Eindhoven, NL.
+     *
+     * This is used both for the treemap tiles on the screen and for treemaps
+     * rendered without any widget, so both look exactly the same.
+     **/
+    class KCushionRenderer
+    {
+    public:
+
+	/**
+	 * Constructor. 'ambientLight' is in the range [0..255], the light
+	 * source coordinates should make up a unit vector.
+	 **/
+	KCushionRenderer( int		ambientLight,
+			  double	lightX,
+			  double	lightY,
+			  double	lightZ,
+			  bool		ensureContrast );
+
+	/**
+	 * Render the part of cushion surface no. 'index' of 'cushions' for
+	 * tile 'tileRect' that is inside 'clipRect' into 'image'. All
+	 * rectangles are in treemap coordinates; 'imageOrigin' is the treemap
+	 * position of the image's top left pixel.
+	 **/
+	void render( QImage &			image,
+		     const QPoint &		imageOrigin,
+		     const QRect &		tileRect,
+		     const QRect &		clipRect,
+		     const KCushionBuffer &	cushions,
+		     int			index,
+		     const QColor &		color ) const;
+
+	/**
+	 * Returns the shaded color of cushion surface no. 'index' of
+	 * 'cushions' in color 'color' at treemap position (x, y).
+	 **/
+	QRgb pixel( const KCushionBuffer &	cushions,
+		    int				index,
+		    const QColor &		color,
+		    int				x,
+		    int				y ) const;
+
+	/**
+	 * Returns a color that gives a reasonable contrast to 'col': Lighter
+	 * if 'col' is dark, darker if 'col' is light.
+	 **/
+	static QRgb contrastingColor( QRgb col );
+
+    protected:
+
+	/**
+	 * Check if the contrast of the cushion within 'tileRect' is
+	 * sufficient to visually distinguish an outline at the right and
+	 * bottom borders. If not, 'rightLine' and/or 'bottomLine' are set to
+	 * 'true' and the respective color to use for that line is returned in
+	 * 'rightColor' / 'bottomColor'.
+	 *
+	 * This only samples a few pixels, so it doesn't need the rendered
+	 * image.
+	 **/
+	void checkContrast( const QRect &		tileRect,
+			    const KCushionBuffer &	cushions,
+			    int				index,
+			    const QColor &		color,
+			    bool &			rightLine,
+			    QRgb &			rightColor,
+			    bool &			bottomLine,
+			    QRgb &			bottomColor ) const;
+
+	// Data members
+
+	int	_ambientLight;
+	double	_lightX;
+	double	_lightY;
+	double	_lightZ;
+	bool	_ensureContrast;
+
+    }; // class KCushionRenderer
+
+
+
+    /**
+     * One tile of a treemap layout as calculated by @ref KTreemapLayout.
+     **/
+    class KTreemapNode
+    {
+    public:
+
+	/**
+	 * Default constructor as required by QValueVector.
+	 **/
+	KTreemapNode()
+	    : orig( 0 ), parent( -1 ), depth( 0 ), aggregateSize( 0 ), isAggregate( false )
+	    {}
+
+	KFileInfo *	orig;		// The same as the parent's for "small items" nodes
+	QRect		rect;
+	int		parent;		// Index of the parent node or -1 for the root
+	int		depth;
+	KFileSize	aggregateSize;
+	bool		isAggregate;
+
+    }; // class KTreemapNode
+
+
+
+    /**
+     * Treemap layout: Calculate the rectangles (and cushion surfaces) of all
+     * treemap tiles for a subtree without needing any widget or canvas.
+     *
+     * The result is a flat list of @ref KTreemapNode objects in depth-first
+     * order: Each node comes after its parent, so painting them in that
+     * order gives the correct overlapping.
+     **/
+    class KTreemapLayout
+    {
+    public:
+
+	/**
+	 * Constructor.
+	 **/
+	KTreemapLayout();
+
+	/**
+	 * Destructor.
+	 **/
+	virtual ~KTreemapLayout();
+
+	/**
+	 * Read the layout parameters from the "Treemaps" group of the global
+	 * @ref KConfig object.
+	 **/
+	void readConfig();
+
+	/**
+	 * Calculate the layout for 'root' within 'rect'. Any previous layout
+	 * is discarded.
+	 **/
+	void layout( KFileInfo * root, const QRect & rect );
+
+	/**
+	 * Discard the current layout.
+	 **/
+	void clear() { _nodes.clear(); _cushions.clear(); }
+
+	/**
+	 * Returns the number of nodes in the current layout.
+	 **/
+	int count() const { return _nodes.size(); }
+
+	/**
+	 * Returns node no. 'index' of the current layout.
+	 **/
+	const KTreemapNode & node( int index ) const { return _nodes[ index ]; }
+
+	/**
+	 * Returns the cushion surfaces of the current layout. Surface no. i
+	 * belongs to node no. i.
+	 **/
+	const KCushionBuffer & cushions() const { return _cushions; }
+
+	/**
+	 * Returns 'true' if tiles are to be squarified, 'false' if the simple
+	 * algorithm is used.
+	 **/
+	bool squarify() const { return _squarify; }
+	void setSquarify( bool squarify ) { _squarify = squarify; }
+
+	/**
+	 * Returns the minimum tile size in pixels. No treemap tiles less than
+	 * this in width or height are created.
+	 **/
+	int minTileSize() const { return _minTileSize; }
+	void setMinTileSize( int size ) { _minTileSize = size; }
+
+	/**
+	 * Returns cushion ridge height degradation factor (0 .. 1.0) for each
+	 * level of subdivision.
+	 **/
+	double heightScaleFactor() const { return _heightScaleFactor; }
+	void setHeightScaleFactor( double factor ) { _heightScaleFactor = factor; }
+
+	/**
+	 * Returns the maximum number of nodes to create or 0 if there is no
+	 * limit. Children that don't fit into that budget any more are
+	 * summarized in "small items" nodes.
+	 **/
+	int maxTiles() const { return _maxTiles; }
+	void setMaxTiles( int maxTiles ) { _maxTiles = maxTiles; }
+
+	/**
+	 * Returns 'true' if no more nodes should be created, 'false' if there
+	 * is no limit or it is not reached yet.
+	 **/
+	bool budgetExhausted() const { return ! budgetAllows( 1 ); }
+
+	/**
+	 * Returns 'true' if there is room for 'nodes' more nodes in the budget.
+	 * Slots reserved for the "small items" nodes of the directories that
+	 * are still being laid out don't count as room.
+	 **/
+	bool budgetAllows( int nodes ) const
+	    { return _maxTiles <= 0 || count() + _reservedTiles + nodes <= _maxTiles; }
+
+
+    protected:
+
+	/**
+	 * Add a node for 'orig' as a child of node no. 'parent' and create
+	 * its children. Returns the index of the new node.
+	 **/
+	int addNode( KFileInfo *		orig,
+		     int			parent,
+		     const QRect &		rect,
+		     const KCushionSurface &	cushionSurface,
+		     KOrientation		orientation );
+
+	/**
+	 * Add a "small items" node that summarizes all children of node no.
+	 * 'parent' that were too small to get a node of their own.
+	 **/
+	void addAggregateNode( int			parent,
+			       const QRect &		rect,
+			       const KCushionSurface &	cushionSurface,
+			       KFileSize		aggregateSize );
+
+	/**
+	 * Create the children of node no. 'parent'.
+	 **/
+	void createChildren( int		parent,
+			     const QRect &	rect,
+			     KOrientation	orientation );
+
+	/**
+	 * Create children using the simple treemap algorithm:
+	 * Alternate between horizontal and vertical subdivision in each
+	 * level. Each child will get the entire height or width, respectively,
+	 * of the specified rectangle. This algorithm is very fast, but often
+	 * results in very thin, elongated tiles.
+	 **/
+	void createChildrenSimple( int			parent,
+				   const QRect &	rect,
+				   KOrientation		orientation );
+
+	/**
+	 * Create children using the "squarified treemaps" algorithm as
+	 * described by Mark Bruls, Kees Huizing, and Jarke J. van Wijk of the
+	 * TU Eindhoven, NL.
+	 *
+	 * This algorithm is not quite so simple and involves more expensive
+	 * operations, e.g., sorting the children of each node by size first,
+	 * try some variations of the layout and maybe backtrack to the
+	 * previous attempt. But it results in tiles that are much more
+	 * square-like, i.e. have more reasonable width-to-height ratios. It is
+	 * very much less likely to get thin, elongated tiles that are hard to
+	 * point at and even harder to compare visually against each other.
+	 *
+	 * This implementation includes some improvements to that basic
+	 * algorithm. For example, children below a certain size are
+	 * disregarded completely since they will not get an adequate visual
+	 * representation anyway (it would be way too small). They are
+	 * summarized in a "small items" node in the parent's area.
+	 *
+	 * In short, a lot of small children that don't have any useful effect
+	 * for the user in finding wasted disk space are omitted from handling
+	 * and, most important, don't need to be sorted by size (which has a
+	 * cost of O(n*ln(n)) in the best case, so reducing n helps a lot).
+	 *
+	 * Layout stops as soon as a row would become thinner than the minimum
+	 * tile size; all children not laid out so far (including those
+	 * omitted right away) are summarized in one "small items" node. This
+	 * keeps the layout cost proportional to the number of visible tiles
+	 * rather than to the number of files.
+	 **/
+	void createSquarifiedChildren( int parent, const QRect & rect );
+
+	/**
+	 * Squarify as many children as possible: Try to squeeze members
+	 * referred to by 'it' into 'rect' until the aspect ratio doesn't get
+	 * better any more. Returns a list of children that should be laid out
+	 * in 'rect'. Moves 'it' until there is no more improvement or 'it'
+	 * runs out of items.
+	 *
+	 * 'scale' is the scaling factor between file sizes and pixels.
+	 **/
+	KFileInfoList squarify( const QRect & 			rect,
+				double				scale,
+				KFileInfoSortedBySizeIterator & it   );
+
+	/**
+	 * Remove the children from the end of 'row' that would not get a
+	 * tile of at least the minimum size if laid out within 'rect'.
+	 * Returns the sum of their total sizes.
+	 **/
+	KFileSize pruneRow( const QRect & rect, KFileInfoList & row );
+
+	/**
+	 * Lay out all members of 'row' within 'rect' along its longer side
+	 * as children of node no. 'parent'. The caller has to make sure the
+	 * entire row fits into the budget. The total sizes of any children
+	 * that don't get a tile after all are added to 'smallSize'.
+	 * Returns the new rectangle with the layouted area subtracted.
+	 **/
+	QRect layoutRow( int			parent,
+			 const QRect &		rect,
+			 double			scale,
+			 KFileInfoList & 	row,
+			 KFileSize &		smallSize );
+
+
+	// Data members
+
+	QValueVector<KTreemapNode>	_nodes;
+	KCushionBuffer			_cushions;
+
+	bool		_squarify;
+	int		_minTileSize;
+	double		_heightScaleFactor;
+	int		_maxTiles;
+	int		_reservedTiles;
+
+    }; // class KTreemapLayout
+
+}	// namespace KDirStat
+
+
+#endif // ifndef KTreemapLayout_h
+
+
+// EOF
@@ -18,7 +18,7 @@
 
 #include <qcanvas.h>
 #include <qrect.h>
-#include "kdirtreeiterators.h"
+#include "ktreemaplayout.h"
 
 
 namespace KDirStat
@@ -26,101 +26,6 @@ namespace KDirStat
     class KFileInfo;
     class KTreemapView;
 
-    enum KOrientation
-    {
-	KTreemapHorizontal,
-	KTreemapVertical,
-	KTreemapAuto
-    };
-
-
-    /**
-     * Helper class for cushioned treemaps: This class holds the polynome
-     * parameters for the cushion surface. The height of each point of such a
-     * surface is defined as:
-     *
-     *     z(x, y) = a*x^2 + b*y^2 + c*x + d*y
-     * or
-     *     z(x, y) = xx2*x^2 + yy2*y^2 + xx1*x + yy1*y
-     *
-     * to better keep track of which coefficient belongs where.
-     **/
-    class KCushionSurface
-    {
-    public:
-	/**
-	 * Constructor. All polynome coefficients are set to 0.
-	 **/
-	KCushionSurface();
-
-	/**
-	 * Adds a ridge of the specified height in dimension 'dim' within
-	 * rectangle 'rect' to this surface. It's real voodo magic.
-	 *
-	 * Just kidding - read the paper about "cushion treemaps" by Jarke
-	 * J. van Wiik and Huub van de Wetering from the TU Eindhoven, NL for
-	 * more details.
-	 *
-	 * If you don't want to get all that involved: The coefficients are
-	 * changed in some way.
-	 **/
-	void addRidge( KOrientation dim, double height, const QRect & rect );
-
-	/**
-	 * Set the cushion's height.
-	 **/
-	void setHeight( double newHeight ) { _height = newHeight; }
-
-	/**
-	 * Returns the cushion's height.
-	 **/
-	double height() const { return _height; }
-
-	/**
-	 * Returns the polynomal coefficient of the second order for X direction.
-	 **/
-	double xx2() const { return _xx2; }
-
-	/**
-	 * Returns the polynomal coefficient of the first order for X direction.
-	 **/
-	double xx1() const { return _xx1; }
-
-	/**
-	 * Returns the polynomal coefficient of the second order for Y direction.
-	 **/
-	double yy2() const { return _yy2; }
-
-	/**
-	 * Returns the polynomal coefficient of the first order for Y direction.
-	 **/
-	double yy1() const { return _yy1; }
-
-
-    protected:
-
-	/**
-	 * Calculate a new square polynomal coefficient for adding a ridge of
-	 * specified height between x1 and x2.
-	 **/
-	double squareRidge( double squareCoefficient, double height, int x1, int x2 );
-
-	/**
-	 * Calculate a new linear polynomal coefficient for adding a ridge of
-	 * specified height between x1 and x2.
-	 **/
-	double linearRidge( double linearCoefficient, double height, int x1, int x2 );
-
-
-	// Data members
-
-	double _xx2, _xx1;
-	double _yy2, _yy1;
-	double _height;
-
-    }; // class KCushionSurface
-
-
 
     /**
      * This is the basic building block of a treemap view: One single tile of a
@@ -135,32 +40,18 @@ namespace KDirStat
     public:
 
 	/**
-	 * Constructor: Create a treemap tile from 'fileinfo' that fits into a
-	 * rectangle 'rect' inside 'parent'.
+	 * Constructor: Create a treemap tile from a node of a treemap layout.
+	 * The tile's children (if any) are created separately, from their own
+	 * layout nodes.
 	 *
-	 * 'orientation' is the direction for further subdivision. 'Auto'
-	 * selects the wider direction inside 'rect'.
-	 **/
-	KTreemapTile( KTreemapView *		parentView,
-		      KTreemapTile *		parentTile,
-		      KFileInfo *		orig,
-		      const QRect &		rect,
-		      KOrientation		orientation = KTreemapAuto );
-
-    protected:
-
-	/**
-	 * Alternate constructor: Like the above, but explicitly specify a
-	 * cushion surface rather than using the parent's.
+	 * 'cushionIndex' is the index of this tile's cushion surface in the
+	 * parent view's cushion buffer.
 	 **/
 	KTreemapTile( KTreemapView *		parentView,
 		      KTreemapTile *		parentTile,
-		      KFileInfo *		orig,
-		      const QRect &		rect,
-		      const KCushionSurface &	cushionSurface,
-		      KOrientation		orientation = KTreemapAuto );
+		      const KTreemapNode &	node,
+		      int			cushionIndex );
 
-    public:
 	/**
 	 * Destructor.
 	 **/
@@ -184,77 +75,26 @@ namespace KDirStat
 	KTreemapTile * parentTile() const { return _parentTile; }
 
 	/**
-	 * Returns this tile's cushion surface parameters.
-	 **/
-	KCushionSurface & cushionSurface() { return _cushionSurface; }
-
-
-    protected:
-
-	/**
-	 * Create children (sub-tiles) of this tile.
+	 * Returns the index of this tile's cushion surface in the parent
+	 * view's cushion buffer.
 	 **/
-	void createChildren	( const QRect &	rect,
-				  KOrientation	orientation );
+	int cushionIndex() const { return _cushionIndex; }
 
 	/**
-	 * Create children (sub-tiles) using the simple treemap algorithm:
-	 * Alternate between horizontal and vertical subdivision in each
-	 * level. Each child will get the entire height or width, respectively,
-	 * of the specified rectangle. This algorithm is very fast, but often
-	 * results in very thin, elongated tiles.
+	 * Returns 'true' if this is a "small items" tile that summarizes all
+	 * children of the parent tile that were too small to be displayed
+	 * individually, 'false' otherwise.
 	 **/
-	void createChildrenSimple( const QRect &	rect,
-				   KOrientation		orientation );
+	bool isAggregate() const { return _isAggregate; }
 
 	/**
-	 * Create children using the "squarified treemaps" algorithm as
-	 * described by Mark Bruls, Kees Huizing, and Jarke J. van Wijk of the
-	 * TU Eindhoven, NL.
-	 *
-	 * This algorithm is not quite so simple and involves more expensive
-	 * operations, e.g., sorting the children of each node by size first,
-	 * try some variations of the layout and maybe backtrack to the
-	 * previous attempt. But it results in tiles that are much more
-	 * square-like, i.e. have more reasonable width-to-height ratios. It is
-	 * very much less likely to get thin, elongated tiles that are hard to
-	 * point at and even harder to compare visually against each other.
-	 *
-	 * This implementation includes some improvements to that basic
-	 * algorithm. For example, children below a certain size are
-	 * disregarded completely since they will not get an adequate visual
-	 * representation anyway (it would be way too small). They are
-	 * summarized in some kind of 'misc stuff' area in the parent treemap
-	 * tile - in fact, part of the parent directory's tile can be "seen
-	 * through".
-	 *
-	 * In short, a lot of small children that don't have any useful effect
-	 * for the user in finding wasted disk space are omitted from handling
-	 * and, most important, don't need to be sorted by size (which has a
-	 * cost of O(n*ln(n)) in the best case, so reducing n helps a lot).
+	 * Returns the sum of the sizes of the children summarized in this tile
+	 * if this is an aggregate tile or 0 otherwise.
 	 **/
-	void createSquarifiedChildren( const QRect & rect );
+	KFileSize aggregateSize() const { return _aggregateSize; }
 
-	/**
-	 * Squarify as many children as possible: Try to squeeze members
-	 * referred to by 'it' into 'rect' until the aspect ratio doesn't get
-	 * better any more. Returns a list of children that should be laid out
-	 * in 'rect'. Moves 'it' until there is no more improvement or 'it'
-	 * runs out of items.
-	 *
-	 * 'scale' is the scaling factor between file sizes and pixels.
-	 **/
-	KFileInfoList squarify( const QRect & 			rect,
-				double				scale,
-				KFileInfoSortedBySizeIterator & it   );
 
-	/**
-	 * Lay out all members of 'row' within 'rect' along its longer side.
-	 * Returns the new rectangle with the layouted area subtracted.
-	 **/
-	QRect layoutRow( const QRect &		rect,
-			 double			scale,
-			 KFileInfoList & 	row );
+    protected:
 
 	/**
 	 * Draw the tile.
@@ -270,26 +110,13 @@ namespace KDirStat
 	QPixmap renderCushion();
 
 	/**
-	 * Check if the contrast of the specified image is sufficient to
-	 * visually distinguish an outline at the right and bottom borders
-	 * and add a grey line there, if necessary.
-	 **/
-	void ensureContrast( QImage & image );
-
-	/**
-	 * Returns a color that gives a reasonable contrast to 'col': Lighter
-	 * if 'col' is dark, darker if 'col' is light.
-	 **/
-	QRgb contrastingColor( QRgb col );
-
-    private:
-
-	/**
-	 * Initialization common to all constructors.
+	 * Returns the color to use for this tile: The view's tile color for
+	 * 'orig' or the color for "small items" tiles.
+	 *
+	 * The color is looked up only once and then cached.
 	 **/
-	void init();
+	QColor color();
 
-	
     protected:
 
 	// Data members
@@ -297,8 +124,11 @@ namespace KDirStat
 	KTreemapView *	_parentView;
 	KTreemapTile *	_parentTile;
 	KFileInfo *	_orig;
-	KCushionSurface	_cushionSurface;
+	int		_cushionIndex;
 	QPixmap		_cushion;
+	bool		_isAggregate;
+	KFileSize	_aggregateSize;
+	QColor		_color;
 
     }; // class KTreemapTile
 
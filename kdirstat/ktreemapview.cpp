@@ -12,8 +12,9 @@
 #   include <config.h>
 #endif
 
+#include <qdatetime.h>
 #include <qevent.h>
-#include <qregexp.h>
+#include <qmemarray.h>
 
 #include <kapp.h>
 #include <kconfig.h>
@@ -23,20 +24,13 @@
 #include "kdirtree.h"
 #include "ktreemapview.h"
 #include "ktreemaptile.h"
+#include "ktreemapcolors.h"
 
 
 using namespace KDirStat;
 
 #define UpdateMinSize	20
 
-#define TileColorImage      QColor( 0x00, 0xb3, 0x8a )
-#define TileColorExecutable QColor( 0xbd, 0x50, 0xa7 )
-#define TileColorAudio      QColor( 0xf1, 0xda, 0x00 )
-#define TileColorBackup     QColor( 0xd7, 0x1e, 0x00 )
-#define TileColorArchive    QColor( 0x55, 0xbb, 0x4d )
-#define TileColorDocument   QColor( 0x00, 0x7e, 0xc6 )
-#define TileColorVideo      QColor( 0xc0, 0xe3, 0x0e )
-#define TileColorObject     QColor( 0xf9, 0x8d, 0x00 )
 
 KTreemapView::KTreemapView( KDirTree * tree, QWidget * parent, const QSize & initialSize )
     : QCanvasView( parent )
@@ -44,17 +38,23 @@ KTreemapView::KTreemapView( KDirTree * tree, QWidget * parent, const QSize & ini
     , _rootTile( 0 )
     , _selectedTile( 0 )
     , _selectionRect( 0 )
+    , _progressive( false )
+    , _progressiveLastSize( -1 )
+    , _progressiveLastItems( -1 )
 {
     // kdDebug() << k_funcinfo << endl;
 
     readConfig();
 
-    // Default values for light sources taken from Wiik / Wetering's paper
-    // about "cushion treemaps".
+    connect( &_progressiveTimer, SIGNAL( timeout() ),
+	     this,		 SLOT  ( progressiveUpdate() ) );
 
-    _lightX		= 0.09759;
-    _lightY		= 0.19518;
-    _lightZ		= 0.9759;
+    if ( tree && tree->isBusy() )
+	startProgressive();
+
+    _lightX		= DefaultLightX;
+    _lightY		= DefaultLightY;
+    _lightZ		= DefaultLightZ;
 
     if ( _autoResize )
     {
@@ -83,11 +83,32 @@ KTreemapView::KTreemapView( KDirTree * tree, QWidget * parent, const QSize & ini
     connect( tree,	SIGNAL( selectionChanged( KFileInfo * ) ),
 	     this,	SLOT  ( selectTile	( KFileInfo * ) ) );
 
+    connect( tree,	SIGNAL( selectedItemsChanged() ),
+	     this,	SLOT  ( markSelectedItems()    ) );
+
     connect( tree,	SIGNAL( deletingChild	( KFileInfo * )	),
 	     this,	SLOT  ( deleteNotify	( KFileInfo * ) ) );
 
     connect( tree,	SIGNAL( childDeleted()	 ),
 	     this,	SLOT  ( rebuildTreemap() ) );
+
+    connect( tree,	SIGNAL( recalcFinished() ),
+	     this,	SLOT  ( rebuildTreemap() ) );
+
+    // The tiles cache their colors, so they have to be created again when
+    // the file filter changes.
+
+    connect( tree,	SIGNAL( filterFinished() ),
+	     this,	SLOT  ( rebuildTreemap() ) );
+
+    connect( tree,	SIGNAL( finalizeLocal	   ( KDirInfo * ) ),
+	     this,	SLOT  ( finalizeLocalNotify( KDirInfo * ) ) );
+
+    connect( tree,	SIGNAL( finished()	 ),
+	     this,	SLOT  ( stopProgressive() ) );
+
+    connect( tree,	SIGNAL( aborted()	 ),
+	     this,	SLOT  ( stopProgressive() ) );
 }
 
 
@@ -104,7 +125,10 @@ KTreemapView::clear()
 
     _selectedTile	= 0;
     _selectionRect	= 0;
+    _markRects.clear();		// Deleted along with all other canvas items
     _rootTile		= 0;
+    _dotEntryTiles.clear();
+    _cushions.clear();
 }
 
 
@@ -136,12 +160,20 @@ KTreemapView::readConfig()
     _ensureContrast	= config->readBoolEntry( "EnsureContrast"	, true	);
     _forceCushionGrid	= config->readBoolEntry( "ForceCushionGrid"	, false	);
     _minTileSize	= config->readNumEntry ( "MinTileSize"		, DefaultMinTileSize );
+    _colorByAge		= config->readBoolEntry( "ColorByAge"		, false	);
+
+    _progressiveEnabled	 = config->readBoolEntry( "ProgressiveTreemap"	 , true );
+    _progressiveInterval = config->readNumEntry ( "ProgressiveInterval" , DefaultProgressiveInterval );
+    _progressiveMaxTiles = config->readNumEntry ( "ProgressiveMaxTiles" , DefaultProgressiveMaxTiles );
 
     _highlightColor	= readColorEntry( config, "HighlightColor"	, red			     );
     _cushionGridColor	= readColorEntry( config, "CushionGridColor"	, QColor( 0x80, 0x80, 0x80 ) );
     _outlineColor	= readColorEntry( config, "OutlineColor"	, black			     );
     _fileFillColor	= readColorEntry( config, "FileFillColor"	, QColor( 0xde, 0x8d, 0x53 ) );
     _dirFillColor	= readColorEntry( config, "DirFillColor"	, QColor( 0x10, 0x7d, 0xb4 ) );
+    _smallItemsColor	= readColorEntry( config, "SmallItemsColor"	, QColor( 0xa0, 0xa0, 0xa0 ) );
+
+    KTreemapColors::treemapColors()->readConfig();
 
     if ( _autoResize )
     {
@@ -194,7 +226,25 @@ KTreemapView::contentsMousePressEvent( QMouseEvent * event )
     switch ( event->button() )
     {
 	case LeftButton:
-	    selectTile( tile );
+
+	    if ( event->state() & ControlButton )
+	    {
+		toggleSelected( tile );
+	    }
+	    else
+	    {
+		selectTile( tile );
+
+		if ( _selectedTile && _tree->selectedItems().count() > 1 )
+		{
+		    // Select this one only
+
+		    QPtrList<KFileInfo> items;
+		    items.append( _selectedTile->orig() );
+		    _tree->setSelectedItems( items );
+		}
+	    }
+
 	    emit userActivity( 1 );
 	    break;
 
@@ -388,6 +438,16 @@ KTreemapView::canSelectParent() const
 void
 KTreemapView::rebuildTreemap()
 {
+    if ( _tree->isRecalcPending() )
+    {
+	// The tree's summaries are outdated, and the tree will send a
+	// recalcFinished() signal as soon as they are up to date again. Don't
+	// bother building a treemap from stale sizes until then; keep any
+	// saved root URL for that rebuild.
+
+	return;
+    }
+
     KFileInfo * root = 0;
 
     if ( ! _savedRootUrl.isEmpty() )
@@ -442,18 +502,26 @@ KTreemapView::rebuildTreemap( KFileInfo *	newRoot,
 
 	if ( newRoot )
 	{
-	    _rootTile = new KTreemapTile( this,		// parentView
-					  0,		// parentTile
-					  newRoot,	// orig
-					  QRect( QPoint( 0, 0), newSize ),
-					  KTreemapAuto );
-	}
+	    _layout.setSquarify( _squarify );
+	    _layout.setMinTileSize( _minTileSize );
+	    _layout.setHeightScaleFactor( _heightScaleFactor );
+
+	    // While the tree is still being read, limit the number of tiles
+	    // so each intermediate treemap stays cheap.
 
+	    _layout.setMaxTiles( isProgressive() ? _progressiveMaxTiles : 0 );
+	    _layout.layout( newRoot, QRect( QPoint( 0, 0 ), newSize ) );
+
+	    createTiles();
+	    _layout.clear();
+	}
 
 	// Synchronize selection with the tree
 
 	if ( _tree->selection() )
-	    selectTile( _tree->selection() );
+	    selectTile( findTile( _tree->selection() ) );
+
+	markSelectedItems();
     }
     else
     {
@@ -464,6 +532,41 @@ KTreemapView::rebuildTreemap( KFileInfo *	newRoot,
 }
 
 
+void
+KTreemapView::createTiles()
+{
+    // The layout nodes are in depth-first order, so each node's parent tile
+    // already exists when the node's tile is created.
+
+    QMemArray<KTreemapTile *> tiles( _layout.count() );
+
+    for ( int i=0; i < _layout.count(); i++ )
+    {
+	const KTreemapNode & node = _layout.node( i );
+	KTreemapTile * parentTile = node.parent >= 0 ? tiles[ node.parent ] : 0;
+
+	KTreemapTile * tile = new KTreemapTile( this, parentTile, node, i );
+	CHECK_PTR( tile );
+	tiles[ i ] = tile;
+
+	if ( isProgressive() && node.orig->isDotEntry() )
+	{
+	    // Dot entries may be deleted when their parent directory is
+	    // finalized during reading. Remember which tiles refer to one.
+
+	    _dotEntryTiles.insert( node.orig, tile );
+	}
+    }
+
+    _rootTile = tiles.isEmpty() ? 0 : tiles[ 0 ];
+
+    // Keep the cushion surfaces for rendering the tiles later - this is
+    // cheap since the buffer's arrays are implicitly shared.
+
+    _cushions = _layout.cushions();
+}
+
+
 void
 KTreemapView::deleteNotify( KFileInfo * )
 {
@@ -502,6 +605,115 @@ KTreemapView::deleteNotify( KFileInfo * )
 }
 
 
+void
+KTreemapView::startProgressive()
+{
+    if ( ! _progressiveEnabled )
+	return;
+
+    // Not the timer's isActive(): A single shot timer is no longer active
+    // by the time its timeout() slot runs, i.e. while a progressive
+    // treemap is being built.
+
+    _progressive		= true;
+    _progressiveLastSize	= -1;
+    _progressiveLastItems	= -1;
+    _progressiveTimer.start( _progressiveInterval, true );	// single shot
+}
+
+
+void
+KTreemapView::stopProgressive()
+{
+    _progressive = false;
+    _progressiveTimer.stop();
+}
+
+
+void
+KTreemapView::progressiveUpdate()
+{
+    if ( ! _tree->isBusy() )
+    {
+	stopProgressive();
+	return;
+    }
+
+    if ( _tree->isRecalcPending() )
+    {
+	// Just like rebuildTreemap(): Don't lay out (and sort children by)
+	// stale totals. Try again with the next frame.
+
+	_progressiveTimer.start( _progressiveInterval, true );	// single shot
+	return;
+    }
+
+    KFileInfo * root = 0;
+    int elapsed = 0;
+
+    if ( _rootTile )
+	root = _rootTile->orig();
+    else if ( ! _savedRootUrl.isEmpty() )
+	root = _tree->locate( _savedRootUrl, true );	// node, findDotEntries
+
+    if ( ! root )
+	root = _tree->root();
+
+    if ( root &&
+	 ( root->totalSize()  != _progressiveLastSize ||
+	   root->totalItems() != _progressiveLastItems  ) )
+    {
+	_progressiveLastSize	= root->totalSize();
+	_progressiveLastItems	= root->totalItems();
+
+	QTime stopWatch;
+	stopWatch.start();
+
+	rebuildTreemap( root );
+	_savedRootUrl = "";
+
+	elapsed = stopWatch.elapsed();
+	// kdDebug() << "Progressive treemap rebuilt in " << elapsed << " millisec" << endl;
+    }
+
+    // Spend no more than 5% of the time on intermediate treemaps so the
+    // scanner is not slowed down.
+
+    _progressiveTimer.start( QMAX( _progressiveInterval, 20 * elapsed ), true );
+}
+
+
+void
+KTreemapView::finalizeLocalNotify( KDirInfo * dir )
+{
+    if ( ! dir || ! dir->dotEntry() || _dotEntryTiles.isEmpty() )
+	return;
+
+    if ( _dotEntryTiles.find( dir->dotEntry() ) )
+    {
+	// The dot entry might be deleted in a moment. Don't keep any tile
+	// that refers to it; the next progressive update rebuilds the
+	// treemap anyway.
+
+	if ( _rootTile && _rootTile->orig() != _tree->root() )
+	{
+	    // Keep the current zoom for the next update.
+
+	    KFileInfo * root = _rootTile->orig();
+
+	    if ( root == dir->dotEntry() )
+		root = dir;
+
+	    _savedRootUrl = root->debugUrl();
+	}
+
+	clear();
+	_progressiveLastSize = -1;
+	emit treemapChanged();
+    }
+}
+
+
 void
 KTreemapView::resizeEvent( QResizeEvent * event )
 {
@@ -540,6 +752,12 @@ KTreemapView::selectTile( KTreemapTile * tile )
 {
     // kdDebug() << k_funcinfo << endl;
 
+    // A "small items" tile stands for its parent directory's small children
+    // collectively - select the directory instead.
+
+    if ( tile && tile->isAggregate() )
+	tile = tile->parentTile();
+
     KTreemapTile * oldSelection = _selectedTile;
     _selectedTile = tile;
 
@@ -568,6 +786,74 @@ void
 KTreemapView::selectTile( KFileInfo * node )
 {
     selectTile( findTile( node ) );
+    markSelectedItems();	// The selected tile is not marked
+}
+
+
+void
+KTreemapView::toggleSelected( KTreemapTile * tile )
+{
+    if ( tile && tile->isAggregate() )
+	tile = tile->parentTile();
+
+    if ( ! tile )
+	return;
+
+    if ( ! _selectedTile )
+    {
+	// Nothing selected yet: Just select this one.
+
+	selectTile( tile );
+	return;
+    }
+
+    QPtrList<KFileInfo> items = _tree->selectedItems();
+
+    if ( ! items.removeRef( tile->orig() ) )
+	items.append( tile->orig() );
+
+    _tree->setSelectedItems( items );
+}
+
+
+void
+KTreemapView::markSelectedItems()
+{
+    while ( ! _markRects.isEmpty() )
+	delete _markRects.take( 0 );
+
+    if ( ! canvas() )
+	return;
+
+    const QPtrList<KFileInfo> & selectedItems = _tree->selectedItems();
+
+    if ( selectedItems.count() > 1 )
+    {
+	// Look up all of them in one pass over the tiles.
+
+	QPtrDict<KFileInfo> marked( 2 * selectedItems.count() + 1 );
+	QPtrListIterator<KFileInfo> it( selectedItems );
+
+	for ( ; *it; ++it )
+	    marked.insert( *it, *it );
+
+	QCanvasItemList itemList = canvas()->allItems();
+
+	for ( QCanvasItemList::Iterator item = itemList.begin(); item != itemList.end(); ++item )
+	{
+	    KTreemapTile * tile = dynamic_cast<KTreemapTile *> (*item);
+
+	    if ( tile && tile != _selectedTile && ! tile->isAggregate() && marked.find( tile->orig() ) )
+	    {
+		KTreemapSelectionRect * rect = new KTreemapSelectionRect( canvas(), _highlightColor, 1 );
+		CHECK_PTR( rect );
+		rect->highlight( tile );
+		_markRects.append( rect );
+	    }
+	}
+    }
+
+    canvas()->update();
 }
 
 
@@ -585,7 +871,7 @@ KTreemapView::findTile( KFileInfo * node )
     {
 	KTreemapTile * tile = dynamic_cast<KTreemapTile *> (*it);
 
-	if ( tile && tile->orig() == node )
+	if ( tile && tile->orig() == node && ! tile->isAggregate() )
 	    return tile;
 
 	++it;
@@ -615,110 +901,24 @@ KTreemapView::visibleSize()
 
 
 QColor
-KTreemapView::tileColor( KFileInfo * file )
+KTreemapView::tileColor( KFileInfo * file ) const
 {
-    if ( file )
-    {
-	if ( file->isFile() )
-	{
-	    // Find the filename extension: Everything after the first '.'
-	    QString ext = file->name().section( '.', 1 );
+    return KTreemapColors::treemapColors()->tileColor( file, _colorByAge );
+}
 
-	    while ( ! ext.isEmpty() )
-	    {
-		QString lowerExt = ext.lower();
-
-		// Try case sensitive comparisions first
-
-		if ( ext == "~"		)	return TileColorBackup;
-		if ( ext == "bak"	)	return TileColorBackup;
-
-		if ( ext == "c"		)	return TileColorDocuent;
-		if ( ext == "cpp"	)	return TileColorDocuent;
-		if ( ext == "cc"	)	return TileColorDocuent;
-		if ( ext == "h"		)	return TileColorDocuent;
-		if ( ext == "hpp"	)	return TileColorDocuent;
-		if ( ext == "el"	)	return TileColorDocuent;
-
-		if ( ext == "o"		)	return TileColorObject;
-		if ( ext == "lo"	)	return TileColorObject;
-		if ( ext == "Po"	)	return TileColorObject;
-		if ( ext == "al"	)	return TileColorObject;
-		if ( ext == "moc.cpp"	)	return TileColorObject;
-		if ( ext == "moc.cc"	)	return TileColorObject;
-		if ( ext == "elc"	)	return TileColorObject;
-		if ( ext == "la"	)	return TileColorObject;
-		if ( ext == "a"		)	return TileColorObject;
-		if ( ext == "rpm"	)	return TileColorObject;
-
-		if ( lowerExt == "tar.bz2" )	return TileColorArchive;
-		if ( lowerExt == "tar.gz"  )	return TileColorArchive;
-		if ( lowerExt == "tgz"	)	return TileColorArchive;
-		if ( lowerExt == "bz2"	)	return TileColorArchive;
-		if ( lowerExt == "bz"	)	return TileColorArchive;
-		if ( lowerExt == "gz"	)	return TileColorArchive;
-
-		if ( lowerExt == "html"	)	return TileColorDocument;
-		if ( lowerExt == "htm"	)	return TileColorDocument;
-		if ( lowerExt == "txt"	)	return TileColorDocument;
-		if ( lowerExt == "doc"	)	return TileColorDocument;
-
-		if ( lowerExt == "png"	)	return TileColorImage;
-		if ( lowerExt == "jpg"	)	return TileColorImage;
-		if ( lowerExt == "jpeg"	)	return TileColorImage;
-		if ( lowerExt == "gif"	)	return TileColorImage;
-		if ( lowerExt == "tif"	)	return TileColorImage;
-		if ( lowerExt == "tiff"	)	return TileColorImage;
-		if ( lowerExt == "bmp"	)	return TileColorImage;
-		if ( lowerExt == "xpm"	)	return TileColorImage;
-		if ( lowerExt == "tga"	)	return TileColorImage;
-
-		if ( lowerExt == "wav"	)	return TileColorAudio;
-		if ( lowerExt == "mp3"	)	return TileColorAudio;
-
-		if ( lowerExt == "avi"	)	return TileColorVideo;
-		if ( lowerExt == "mov"	)	return TileColorVideo;
-		if ( lowerExt == "mpg"	)	return TileColorVideo;
-		if ( lowerExt == "mpeg"	)	return TileColorVideo;
-
-		if ( lowerExt == "pdf"	)	return TileColorDocument;
-		if ( lowerExt == "ps"	)	return TileColorExecutable;
-
-
-		// Some DOS/Windows types
-
-		if ( lowerExt == "exe"	)	return TileColorExecutable;
-		if ( lowerExt == "com"	)	return TileColorExecutable;
-		if ( lowerExt == "dll"	)	return TileColorObject;
-		if ( lowerExt == "zip"	)	return TileColorArchive;
-		if ( lowerExt == "arj"	)	return TileColorArchive;
-
-
-		// No match so far? Try the next extension. Some files might have
-		// more than one, e.g., "tar.bz2" - if there is no match for
-		// "tar.bz2", there might be one for just "bz2".
-
-		ext = ext.section( '.', 1 );
-	    }
 
-	    // Shared libs
-	    if ( QRegExp( "lib.*\\.so.*" ).exactMatch( file->name() ) )
-		return TileColorObject;
+void
+KTreemapView::setColorByAge( bool byAge )
+{
+    if ( byAge == _colorByAge )
+	return;
 
-	    // Very special, but common: Core dumps
-	    if ( file->name() == "core" )	return TileColorBackup;
+    _colorByAge = byAge;
 
-	    // Special case: Executables
-	    if ( ( file->mode() & S_IXUSR  ) == S_IXUSR )	return TileColorExecutable;
-	}
-	else // Directories
-	{
-	    // TO DO
-	    return Qt::blue;
-	}
-    }
+    // The tiles cache their colors, so they have to be created again.
 
-    return Qt::white;
+    if ( _rootTile )
+	rebuildTreemap();
 }
 
 
@@ -726,10 +926,10 @@ KTreemapView::tileColor( KFileInfo * file )
 
 
 
-KTreemapSelectionRect::KTreemapSelectionRect( QCanvas * canvas, const QColor & color )
+KTreemapSelectionRect::KTreemapSelectionRect( QCanvas * canvas, const QColor & color, int width )
     : QCanvasRectangle( canvas )
 {
-    setPen( QPen( color, 2 ) );
+    setPen( QPen( color, width ) );
     setZ( 1e10 );		// Higher than everything else
 }
 
@@ -17,6 +17,10 @@
 #endif
 
 #include <qcanvas.h>
+#include <qptrdict.h>
+#include <qptrlist.h>
+#include <qtimer.h>
+#include "ktreemaplayout.h"
 
 
 #define MinAmbientLight			0
@@ -25,11 +29,9 @@
 
 #define	MinHeightScalePercent		10
 #define	MaxHeightScalePercent		200
-#define DefaultHeightScalePercent	100
-#define DefaultHeightScaleFactor	( DefaultHeightScalePercent / 100.0 )
 
-#define DefaultMinTileSize		3
-#define CushionHeight			1.0
+#define DefaultProgressiveInterval	1000	// millisec
+#define DefaultProgressiveMaxTiles	2000
 
 
 class QMouseEvent;
@@ -40,7 +42,7 @@ namespace KDirStat
     class KTreemapTile;
     class KTreemapSelectionRect;
     class KDirTree;
-    class KFileInfo;
+    class KDirInfo;
 
     class KTreemapView:	public QCanvasView
     {
@@ -99,9 +101,13 @@ namespace KDirStat
 
 	/**
 	 * Returns a suitable color for 'file' based on a set of internal rules
-	 * (according to filename extension, MIME type or permissions).
+	 * (according to filename extension, MIME type or permissions) or, if
+	 * colorByAge() is set, based on its age. Files that are not accepted
+	 * by the tree's file filter are gray.
+	 *
+	 * This is just a shortcut for the KTreemapColors singleton.
 	 **/
-	QColor tileColor( KFileInfo * file );
+	QColor tileColor( KFileInfo * file ) const;
 
 
     public slots:
@@ -120,6 +126,13 @@ namespace KDirStat
 	 **/
         void selectTile( KFileInfo * node );
 
+	/**
+	 * Mark the tiles of all selected items of the tree (see @ref
+	 * KDirTree::selectedItems() ) other than the selected tile with a thin
+	 * outline.
+	 **/
+	void markSelectedItems();
+
 	/**
 	 * Zoom in one level towards the currently selected treemap tile:
 	 * The entire treemap will be rebuilt with the near-topmost ancestor of
@@ -150,6 +163,12 @@ namespace KDirStat
 	 **/
 	void rebuildTreemap();
 
+	/**
+	 * Color the tiles by the age of their files rather than by file type.
+	 * Rebuilds the treemap if this changes anything.
+	 **/
+	void setColorByAge( bool byAge );
+
 	/**
 	 * Clear the treemap contents.
 	 **/
@@ -172,6 +191,35 @@ namespace KDirStat
 	 **/
 	void readConfig();
 
+	/**
+	 * Start rebuilding the treemap periodically while the tree is being
+	 * read. This is a NOP if progressive treemaps are disabled in the
+	 * config.
+	 **/
+	void startProgressive();
+
+	/**
+	 * Stop rebuilding the treemap periodically.
+	 **/
+	void stopProgressive();
+
+    protected slots:
+
+	/**
+	 * Rebuild the treemap from the partial totals of the tree that is
+	 * currently being read - if anything changed since the last time -
+	 * and schedule the next update. The interval is adapted so the
+	 * treemap never takes more than a small fraction of the reading time.
+	 **/
+	void progressiveUpdate();
+
+	/**
+	 * Notification that 'dir' is about to be finalized, i.e. its dot
+	 * entry might be deleted. Any tile that refers to that dot entry is
+	 * thrown away.
+	 **/
+	void finalizeLocalNotify( KDirInfo * dir );
+
     public:
 
 	/**
@@ -255,6 +303,12 @@ namespace KDirStat
 	 **/
 	bool ensureContrast() const { return _ensureContrast; }
 
+	/**
+	 * Returns 'true' if tiles are colored by the age of their files
+	 * rather than by file type.
+	 **/
+	bool colorByAge() const { return _colorByAge; }
+
 	/**
 	 * Returns the minimum tile size in pixels. No treemap tiles less than
 	 * this in width or height are desired.
@@ -283,6 +337,19 @@ namespace KDirStat
 	 **/
 	const QColor & dirFillColor() const { return _dirFillColor; }
 
+	/**
+	 * Returns the color for "small items" tiles that summarize all
+	 * children of a directory that are too small to be displayed
+	 * individually.
+	 **/
+	const QColor & smallItemsColor() const { return _smallItemsColor; }
+
+	/**
+	 * Returns the cushion surfaces of the current tiles.
+	 * See @ref KTreemapTile::cushionIndex().
+	 **/
+	const KCushionBuffer & cushions() const { return _cushions; }
+
 	/**
 	 * Returns the intensity of ambient light for cushion shading 
 	 * [0..255]
@@ -314,6 +381,13 @@ namespace KDirStat
 	 **/
 	double heightScaleFactor() const { return _heightScaleFactor; }
 
+	/**
+	 * Returns 'true' if the treemap is periodically rebuilt while the tree
+	 * is being read, 'false' if not.
+	 **/
+	bool isProgressive() const { return _progressive; }
+
+
 
     signals:
 
@@ -361,6 +435,12 @@ namespace KDirStat
 	 **/
 	virtual void contentsMouseDoubleClickEvent( QMouseEvent * event );
 
+	/**
+	 * Add the item of 'tile' to the tree's selected items or remove it
+	 * from them (Ctrl-click).
+	 **/
+	void toggleSelected( KTreemapTile * tile );
+
 	/**
 	 * Resize the treemap view. Suppress the treemap contents if the size
 	 * falls below a minimum size, redisplay it if it grows above that
@@ -370,6 +450,11 @@ namespace KDirStat
 	 **/
 	virtual void resizeEvent( QResizeEvent * event );
 
+	/**
+	 * Create the canvas tiles for the nodes of the current layout.
+	 **/
+	void createTiles();
+
 	/**
 	 * Convenience method to read a color from 'config'.
 	 **/
@@ -383,6 +468,7 @@ namespace KDirStat
 	KTreemapTile *		_rootTile;
 	KTreemapTile * 		_selectedTile;
 	KTreemapSelectionRect *	_selectionRect;
+	QPtrList<KTreemapSelectionRect> _markRects;
 	QString			_savedRootUrl;
 
 	bool			_autoResize;
@@ -390,6 +476,7 @@ namespace KDirStat
 	bool			_doCushionShading;
 	bool			_forceCushionGrid;
 	bool			_ensureContrast;
+	bool			_colorByAge;
 	int			_minTileSize;
 
 	QColor			_highlightColor;
@@ -397,6 +484,7 @@ namespace KDirStat
 	QColor			_outlineColor;
 	QColor			_fileFillColor;
 	QColor			_dirFillColor;
+	QColor			_smallItemsColor;
 
 	int			_ambientLight;
 
@@ -406,6 +494,18 @@ namespace KDirStat
 
 	double 			_heightScaleFactor;
 
+	bool			_progressiveEnabled;
+	bool			_progressive;
+	int			_progressiveInterval;
+	int			_progressiveMaxTiles;
+	QTimer			_progressiveTimer;
+	KFileSize		_progressiveLastSize;
+	int			_progressiveLastItems;
+	QPtrDict<KTreemapTile>	_dotEntryTiles;
+
+	KTreemapLayout		_layout;
+	KCushionBuffer		_cushions;
+
     }; // class KTreemapView
 
 
@@ -418,6 +518,8 @@ namespace KDirStat
      * visible. This selection rectangle simply draws a two-pixel red outline
      * on top (i.e., great z-height) of everything else. The rectangle is
      * transparent, so the treemap tile contents remain visible.
+     *
+     * With a one-pixel outline, this marks the other selected items.
      **/
     class KTreemapSelectionRect: public QCanvasRectangle
     {
@@ -426,7 +528,7 @@ namespace KDirStat
 	/**
 	 * Constructor.
 	 **/
-	KTreemapSelectionRect( QCanvas * canvas, const QColor & color );
+	KTreemapSelectionRect( QCanvas * canvas, const QColor & color, int width = 2 );
 
 	/**
 	 * Highlight the specified treemap tile: Resize this selection